@@ -0,0 +1,184 @@
+#!/usr/bin/env julia
+
+# Throughput of every record access path over synthetic DBN files.
+#
+#     julia --project=. benchmark/run.jl [--records N] [--instruments N] [--check]
+#
+# Each path reads the same generated MBO file end to end and reports
+# records/sec, ns/record and bytes allocated per record. With `--check` the
+# script exits with status 1 when a path misses its target in TARGETS, so a
+# regression fails CI instead of showing up as a slower backtest. The C++ side
+# of the same paths is `databento_jl_bench`, built with
+# -DDATABENTO_JL_BUILD_BENCHMARKS=ON.
+
+using Databento
+using Databento: DbnFileStore, MboMsg, consume!, get_mbo_if, next_record
+using Printf
+
+# Minimum records/sec and maximum bytes allocated per record for each path.
+# Rates are set well below a laptop run so only real regressions trip them;
+# per-record paths allocate a little for CxxWrap's pointer wrappers, batch
+# paths must not allocate per record at all.
+const TARGETS = Dict(
+    "next_record"                 => (rate = 5e6,   bytes = 64.0),
+    "next_record (zstd)"          => (rate = 3e6,   bytes = 64.0),
+    "get_mbo_if + unsafe_load"    => (rate = 3e6,   bytes = 128.0),
+    "per-field accessors"         => (rate = 2e6,   bytes = 128.0),
+    "read_columns!"               => (rate = 30e6,  bytes = 0.1),
+    "read_columns! (zstd)"        => (rate = 15e6,  bytes = 0.1),
+    "read_columns! (filtered)"    => (rate = 30e6,  bytes = 0.1),
+    "read_columns! (mmap)"        => (rate = 50e6,  bytes = 0.1),
+    "read_columns! (prefetch)"    => (rate = 20e6,  bytes = 0.1),
+    "records_view"                => (rate = 200e6, bytes = 0.1),
+    "consume! (order books)"      => (rate = 10e6,  bytes = 0.1),
+)
+
+const CHUNK = 65_536
+
+function drain_next_record(path)
+    store = DbnFileStore(path)
+    n = 0
+    while next_record(store) != C_NULL
+        n += 1
+    end
+    return n
+end
+
+function drain_get_if(path)
+    store = DbnFileStore(path)
+    n = 0
+    while (record_ptr = next_record(store)) != C_NULL
+        mbo_ptr = get_mbo_if(unsafe_load(record_ptr))
+        mbo_ptr != C_NULL && unsafe_load(mbo_ptr)
+        n += 1
+    end
+    return n
+end
+
+function drain_accessors(path)
+    store = DbnFileStore(path)
+    n = 0
+    checksum = 0
+    while (record_ptr = next_record(store)) != C_NULL
+        mbo_ptr = get_mbo_if(unsafe_load(record_ptr))
+        if mbo_ptr != C_NULL
+            mbo = unsafe_load(mbo_ptr)
+            checksum += Databento.price(mbo) + Databento.size(mbo) + Databento.order_id(mbo)
+        end
+        n += 1
+    end
+    return n
+end
+
+function drain_columns(source, cols; filter=nothing)
+    n = 0
+    while (k = read_columns!(source, cols; filter)) > 0
+        n += k
+    end
+    return n
+end
+
+function drain_filtered(path, cols)
+    filter = record_filter(instrument_ids = (1,))
+    drain_columns(DbnFileStore(path), cols; filter)
+    # Rate over the records scanned, not the few that matched
+    return filter_stats(filter).scanned
+end
+
+function drain_records_view(path)
+    reader = MmapDbnReader(path)
+    records = records_view(reader, MboMsg)
+    # Read each price in place (offset 24: header, then order_id) so the loop
+    # touches every record
+    checksum = 0
+    GC.@preserve records for i in eachindex(records)
+        checksum += unsafe_load(Ptr{Int64}(pointer(records, i) + 24))
+    end
+    checksum == 0 && error("no prices read")
+    return length(records)
+end
+
+drain_order_books(path) = consume!(OrderBookEngine(), MmapDbnReader(path))
+
+function paths(raw, zst, cols)
+    return [
+        "next_record"              => () -> drain_next_record(raw),
+        "next_record (zstd)"       => () -> drain_next_record(zst),
+        "get_mbo_if + unsafe_load" => () -> drain_get_if(raw),
+        "per-field accessors"      => () -> drain_accessors(raw),
+        "read_columns!"            => () -> drain_columns(DbnFileStore(raw), cols),
+        "read_columns! (zstd)"     => () -> drain_columns(DbnFileStore(zst), cols),
+        "read_columns! (filtered)" => () -> drain_filtered(raw, cols),
+        "read_columns! (mmap)"     => () -> drain_columns(MmapDbnReader(raw), cols),
+        "read_columns! (prefetch)" => () -> drain_columns(PrefetchDbnFileStore(zst), cols),
+        "records_view"             => () -> drain_records_view(raw),
+        "consume! (order books)"   => () -> drain_order_books(raw),
+    ]
+end
+
+# Runs `f` once and returns (records, seconds, bytes allocated)
+function measure(f)
+    GC.gc()
+    stats = @timed f()
+    return stats.value, stats.time, stats.bytes
+end
+
+function parse_args(args)
+    records = 10_000_000
+    instruments = 16
+    check = false
+    i = 1
+    while i <= length(args)
+        if args[i] == "--records"
+            records = parse(Int, args[i += 1])
+        elseif args[i] == "--instruments"
+            instruments = parse(Int, args[i += 1])
+        elseif args[i] == "--check"
+            check = true
+        else
+            error("unknown argument $(args[i])")
+        end
+        i += 1
+    end
+    return (; records, instruments, check)
+end
+
+function main(args)
+    opts = parse_args(args)
+    dir = mktempdir()
+    cols = MboColumns(CHUNK)
+
+    # Compile every path on a small file first so the timed runs exclude JIT
+    warm_raw = joinpath(dir, "warm.dbn")
+    warm_zst = joinpath(dir, "warm.dbn.zst")
+    write_synthetic_dbn(warm_raw; instruments = opts.instruments, records = 1_000)
+    write_synthetic_dbn(warm_zst; instruments = opts.instruments, records = 1_000)
+    foreach(((_, f),) -> f(), paths(warm_raw, warm_zst, cols))
+
+    raw = joinpath(dir, "mbo.dbn")
+    zst = joinpath(dir, "mbo.dbn.zst")
+    write_synthetic_dbn(raw; instruments = opts.instruments, records = opts.records)
+    write_synthetic_dbn(zst; instruments = opts.instruments, records = opts.records)
+    @printf("%d MBO records over %d instruments (%.1f MB raw, %.1f MB zstd)\n\n",
+            opts.records, opts.instruments, filesize(raw) / 1e6, filesize(zst) / 1e6)
+
+    @printf("%-26s %14s %10s %12s  %s\n", "path", "records/s", "ns/record", "bytes/record", "target")
+    failures = String[]
+    for (name, f) in paths(raw, zst, cols)
+        n, seconds, bytes = measure(f)
+        rate = n / seconds
+        per_record = bytes / n
+        target = TARGETS[name]
+        ok = rate >= target.rate && per_record <= target.bytes
+        ok || push!(failures, name)
+        @printf("%-26s %14.0f %10.2f %12.2f  %s\n", name, rate, 1e9 / rate, per_record,
+                ok ? "ok" : "MISSED (>= $(target.rate) rec/s, <= $(target.bytes) B/rec)")
+    end
+
+    if opts.check && !isempty(failures)
+        println("\n", length(failures), " path(s) missed their target: ", join(failures, ", "))
+        exit(1)
+    end
+end
+
+main(ARGS)
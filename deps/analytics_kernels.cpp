@@ -0,0 +1,345 @@
+#include "analytics_kernels.hpp"
+
+#include <databento/constants.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define DATABENTO_JL_HAS_AVX2_KERNELS 1
+#include <immintrin.h>
+#else
+#define DATABENTO_JL_HAS_AVX2_KERNELS 0
+#endif
+
+namespace databento_jl {
+
+namespace {
+constexpr double kPriceScale = 1e-9;
+constexpr double kHalfPriceScale = 0.5e-9;
+constexpr std::int64_t kUndefPrice = databento::kUndefPrice;
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+// Rows per AddTrades pass through the vectorized kernels
+constexpr std::size_t kChunkRows = 4096;
+
+std::atomic<bool> simd_enabled{true};
+
+// ============================================================================
+// Scalar kernels
+// ============================================================================
+
+void ScalePricesScalar(const std::int64_t* price, std::size_t n, double* out) {
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = price[i] == kUndefPrice ? kNaN : static_cast<double>(price[i]) * kPriceScale;
+  }
+}
+
+void MidPricesScalar(const std::int64_t* bid_px, const std::int64_t* ask_px, std::size_t n,
+                     double* out) {
+  for (std::size_t i = 0; i < n; ++i) {
+    const double sum = static_cast<double>(bid_px[i]) + static_cast<double>(ask_px[i]);
+    out[i] = bid_px[i] == kUndefPrice || ask_px[i] == kUndefPrice ? kNaN : sum * kHalfPriceScale;
+  }
+}
+
+void SpreadsScalar(const std::int64_t* bid_px, const std::int64_t* ask_px, std::size_t n,
+                   double* out) {
+  for (std::size_t i = 0; i < n; ++i) {
+    const double spread = static_cast<double>(ask_px[i]) - static_cast<double>(bid_px[i]);
+    out[i] = bid_px[i] == kUndefPrice || ask_px[i] == kUndefPrice ? kNaN : spread * kPriceScale;
+  }
+}
+
+void MicropricesScalar(const std::int64_t* bid_px, const std::int64_t* ask_px,
+                       const std::uint32_t* bid_sz, const std::uint32_t* ask_sz, std::size_t n,
+                       double* out) {
+  for (std::size_t i = 0; i < n; ++i) {
+    const double bid = static_cast<double>(bid_px[i]);
+    const double ask = static_cast<double>(ask_px[i]);
+    const double bsz = static_cast<double>(bid_sz[i]);
+    const double asz = static_cast<double>(ask_sz[i]);
+    const double micro = (bid * asz + ask * bsz) / (bsz + asz);
+    out[i] = bid_px[i] == kUndefPrice || ask_px[i] == kUndefPrice ? kNaN : micro * kPriceScale;
+  }
+}
+
+void SignedVolumesScalar(const std::uint32_t* size, const std::uint8_t* side, std::size_t n,
+                         std::int64_t* out) {
+  for (std::size_t i = 0; i < n; ++i) {
+    const auto volume = static_cast<std::int64_t>(size[i]);
+    out[i] = side[i] == 'B' ? volume : side[i] == 'A' ? -volume : 0;
+  }
+}
+
+// ============================================================================
+// AVX2 kernels
+// ============================================================================
+
+#if DATABENTO_JL_HAS_AVX2_KERNELS
+#define DATABENTO_JL_AVX2 __attribute__((target("avx2")))
+
+// Exact int64 to double conversion, rounded like a scalar cast: the high
+// 48 and low 16 bits are converted exactly through magic-number doubles and
+// added with a single rounding
+DATABENTO_JL_AVX2 inline __m256d Int64ToDouble(__m256i x) {
+  __m256i high = _mm256_srai_epi32(x, 16);
+  high = _mm256_blend_epi16(high, _mm256_setzero_si256(), 0x33);
+  high = _mm256_add_epi64(high, _mm256_castpd_si256(_mm256_set1_pd(442721857769029238784.0)));
+  const __m256i low =
+      _mm256_blend_epi16(x, _mm256_castpd_si256(_mm256_set1_pd(0x0010000000000000)), 0x88);
+  const __m256d f =
+      _mm256_sub_pd(_mm256_castsi256_pd(high), _mm256_set1_pd(442726361368656609280.0));
+  return _mm256_add_pd(f, _mm256_castsi256_pd(low));
+}
+
+// cvtepi32_pd is signed, so flip the sign bit and add 2^31 back
+DATABENTO_JL_AVX2 inline __m256d UInt32ToDouble(const std::uint32_t* p) {
+  const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  const __m128i flipped = _mm_xor_si128(x, _mm_set1_epi32(std::numeric_limits<std::int32_t>::min()));
+  return _mm256_add_pd(_mm256_cvtepi32_pd(flipped), _mm256_set1_pd(2147483648.0));
+}
+
+DATABENTO_JL_AVX2 inline __m256i LoadPrices(const std::int64_t* p) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+DATABENTO_JL_AVX2 inline __m256d UndefMask(__m256i price) {
+  return _mm256_castsi256_pd(_mm256_cmpeq_epi64(price, _mm256_set1_epi64x(kUndefPrice)));
+}
+
+DATABENTO_JL_AVX2 void ScalePricesAvx2(const std::int64_t* price, std::size_t n, double* out) {
+  const __m256d scale = _mm256_set1_pd(kPriceScale);
+  const __m256d nan = _mm256_set1_pd(kNaN);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m256i p = LoadPrices(price + i);
+    const __m256d value = _mm256_mul_pd(Int64ToDouble(p), scale);
+    _mm256_storeu_pd(out + i, _mm256_blendv_pd(value, nan, UndefMask(p)));
+  }
+  ScalePricesScalar(price + i, n - i, out + i);
+}
+
+DATABENTO_JL_AVX2 void MidPricesAvx2(const std::int64_t* bid_px, const std::int64_t* ask_px,
+                                     std::size_t n, double* out) {
+  const __m256d scale = _mm256_set1_pd(kHalfPriceScale);
+  const __m256d nan = _mm256_set1_pd(kNaN);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m256i bid = LoadPrices(bid_px + i);
+    const __m256i ask = LoadPrices(ask_px + i);
+    const __m256d sum = _mm256_add_pd(Int64ToDouble(bid), Int64ToDouble(ask));
+    const __m256d undef = _mm256_or_pd(UndefMask(bid), UndefMask(ask));
+    _mm256_storeu_pd(out + i, _mm256_blendv_pd(_mm256_mul_pd(sum, scale), nan, undef));
+  }
+  MidPricesScalar(bid_px + i, ask_px + i, n - i, out + i);
+}
+
+DATABENTO_JL_AVX2 void SpreadsAvx2(const std::int64_t* bid_px, const std::int64_t* ask_px,
+                                   std::size_t n, double* out) {
+  const __m256d scale = _mm256_set1_pd(kPriceScale);
+  const __m256d nan = _mm256_set1_pd(kNaN);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m256i bid = LoadPrices(bid_px + i);
+    const __m256i ask = LoadPrices(ask_px + i);
+    const __m256d spread = _mm256_sub_pd(Int64ToDouble(ask), Int64ToDouble(bid));
+    const __m256d undef = _mm256_or_pd(UndefMask(bid), UndefMask(ask));
+    _mm256_storeu_pd(out + i, _mm256_blendv_pd(_mm256_mul_pd(spread, scale), nan, undef));
+  }
+  SpreadsScalar(bid_px + i, ask_px + i, n - i, out + i);
+}
+
+DATABENTO_JL_AVX2 void MicropricesAvx2(const std::int64_t* bid_px, const std::int64_t* ask_px,
+                                       const std::uint32_t* bid_sz, const std::uint32_t* ask_sz,
+                                       std::size_t n, double* out) {
+  const __m256d scale = _mm256_set1_pd(kPriceScale);
+  const __m256d nan = _mm256_set1_pd(kNaN);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m256i bid = LoadPrices(bid_px + i);
+    const __m256i ask = LoadPrices(ask_px + i);
+    const __m256d bsz = UInt32ToDouble(bid_sz + i);
+    const __m256d asz = UInt32ToDouble(ask_sz + i);
+    const __m256d weighted = _mm256_add_pd(_mm256_mul_pd(Int64ToDouble(bid), asz),
+                                           _mm256_mul_pd(Int64ToDouble(ask), bsz));
+    const __m256d micro = _mm256_div_pd(weighted, _mm256_add_pd(bsz, asz));
+    const __m256d undef = _mm256_or_pd(UndefMask(bid), UndefMask(ask));
+    _mm256_storeu_pd(out + i, _mm256_blendv_pd(_mm256_mul_pd(micro, scale), nan, undef));
+  }
+  MicropricesScalar(bid_px + i, ask_px + i, bid_sz + i, ask_sz + i, n - i, out + i);
+}
+
+DATABENTO_JL_AVX2 void SignedVolumesAvx2(const std::uint32_t* size, const std::uint8_t* side,
+                                         std::size_t n, std::int64_t* out) {
+  const __m256i buy = _mm256_set1_epi64x('B');
+  const __m256i sell = _mm256_set1_epi64x('A');
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m256i volume =
+        _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(size + i)));
+    std::int32_t sides;
+    std::memcpy(&sides, side + i, sizeof(sides));
+    const __m256i s = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(sides));
+    const __m256i bought = _mm256_and_si256(volume, _mm256_cmpeq_epi64(s, buy));
+    const __m256i sold = _mm256_and_si256(volume, _mm256_cmpeq_epi64(s, sell));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_sub_epi64(bought, sold));
+  }
+  SignedVolumesScalar(size + i, side + i, n - i, out + i);
+}
+
+bool CpuHasAvx2() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+}
+#else
+bool CpuHasAvx2() { return false; }
+#endif
+
+bool UseAvx2() {
+  static const bool has_avx2 = CpuHasAvx2();
+  return has_avx2 && simd_enabled.load(std::memory_order_relaxed);
+}
+}  // namespace
+
+// ============================================================================
+// Dispatch
+// ============================================================================
+
+SimdLevel ActiveSimdLevel() { return UseAvx2() ? SimdLevel::kAvx2 : SimdLevel::kScalar; }
+
+void SetSimdEnabled(bool enabled) { simd_enabled.store(enabled, std::memory_order_relaxed); }
+
+#if DATABENTO_JL_HAS_AVX2_KERNELS
+#define DATABENTO_JL_DISPATCH(kernel, ...) \
+  (UseAvx2() ? kernel##Avx2(__VA_ARGS__) : kernel##Scalar(__VA_ARGS__))
+#else
+#define DATABENTO_JL_DISPATCH(kernel, ...) kernel##Scalar(__VA_ARGS__)
+#endif
+
+void ScalePrices(const std::int64_t* price, std::size_t n, double* out) {
+  DATABENTO_JL_DISPATCH(ScalePrices, price, n, out);
+}
+
+void MidPrices(const std::int64_t* bid_px, const std::int64_t* ask_px, std::size_t n,
+               double* out) {
+  DATABENTO_JL_DISPATCH(MidPrices, bid_px, ask_px, n, out);
+}
+
+void Spreads(const std::int64_t* bid_px, const std::int64_t* ask_px, std::size_t n,
+             double* out) {
+  DATABENTO_JL_DISPATCH(Spreads, bid_px, ask_px, n, out);
+}
+
+void Microprices(const std::int64_t* bid_px, const std::int64_t* ask_px,
+                 const std::uint32_t* bid_sz, const std::uint32_t* ask_sz, std::size_t n,
+                 double* out) {
+  DATABENTO_JL_DISPATCH(Microprices, bid_px, ask_px, bid_sz, ask_sz, n, out);
+}
+
+void SignedVolumes(const std::uint32_t* size, const std::uint8_t* side, std::size_t n,
+                   std::int64_t* out) {
+  DATABENTO_JL_DISPATCH(SignedVolumes, size, side, n, out);
+}
+
+// ============================================================================
+// GroupedAnalytics
+// ============================================================================
+
+std::uint32_t GroupedAnalytics::GroupOf(std::uint32_t instrument_id) {
+  if (has_cached_ && cached_id_ == instrument_id) {
+    return cached_group_;
+  }
+  const auto next = static_cast<std::uint32_t>(instrument_ids_.size());
+  const auto [group, inserted] = index_.TryEmplace(instrument_id, next);
+  if (inserted) {
+    instrument_ids_.push_back(instrument_id);
+    groups_.push_back(Group{{}, {}, {}, {}, {}, kNaN});
+  }
+  cached_id_ = instrument_id;
+  cached_group_ = *group;
+  has_cached_ = true;
+  return cached_group_;
+}
+
+void GroupedAnalytics::GroupIndexes(const std::uint32_t* instrument_id, std::size_t n,
+                                    std::uint32_t* out) {
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = GroupOf(instrument_id[i]);
+  }
+}
+
+void GroupedAnalytics::AddTrades(const std::uint32_t* instrument_id, const std::int64_t* price,
+                                 const std::uint32_t* size, const std::uint8_t* side,
+                                 std::size_t n) {
+  scratch_price_.resize(std::min(n, kChunkRows));
+  scratch_signed_.resize(std::min(n, kChunkRows));
+  for (std::size_t start = 0; start < n; start += kChunkRows) {
+    const std::size_t rows = std::min(kChunkRows, n - start);
+    // Element-wise work goes through the vector kernels; only the
+    // accumulation into groups is scalar
+    ScalePrices(price + start, rows, scratch_price_.data());
+    SignedVolumes(size + start, side + start, rows, scratch_signed_.data());
+    for (std::size_t i = 0; i < rows; ++i) {
+      Group& group = groups_[GroupOf(instrument_id[start + i])];
+      const std::uint32_t volume = size[start + i];
+      if (!std::isnan(scratch_price_[i])) {
+        group.notional += scratch_price_[i] * volume;
+        group.priced_volume += volume;
+      }
+      group.volume += volume;
+      group.signed_volume += scratch_signed_[i];
+      ++group.trades;
+    }
+  }
+}
+
+void GroupedAnalytics::TradeTotals(std::uint32_t* instrument_id, double* vwap,
+                                   std::uint64_t* volume, std::int64_t* signed_volume,
+                                   std::uint64_t* trades) const {
+  for (std::size_t g = 0; g < groups_.size(); ++g) {
+    const Group& group = groups_[g];
+    if (instrument_id != nullptr) {
+      instrument_id[g] = instrument_ids_[g];
+    }
+    if (vwap != nullptr) {
+      vwap[g] = group.priced_volume == 0
+                    ? kNaN
+                    : group.notional / static_cast<double>(group.priced_volume);
+    }
+    if (volume != nullptr) {
+      volume[g] = group.volume;
+    }
+    if (signed_volume != nullptr) {
+      signed_volume[g] = group.signed_volume;
+    }
+    if (trades != nullptr) {
+      trades[g] = group.trades;
+    }
+  }
+}
+
+void GroupedAnalytics::Returns(const std::uint32_t* instrument_id, const double* value,
+                               std::size_t n, double* out) {
+  for (std::size_t i = 0; i < n; ++i) {
+    Group& group = groups_[GroupOf(instrument_id[i])];
+    if (!std::isfinite(value[i])) {
+      out[i] = kNaN;
+      continue;
+    }
+    // NaN until the instrument has a previous value
+    out[i] = value[i] / group.last_value - 1.0;
+    group.last_value = value[i];
+  }
+}
+
+void GroupedAnalytics::Clear() {
+  index_.Clear();
+  instrument_ids_.clear();
+  groups_.clear();
+  has_cached_ = false;
+}
+
+}  // namespace databento_jl
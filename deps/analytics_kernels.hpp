@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "flat_hash_map.hpp"
+
+namespace databento_jl {
+
+// Column kernels over the struct-of-arrays buffers filled by read_columns!.
+//
+// Each kernel reads `n` rows and writes `n` results into caller-owned
+// buffers. Fixed-point prices are int64 in units of 1e-9; an undefined price
+// (INT64_MAX) turns every result derived from it into NaN. The element-wise
+// kernels use AVX2 when the CPU supports it and a scalar loop otherwise,
+// chosen at runtime; both produce bit-identical results.
+
+enum class SimdLevel : std::uint8_t { kScalar, kAvx2 };
+
+// Instruction set the kernels currently use
+SimdLevel ActiveSimdLevel();
+// Disabling SIMD forces the scalar loops, e.g. to compare the two paths.
+// Enabling has no effect on CPUs without AVX2.
+void SetSimdEnabled(bool enabled);
+
+// price * 1e-9
+void ScalePrices(const std::int64_t* price, std::size_t n, double* out);
+// (bid + ask) / 2
+void MidPrices(const std::int64_t* bid_px, const std::int64_t* ask_px, std::size_t n,
+               double* out);
+// ask - bid
+void Spreads(const std::int64_t* bid_px, const std::int64_t* ask_px, std::size_t n,
+             double* out);
+// Size-weighted mid, (bid * ask_sz + ask * bid_sz) / (bid_sz + ask_sz); NaN
+// when both sizes are 0
+void Microprices(const std::int64_t* bid_px, const std::int64_t* ask_px,
+                 const std::uint32_t* bid_sz, const std::uint32_t* ask_sz, std::size_t n,
+                 double* out);
+// +size for buy aggressors ('B'), -size for sell aggressors ('A'), 0 when the
+// side is unknown ('N')
+void SignedVolumes(const std::uint32_t* size, const std::uint8_t* side, std::size_t n,
+                   std::int64_t* out);
+
+// Per-instrument kernels that carry state across chunks.
+//
+// Instruments get dense group indexes in order of first appearance; these
+// index the per-group results, so a caller can size its output buffers with
+// GroupCount() and keep them across calls.
+class GroupedAnalytics {
+ public:
+  std::size_t GroupCount() const { return instrument_ids_.size(); }
+  std::uint32_t InstrumentId(std::size_t group) const { return instrument_ids_[group]; }
+  std::uint32_t GroupOf(std::uint32_t instrument_id);
+
+  // Writes the group index of every row
+  void GroupIndexes(const std::uint32_t* instrument_id, std::size_t n, std::uint32_t* out);
+
+  // Accumulates VWAP, volume, signed volume and trade counts per instrument.
+  // Trades with an undefined price count towards the volumes but not the
+  // VWAP.
+  void AddTrades(const std::uint32_t* instrument_id, const std::int64_t* price,
+                 const std::uint32_t* size, const std::uint8_t* side, std::size_t n);
+  // Writes GroupCount() entries to each non-null buffer; the VWAP of an
+  // instrument without priced trades is NaN
+  void TradeTotals(std::uint32_t* instrument_id, double* vwap, std::uint64_t* volume,
+                   std::int64_t* signed_volume, std::uint64_t* trades) const;
+
+  // Simple returns value / previous - 1 against the previous finite value of
+  // the same instrument, e.g. over trade prices from ScalePrices or mids.
+  // The first value of an instrument and non-finite values give NaN.
+  void Returns(const std::uint32_t* instrument_id, const double* value, std::size_t n,
+               double* out);
+
+  void Clear();
+
+ private:
+  struct Group {
+    double notional{};
+    std::uint64_t priced_volume{};
+    std::uint64_t volume{};
+    std::int64_t signed_volume{};
+    std::uint64_t trades{};
+    double last_value;
+  };
+
+  FlatHashMap<std::uint32_t, std::uint32_t> index_;
+  std::vector<std::uint32_t> instrument_ids_;
+  std::vector<Group> groups_;
+  // Rows of one instrument tend to cluster, so remember the last lookup
+  std::uint32_t cached_id_{};
+  std::uint32_t cached_group_{};
+  bool has_cached_{};
+  // Scaled prices and signed volumes of the chunk being added
+  std::vector<double> scratch_price_;
+  std::vector<std::int64_t> scratch_signed_;
+};
+
+}  // namespace databento_jl
@@ -0,0 +1,371 @@
+#include "arrow_batch.hpp"
+
+#include <databento/constants.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <stdexcept>
+
+namespace databento_jl {
+
+namespace {
+constexpr std::size_t kAlignment = 64;
+
+AlignedBuffer AllocateColumn(std::size_t bytes) {
+  // aligned_alloc needs a non-zero multiple of the alignment
+  const std::size_t size = std::max<std::size_t>(kAlignment, (bytes + kAlignment - 1) /
+                                                                  kAlignment * kAlignment);
+  void* p = std::aligned_alloc(kAlignment, size);
+  if (p == nullptr) {
+    throw std::bad_alloc{};
+  }
+  return AlignedBuffer{static_cast<std::byte*>(p)};
+}
+
+std::vector<ArrowField> HeaderFields() {
+  return {{"ts_event", ArrowType::kTimestampNs, false},
+          {"instrument_id", ArrowType::kUInt32, false},
+          {"publisher_id", ArrowType::kUInt16, false}};
+}
+
+// Fields shared by TradeMsg and Mbp1Msg, in TradeColumns order
+std::vector<ArrowField> TradeFields() {
+  std::vector<ArrowField> fields = HeaderFields();
+  fields.insert(fields.end(), {{"ts_recv", ArrowType::kTimestampNs, false},
+                               {"price", ArrowType::kInt64, true},
+                               {"size", ArrowType::kUInt32, false},
+                               {"action", ArrowType::kUInt8, false},
+                               {"side", ArrowType::kUInt8, false},
+                               {"flags", ArrowType::kUInt8, false},
+                               {"depth", ArrowType::kUInt8, false},
+                               {"ts_in_delta", ArrowType::kInt32, false},
+                               {"sequence", ArrowType::kUInt32, false}});
+  return fields;
+}
+
+std::vector<ArrowField> MboFields() {
+  std::vector<ArrowField> fields = HeaderFields();
+  fields.insert(fields.end(), {{"ts_recv", ArrowType::kTimestampNs, false},
+                               {"order_id", ArrowType::kUInt64, false},
+                               {"price", ArrowType::kInt64, true},
+                               {"size", ArrowType::kUInt32, false},
+                               {"flags", ArrowType::kUInt8, false},
+                               {"channel_id", ArrowType::kUInt8, false},
+                               {"action", ArrowType::kUInt8, false},
+                               {"side", ArrowType::kUInt8, false},
+                               {"ts_in_delta", ArrowType::kInt32, false},
+                               {"sequence", ArrowType::kUInt32, false}});
+  return fields;
+}
+
+std::vector<ArrowField> Mbp1Fields() {
+  std::vector<ArrowField> fields = TradeFields();
+  fields.insert(fields.end(), {{"bid_px", ArrowType::kInt64, true},
+                               {"ask_px", ArrowType::kInt64, true},
+                               {"bid_sz", ArrowType::kUInt32, false},
+                               {"ask_sz", ArrowType::kUInt32, false},
+                               {"bid_ct", ArrowType::kUInt32, false},
+                               {"ask_ct", ArrowType::kUInt32, false}});
+  return fields;
+}
+
+std::vector<ArrowField> OhlcvFields() {
+  std::vector<ArrowField> fields = HeaderFields();
+  fields.insert(fields.end(), {{"open", ArrowType::kInt64, true},
+                               {"high", ArrowType::kInt64, true},
+                               {"low", ArrowType::kInt64, true},
+                               {"close", ArrowType::kInt64, true},
+                               {"volume", ArrowType::kUInt64, false}});
+  return fields;
+}
+
+// Private data of one exported child array: its buffer and the pointer table
+struct ExportedColumn {
+  AlignedBuffer data;
+  const void* buffers[2];
+};
+
+// Private data of the exported struct array
+struct ExportedBatch {
+  std::vector<ArrowArray> children;
+  std::vector<ArrowArray*> child_pointers;
+  const void* buffers[1];
+};
+
+void ReleaseColumn(ArrowArray* array) {
+  delete static_cast<ExportedColumn*>(array->private_data);
+  array->release = nullptr;
+}
+
+void ReleaseBatch(ArrowArray* array) {
+  auto* exported = static_cast<ExportedBatch*>(array->private_data);
+  for (ArrowArray& child : exported->children) {
+    // Children moved out by the consumer have been marked released
+    if (child.release != nullptr) {
+      child.release(&child);
+    }
+  }
+  delete exported;
+  array->release = nullptr;
+}
+
+struct ExportedField {
+  std::string name;
+};
+
+struct ExportedSchema {
+  std::vector<ArrowSchema> children;
+  std::vector<ArrowSchema*> child_pointers;
+};
+
+void ReleaseField(ArrowSchema* schema) {
+  delete static_cast<ExportedField*>(schema->private_data);
+  schema->release = nullptr;
+}
+
+void ReleaseSchema(ArrowSchema* schema) {
+  auto* exported = static_cast<ExportedSchema*>(schema->private_data);
+  for (ArrowSchema& child : exported->children) {
+    if (child.release != nullptr) {
+      child.release(&child);
+    }
+  }
+  delete exported;
+  schema->release = nullptr;
+}
+}  // namespace
+
+std::size_t ArrowTypeWidth(ArrowType type) {
+  switch (type) {
+    case ArrowType::kUInt8:
+      return 1;
+    case ArrowType::kUInt16:
+      return 2;
+    case ArrowType::kUInt32:
+    case ArrowType::kInt32:
+      return 4;
+    case ArrowType::kUInt64:
+    case ArrowType::kInt64:
+    case ArrowType::kFloat64:
+    case ArrowType::kTimestampNs:
+      return 8;
+  }
+  return 0;
+}
+
+const char* ArrowFormat(ArrowType type) {
+  switch (type) {
+    case ArrowType::kUInt8:
+      return "C";
+    case ArrowType::kUInt16:
+      return "S";
+    case ArrowType::kUInt32:
+      return "I";
+    case ArrowType::kUInt64:
+      return "L";
+    case ArrowType::kInt32:
+      return "i";
+    case ArrowType::kInt64:
+      return "l";
+    case ArrowType::kFloat64:
+      return "g";
+    case ArrowType::kTimestampNs:
+      return "tsn:UTC";
+  }
+  return "";
+}
+
+ArrowBatch::ArrowBatch(std::shared_ptr<const std::vector<ArrowField>> fields,
+                       std::size_t capacity)
+    : fields_{std::move(fields)}, capacity_{capacity} {
+  columns_.reserve(fields_->size());
+  for (const ArrowField& field : *fields_) {
+    columns_.push_back(AllocateColumn(capacity * ArrowTypeWidth(field.type)));
+  }
+}
+
+namespace arrow_detail {
+template <>
+MboColumns Bind<MboColumns>(ArrowBatch& batch) {
+  return {batch.Capacity(),
+          batch.ColumnAs<std::uint64_t>(0),
+          batch.ColumnAs<std::uint32_t>(1),
+          batch.ColumnAs<std::uint16_t>(2),
+          batch.ColumnAs<std::uint64_t>(3),
+          batch.ColumnAs<std::uint64_t>(4),
+          batch.ColumnAs<std::int64_t>(5),
+          batch.ColumnAs<std::uint32_t>(6),
+          batch.ColumnAs<std::uint8_t>(7),
+          batch.ColumnAs<std::uint8_t>(8),
+          batch.ColumnAs<std::uint8_t>(9),
+          batch.ColumnAs<std::uint8_t>(10),
+          batch.ColumnAs<std::int32_t>(11),
+          batch.ColumnAs<std::uint32_t>(12)};
+}
+
+template <>
+TradeColumns Bind<TradeColumns>(ArrowBatch& batch) {
+  return {batch.Capacity(),
+          batch.ColumnAs<std::uint64_t>(0),
+          batch.ColumnAs<std::uint32_t>(1),
+          batch.ColumnAs<std::uint16_t>(2),
+          batch.ColumnAs<std::uint64_t>(3),
+          batch.ColumnAs<std::int64_t>(4),
+          batch.ColumnAs<std::uint32_t>(5),
+          batch.ColumnAs<std::uint8_t>(6),
+          batch.ColumnAs<std::uint8_t>(7),
+          batch.ColumnAs<std::uint8_t>(8),
+          batch.ColumnAs<std::uint8_t>(9),
+          batch.ColumnAs<std::int32_t>(10),
+          batch.ColumnAs<std::uint32_t>(11)};
+}
+
+template <>
+Mbp1Columns Bind<Mbp1Columns>(ArrowBatch& batch) {
+  return {batch.Capacity(),
+          batch.ColumnAs<std::uint64_t>(0),
+          batch.ColumnAs<std::uint32_t>(1),
+          batch.ColumnAs<std::uint16_t>(2),
+          batch.ColumnAs<std::uint64_t>(3),
+          batch.ColumnAs<std::int64_t>(4),
+          batch.ColumnAs<std::uint32_t>(5),
+          batch.ColumnAs<std::uint8_t>(6),
+          batch.ColumnAs<std::uint8_t>(7),
+          batch.ColumnAs<std::uint8_t>(8),
+          batch.ColumnAs<std::uint8_t>(9),
+          batch.ColumnAs<std::int32_t>(10),
+          batch.ColumnAs<std::uint32_t>(11),
+          batch.ColumnAs<std::int64_t>(12),
+          batch.ColumnAs<std::int64_t>(13),
+          batch.ColumnAs<std::uint32_t>(14),
+          batch.ColumnAs<std::uint32_t>(15),
+          batch.ColumnAs<std::uint32_t>(16),
+          batch.ColumnAs<std::uint32_t>(17)};
+}
+
+template <>
+OhlcvColumns Bind<OhlcvColumns>(ArrowBatch& batch) {
+  return {batch.Capacity(),
+          batch.ColumnAs<std::uint64_t>(0),
+          batch.ColumnAs<std::uint32_t>(1),
+          batch.ColumnAs<std::uint16_t>(2),
+          batch.ColumnAs<std::int64_t>(3),
+          batch.ColumnAs<std::int64_t>(4),
+          batch.ColumnAs<std::int64_t>(5),
+          batch.ColumnAs<std::int64_t>(6),
+          batch.ColumnAs<std::uint64_t>(7)};
+}
+}  // namespace arrow_detail
+
+DbnArrowConverter::DbnArrowConverter(const ArrowConvertOptions& options) : options_{options} {
+  if (options_.batch_rows == 0) {
+    throw std::invalid_argument{"Arrow batches need at least one row"};
+  }
+  std::vector<ArrowField> fields;
+  switch (options_.schema) {
+    case databento::Schema::Mbo:
+      layout_ = Layout::kMbo;
+      fields = MboFields();
+      break;
+    case databento::Schema::Trades:
+      layout_ = Layout::kTrade;
+      fields = TradeFields();
+      break;
+    case databento::Schema::Mbp1:
+    case databento::Schema::Tbbo:
+      layout_ = Layout::kMbp1;
+      fields = Mbp1Fields();
+      break;
+    case databento::Schema::Ohlcv1S:
+    case databento::Schema::Ohlcv1M:
+    case databento::Schema::Ohlcv1H:
+    case databento::Schema::Ohlcv1D:
+    case databento::Schema::OhlcvEod:
+      layout_ = Layout::kOhlcv;
+      fields = OhlcvFields();
+      break;
+    default:
+      throw std::invalid_argument{"No Arrow conversion for schema " +
+                                  databento::ToString(options_.schema)};
+  }
+  if (options_.scale_prices) {
+    for (ArrowField& field : fields) {
+      if (field.is_price) {
+        field.type = ArrowType::kFloat64;
+      }
+    }
+  }
+  fields_ = std::make_shared<const std::vector<ArrowField>>(std::move(fields));
+}
+
+void DbnArrowConverter::ScalePrices(ArrowBatch& batch) const {
+  constexpr double kScale = 1e-9;
+  for (std::size_t i = 0; i < batch.ColumnCount(); ++i) {
+    if (!batch.Fields()[i].is_price) {
+      continue;
+    }
+    // Same width, so each value is converted where it was decoded
+    std::byte* column = batch.Column(i);
+    for (std::size_t row = 0; row < batch.Length(); ++row) {
+      std::int64_t fixed;
+      std::memcpy(&fixed, column + row * sizeof(fixed), sizeof(fixed));
+      const double scaled = fixed == databento::kUndefPrice
+                                ? std::numeric_limits<double>::quiet_NaN()
+                                : static_cast<double>(fixed) * kScale;
+      std::memcpy(column + row * sizeof(scaled), &scaled, sizeof(scaled));
+    }
+  }
+}
+
+void ExportArrowBatch(ArrowBatch batch, ArrowArray* out) {
+  const std::size_t n = batch.ColumnCount();
+  const auto length = static_cast<std::int64_t>(batch.Length());
+  auto exported = std::make_unique<ExportedBatch>();
+  exported->children.resize(n);
+  exported->child_pointers.resize(n);
+  exported->buffers[0] = nullptr;
+  for (std::size_t i = 0; i < n; ++i) {
+    auto column = std::make_unique<ExportedColumn>();
+    column->data = batch.TakeColumn(i);
+    // No validity bitmap: every column is non-null
+    column->buffers[0] = nullptr;
+    column->buffers[1] = column->data.get();
+    ArrowArray& child = exported->children[i];
+    child = ArrowArray{length, 0, 0, 2, 0, column->buffers, nullptr, nullptr,
+                       &ReleaseColumn, column.get()};
+    column.release();
+    exported->child_pointers[i] = &child;
+  }
+  *out = ArrowArray{length,  0,       0,       1, static_cast<std::int64_t>(n),
+                    exported->buffers, exported->child_pointers.data(), nullptr,
+                    &ReleaseBatch, exported.get()};
+  exported.release();
+}
+
+void ExportArrowSchema(const std::vector<ArrowField>& fields, ArrowSchema* out) {
+  auto exported = std::make_unique<ExportedSchema>();
+  exported->children.resize(fields.size());
+  exported->child_pointers.resize(fields.size());
+  for (std::size_t i = 0; i < fields.size(); ++i) {
+    auto field = std::make_unique<ExportedField>(ExportedField{fields[i].name});
+    ArrowSchema& child = exported->children[i];
+    child = ArrowSchema{ArrowFormat(fields[i].type), field->name.c_str(), nullptr, 0, 0,
+                        nullptr, nullptr, &ReleaseField, field.get()};
+    field.release();
+    exported->child_pointers[i] = &child;
+  }
+  *out = ArrowSchema{"+s",
+                     "",
+                     nullptr,
+                     0,
+                     static_cast<std::int64_t>(fields.size()),
+                     exported->child_pointers.data(),
+                     nullptr,
+                     &ReleaseSchema,
+                     exported.get()};
+  exported.release();
+}
+
+}  // namespace databento_jl
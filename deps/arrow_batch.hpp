@@ -0,0 +1,183 @@
+#pragma once
+
+#include <databento/enums.hpp>
+#include <databento/record.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "arrow_c_data.hpp"
+#include "columnar.hpp"
+
+namespace databento_jl {
+
+// Physical types of the columns produced from DBN records. Timestamps are
+// nanoseconds since the UNIX epoch in UTC, stored like int64.
+enum class ArrowType : std::uint8_t {
+  kUInt8,
+  kUInt16,
+  kUInt32,
+  kUInt64,
+  kInt32,
+  kInt64,
+  kFloat64,
+  kTimestampNs,
+};
+
+std::size_t ArrowTypeWidth(ArrowType type);
+// Format string of the Arrow C Data Interface
+const char* ArrowFormat(ArrowType type);
+
+struct ArrowField {
+  std::string name;
+  ArrowType type;
+  // Fixed-point price in units of 1e-9
+  bool is_price;
+};
+
+struct AlignedFree {
+  void operator()(std::byte* p) const { std::free(p); }
+};
+// Column buffer aligned to 64 bytes, as recommended by the Arrow format
+using AlignedBuffer = std::unique_ptr<std::byte, AlignedFree>;
+
+// Fixed-width columns of up to `capacity` rows, one buffer per field.
+class ArrowBatch {
+ public:
+  ArrowBatch(std::shared_ptr<const std::vector<ArrowField>> fields, std::size_t capacity);
+
+  const std::vector<ArrowField>& Fields() const { return *fields_; }
+  const std::shared_ptr<const std::vector<ArrowField>>& SharedFields() const { return fields_; }
+  std::size_t ColumnCount() const { return columns_.size(); }
+  std::size_t Capacity() const { return capacity_; }
+  std::size_t Length() const { return length_; }
+  void SetLength(std::size_t length) { length_ = length; }
+
+  std::byte* Column(std::size_t i) { return columns_[i].get(); }
+  const std::byte* Column(std::size_t i) const { return columns_[i].get(); }
+  template <typename T>
+  T* ColumnAs(std::size_t i) {
+    return reinterpret_cast<T*>(Column(i));
+  }
+  // Bytes of column `i` holding rows
+  std::size_t ColumnBytes(std::size_t i) const {
+    return length_ * ArrowTypeWidth((*fields_)[i].type);
+  }
+  AlignedBuffer TakeColumn(std::size_t i) { return std::move(columns_[i]); }
+
+ private:
+  std::shared_ptr<const std::vector<ArrowField>> fields_;
+  std::size_t capacity_;
+  std::size_t length_{};
+  std::vector<AlignedBuffer> columns_;
+};
+
+namespace arrow_detail {
+// Points the columns of `Columns` at the buffers of `batch`, in field order
+template <typename Columns>
+Columns Bind(ArrowBatch& batch);
+template <>
+MboColumns Bind<MboColumns>(ArrowBatch& batch);
+template <>
+TradeColumns Bind<TradeColumns>(ArrowBatch& batch);
+template <>
+Mbp1Columns Bind<Mbp1Columns>(ArrowBatch& batch);
+template <>
+OhlcvColumns Bind<OhlcvColumns>(ArrowBatch& batch);
+}  // namespace arrow_detail
+
+struct ArrowConvertOptions {
+  // Mbo, Trades, Mbp1/Tbbo or any Ohlcv schema
+  databento::Schema schema{databento::Schema::Mbo};
+  std::size_t batch_rows{65'536};
+  // Store prices as float64 in currency units instead of int64 in 1e-9
+  // units; undefined prices become NaN
+  bool scale_prices{};
+};
+
+// Turns a stream of DBN records of one schema into bounded Arrow batches.
+//
+// Each batch is decoded straight into freshly allocated column buffers by
+// the same DecodeColumns path as read_columns!, so converting a file needs
+// memory for one batch at a time, however large the file. ts_event and
+// ts_recv become timestamp[ns, UTC] columns; action and side keep their ASCII
+// codes as uint8.
+class DbnArrowConverter {
+ public:
+  explicit DbnArrowConverter(const ArrowConvertOptions& options);
+
+  const std::vector<ArrowField>& Fields() const { return *fields_; }
+  std::size_t BatchRows() const { return options_.batch_rows; }
+
+  // Decodes up to BatchRows() records from `source` into a new batch.
+  // Records of other schemas are skipped. An empty batch means the source
+  // is exhausted.
+  template <typename Source>
+  ArrowBatch NextBatch(Source& source) {
+    ArrowBatch batch{fields_, options_.batch_rows};
+    std::size_t n = 0;
+    switch (layout_) {
+      case Layout::kMbo:
+        n = DecodeColumns(source, arrow_detail::Bind<MboColumns>(batch));
+        break;
+      case Layout::kTrade:
+        n = DecodeColumns(source, arrow_detail::Bind<TradeColumns>(batch));
+        break;
+      case Layout::kMbp1:
+        n = DecodeColumns(source, arrow_detail::Bind<Mbp1Columns>(batch));
+        break;
+      case Layout::kOhlcv:
+        n = DecodeColumns(source, arrow_detail::Bind<OhlcvColumns>(batch));
+        break;
+    }
+    batch.SetLength(n);
+    if (options_.scale_prices) {
+      ScalePrices(batch);
+    }
+    rows_ += n;
+    return batch;
+  }
+
+  // Converts the rest of `source` into `writer` (anything with a
+  // Write(const ArrowBatch&) member). Returns the number of rows written.
+  template <typename Source, typename Writer>
+  std::uint64_t WriteAll(Source& source, Writer& writer) {
+    std::uint64_t rows = 0;
+    while (true) {
+      const ArrowBatch batch = NextBatch(source);
+      if (batch.Length() == 0) {
+        break;
+      }
+      writer.Write(batch);
+      rows += batch.Length();
+    }
+    return rows;
+  }
+
+  std::uint64_t RowsConverted() const { return rows_; }
+
+ private:
+  enum class Layout { kMbo, kTrade, kMbp1, kOhlcv };
+
+  // Rewrites the int64 price columns as float64 in place
+  void ScalePrices(ArrowBatch& batch) const;
+
+  ArrowConvertOptions options_;
+  Layout layout_;
+  std::shared_ptr<const std::vector<ArrowField>> fields_;
+  std::uint64_t rows_{};
+};
+
+// Moves `batch` into `out` as a struct array with one child per column. Each
+// child owns its buffer, so consumers may move children out individually;
+// `out` must be released through its release callback.
+void ExportArrowBatch(ArrowBatch batch, ArrowArray* out);
+// Describes `fields` in `out` as the struct type matching ExportArrowBatch
+void ExportArrowSchema(const std::vector<ArrowField>& fields, ArrowSchema* out);
+
+}  // namespace databento_jl
@@ -0,0 +1,291 @@
+#include "arrow_ipc_writer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace databento_jl {
+
+namespace {
+constexpr char kArrowMagic[8] = {'A', 'R', 'R', 'O', 'W', '1', '\0', '\0'};
+constexpr std::uint32_t kContinuation = 0xFFFFFFFF;
+
+// Arrow format enums (Schema.fbs, Message.fbs)
+constexpr std::int16_t kMetadataV5 = 4;
+constexpr std::uint8_t kHeaderSchema = 1;
+constexpr std::uint8_t kHeaderRecordBatch = 3;
+constexpr std::uint8_t kTypeInt = 2;
+constexpr std::uint8_t kTypeFloatingPoint = 3;
+constexpr std::uint8_t kTypeTimestamp = 10;
+constexpr std::int16_t kPrecisionDouble = 2;
+constexpr std::int16_t kTimeUnitNanosecond = 3;
+
+// Minimal FlatBuffers builder covering what Arrow metadata needs: tables of
+// scalars and offsets, strings, vectors of tables and vectors of structs.
+// Like the reference implementation it builds back to front, so references
+// are distances from the end of the buffer and children precede parents.
+class FlatBufferBuilder {
+ public:
+  using Ref = std::uint32_t;
+
+  std::uint32_t Size() const { return static_cast<std::uint32_t>(buf_.size()); }
+
+  // Pads so that `size` more bytes end aligned to `alignment`
+  void Align(std::size_t alignment, std::size_t size = 0) {
+    max_align_ = std::max(max_align_, alignment);
+    const std::size_t pad = (alignment - (buf_.size() + size) % alignment) % alignment;
+    buf_.insert(buf_.begin(), pad, 0);
+  }
+
+  template <typename T>
+  void Prepend(T value) {
+    Align(sizeof(T));
+    PrependBytes(&value, sizeof(T));
+  }
+  void PrependOffset(Ref ref) {
+    Align(4);
+    Prepend<std::uint32_t>(Size() + 4 - ref);
+  }
+
+  Ref String(const std::string& s) {
+    Align(4, s.size() + 1);
+    buf_.insert(buf_.begin(), 0);
+    PrependBytes(s.data(), s.size());
+    Prepend<std::uint32_t>(static_cast<std::uint32_t>(s.size()));
+    return Size();
+  }
+
+  Ref OffsetVector(const std::vector<Ref>& refs) {
+    Align(4, refs.size() * 4);
+    for (auto it = refs.rbegin(); it != refs.rend(); ++it) {
+      PrependOffset(*it);
+    }
+    Prepend<std::uint32_t>(static_cast<std::uint32_t>(refs.size()));
+    return Size();
+  }
+
+  // `data` holds `count` structs of `struct_size` bytes aligned to 8
+  Ref StructVector(const void* data, std::size_t count, std::size_t struct_size) {
+    Align(4, count * struct_size);
+    Align(8, count * struct_size);
+    PrependBytes(data, count * struct_size);
+    Prepend<std::uint32_t>(static_cast<std::uint32_t>(count));
+    return Size();
+  }
+
+  void StartTable() {
+    fields_.clear();
+    table_start_ = Size();
+  }
+  template <typename T>
+  void AddScalar(std::uint16_t slot, T value) {
+    Prepend(value);
+    fields_.emplace_back(slot, Size());
+  }
+  void AddOffset(std::uint16_t slot, Ref ref) {
+    PrependOffset(ref);
+    fields_.emplace_back(slot, Size());
+  }
+  Ref EndTable() {
+    // The soffset to the vtable is patched once the vtable is in place
+    Prepend<std::int32_t>(0);
+    const Ref table = Size();
+    std::uint16_t slots = 0;
+    for (const auto& field : fields_) {
+      slots = std::max<std::uint16_t>(slots, field.first + 1);
+    }
+    std::vector<std::uint16_t> vtable(2 + slots, 0);
+    vtable[0] = static_cast<std::uint16_t>(vtable.size() * 2);
+    vtable[1] = static_cast<std::uint16_t>(table - table_start_);
+    for (const auto& field : fields_) {
+      vtable[2 + field.first] = static_cast<std::uint16_t>(table - field.second);
+    }
+    for (auto it = vtable.rbegin(); it != vtable.rend(); ++it) {
+      Prepend(*it);
+    }
+    const auto soffset = static_cast<std::int32_t>(Size() - table);
+    std::memcpy(buf_.data() + (buf_.size() - table), &soffset, sizeof(soffset));
+    return table;
+  }
+
+  std::vector<std::uint8_t> Finish(Ref root) {
+    Align(max_align_, 4);
+    PrependOffset(root);
+    return std::move(buf_);
+  }
+
+ private:
+  void PrependBytes(const void* data, std::size_t size) {
+    const auto* bytes = static_cast<const std::uint8_t*>(data);
+    buf_.insert(buf_.begin(), bytes, bytes + size);
+  }
+
+  // Metadata is a few KB at most, so prepending to a vector is cheap enough
+  std::vector<std::uint8_t> buf_;
+  std::size_t max_align_{1};
+  std::vector<std::pair<std::uint16_t, Ref>> fields_;
+  Ref table_start_{};
+};
+
+// FlatBuffers structs of Message.fbs and File.fbs, little endian
+struct FieldNode {
+  std::int64_t length;
+  std::int64_t null_count;
+};
+struct BufferSpec {
+  std::int64_t offset;
+  std::int64_t length;
+};
+struct FileBlock {
+  std::int64_t offset;
+  std::int32_t metadata_length;
+  std::int32_t padding;
+  std::int64_t body_length;
+};
+
+FlatBufferBuilder::Ref BuildType(FlatBufferBuilder& fbb, ArrowType type, std::uint8_t* type_id) {
+  switch (type) {
+    case ArrowType::kFloat64:
+      *type_id = kTypeFloatingPoint;
+      fbb.StartTable();
+      fbb.AddScalar<std::int16_t>(0, kPrecisionDouble);
+      return fbb.EndTable();
+    case ArrowType::kTimestampNs: {
+      *type_id = kTypeTimestamp;
+      const auto timezone = fbb.String("UTC");
+      fbb.StartTable();
+      fbb.AddOffset(1, timezone);
+      fbb.AddScalar<std::int16_t>(0, kTimeUnitNanosecond);
+      return fbb.EndTable();
+    }
+    default: {
+      *type_id = kTypeInt;
+      const bool is_signed = type == ArrowType::kInt32 || type == ArrowType::kInt64;
+      fbb.StartTable();
+      fbb.AddScalar<std::int32_t>(0, static_cast<std::int32_t>(ArrowTypeWidth(type) * 8));
+      fbb.AddScalar<std::uint8_t>(1, is_signed);
+      return fbb.EndTable();
+    }
+  }
+}
+
+FlatBufferBuilder::Ref BuildSchema(FlatBufferBuilder& fbb, const std::vector<ArrowField>& fields) {
+  std::vector<FlatBufferBuilder::Ref> refs;
+  refs.reserve(fields.size());
+  for (const ArrowField& field : fields) {
+    const auto name = fbb.String(field.name);
+    std::uint8_t type_id = 0;
+    const auto type = BuildType(fbb, field.type, &type_id);
+    const auto children = fbb.OffsetVector({});
+    fbb.StartTable();
+    fbb.AddOffset(0, name);
+    fbb.AddOffset(3, type);
+    fbb.AddOffset(5, children);
+    fbb.AddScalar<std::uint8_t>(1, 0);  // nullable
+    fbb.AddScalar<std::uint8_t>(2, type_id);
+    refs.push_back(fbb.EndTable());
+  }
+  const auto field_vector = fbb.OffsetVector(refs);
+  fbb.StartTable();
+  fbb.AddOffset(1, field_vector);
+  fbb.AddScalar<std::int16_t>(0, 0);  // little endian
+  return fbb.EndTable();
+}
+
+std::vector<std::uint8_t> BuildMessage(FlatBufferBuilder& fbb, std::uint8_t header_type,
+                                       FlatBufferBuilder::Ref header, std::int64_t body_length) {
+  fbb.StartTable();
+  fbb.AddScalar<std::int64_t>(3, body_length);
+  fbb.AddOffset(2, header);
+  fbb.AddScalar<std::int16_t>(0, kMetadataV5);
+  fbb.AddScalar<std::uint8_t>(1, header_type);
+  return fbb.Finish(fbb.EndTable());
+}
+
+std::int64_t Padded8(std::int64_t n) { return (n + 7) & ~std::int64_t{7}; }
+}  // namespace
+
+ArrowIpcFileWriter::ArrowIpcFileWriter(const std::string& path, std::vector<ArrowField> fields)
+    : fields_{std::move(fields)}, file_{path} {
+  file_.Write(kArrowMagic, sizeof(kArrowMagic));
+  FlatBufferBuilder fbb;
+  const auto schema = BuildSchema(fbb, fields_);
+  WriteMessage(BuildMessage(fbb, kHeaderSchema, schema, 0));
+}
+
+void ArrowIpcFileWriter::Write(const ArrowBatch& batch) {
+  const std::size_t n = fields_.size();
+  if (batch.ColumnCount() != n) {
+    throw std::invalid_argument{"Batch has " + std::to_string(batch.ColumnCount()) +
+                                " columns, the file " + std::to_string(n)};
+  }
+  std::vector<FieldNode> nodes(n);
+  std::vector<BufferSpec> buffers(2 * n);
+  std::int64_t body_length = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    const auto bytes = static_cast<std::int64_t>(batch.ColumnBytes(i));
+    nodes[i] = {static_cast<std::int64_t>(batch.Length()), 0};
+    buffers[2 * i] = {body_length, 0};
+    buffers[2 * i + 1] = {body_length, bytes};
+    body_length += Padded8(bytes);
+  }
+  FlatBufferBuilder fbb;
+  const auto buffer_vector = fbb.StructVector(buffers.data(), buffers.size(), sizeof(BufferSpec));
+  const auto node_vector = fbb.StructVector(nodes.data(), nodes.size(), sizeof(FieldNode));
+  fbb.StartTable();
+  fbb.AddScalar<std::int64_t>(0, static_cast<std::int64_t>(batch.Length()));
+  fbb.AddOffset(1, node_vector);
+  fbb.AddOffset(2, buffer_vector);
+  const auto record_batch = fbb.EndTable();
+
+  Block block{static_cast<std::int64_t>(file_.Position()), 0, body_length};
+  block.metadata_length =
+      WriteMessage(BuildMessage(fbb, kHeaderRecordBatch, record_batch, body_length));
+  for (std::size_t i = 0; i < n; ++i) {
+    file_.Write(batch.Column(i), batch.ColumnBytes(i));
+    file_.Pad(8);
+  }
+  blocks_.push_back(block);
+}
+
+void ArrowIpcFileWriter::Close() {
+  if (!IsOpen()) {
+    return;
+  }
+  // End-of-stream marker, so the file also reads as an IPC stream
+  const std::uint32_t eos[2] = {kContinuation, 0};
+  file_.Write(eos, sizeof(eos));
+
+  std::vector<FileBlock> blocks;
+  blocks.reserve(blocks_.size());
+  for (const Block& block : blocks_) {
+    blocks.push_back({block.offset, block.metadata_length, 0, block.body_length});
+  }
+  FlatBufferBuilder fbb;
+  const auto batch_vector = fbb.StructVector(blocks.data(), blocks.size(), sizeof(FileBlock));
+  const auto dictionary_vector = fbb.StructVector(nullptr, 0, sizeof(FileBlock));
+  const auto schema = BuildSchema(fbb, fields_);
+  fbb.StartTable();
+  fbb.AddOffset(1, schema);
+  fbb.AddOffset(2, dictionary_vector);
+  fbb.AddOffset(3, batch_vector);
+  fbb.AddScalar<std::int16_t>(0, kMetadataV5);
+  const std::vector<std::uint8_t> footer = fbb.Finish(fbb.EndTable());
+  file_.Write(footer.data(), footer.size());
+  const auto footer_length = static_cast<std::int32_t>(footer.size());
+  file_.Write(&footer_length, sizeof(footer_length));
+  file_.Write(kArrowMagic, 6);
+  file_.Commit();
+}
+
+std::int32_t ArrowIpcFileWriter::WriteMessage(const std::vector<std::uint8_t>& flatbuffer) {
+  // The body that follows must start 8-byte aligned
+  const auto length = static_cast<std::int32_t>(Padded8(8 + flatbuffer.size()) - 8);
+  file_.Write(&kContinuation, sizeof(kContinuation));
+  file_.Write(&length, sizeof(length));
+  file_.Write(flatbuffer.data(), flatbuffer.size());
+  file_.Pad(8);
+  return length + 8;
+}
+
+}  // namespace databento_jl
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "arrow_batch.hpp"
+#include "output_file.hpp"
+
+namespace databento_jl {
+
+// Writes ArrowBatches as an Arrow IPC file (the format read by
+// pyarrow.ipc.open_file, arrow::ipc::RecordBatchFileReader and Feather v2).
+//
+// Each batch is appended as one record batch message as soon as it is
+// written, so only the footer's block table grows with the file. Columns are
+// non-nullable and uncompressed. The file is complete once Close returns.
+class ArrowIpcFileWriter {
+ public:
+  ArrowIpcFileWriter(const std::string& path, std::vector<ArrowField> fields);
+
+  void Write(const ArrowBatch& batch);
+  // Writes the footer and moves the file to its path
+  void Close();
+  bool IsOpen() const { return file_.IsOpen(); }
+  std::uint64_t BatchesWritten() const { return blocks_.size(); }
+
+ private:
+  struct Block {
+    std::int64_t offset;
+    std::int32_t metadata_length;
+    std::int64_t body_length;
+  };
+
+  // Writes an encapsulated message: continuation marker, metadata length and
+  // the flatbuffer padded to 8 bytes. Returns the bytes written.
+  std::int32_t WriteMessage(const std::vector<std::uint8_t>& flatbuffer);
+
+  std::vector<ArrowField> fields_;
+  OutputFile file_;
+  std::vector<Block> blocks_;
+};
+
+}  // namespace databento_jl
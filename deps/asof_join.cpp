@@ -0,0 +1,150 @@
+#include "asof_join.hpp"
+
+#include <databento/constants.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace databento_jl {
+
+namespace {
+std::vector<std::uint64_t> SortedHorizons(std::vector<std::uint64_t> horizons) {
+  std::sort(horizons.begin(), horizons.end());
+  horizons.erase(std::unique(horizons.begin(), horizons.end()), horizons.end());
+  return horizons;
+}
+
+constexpr AsofQuote kNoQuote{databento::kUndefTimestamp, databento::kUndefPrice,
+                             databento::kUndefPrice, 0, 0};
+
+template <typename Msg>
+AsofQuote TopOfBook(const Msg& msg) {
+  const auto& level = msg.levels[0];
+  return {msg.ts_recv.time_since_epoch().count(), level.bid_px, level.ask_px, level.bid_sz,
+          level.ask_sz};
+}
+}  // namespace
+
+AsofJoin::AsofJoin(std::vector<std::uint64_t> horizons, bool exact_matches,
+                   std::uint64_t tolerance)
+    : horizons_{SortedHorizons(std::move(horizons))},
+      exact_matches_{exact_matches},
+      tolerance_{tolerance},
+      resolved_(horizons_.size()) {}
+
+bool AsofJoin::TakeTrade(const databento::Record& record) {
+  const auto* trade = record.GetIf<databento::TradeMsg>();
+  if (trade == nullptr) {
+    ++records_skipped_;
+    return false;
+  }
+  trade_.ts_recv = trade->ts_recv.time_since_epoch().count();
+  trade_.ts_event = trade->hd.ts_event.time_since_epoch().count();
+  trade_.instrument_id = trade->hd.instrument_id;
+  trade_.publisher_id = trade->hd.publisher_id;
+  trade_.price = trade->price;
+  trade_.size = trade->size;
+  trade_.side = static_cast<char>(trade->side);
+  return true;
+}
+
+bool AsofJoin::TakeQuote(const databento::Record& record) {
+  if (const auto* mbp1 = record.GetIf<databento::Mbp1Msg>()) {
+    quote_ = TopOfBook(*mbp1);
+  } else if (const auto* bbo = record.GetIf<databento::BboMsg>()) {
+    quote_ = TopOfBook(*bbo);
+  } else if (const auto* cmbp1 = record.GetIf<databento::Cmbp1Msg>()) {
+    quote_ = TopOfBook(*cmbp1);
+  } else if (const auto* cbbo = record.GetIf<databento::CbboMsg>()) {
+    quote_ = TopOfBook(*cbbo);
+  } else {
+    ++records_skipped_;
+    return false;
+  }
+  quote_instrument_id_ = record.Header().instrument_id;
+  return true;
+}
+
+void AsofJoin::Step() {
+  const bool trade_first =
+      has_trade_ && (!has_quote_ || trade_.ts_recv < quote_.ts_recv ||
+                     (trade_.ts_recv == quote_.ts_recv && !exact_matches_));
+  if (trade_first) {
+    AsofRow& row = rows_.emplace_back(trade_);
+    row.quote = QuoteAt(row.instrument_id, row.ts_recv);
+    if (row.quote.ts_recv == databento::kUndefTimestamp) {
+      ++trades_without_quote_;
+    }
+    markouts_.resize(markouts_.size() + horizons_.size());
+    ++next_row_;
+    has_trade_ = false;
+    if (quotes_done_) {
+      Resolve(kNever);
+    }
+  } else if (has_quote_) {
+    Resolve(quote_.ts_recv);
+    book_[quote_instrument_id_] = quote_;
+    ++quotes_applied_;
+    has_quote_ = false;
+  }
+}
+
+void AsofJoin::Resolve(std::uint64_t ts) {
+  const std::size_t horizon_count = horizons_.size();
+  for (std::size_t k = 0; k < horizon_count; ++k) {
+    const std::uint64_t horizon = horizons_[k];
+    std::uint64_t& row = resolved_[k];
+    for (; row < next_row_; ++row) {
+      const std::size_t index = static_cast<std::size_t>(row - first_row_);
+      const AsofRow& trade = rows_[index];
+      // Saturates below kNever so the end of the quotes resolves every target
+      const std::uint64_t room = kNever - 1 - std::min(trade.ts_recv, kNever - 1);
+      const std::uint64_t target = horizon < room ? trade.ts_recv + horizon : kNever - 1;
+      if (target >= ts) {
+        break;
+      }
+      markouts_[index * horizon_count + k] = QuoteAt(trade.instrument_id, target);
+    }
+  }
+}
+
+AsofQuote AsofJoin::QuoteAt(std::uint32_t instrument_id, std::uint64_t ts) const {
+  const AsofQuote* quote = book_.Find(instrument_id);
+  if (quote == nullptr ||
+      (tolerance_ != 0 && ts > quote->ts_recv && ts - quote->ts_recv > tolerance_)) {
+    return kNoQuote;
+  }
+  return *quote;
+}
+
+std::size_t AsofJoin::Drain(const AsofJoinColumns& out) {
+  const std::size_t n = std::min(out.capacity, ReadyRows());
+  const std::size_t horizon_count = horizons_.size();
+  for (std::size_t i = 0; i < n; ++i) {
+    const AsofRow& row = rows_[i];
+    out.ts_recv[i] = row.ts_recv;
+    out.ts_event[i] = row.ts_event;
+    out.instrument_id[i] = row.instrument_id;
+    out.publisher_id[i] = row.publisher_id;
+    out.price[i] = row.price;
+    out.size[i] = row.size;
+    out.side[i] = static_cast<std::uint8_t>(row.side);
+    out.quote_ts_recv[i] = row.quote.ts_recv;
+    out.bid_px[i] = row.quote.bid_px;
+    out.ask_px[i] = row.quote.ask_px;
+    out.bid_sz[i] = row.quote.bid_sz;
+    out.ask_sz[i] = row.quote.ask_sz;
+    for (std::size_t k = 0; k < horizon_count; ++k) {
+      const AsofQuote& markout = markouts_[i * horizon_count + k];
+      out.markout_bid[i * horizon_count + k] = markout.bid_px;
+      out.markout_ask[i * horizon_count + k] = markout.ask_px;
+    }
+  }
+  rows_.erase(rows_.begin(), rows_.begin() + static_cast<std::ptrdiff_t>(n));
+  markouts_.erase(markouts_.begin(),
+                  markouts_.begin() + static_cast<std::ptrdiff_t>(n * horizon_count));
+  first_row_ += n;
+  return n;
+}
+
+}  // namespace databento_jl
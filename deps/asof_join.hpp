@@ -0,0 +1,169 @@
+#pragma once
+
+#include <databento/record.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "flat_hash_map.hpp"
+
+namespace databento_jl {
+
+// A top of book, as of its ts_recv
+struct AsofQuote {
+  std::uint64_t ts_recv;
+  std::int64_t bid_px;
+  std::int64_t ask_px;
+  std::uint32_t bid_sz;
+  std::uint32_t ask_sz;
+};
+
+// A trade paired with the quote of its instrument prevailing at its ts_recv.
+// Without one, quote_ts_recv is kUndefTimestamp, the prices kUndefPrice and
+// the sizes zero.
+struct AsofRow {
+  std::uint64_t ts_recv;
+  std::uint64_t ts_event;
+  std::uint32_t instrument_id;
+  std::uint16_t publisher_id;
+  std::int64_t price;
+  std::uint32_t size;
+  char side;
+  AsofQuote quote;
+};
+
+// Caller-owned output columns. markout_bid and markout_ask hold
+// HorizonCount() values per row, horizons contiguous, as in a Julia
+// (horizons, rows) matrix.
+struct AsofJoinColumns {
+  std::size_t capacity;
+  std::uint64_t* ts_recv;
+  std::uint64_t* ts_event;
+  std::uint32_t* instrument_id;
+  std::uint16_t* publisher_id;
+  std::int64_t* price;
+  std::uint32_t* size;
+  std::uint8_t* side;
+  std::uint64_t* quote_ts_recv;
+  std::int64_t* bid_px;
+  std::int64_t* ask_px;
+  std::uint32_t* bid_sz;
+  std::uint32_t* ask_sz;
+  std::int64_t* markout_bid;
+  std::int64_t* markout_ask;
+};
+
+// Streaming as-of join of trades with the prevailing quote of their
+// instrument, for transaction-cost analysis across many instruments.
+//
+// Advance merges a trade source (TradeMsg records) with a quote source
+// (Mbp1Msg, BboMsg, Cmbp1Msg/TCBBO or CbboMsg records) by ts_recv, both
+// assumed in ts_recv order as DBN files are. Quotes update a flat hash map of
+// the top of book per instrument_id; each trade becomes a row carrying the
+// quote of its instrument at that moment. A quote with the same ts_recv as
+// the trade prevails only with `exact_matches`, and with a nonzero
+// `tolerance` a quote older than that many nanoseconds counts as missing.
+//
+// For each markout horizon h the row also records the quote prevailing at
+// ts_recv + h. A horizon's rows resolve in trade order, each as soon as the
+// quote source moves past its target time, so a row stays pending for at
+// most the longest horizon of quote time and memory is bounded by the
+// trades within that window plus the rows not yet drained. Quotes after the
+// end of the quote source never arrive: targets beyond it resolve to the last
+// quote.
+class AsofJoin {
+ public:
+  // Horizons in nanoseconds, in any order
+  AsofJoin(std::vector<std::uint64_t> horizons, bool exact_matches, std::uint64_t tolerance);
+
+  // Merges records from the two sources until `max_rows` rows are ready to
+  // drain or the join is complete. Records of other types are skipped. The
+  // sources should not be read elsewhere during a join.
+  template <typename Trades, typename Quotes>
+  void Advance(Trades& trades, Quotes& quotes, std::size_t max_rows) {
+    while (ReadyRows() < max_rows && !Complete()) {
+      while (!has_trade_ && !trades_done_) {
+        const databento::Record* record = trades.NextRecord();
+        if (record == nullptr) {
+          trades_done_ = true;
+        } else {
+          has_trade_ = TakeTrade(*record);
+        }
+      }
+      while (!has_quote_ && !quotes_done_) {
+        const databento::Record* record = quotes.NextRecord();
+        if (record == nullptr) {
+          quotes_done_ = true;
+          Resolve(kNever);
+        } else {
+          has_quote_ = TakeQuote(*record);
+        }
+      }
+      Step();
+    }
+  }
+  // Moves up to `out.capacity` ready rows into `out`, oldest first. Returns
+  // how many were drained.
+  std::size_t Drain(const AsofJoinColumns& out);
+
+  // Both sources are spent or no longer needed and every row is ready
+  bool Complete() const {
+    return trades_done_ && !has_trade_ && (quotes_done_ || resolved_.empty() ||
+                                           resolved_.back() == next_row_);
+  }
+  std::size_t HorizonCount() const { return horizons_.size(); }
+  std::uint64_t Horizon(std::size_t i) const { return horizons_[i]; }
+  std::uint64_t TradesJoined() const { return next_row_; }
+  std::uint64_t TradesWithoutQuote() const { return trades_without_quote_; }
+  std::uint64_t QuotesApplied() const { return quotes_applied_; }
+  std::uint64_t RecordsSkipped() const { return records_skipped_; }
+  std::size_t InstrumentCount() const { return book_.Size(); }
+  std::size_t ReadyRows() const {
+    return static_cast<std::size_t>((resolved_.empty() ? next_row_ : resolved_.back()) -
+                                    first_row_);
+  }
+  std::size_t PendingRows() const { return rows_.size(); }
+
+ private:
+  static constexpr std::uint64_t kNever = ~std::uint64_t{};
+
+  // Copies the next trade or quote into the head of its side; false for
+  // records of other types
+  bool TakeTrade(const databento::Record& record);
+  bool TakeQuote(const databento::Record& record);
+  // Applies whichever head comes first
+  void Step();
+  // Resolves every markout whose target time is before `ts`
+  void Resolve(std::uint64_t ts);
+  // Quote of `instrument_id` prevailing at `ts`, subject to the tolerance
+  AsofQuote QuoteAt(std::uint32_t instrument_id, std::uint64_t ts) const;
+
+  const std::vector<std::uint64_t> horizons_;
+  const bool exact_matches_;
+  const std::uint64_t tolerance_;
+  FlatHashMap<std::uint32_t, AsofQuote> book_;
+
+  AsofRow trade_{};
+  std::uint32_t quote_instrument_id_{};
+  AsofQuote quote_{};
+  bool has_trade_{};
+  bool has_quote_{};
+  bool trades_done_{};
+  bool quotes_done_{};
+
+  // Rows first_row_ to next_row_ - 1 and their markouts, horizons contiguous
+  std::deque<AsofRow> rows_;
+  std::deque<AsofQuote> markouts_;
+  std::uint64_t first_row_{};
+  std::uint64_t next_row_{};
+  // Per horizon, the first row whose markout is unresolved
+  std::vector<std::uint64_t> resolved_;
+
+  std::uint64_t trades_without_quote_{};
+  std::uint64_t quotes_applied_{};
+  std::uint64_t records_skipped_{};
+};
+
+}  // namespace databento_jl
@@ -0,0 +1,166 @@
+#include "bar_aggregator.hpp"
+
+#include <databento/constants.hpp>
+#include <databento/enums.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <tuple>
+
+namespace databento_jl {
+
+namespace {
+// Fixed-precision prices are in units of 1e-9
+constexpr double kPriceScale = 1e-9;
+constexpr std::uint64_t kNanosPerSecond = 1'000'000'000;
+
+std::uint64_t CheckedThreshold(BarKind kind, double threshold) {
+  if (!(threshold > 0) || !std::isfinite(threshold)) {
+    throw std::invalid_argument{"Bar threshold must be positive and finite"};
+  }
+  if (kind == BarKind::Dollar) {
+    return 0;
+  }
+  if (threshold != std::floor(threshold)) {
+    throw std::invalid_argument{
+        "Time, tick and volume bar thresholds must be whole numbers"};
+  }
+  return static_cast<std::uint64_t>(threshold);
+}
+}  // namespace
+
+BarAggregator::BarAggregator(BarKind kind, double threshold)
+    : kind_{kind}, threshold_{threshold}, interval_{CheckedThreshold(kind, threshold)} {}
+
+void BarAggregator::AddTrade(std::uint32_t instrument_id, std::uint16_t publisher_id,
+                             std::uint64_t ts_event, std::int64_t price,
+                             std::uint32_t size) {
+  if (price == databento::kUndefPrice) {
+    return;
+  }
+  ++trades_applied_;
+  OpenBar& open = open_[instrument_id];
+  Bar& bar = open.bar;
+  if (open.active && kind_ == BarKind::Time && ts_event >= bar.ts_open + interval_) {
+    Close(open);
+  }
+  if (!open.active) {
+    open.active = true;
+    bar = Bar{};
+    bar.ts_open = kind_ == BarKind::Time ? ts_event - ts_event % interval_ : ts_event;
+    bar.instrument_id = instrument_id;
+    bar.open = bar.high = bar.low = price;
+  }
+  bar.ts_close = ts_event;
+  bar.publisher_id = publisher_id;
+  bar.high = std::max(bar.high, price);
+  bar.low = std::min(bar.low, price);
+  bar.close = price;
+  bar.volume += size;
+  ++bar.trade_count;
+  bar.notional += static_cast<double>(price) * kPriceScale * size;
+
+  switch (kind_) {
+    case BarKind::Time:
+      break;
+    case BarKind::Tick:
+      if (bar.trade_count >= interval_) {
+        Close(open);
+      }
+      break;
+    case BarKind::Volume:
+      if (bar.volume >= interval_) {
+        Close(open);
+      }
+      break;
+    case BarKind::Dollar:
+      if (bar.notional >= threshold_) {
+        Close(open);
+      }
+      break;
+  }
+}
+
+bool BarAggregator::Apply(const databento::Record& record) {
+  const databento::RecordHeader& hd = record.Header();
+  if (const auto* trade = record.GetIf<databento::TradeMsg>()) {
+    AddTrade(hd.instrument_id, hd.publisher_id, hd.ts_event.time_since_epoch().count(),
+             trade->price, trade->size);
+    return true;
+  }
+  if (const auto* mbp1 = record.GetIf<databento::Mbp1Msg>()) {
+    if (mbp1->action == databento::Action::Trade) {
+      AddTrade(hd.instrument_id, hd.publisher_id, hd.ts_event.time_since_epoch().count(),
+               mbp1->price, mbp1->size);
+      return true;
+    }
+    return false;
+  }
+  if (const auto* mbo = record.GetIf<databento::MboMsg>()) {
+    if (mbo->action == databento::Action::Trade) {
+      AddTrade(hd.instrument_id, hd.publisher_id, hd.ts_event.time_since_epoch().count(),
+               mbo->price, mbo->size);
+      return true;
+    }
+  }
+  return false;
+}
+
+void BarAggregator::Flush() {
+  const std::size_t first = completed_.size();
+  open_.ForEach([this](std::uint32_t, OpenBar& open) {
+    if (open.active) {
+      Close(open);
+    }
+  });
+  std::sort(completed_.begin() + static_cast<std::ptrdiff_t>(first), completed_.end(),
+            [](const Bar& a, const Bar& b) {
+              return std::tie(a.ts_open, a.instrument_id) <
+                     std::tie(b.ts_open, b.instrument_id);
+            });
+}
+
+databento::OhlcvMsg BarAggregator::ToOhlcv(const Bar& bar) const {
+  databento::RType rtype = databento::RType::OhlcvDeprecated;
+  if (kind_ == BarKind::Time) {
+    switch (interval_) {
+      case kNanosPerSecond:
+        rtype = databento::RType::Ohlcv1S;
+        break;
+      case 60 * kNanosPerSecond:
+        rtype = databento::RType::Ohlcv1M;
+        break;
+      case 3600 * kNanosPerSecond:
+        rtype = databento::RType::Ohlcv1H;
+        break;
+      case 86400 * kNanosPerSecond:
+        rtype = databento::RType::Ohlcv1D;
+        break;
+      default:
+        break;
+    }
+  }
+  databento::OhlcvMsg msg{};
+  msg.hd.length = static_cast<std::uint8_t>(sizeof(databento::OhlcvMsg) /
+                                            databento::RecordHeader::kLengthMultiplier);
+  msg.hd.rtype = rtype;
+  msg.hd.publisher_id = bar.publisher_id;
+  msg.hd.instrument_id = bar.instrument_id;
+  msg.hd.ts_event =
+      databento::UnixNanos{std::chrono::duration<std::uint64_t, std::nano>{bar.ts_open}};
+  msg.open = bar.open;
+  msg.high = bar.high;
+  msg.low = bar.low;
+  msg.close = bar.close;
+  msg.volume = bar.volume;
+  return msg;
+}
+
+void BarAggregator::Close(OpenBar& open) {
+  completed_.push_back(open.bar);
+  open.active = false;
+}
+
+}  // namespace databento_jl
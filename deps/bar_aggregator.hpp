@@ -0,0 +1,127 @@
+#pragma once
+
+#include <databento/record.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "flat_hash_map.hpp"
+
+namespace databento_jl {
+
+// How a bar's boundary is decided
+enum class BarKind : std::uint8_t {
+  // Fixed wall-clock intervals of `threshold` nanoseconds aligned to the UNIX
+  // epoch, by ts_event. Intervals without trades produce no bar.
+  Time = 0,
+  // Every `threshold` trades
+  Tick = 1,
+  // Once the traded size reaches `threshold`
+  Volume = 2,
+  // Once the traded notional (price in currency units times size) reaches
+  // `threshold`
+  Dollar = 3,
+};
+
+// A completed bar. Prices use the fixed-precision scale of the source
+// records, as in OhlcvMsg.
+struct Bar {
+  // Interval start for time bars, otherwise the first trade's ts_event
+  std::uint64_t ts_open;
+  // ts_event of the last trade in the bar
+  std::uint64_t ts_close;
+  std::uint32_t instrument_id;
+  std::uint16_t publisher_id;
+  std::int64_t open;
+  std::int64_t high;
+  std::int64_t low;
+  std::int64_t close;
+  std::uint64_t volume;
+  std::uint32_t trade_count;
+  double notional;
+};
+
+// Streaming resampler from trades to bars for many instruments at once.
+//
+// Trades are TradeMsg records, Mbp1Msg and MboMsg records with
+// Action::Trade, all keyed by instrument_id into a flat hash map of open
+// bars. MBO Fill records are not counted: they are the passive side of a
+// trade already reported by its Trade record. Completed bars queue up until
+// drained, either as OhlcvMsg records or as columns.
+//
+// A bar closes when a trade for the same instrument falls past its boundary
+// (time bars) or when the trade that reaches the threshold is added (tick,
+// volume and dollar bars, which never split a trade). Flush closes all
+// partial bars at the end of a stream.
+class BarAggregator {
+ public:
+  BarAggregator(BarKind kind, double threshold);
+
+  void AddTrade(std::uint32_t instrument_id, std::uint16_t publisher_id,
+                std::uint64_t ts_event, std::int64_t price, std::uint32_t size);
+  // Adds `record` if it is a trade. Returns whether it was.
+  bool Apply(const databento::Record& record);
+  // Applies records from `source` until it is exhausted or `max_records`
+  // records have been read. Returns the number of records read.
+  template <typename Source>
+  std::size_t Consume(Source& source, std::size_t max_records) {
+    std::size_t n = 0;
+    while (n < max_records) {
+      const databento::Record* record = source.NextRecord();
+      if (record == nullptr) {
+        break;
+      }
+      ++n;
+      Apply(*record);
+    }
+    return n;
+  }
+  // Closes every partial bar, ordered by ts_open then instrument_id
+  void Flush();
+
+  BarKind Kind() const { return kind_; }
+  double Threshold() const { return threshold_; }
+  std::size_t InstrumentCount() const { return open_.Size(); }
+  std::uint64_t TradesApplied() const { return trades_applied_; }
+  std::size_t PendingBars() const { return completed_.size() - drained_; }
+
+  // Hands up to `max_bars` completed bars to `f(i, bar)` in completion order
+  // and removes them. Returns how many were drained.
+  template <typename F>
+  std::size_t Drain(std::size_t max_bars, F&& f) {
+    std::size_t n = 0;
+    while (n < max_bars && drained_ < completed_.size()) {
+      f(n++, completed_[drained_++]);
+    }
+    if (drained_ == completed_.size()) {
+      completed_.clear();
+      drained_ = 0;
+    }
+    return n;
+  }
+
+  // OhlcvMsg with ts_event = ts_open. The rtype is Ohlcv1S/1M/1H/1D for time
+  // bars of exactly that interval and OhlcvDeprecated, the generic OHLCV
+  // rtype, otherwise.
+  databento::OhlcvMsg ToOhlcv(const Bar& bar) const;
+
+ private:
+  struct OpenBar {
+    Bar bar;
+    bool active;
+  };
+
+  void Close(OpenBar& open);
+
+  const BarKind kind_;
+  const double threshold_;
+  // Integer forms of the threshold for time, tick and volume bars
+  const std::uint64_t interval_;
+  FlatHashMap<std::uint32_t, OpenBar> open_;
+  std::vector<Bar> completed_;
+  std::size_t drained_{};
+  std::uint64_t trades_applied_{};
+};
+
+}  // namespace databento_jl
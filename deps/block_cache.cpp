@@ -0,0 +1,285 @@
+#include "block_cache.hpp"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <exception>
+#include <system_error>
+#include <utility>
+
+namespace databento_jl {
+
+namespace {
+constexpr std::uint64_t kDefaultBudget = std::uint64_t{1} << 30;
+constexpr std::size_t kMinPruneAt = 64;
+
+std::uint64_t Mix(std::uint64_t x) {
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+  return x;
+}
+
+databento::Record RecordIn(const RecordBlock& block, std::size_t i) {
+  return databento::Record{reinterpret_cast<databento::RecordHeader*>(
+      const_cast<std::byte*>(block.bytes.data() + block.offsets[i]))};
+}
+
+std::uint64_t BlockBytes(const RecordBlock& block) {
+  return block.bytes.capacity() + block.offsets.capacity() * sizeof(std::size_t) +
+         block.index_ts.capacity() * sizeof(std::uint64_t);
+}
+}  // namespace
+
+std::size_t BlockCache::BlockKeyHash::operator()(const BlockKey& key) const {
+  return static_cast<std::size_t>(Mix(key.file_id * 0x9e3779b97f4a7c15ULL ^ key.file_offset));
+}
+
+std::size_t BlockCache::FileKeyHash::operator()(const FileKey& key) const {
+  const std::uint64_t mtime = static_cast<std::uint64_t>(key.mtime_ns);
+  return static_cast<std::size_t>(Mix(key.device ^ Mix(key.inode ^ Mix(key.size ^ mtime))));
+}
+
+BlockCache::BlockCache(std::uint64_t budget_bytes)
+    : budget_{budget_bytes}, prune_at_{kMinPruneAt} {}
+
+BlockCache& BlockCache::Shared() {
+  static BlockCache cache{kDefaultBudget};
+  return cache;
+}
+
+std::shared_ptr<const CachedFile> BlockCache::Open(const std::string& dbn_path) {
+  struct stat st {};
+  if (::stat(dbn_path.c_str(), &st) != 0) {
+    throw std::system_error{errno, std::generic_category(), "Failed to stat " + dbn_path};
+  }
+  const FileKey key{static_cast<std::uint64_t>(st.st_dev), static_cast<std::uint64_t>(st.st_ino),
+                    static_cast<std::uint64_t>(st.st_size),
+                    static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1'000'000'000 +
+                        st.st_mtim.tv_nsec};
+  std::shared_ptr<FileSlot> slot;
+  {
+    std::lock_guard<std::mutex> lock{files_mutex_};
+    if (files_.size() >= prune_at_) {
+      PruneFiles();
+    }
+    std::shared_ptr<FileSlot>& existing = files_[key];
+    if (existing == nullptr) {
+      existing = std::make_shared<FileSlot>();
+      existing->id = next_file_id_++;
+    }
+    slot = existing;
+  }
+  // Readers of the same file wait for the one loading it; a load that throws
+  // is retried by the next reader
+  std::lock_guard<std::mutex> loading{slot->mutex};
+  if (std::shared_ptr<const CachedFile> file = slot->file.lock()) {
+    return file;
+  }
+  TsIndex index;
+  try {
+    index = TsIndex::Load(DefaultIndexPath(dbn_path));
+  } catch (const std::exception&) {
+    // No readable sidecar index, build one below
+  }
+  if (!index.MatchesSource(dbn_path)) {
+    index = BuildTsIndex(dbn_path);
+  }
+  auto file = std::make_shared<CachedFile>();
+  file->id = slot->id;
+  file->metadata = IndexedDbnReader{dbn_path, index}.GetMetadata();
+  file->index = std::move(index);
+  slot->file = file;
+  return file;
+}
+
+void BlockCache::PruneFiles() {
+  for (auto it = files_.begin(); it != files_.end();) {
+    FileSlot& slot = *it->second;
+    // A slot that is locked is being loaded or was just found
+    std::unique_lock<std::mutex> lock{slot.mutex, std::try_to_lock};
+    if (lock.owns_lock() && slot.file.expired()) {
+      lock.unlock();
+      it = files_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  prune_at_ = std::max(kMinPruneAt, 2 * files_.size());
+}
+
+BlockCache::Shard& BlockCache::ShardOf(const BlockKey& key) {
+  return shards_[BlockKeyHash{}(key) % kShardCount];
+}
+
+std::shared_ptr<const RecordBlock> BlockCache::Find(std::uint64_t file_id,
+                                                    std::uint64_t file_offset) {
+  const BlockKey key{file_id, file_offset};
+  Shard& shard = ShardOf(key);
+  {
+    std::shared_lock<std::shared_mutex> lock{shard.mutex};
+    const auto it = shard.entries.find(key);
+    if (it != shard.entries.end()) {
+      it->second.last_use.store(clock_.fetch_add(1, std::memory_order_relaxed),
+                                std::memory_order_relaxed);
+      hits_.fetch_add(1, std::memory_order_relaxed);
+      return it->second.block;
+    }
+  }
+  misses_.fetch_add(1, std::memory_order_relaxed);
+  return nullptr;
+}
+
+std::shared_ptr<const RecordBlock> BlockCache::Insert(const std::shared_ptr<const CachedFile>& file,
+                                                      std::uint64_t file_offset,
+                                                      std::shared_ptr<const RecordBlock> block) {
+  const BlockKey key{file->id, file_offset};
+  Shard& shard = ShardOf(key);
+  {
+    std::unique_lock<std::shared_mutex> lock{shard.mutex};
+    const auto [it, inserted] = shard.entries.try_emplace(key);
+    Entry& entry = it->second;
+    entry.last_use.store(clock_.fetch_add(1, std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+    if (!inserted) {
+      return entry.block;
+    }
+    entry.file = file;
+    entry.block = std::move(block);
+    entry.bytes = BlockBytes(*entry.block);
+    bytes_.fetch_add(entry.bytes, std::memory_order_relaxed);
+    block = entry.block;
+  }
+  Shrink();
+  return block;
+}
+
+void BlockCache::SetBudget(std::uint64_t budget_bytes) {
+  budget_.store(budget_bytes, std::memory_order_relaxed);
+  Shrink();
+}
+
+std::size_t BlockCache::BlockCount() const {
+  std::size_t count = 0;
+  for (const Shard& shard : shards_) {
+    std::shared_lock<std::shared_mutex> lock{shard.mutex};
+    count += shard.entries.size();
+  }
+  return count;
+}
+
+void BlockCache::Clear() {
+  for (Shard& shard : shards_) {
+    std::unique_lock<std::shared_mutex> lock{shard.mutex};
+    for (const auto& [key, entry] : shard.entries) {
+      bytes_.fetch_sub(entry.bytes, std::memory_order_relaxed);
+    }
+    shard.entries.clear();
+  }
+  hits_.store(0, std::memory_order_relaxed);
+  misses_.store(0, std::memory_order_relaxed);
+  evictions_.store(0, std::memory_order_relaxed);
+}
+
+void BlockCache::Shrink() {
+  std::lock_guard<std::mutex> evicting{evict_mutex_};
+  while (bytes_.load(std::memory_order_relaxed) > Budget()) {
+    // The victim is the oldest of the shards' least recently used entries
+    Shard* victim_shard = nullptr;
+    BlockKey victim{};
+    std::uint64_t oldest = ~std::uint64_t{};
+    for (Shard& shard : shards_) {
+      std::shared_lock<std::shared_mutex> lock{shard.mutex};
+      for (const auto& [key, entry] : shard.entries) {
+        const std::uint64_t last_use = entry.last_use.load(std::memory_order_relaxed);
+        if (victim_shard == nullptr || last_use < oldest) {
+          victim_shard = &shard;
+          victim = key;
+          oldest = last_use;
+        }
+      }
+    }
+    if (victim_shard == nullptr) {
+      // Other threads emptied the cache
+      return;
+    }
+    // Released after the shard lock, as the file may be the last reference
+    // to its index
+    std::shared_ptr<const CachedFile> file;
+    std::shared_ptr<const RecordBlock> block;
+    {
+      std::unique_lock<std::shared_mutex> lock{victim_shard->mutex};
+      const auto it = victim_shard->entries.find(victim);
+      // Look again if the victim was used or dropped since the scan
+      if (it == victim_shard->entries.end() ||
+          it->second.last_use.load(std::memory_order_relaxed) != oldest) {
+        continue;
+      }
+      file = std::move(it->second.file);
+      block = std::move(it->second.block);
+      bytes_.fetch_sub(it->second.bytes, std::memory_order_relaxed);
+      victim_shard->entries.erase(it);
+    }
+    evictions_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+CachedDbnReader::CachedDbnReader(const std::string& dbn_path, BlockCache& cache)
+    : path_{dbn_path}, cache_{cache}, file_{cache.Open(dbn_path)} {}
+
+const databento::Record* CachedDbnReader::NextRecord() {
+  while (current_ == nullptr || next_ == current_->Size()) {
+    const std::size_t block = current_ == nullptr ? block_ : block_ + 1;
+    if (block >= file_->index.blocks.size()) {
+      return nullptr;
+    }
+    Load(block);
+  }
+  record_ = RecordIn(*current_, next_++);
+  return &record_;
+}
+
+void CachedDbnReader::Seek(std::uint64_t ts) {
+  const std::size_t block = file_->index.FindBlock(ts);
+  current_.reset();
+  block_ = block;
+  next_ = 0;
+  if (block == file_->index.blocks.size()) {
+    return;
+  }
+  Load(block);
+  while (const databento::Record* record = NextRecord()) {
+    if (static_cast<std::uint64_t>(record->Header().ts_event.time_since_epoch().count()) >= ts) {
+      // Return it again from the next NextRecord call
+      --next_;
+      return;
+    }
+  }
+}
+
+void CachedDbnReader::Load(std::size_t block) {
+  const std::uint64_t file_offset = file_->index.blocks[block].file_offset;
+  std::shared_ptr<const RecordBlock> records = cache_.Find(file_->id, file_offset);
+  if (records != nullptr) {
+    ++hits_;
+  } else {
+    ++misses_;
+    if (decoder_ == nullptr) {
+      decoder_ = std::make_unique<IndexedDbnReader>(path_, file_->index);
+    }
+    auto decoded = std::make_shared<RecordBlock>();
+    decoder_->ReadBlock(block, *decoded);
+    decoded->bytes.shrink_to_fit();
+    decoded->offsets.shrink_to_fit();
+    decoded->index_ts.shrink_to_fit();
+    records = cache_.Insert(file_, file_offset, std::move(decoded));
+  }
+  current_ = std::move(records);
+  block_ = block;
+  next_ = 0;
+}
+
+}  // namespace databento_jl
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <databento/dbn.hpp>
+#include <databento/record.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+#include "indexed_reader.hpp"
+#include "record_block.hpp"
+#include "ts_index.hpp"
+
+namespace databento_jl {
+
+// A DBN file known to a BlockCache: its timestamp index, which defines the
+// blocks, and its metadata, shared by every reader of the file
+struct CachedFile {
+  // Unique per file identity within the process
+  std::uint64_t id;
+  TsIndex index;
+  databento::Metadata metadata;
+};
+
+// Process-wide LRU cache of decoded record blocks, so repeated replays of the
+// same files skip decompression and framing once the blocks are warm.
+//
+// Blocks are those of the file's TsIndex: the sidecar index when it is
+// current, otherwise one built in memory the first time the file is opened.
+// Each block is an immutable RecordBlock keyed by the file's identity
+// (device, inode, size and modification time, so a rewritten file never
+// serves stale records) and the block's file offset. Readers hold blocks by
+// shared_ptr, so an evicted block stays valid for whoever is reading it.
+// Cached blocks also keep their file's index alive; a file with neither
+// readers nor cached blocks is forgotten and indexed again on its next open.
+//
+// Entries are spread over kShardCount shards. A lookup takes its shard's
+// lock shared and marks the entry used with a relaxed store, so concurrent
+// hits never serialize; inserts take it exclusively. When the decoded bytes
+// exceed the budget, the least recently used block across all shards is
+// evicted until the total is back under it.
+class BlockCache {
+ public:
+  static constexpr std::size_t kShardCount = 16;
+
+  explicit BlockCache(std::uint64_t budget_bytes);
+  BlockCache(const BlockCache&) = delete;
+  BlockCache& operator=(const BlockCache&) = delete;
+
+  // The cache shared by every CachedDbnReader, 1 GiB by default
+  static BlockCache& Shared();
+
+  // Identity, index and metadata of the DBN file at `dbn_path`, loading or
+  // building its index only on first use. Throws like IndexedDbnReader for
+  // files it cannot read.
+  std::shared_ptr<const CachedFile> Open(const std::string& dbn_path);
+
+  std::shared_ptr<const RecordBlock> Find(std::uint64_t file_id, std::uint64_t file_offset);
+  // Caches `block` of `file` unless another reader cached it first; returns
+  // the cached block either way
+  std::shared_ptr<const RecordBlock> Insert(const std::shared_ptr<const CachedFile>& file,
+                                            std::uint64_t file_offset,
+                                            std::shared_ptr<const RecordBlock> block);
+
+  // Lowering the budget evicts immediately
+  void SetBudget(std::uint64_t budget_bytes);
+  std::uint64_t Budget() const { return budget_.load(std::memory_order_relaxed); }
+  std::uint64_t Bytes() const { return bytes_.load(std::memory_order_relaxed); }
+  std::size_t BlockCount() const;
+  std::uint64_t Hits() const { return hits_.load(std::memory_order_relaxed); }
+  std::uint64_t Misses() const { return misses_.load(std::memory_order_relaxed); }
+  std::uint64_t Evictions() const { return evictions_.load(std::memory_order_relaxed); }
+  // Drops every block and zeroes the counters; readers keep the blocks they
+  // hold
+  void Clear();
+
+ private:
+  struct BlockKey {
+    std::uint64_t file_id;
+    std::uint64_t file_offset;
+    bool operator==(const BlockKey& other) const {
+      return file_id == other.file_id && file_offset == other.file_offset;
+    }
+  };
+  struct BlockKeyHash {
+    std::size_t operator()(const BlockKey& key) const;
+  };
+  struct Entry {
+    std::shared_ptr<const CachedFile> file;
+    std::shared_ptr<const RecordBlock> block;
+    std::uint64_t bytes{};
+    // clock_ at the last lookup
+    mutable std::atomic<std::uint64_t> last_use{};
+  };
+  struct Shard {
+    mutable std::shared_mutex mutex;
+    std::unordered_map<BlockKey, Entry, BlockKeyHash> entries;
+  };
+  struct FileKey {
+    std::uint64_t device;
+    std::uint64_t inode;
+    std::uint64_t size;
+    std::int64_t mtime_ns;
+    bool operator==(const FileKey& other) const {
+      return device == other.device && inode == other.inode && size == other.size &&
+             mtime_ns == other.mtime_ns;
+    }
+  };
+  struct FileKeyHash {
+    std::size_t operator()(const FileKey& key) const;
+  };
+  struct FileSlot {
+    std::uint64_t id;
+    // Held while loading, so readers of the same file wait for one load
+    std::mutex mutex;
+    // Alive while a reader or a cached block holds the file
+    std::weak_ptr<const CachedFile> file;
+  };
+
+  Shard& ShardOf(const BlockKey& key);
+  // Evicts the globally least recently used block until the cache fits its
+  // budget
+  void Shrink();
+  // Drops the slots of files nothing holds any more; requires files_mutex_
+  void PruneFiles();
+
+  std::array<Shard, kShardCount> shards_;
+  std::atomic<std::uint64_t> budget_;
+  std::atomic<std::uint64_t> bytes_{};
+  std::atomic<std::uint64_t> clock_{};
+  // Serializes eviction, so concurrent inserts don't pick the same victim
+  std::mutex evict_mutex_;
+  std::atomic<std::uint64_t> hits_{};
+  std::atomic<std::uint64_t> misses_{};
+  std::atomic<std::uint64_t> evictions_{};
+
+  std::mutex files_mutex_;
+  std::unordered_map<FileKey, std::shared_ptr<FileSlot>, FileKeyHash> files_;
+  std::uint64_t next_file_id_{};
+  // files_ size at which PruneFiles next runs
+  std::size_t prune_at_;
+};
+
+// DBN file reader that serves records from a BlockCache.
+//
+// Each index block is looked up in the cache before it is decoded; misses
+// are decoded by an IndexedDbnReader, opened on the first miss, and cached
+// for every other reader of the file. A warm replay therefore only copies
+// record pointers out of shared memory. Blocks are as coarse as the file's
+// index: a .dbn.zst written as one zstd frame is a single block, so write
+// large compressed files with DbnWriter (independent frames) or read them
+// uncompressed for finer-grained caching. Like IndexedDbnReader, only files
+// in the current DBN version are accepted.
+//
+// Readers are not thread-safe, but any number of them, on any threads, can
+// share the cache.
+class CachedDbnReader {
+ public:
+  CachedDbnReader(const std::string& dbn_path, BlockCache& cache);
+
+  const databento::Metadata& GetMetadata() const { return file_->metadata; }
+  // Returns the next record, or nullptr at the end of the file. The record
+  // is valid until the next call.
+  const databento::Record* NextRecord();
+  // Positions the reader at the first record in file order with
+  // ts_event >= ts
+  void Seek(std::uint64_t ts);
+  void Rewind() { Seek(0); }
+
+  std::size_t BlockCount() const { return file_->index.blocks.size(); }
+  // Blocks this reader found in the cache and decoded itself
+  std::uint64_t Hits() const { return hits_; }
+  std::uint64_t Misses() const { return misses_; }
+
+ private:
+  // Makes `block` current, from the cache or by decoding it
+  void Load(std::size_t block);
+
+  const std::string path_;
+  BlockCache& cache_;
+  const std::shared_ptr<const CachedFile> file_;
+  std::unique_ptr<IndexedDbnReader> decoder_;
+
+  std::shared_ptr<const RecordBlock> current_;
+  std::size_t block_{};
+  std::size_t next_{};
+  databento::Record record_{nullptr};
+  std::uint64_t hits_{};
+  std::uint64_t misses_{};
+};
+
+}  // namespace databento_jl
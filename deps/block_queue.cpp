@@ -0,0 +1,101 @@
+#include "block_queue.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace databento_jl {
+
+namespace {
+std::uint64_t ElapsedNs(std::chrono::steady_clock::time_point start) {
+  return static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start)
+          .count());
+}
+}  // namespace
+
+BlockQueue::BlockQueue(std::size_t block_count)
+    : blocks_(std::max<std::size_t>(block_count, 2)) {}
+
+RecordBlock* BlockQueue::AcquireFree() {
+  const std::uint64_t capacity = blocks_.size();
+  std::unique_lock<std::mutex> lock{mutex_};
+  // Filled blocks, including the one the consumer is reading, occupy ring
+  // slots [tail_, head_)
+  const auto has_room = [&] { return stopping_ || head_ - tail_ < capacity; };
+  if (!has_room()) {
+    const auto start = std::chrono::steady_clock::now();
+    drained_.wait(lock, has_room);
+    producer_stall_ns_ += ElapsedNs(start);
+  }
+  if (stopping_) {
+    return nullptr;
+  }
+  RecordBlock* block = &blocks_[head_ % capacity];
+  block->Clear();
+  return block;
+}
+
+void BlockQueue::Publish(bool last) {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (!blocks_[head_ % blocks_.size()].Empty()) {
+      ++head_;
+    }
+    producer_done_ = last;
+  }
+  filled_.notify_all();
+}
+
+void BlockQueue::Fail(std::exception_ptr error) {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    producer_error_ = std::move(error);
+    producer_done_ = true;
+  }
+  filled_.notify_all();
+}
+
+RecordBlock* BlockQueue::NextFilled() {
+  std::unique_lock<std::mutex> lock{mutex_};
+  if (holding_) {
+    holding_ = false;
+    ++tail_;
+    drained_.notify_all();
+  }
+  const auto ready = [&] { return head_ > tail_ || producer_done_; };
+  if (!ready()) {
+    const auto start = std::chrono::steady_clock::now();
+    filled_.wait(lock, ready);
+    consumer_stall_ns_ += ElapsedNs(start);
+  }
+  // Deliver everything produced before a failure, then report it
+  if (head_ == tail_) {
+    if (producer_error_) {
+      std::rethrow_exception(producer_error_);
+    }
+    return nullptr;
+  }
+  holding_ = true;
+  return &blocks_[tail_ % blocks_.size()];
+}
+
+void BlockQueue::Stop() {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    stopping_ = true;
+  }
+  drained_.notify_all();
+}
+
+std::uint64_t BlockQueue::ProducerStallNs() const {
+  std::lock_guard<std::mutex> lock{mutex_};
+  return producer_stall_ns_;
+}
+
+std::uint64_t BlockQueue::BlocksFilled() const {
+  std::lock_guard<std::mutex> lock{mutex_};
+  return head_;
+}
+
+}  // namespace databento_jl
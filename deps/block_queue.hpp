@@ -0,0 +1,63 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+#include "record_block.hpp"
+
+namespace databento_jl {
+
+// Bounded ring of RecordBlocks handed from one producing thread to one
+// consuming thread. Memory stays at `block_count` blocks: the producer waits
+// for the consumer to release a block before refilling it. Stall counters
+// report how long each side waited on the other.
+class BlockQueue {
+ public:
+  // At least two blocks so producing and consuming can overlap
+  explicit BlockQueue(std::size_t block_count);
+
+  std::size_t BlockCount() const { return blocks_.size(); }
+
+  // Producer side. Waits for a free block and returns it cleared, or
+  // nullptr once the consumer has stopped the queue.
+  RecordBlock* AcquireFree();
+  // Makes the block from AcquireFree visible to the consumer unless it is
+  // empty. `last` marks the end of the stream.
+  void Publish(bool last);
+  // Ends the stream with an error, rethrown by the consumer once it has
+  // drained the blocks published before it
+  void Fail(std::exception_ptr error);
+
+  // Consumer side. Releases the previously returned block and waits for the
+  // next filled one; returns nullptr at the end of the stream.
+  RecordBlock* NextFilled();
+  // Wakes and stops a waiting producer, e.g. when the consumer goes away
+  void Stop();
+
+  std::uint64_t ProducerStallNs() const;
+  std::uint64_t ConsumerStallNs() const { return consumer_stall_ns_; }
+  std::uint64_t BlocksFilled() const;
+
+ private:
+  std::vector<RecordBlock> blocks_;
+  mutable std::mutex mutex_;
+  std::condition_variable filled_;
+  std::condition_variable drained_;
+  // Ring positions: blocks [tail_, head_) are filled, the one at tail_ being
+  // read by the consumer once holding_ is set
+  std::uint64_t head_{};
+  std::uint64_t tail_{};
+  bool producer_done_{};
+  bool stopping_{};
+  std::exception_ptr producer_error_;
+  std::uint64_t producer_stall_ns_{};
+  // Owned by the consuming thread
+  bool holding_{};
+  std::uint64_t consumer_stall_ns_{};
+};
+
+}  // namespace databento_jl
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <databento/record.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace databento_jl {
+
+// Struct-of-arrays destinations for bulk record decoding.
+//
+// Every pointer refers to a caller-owned buffer (normally a Julia Vector passed
+// in through jlcxx::ArrayRef) with room for at least `capacity` elements.
+// Nothing is allocated on the C++ side: a batch call writes records straight
+// into these buffers and returns how many rows it filled.
+
+struct MboColumns {
+  using Msg = databento::MboMsg;
+
+  std::size_t capacity;
+  std::uint64_t* ts_event;
+  std::uint32_t* instrument_id;
+  std::uint16_t* publisher_id;
+  std::uint64_t* ts_recv;
+  std::uint64_t* order_id;
+  std::int64_t* price;
+  std::uint32_t* size;
+  std::uint8_t* flags;
+  std::uint8_t* channel_id;
+  std::uint8_t* action;
+  std::uint8_t* side;
+  std::int32_t* ts_in_delta;
+  std::uint32_t* sequence;
+
+  void Store(std::size_t i, const Msg& m) const {
+    ts_event[i] = m.hd.ts_event.time_since_epoch().count();
+    instrument_id[i] = m.hd.instrument_id;
+    publisher_id[i] = m.hd.publisher_id;
+    ts_recv[i] = m.ts_recv.time_since_epoch().count();
+    order_id[i] = m.order_id;
+    price[i] = m.price;
+    size[i] = m.size;
+    flags[i] = m.flags.Raw();
+    channel_id[i] = m.channel_id;
+    action[i] = static_cast<std::uint8_t>(m.action);
+    side[i] = static_cast<std::uint8_t>(m.side);
+    ts_in_delta[i] = m.ts_in_delta.count();
+    sequence[i] = m.sequence;
+  }
+};
+
+struct TradeColumns {
+  using Msg = databento::TradeMsg;
+
+  std::size_t capacity;
+  std::uint64_t* ts_event;
+  std::uint32_t* instrument_id;
+  std::uint16_t* publisher_id;
+  std::uint64_t* ts_recv;
+  std::int64_t* price;
+  std::uint32_t* size;
+  std::uint8_t* action;
+  std::uint8_t* side;
+  std::uint8_t* flags;
+  std::uint8_t* depth;
+  std::int32_t* ts_in_delta;
+  std::uint32_t* sequence;
+
+  void Store(std::size_t i, const Msg& m) const {
+    ts_event[i] = m.hd.ts_event.time_since_epoch().count();
+    instrument_id[i] = m.hd.instrument_id;
+    publisher_id[i] = m.hd.publisher_id;
+    ts_recv[i] = m.ts_recv.time_since_epoch().count();
+    price[i] = m.price;
+    size[i] = m.size;
+    action[i] = static_cast<std::uint8_t>(m.action);
+    side[i] = static_cast<std::uint8_t>(m.side);
+    flags[i] = m.flags.Raw();
+    depth[i] = m.depth;
+    ts_in_delta[i] = m.ts_in_delta.count();
+    sequence[i] = m.sequence;
+  }
+};
+
+struct Mbp1Columns {
+  using Msg = databento::Mbp1Msg;
+
+  std::size_t capacity;
+  std::uint64_t* ts_event;
+  std::uint32_t* instrument_id;
+  std::uint16_t* publisher_id;
+  std::uint64_t* ts_recv;
+  std::int64_t* price;
+  std::uint32_t* size;
+  std::uint8_t* action;
+  std::uint8_t* side;
+  std::uint8_t* flags;
+  std::uint8_t* depth;
+  std::int32_t* ts_in_delta;
+  std::uint32_t* sequence;
+  std::int64_t* bid_px;
+  std::int64_t* ask_px;
+  std::uint32_t* bid_sz;
+  std::uint32_t* ask_sz;
+  std::uint32_t* bid_ct;
+  std::uint32_t* ask_ct;
+
+  void Store(std::size_t i, const Msg& m) const {
+    ts_event[i] = m.hd.ts_event.time_since_epoch().count();
+    instrument_id[i] = m.hd.instrument_id;
+    publisher_id[i] = m.hd.publisher_id;
+    ts_recv[i] = m.ts_recv.time_since_epoch().count();
+    price[i] = m.price;
+    size[i] = m.size;
+    action[i] = static_cast<std::uint8_t>(m.action);
+    side[i] = static_cast<std::uint8_t>(m.side);
+    flags[i] = m.flags.Raw();
+    depth[i] = m.depth;
+    ts_in_delta[i] = m.ts_in_delta.count();
+    sequence[i] = m.sequence;
+    const databento::BidAskPair& level = m.levels[0];
+    bid_px[i] = level.bid_px;
+    ask_px[i] = level.ask_px;
+    bid_sz[i] = level.bid_sz;
+    ask_sz[i] = level.ask_sz;
+    bid_ct[i] = level.bid_ct;
+    ask_ct[i] = level.ask_ct;
+  }
+};
+
+// BBO-1s/BBO-1m: the last trade of the interval plus the closing quote
+struct BboColumns {
+  using Msg = databento::BboMsg;
+
+  std::size_t capacity;
+  std::uint64_t* ts_event;
+  std::uint32_t* instrument_id;
+  std::uint16_t* publisher_id;
+  std::uint64_t* ts_recv;
+  std::int64_t* price;
+  std::uint32_t* size;
+  std::uint8_t* side;
+  std::uint8_t* flags;
+  std::uint32_t* sequence;
+  std::int64_t* bid_px;
+  std::int64_t* ask_px;
+  std::uint32_t* bid_sz;
+  std::uint32_t* ask_sz;
+  std::uint32_t* bid_ct;
+  std::uint32_t* ask_ct;
+
+  void Store(std::size_t i, const Msg& m) const {
+    ts_event[i] = m.hd.ts_event.time_since_epoch().count();
+    instrument_id[i] = m.hd.instrument_id;
+    publisher_id[i] = m.hd.publisher_id;
+    ts_recv[i] = m.ts_recv.time_since_epoch().count();
+    price[i] = m.price;
+    size[i] = m.size;
+    side[i] = static_cast<std::uint8_t>(m.side);
+    flags[i] = m.flags.Raw();
+    sequence[i] = m.sequence;
+    const databento::BidAskPair& level = m.levels[0];
+    bid_px[i] = level.bid_px;
+    ask_px[i] = level.ask_px;
+    bid_sz[i] = level.bid_sz;
+    ask_sz[i] = level.ask_sz;
+    bid_ct[i] = level.bid_ct;
+    ask_ct[i] = level.ask_ct;
+  }
+};
+
+struct OhlcvColumns {
+  using Msg = databento::OhlcvMsg;
+
+  std::size_t capacity;
+  std::uint64_t* ts_event;
+  std::uint32_t* instrument_id;
+  std::uint16_t* publisher_id;
+  std::int64_t* open;
+  std::int64_t* high;
+  std::int64_t* low;
+  std::int64_t* close;
+  std::uint64_t* volume;
+
+  void Store(std::size_t i, const Msg& m) const {
+    ts_event[i] = m.hd.ts_event.time_since_epoch().count();
+    instrument_id[i] = m.hd.instrument_id;
+    publisher_id[i] = m.hd.publisher_id;
+    open[i] = m.open;
+    high[i] = m.high;
+    low[i] = m.low;
+    close[i] = m.close;
+    volume[i] = m.volume;
+  }
+};
+
+// Decodes up to `columns.capacity` records of `Columns::Msg` from `source`
+// into `columns` and returns the number of rows written. Records of any other
+// type (e.g. interleaved SymbolMappingMsg or SystemMsg) are skipped. `Source`
+// is anything with a `const databento::Record* NextRecord()` member, such as
+// databento::DbnFileStore.
+template <typename Columns, typename Source>
+std::size_t DecodeColumns(Source& source, const Columns& columns) {
+  using Msg = typename Columns::Msg;
+  std::size_t n = 0;
+  while (n < columns.capacity) {
+    const databento::Record* record = source.NextRecord();
+    if (record == nullptr) {
+      break;
+    }
+    if (const Msg* msg = record->template GetIf<Msg>()) {
+      columns.Store(n++, *msg);
+    }
+  }
+  return n;
+}
+
+}  // namespace databento_jl
@@ -1,17 +1,59 @@
 #include <jlcxx/jlcxx.hpp>
+#include <jlcxx/array.hpp>
+#include <jlcxx/stl.hpp>
+#include <jlcxx/tuple.hpp>
 #include <databento/enums.hpp>
 #include <databento/publishers.hpp>
 #include <databento/record.hpp>
 #include <databento/datetime.hpp>
 #include <databento/flag_set.hpp>
 #include <databento/historical.hpp>
+#include <databento/log.hpp>
 #include <databento/dbn_file_store.hpp>
 #include <databento/dbn.hpp>
+#include <algorithm>
+#include <array>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <cstring>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "analytics_kernels.hpp"
+#include "arrow_batch.hpp"
+#include "arrow_ipc_writer.hpp"
+#include "asof_join.hpp"
+#include "bar_aggregator.hpp"
+#include "block_cache.hpp"
+#include "columnar.hpp"
+#include "dbn_catalog.hpp"
+#include "dbn_summary.hpp"
+#include "dbn_writer.hpp"
+#include "definition_store.hpp"
+#include "depth_tensor.hpp"
+#include "download_manager.hpp"
+#include "historical_stream.hpp"
+#include "indexed_reader.hpp"
+#include "live_client.hpp"
+#include "mmap_reader.hpp"
+#include "multi_reader.hpp"
+#include "order_book.hpp"
+#include "parquet_writer.hpp"
+#include "pipeline_stats.hpp"
+#include "prefetch_reader.hpp"
+#include "profiled_reader.hpp"
+#include "record_demux.hpp"
+#include "record_fields.hpp"
+#include "record_filter.hpp"
+#include "record_util.hpp"
+#include "symbol_map.hpp"
+#include "synthetic_dbn.hpp"
+#include "ts_index.hpp"
+
 namespace jlcxx
 {
   // Enable automatic Julia type conversion for databento enums
@@ -30,6 +72,7 @@ namespace jlcxx
   template<> struct IsBits<databento::UnixNanos> : std::true_type {};
   template<> struct IsBits<databento::TimeDeltaNanos> : std::true_type {};
   template<> struct IsBits<databento::BidAskPair> : std::true_type {};
+  template<> struct IsBits<databento::ConsolidatedBidAskPair> : std::true_type {};
 
   // Phase 2: Record structures
   template<> struct IsBits<databento::RecordHeader> : std::true_type {};
@@ -48,6 +91,514 @@ namespace jlcxx
   template<> struct IsBits<databento::BboMsg> : std::true_type {};
   template<> struct IsBits<databento::Cmbp1Msg> : std::true_type {};
   template<> struct IsBits<databento::CbboMsg> : std::true_type {};
+
+  // Bar aggregation
+  template<> struct IsBits<databento_jl::BarKind> : std::true_type {};
+}
+
+namespace
+{
+  // Smallest length among the Julia column buffers handed to a batch call, so
+  // a short column can never be written past its end.
+  template<typename... Arrays>
+  std::size_t min_length(const Arrays&... arrays)
+  {
+    return std::min({static_cast<std::size_t>(arrays.size())...});
+  }
+
+  // Kernels over Julia buffers take an explicit row count, since chunked
+  // reads fill only a prefix of their columns
+  template<typename... Arrays>
+  void check_rows(std::size_t n, const Arrays&... arrays)
+  {
+    if (n > min_length(arrays...)) {
+      throw std::out_of_range{"Row count " + std::to_string(n) + " exceeds the buffer length " +
+                              std::to_string(min_length(arrays...))};
+    }
+  }
+
+  // Runs DecodeColumns behind the filter, skipping the adapter entirely when
+  // the filter would accept everything
+  template<typename Source, typename Columns>
+  std::size_t decode_filtered(Source& source, databento_jl::RecordFilter& filter, const Columns& columns)
+  {
+    if (filter.IsEmpty()) {
+      return databento_jl::DecodeColumns(source, columns);
+    }
+    databento_jl::FilteredSource<Source> filtered{source, filter};
+    return databento_jl::DecodeColumns(filtered, columns);
+  }
+
+  template<typename T> struct is_char_array : std::false_type {};
+  template<std::size_t N> struct is_char_array<std::array<char, N>> : std::true_type {};
+  template<std::size_t N> struct is_char_array<char[N]> : std::true_type {};
+
+  // One accessor per field of T's table in record_fields.hpp, named after the
+  // field. NUL-padded character arrays are returned as strings and enums
+  // without a Julia type as their underlying integer. The lambdas differ only
+  // in the member pointer they capture, so fields of the same C++ type share
+  // one wrapper instantiation instead of one per field.
+  template<typename T>
+  void add_field_methods(jlcxx::Module& mod)
+  {
+    databento_jl::ForEachField<T>([&mod](const auto& field) {
+      using Value =
+          std::remove_cv_t<std::remove_reference_t<decltype(std::declval<const T&>().*field.member)>>;
+      const auto member = field.member;
+      if constexpr (is_char_array<Value>::value) {
+        mod.method(field.name, [member](const T& m) -> std::string {
+          const auto& chars = m.*member;
+          const char* first = std::data(chars);
+          return std::string(first, std::find(first, first + std::size(chars), '\0'));
+        });
+      } else if constexpr (std::is_enum_v<Value> && !jlcxx::IsBits<Value>::value) {
+        mod.method(field.name, [member](const T& m) {
+          return static_cast<std::underlying_type_t<Value>>(m.*member);
+        });
+      } else {
+        mod.method(field.name, [member](const T& m) -> Value { return m.*member; });
+      }
+    });
+
+    // The layout lets Julia load fields straight from a record's bytes
+    mod.method("record_field_names", [](jlcxx::SingletonType<T>) {
+      std::vector<std::string> names;
+      for (const auto& field : databento_jl::Layout<T>()) {
+        names.emplace_back(field.name);
+      }
+      return names;
+    });
+    mod.method("record_field_offsets", [](jlcxx::SingletonType<T>) {
+      std::vector<std::uint64_t> offsets;
+      for (const auto& field : databento_jl::Layout<T>()) {
+        offsets.push_back(field.offset);
+      }
+      return offsets;
+    });
+    mod.method("record_field_sizes", [](jlcxx::SingletonType<T>) {
+      std::vector<std::uint64_t> sizes;
+      for (const auto& field : databento_jl::Layout<T>()) {
+        sizes.push_back(field.size);
+      }
+      return sizes;
+    });
+  }
+
+  // A record struct as a bits type with its field accessors, index_ts and
+  // to_string
+  template<typename Msg>
+  void add_record_type(jlcxx::Module& mod)
+  {
+    mod.add_bits<Msg>(databento_jl::RecordFields<Msg>::kName, jlcxx::julia_type("IsBits"));
+    add_field_methods<Msg>(mod);
+    mod.method("index_ts", [](const Msg& m) { return m.IndexTs(); });
+    mod.method("to_string", [](const Msg& m) -> std::string {
+      return databento::ToString(m);
+    });
+  }
+
+  // Batch decode methods for any record source with a NextRecord() member.
+  // Each call fills caller-owned Julia vectors with up to min_length(...)
+  // records of one schema that pass `filter`, so a whole chunk crosses the FFI
+  // boundary at once.
+  template<typename Source>
+  void add_columnar_methods(jlcxx::Module& mod)
+  {
+    mod.method("read_mbo_columns!", [](Source& source,
+                                       databento_jl::RecordFilter& filter,
+                                       jlcxx::ArrayRef<std::uint64_t> ts_event,
+                                       jlcxx::ArrayRef<std::uint32_t> instrument_id,
+                                       jlcxx::ArrayRef<std::uint16_t> publisher_id,
+                                       jlcxx::ArrayRef<std::uint64_t> ts_recv,
+                                       jlcxx::ArrayRef<std::uint64_t> order_id,
+                                       jlcxx::ArrayRef<std::int64_t> price,
+                                       jlcxx::ArrayRef<std::uint32_t> size,
+                                       jlcxx::ArrayRef<std::uint8_t> flags,
+                                       jlcxx::ArrayRef<std::uint8_t> channel_id,
+                                       jlcxx::ArrayRef<std::uint8_t> action,
+                                       jlcxx::ArrayRef<std::uint8_t> side,
+                                       jlcxx::ArrayRef<std::int32_t> ts_in_delta,
+                                       jlcxx::ArrayRef<std::uint32_t> sequence) -> std::size_t {
+      const databento_jl::MboColumns columns{
+        min_length(ts_event, instrument_id, publisher_id, ts_recv, order_id, price, size,
+                   flags, channel_id, action, side, ts_in_delta, sequence),
+        ts_event.data(), instrument_id.data(), publisher_id.data(), ts_recv.data(),
+        order_id.data(), price.data(), size.data(), flags.data(), channel_id.data(),
+        action.data(), side.data(), ts_in_delta.data(), sequence.data()};
+      return decode_filtered(source, filter, columns);
+    });
+
+    mod.method("read_trade_columns!", [](Source& source,
+                                         databento_jl::RecordFilter& filter,
+                                         jlcxx::ArrayRef<std::uint64_t> ts_event,
+                                         jlcxx::ArrayRef<std::uint32_t> instrument_id,
+                                         jlcxx::ArrayRef<std::uint16_t> publisher_id,
+                                         jlcxx::ArrayRef<std::uint64_t> ts_recv,
+                                         jlcxx::ArrayRef<std::int64_t> price,
+                                         jlcxx::ArrayRef<std::uint32_t> size,
+                                         jlcxx::ArrayRef<std::uint8_t> action,
+                                         jlcxx::ArrayRef<std::uint8_t> side,
+                                         jlcxx::ArrayRef<std::uint8_t> flags,
+                                         jlcxx::ArrayRef<std::uint8_t> depth,
+                                         jlcxx::ArrayRef<std::int32_t> ts_in_delta,
+                                         jlcxx::ArrayRef<std::uint32_t> sequence) -> std::size_t {
+      const databento_jl::TradeColumns columns{
+        min_length(ts_event, instrument_id, publisher_id, ts_recv, price, size, action,
+                   side, flags, depth, ts_in_delta, sequence),
+        ts_event.data(), instrument_id.data(), publisher_id.data(), ts_recv.data(),
+        price.data(), size.data(), action.data(), side.data(), flags.data(), depth.data(),
+        ts_in_delta.data(), sequence.data()};
+      return decode_filtered(source, filter, columns);
+    });
+
+    mod.method("read_mbp1_columns!", [](Source& source,
+                                        databento_jl::RecordFilter& filter,
+                                        jlcxx::ArrayRef<std::uint64_t> ts_event,
+                                        jlcxx::ArrayRef<std::uint32_t> instrument_id,
+                                        jlcxx::ArrayRef<std::uint16_t> publisher_id,
+                                        jlcxx::ArrayRef<std::uint64_t> ts_recv,
+                                        jlcxx::ArrayRef<std::int64_t> price,
+                                        jlcxx::ArrayRef<std::uint32_t> size,
+                                        jlcxx::ArrayRef<std::uint8_t> action,
+                                        jlcxx::ArrayRef<std::uint8_t> side,
+                                        jlcxx::ArrayRef<std::uint8_t> flags,
+                                        jlcxx::ArrayRef<std::uint8_t> depth,
+                                        jlcxx::ArrayRef<std::int32_t> ts_in_delta,
+                                        jlcxx::ArrayRef<std::uint32_t> sequence,
+                                        jlcxx::ArrayRef<std::int64_t> bid_px,
+                                        jlcxx::ArrayRef<std::int64_t> ask_px,
+                                        jlcxx::ArrayRef<std::uint32_t> bid_sz,
+                                        jlcxx::ArrayRef<std::uint32_t> ask_sz,
+                                        jlcxx::ArrayRef<std::uint32_t> bid_ct,
+                                        jlcxx::ArrayRef<std::uint32_t> ask_ct) -> std::size_t {
+      const databento_jl::Mbp1Columns columns{
+        min_length(ts_event, instrument_id, publisher_id, ts_recv, price, size, action,
+                   side, flags, depth, ts_in_delta, sequence, bid_px, ask_px, bid_sz,
+                   ask_sz, bid_ct, ask_ct),
+        ts_event.data(), instrument_id.data(), publisher_id.data(), ts_recv.data(),
+        price.data(), size.data(), action.data(), side.data(), flags.data(), depth.data(),
+        ts_in_delta.data(), sequence.data(), bid_px.data(), ask_px.data(), bid_sz.data(),
+        ask_sz.data(), bid_ct.data(), ask_ct.data()};
+      return decode_filtered(source, filter, columns);
+    });
+
+    mod.method("read_bbo_columns!", [](Source& source,
+                                       databento_jl::RecordFilter& filter,
+                                       jlcxx::ArrayRef<std::uint64_t> ts_event,
+                                       jlcxx::ArrayRef<std::uint32_t> instrument_id,
+                                       jlcxx::ArrayRef<std::uint16_t> publisher_id,
+                                       jlcxx::ArrayRef<std::uint64_t> ts_recv,
+                                       jlcxx::ArrayRef<std::int64_t> price,
+                                       jlcxx::ArrayRef<std::uint32_t> size,
+                                       jlcxx::ArrayRef<std::uint8_t> side,
+                                       jlcxx::ArrayRef<std::uint8_t> flags,
+                                       jlcxx::ArrayRef<std::uint32_t> sequence,
+                                       jlcxx::ArrayRef<std::int64_t> bid_px,
+                                       jlcxx::ArrayRef<std::int64_t> ask_px,
+                                       jlcxx::ArrayRef<std::uint32_t> bid_sz,
+                                       jlcxx::ArrayRef<std::uint32_t> ask_sz,
+                                       jlcxx::ArrayRef<std::uint32_t> bid_ct,
+                                       jlcxx::ArrayRef<std::uint32_t> ask_ct) -> std::size_t {
+      const databento_jl::BboColumns columns{
+        min_length(ts_event, instrument_id, publisher_id, ts_recv, price, size, side, flags,
+                   sequence, bid_px, ask_px, bid_sz, ask_sz, bid_ct, ask_ct),
+        ts_event.data(), instrument_id.data(), publisher_id.data(), ts_recv.data(),
+        price.data(), size.data(), side.data(), flags.data(), sequence.data(), bid_px.data(),
+        ask_px.data(), bid_sz.data(), ask_sz.data(), bid_ct.data(), ask_ct.data()};
+      return decode_filtered(source, filter, columns);
+    });
+
+    mod.method("read_ohlcv_columns!", [](Source& source,
+                                         databento_jl::RecordFilter& filter,
+                                         jlcxx::ArrayRef<std::uint64_t> ts_event,
+                                         jlcxx::ArrayRef<std::uint32_t> instrument_id,
+                                         jlcxx::ArrayRef<std::uint16_t> publisher_id,
+                                         jlcxx::ArrayRef<std::int64_t> open,
+                                         jlcxx::ArrayRef<std::int64_t> high,
+                                         jlcxx::ArrayRef<std::int64_t> low,
+                                         jlcxx::ArrayRef<std::int64_t> close,
+                                         jlcxx::ArrayRef<std::uint64_t> volume) -> std::size_t {
+      const databento_jl::OhlcvColumns columns{
+        min_length(ts_event, instrument_id, publisher_id, open, high, low, close, volume),
+        ts_event.data(), instrument_id.data(), publisher_id.data(), open.data(),
+        high.data(), low.data(), close.data(), volume.data()};
+      return decode_filtered(source, filter, columns);
+    });
+
+    // MBP-10 books as a dense tensor; `features` may be empty to skip the
+    // derived per-level values
+    mod.method("read_mbp10_tensor!", [](Source& source,
+                                        databento_jl::RecordFilter& filter,
+                                        jlcxx::ArrayRef<std::uint64_t> ts_event,
+                                        jlcxx::ArrayRef<std::uint64_t> ts_recv,
+                                        jlcxx::ArrayRef<std::uint32_t> instrument_id,
+                                        jlcxx::ArrayRef<double> depth,
+                                        jlcxx::ArrayRef<double> features,
+                                        bool scale_prices) -> std::size_t {
+      using Tensor = databento_jl::Mbp10TensorColumns;
+      std::size_t capacity = std::min(min_length(ts_event, ts_recv, instrument_id),
+                                      static_cast<std::size_t>(depth.size()) / (Tensor::kLevels * Tensor::kFields));
+      const bool with_features = features.size() != 0;
+      if (with_features) {
+        capacity = std::min(capacity, static_cast<std::size_t>(features.size()) /
+                                          (Tensor::kLevels * Tensor::kFeatures));
+      }
+      const Tensor columns{capacity, ts_event.data(), ts_recv.data(), instrument_id.data(),
+                           depth.data(), with_features ? features.data() : nullptr, scale_prices};
+      return decode_filtered(source, filter, columns);
+    });
+  }
+
+  // Replays MBO records from a source into an order book engine without
+  // returning to Julia between records
+  template<typename Source>
+  void add_order_book_methods(jlcxx::Module& mod)
+  {
+    mod.method("consume!", [](databento_jl::OrderBookEngine& engine, Source& source, std::size_t max_records) -> std::size_t {
+      return engine.Consume(source, max_records);
+    });
+    mod.method("consume!", [](databento_jl::OrderBookEngine& engine, Source& source,
+                              databento_jl::RecordFilter& filter, std::size_t max_records) -> std::size_t {
+      databento_jl::FilteredSource<Source> filtered{source, filter};
+      return engine.Consume(filtered, max_records);
+    });
+  }
+
+  // Feeds trades from a source into a bar aggregator in one C++ call
+  template<typename Source>
+  void add_bar_methods(jlcxx::Module& mod)
+  {
+    mod.method("consume!", [](databento_jl::BarAggregator& aggregator, Source& source, std::size_t max_records) -> std::size_t {
+      return aggregator.Consume(source, max_records);
+    });
+    mod.method("consume!", [](databento_jl::BarAggregator& aggregator, Source& source,
+                              databento_jl::RecordFilter& filter, std::size_t max_records) -> std::size_t {
+      databento_jl::FilteredSource<Source> filtered{source, filter};
+      return aggregator.Consume(filtered, max_records);
+    });
+  }
+
+  // Record-at-a-time iteration with the filter applied on the C++ side
+  template<typename Source>
+  void add_filter_methods(jlcxx::Module& mod)
+  {
+    mod.method("next_record", [](Source& source, databento_jl::RecordFilter& filter) -> const databento::Record* {
+      databento_jl::FilteredSource<Source> filtered{source, filter};
+      return filtered.NextRecord();
+    });
+  }
+
+  // Collects the SymbolMappingMsg records of a source into a symbol map
+  template<typename Source>
+  void add_symbol_map_methods(jlcxx::Module& mod)
+  {
+    mod.method("consume!", [](databento_jl::TsSymbolMap& map, Source& source, std::size_t max_records) -> std::size_t {
+      return map.Consume(source, max_records);
+    });
+  }
+
+  // Ingests the definitions of a source into a definition store
+  template<typename Source>
+  void add_definition_store_methods(jlcxx::Module& mod)
+  {
+    mod.method("consume!", [](databento_jl::DefinitionStore& store, Source& source, std::size_t max_records) -> std::size_t {
+      return store.Consume(source, max_records);
+    });
+  }
+
+  // Copies the records of a source into a DBN writer or fan-out in one C++
+  // call, optionally behind a filter
+  template<typename Source>
+  void add_writer_methods(jlcxx::Module& mod)
+  {
+    mod.method("write_records!", [](databento_jl::DbnWriter& writer, Source& source, std::size_t max_records) -> std::size_t {
+      return writer.WriteFrom(source, max_records);
+    });
+    mod.method("write_records!", [](databento_jl::DbnWriter& writer, Source& source,
+                                    databento_jl::RecordFilter& filter, std::size_t max_records) -> std::size_t {
+      databento_jl::FilteredSource<Source> filtered{source, filter};
+      return writer.WriteFrom(filtered, max_records);
+    });
+    mod.method("write_records!", [](databento_jl::DbnFanOut& fan_out, Source& source, std::size_t max_records) -> std::size_t {
+      return fan_out.WriteFrom(source, max_records);
+    });
+    mod.method("write_records!", [](databento_jl::DbnFanOut& fan_out, Source& source,
+                                    databento_jl::RecordFilter& filter, std::size_t max_records) -> std::size_t {
+      databento_jl::FilteredSource<Source> filtered{source, filter};
+      return fan_out.WriteFrom(filtered, max_records);
+    });
+  }
+
+  // Splits the records of a source by type in one C++ call, optionally
+  // behind a filter
+  template<typename Source>
+  void add_demux_methods(jlcxx::Module& mod)
+  {
+    mod.method("demux!", [](databento_jl::RecordDemux& demux, Source& source, std::uint64_t max_records) -> std::uint64_t {
+      return demux.Split(source, max_records);
+    });
+    mod.method("demux!", [](databento_jl::RecordDemux& demux, Source& source,
+                            databento_jl::RecordFilter& filter, std::uint64_t max_records) -> std::uint64_t {
+      databento_jl::FilteredSource<Source> filtered{source, filter};
+      return demux.Split(filtered, max_records);
+    });
+  }
+
+  databento_jl::ParquetWriterOptions parquet_options(bool zstd, int compression_level, std::size_t threads,
+                                                     std::size_t row_group_rows)
+  {
+    databento_jl::ParquetWriterOptions options;
+    options.zstd = zstd;
+    options.compression_level = compression_level;
+    options.threads = threads;
+    options.row_group_rows = row_group_rows;
+    return options;
+  }
+
+  // Converts a source into Arrow batches handed over through the C Data
+  // Interface
+  template<typename Source>
+  void add_arrow_batch_methods(jlcxx::Module& mod)
+  {
+    // Exports the next batch into the ArrowArray at `out` and returns its
+    // length; 0 means the source is exhausted
+    mod.method("next_arrow_batch!", [](databento_jl::DbnArrowConverter& converter, Source& source, void* out) -> std::size_t {
+      databento_jl::ArrowBatch batch = converter.NextBatch(source);
+      const std::size_t length = batch.Length();
+      databento_jl::ExportArrowBatch(std::move(batch), static_cast<ArrowArray*>(out));
+      return length;
+    });
+    mod.method("next_arrow_batch!", [](databento_jl::DbnArrowConverter& converter, Source& source,
+                                       databento_jl::RecordFilter& filter, void* out) -> std::size_t {
+      databento_jl::FilteredSource<Source> filtered{source, filter};
+      databento_jl::ArrowBatch batch = converter.NextBatch(filtered);
+      const std::size_t length = batch.Length();
+      databento_jl::ExportArrowBatch(std::move(batch), static_cast<ArrowArray*>(out));
+      return length;
+    });
+  }
+
+  // Converts a whole source straight into an Arrow IPC or Parquet file
+  template<typename Source>
+  void add_arrow_file_methods(jlcxx::Module& mod)
+  {
+    mod.method("write_arrow_ipc!", [](databento_jl::DbnArrowConverter& converter, Source& source,
+                                      const std::string& path) -> std::uint64_t {
+      databento_jl::ArrowIpcFileWriter writer{path, converter.Fields()};
+      const std::uint64_t rows = converter.WriteAll(source, writer);
+      writer.Close();
+      return rows;
+    });
+    mod.method("write_arrow_ipc!", [](databento_jl::DbnArrowConverter& converter, Source& source,
+                                      databento_jl::RecordFilter& filter, const std::string& path) -> std::uint64_t {
+      databento_jl::FilteredSource<Source> filtered{source, filter};
+      databento_jl::ArrowIpcFileWriter writer{path, converter.Fields()};
+      const std::uint64_t rows = converter.WriteAll(filtered, writer);
+      writer.Close();
+      return rows;
+    });
+    mod.method("write_parquet!", [](databento_jl::DbnArrowConverter& converter, Source& source,
+                                    const std::string& path, bool zstd, int compression_level,
+                                    std::size_t threads, std::size_t row_group_rows) -> std::uint64_t {
+      databento_jl::ParquetFileWriter writer{
+          path, converter.Fields(), parquet_options(zstd, compression_level, threads, row_group_rows)};
+      const std::uint64_t rows = converter.WriteAll(source, writer);
+      writer.Close();
+      return rows;
+    });
+    mod.method("write_parquet!", [](databento_jl::DbnArrowConverter& converter, Source& source,
+                                    databento_jl::RecordFilter& filter, const std::string& path,
+                                    bool zstd, int compression_level, std::size_t threads,
+                                    std::size_t row_group_rows) -> std::uint64_t {
+      databento_jl::FilteredSource<Source> filtered{source, filter};
+      databento_jl::ParquetFileWriter writer{
+          path, converter.Fields(), parquet_options(zstd, compression_level, threads, row_group_rows)};
+      const std::uint64_t rows = converter.WriteAll(filtered, writer);
+      writer.Close();
+      return rows;
+    });
+  }
+
+  // Methods that take what a source has ready and can simply be called
+  // again, so they also suit a source whose NextRecord() returns nullptr
+  // while it waits for more data
+  template<typename Source>
+  void add_record_poll_methods(jlcxx::Module& mod)
+  {
+    add_columnar_methods<Source>(mod);
+    add_filter_methods<Source>(mod);
+    add_arrow_batch_methods<Source>(mod);
+  }
+
+  // Everything that can be driven by a record source: registered once per
+  // source type at the end of the module, after all wrapped types exist.
+  // Besides the poll methods these read until NextRecord() returns nullptr,
+  // so they need a source for which that means the end of the stream
+  template<typename Source>
+  void add_record_source_methods(jlcxx::Module& mod)
+  {
+    add_record_poll_methods<Source>(mod);
+    add_order_book_methods<Source>(mod);
+    add_bar_methods<Source>(mod);
+    add_symbol_map_methods<Source>(mod);
+    add_definition_store_methods<Source>(mod);
+    add_writer_methods<Source>(mod);
+    add_arrow_file_methods<Source>(mod);
+    add_demux_methods<Source>(mod);
+    // Type-erased handle for the as-of join, which then takes any two readers
+    // without an instantiation per pair of source types
+    mod.method("source_ref", [](Source& source) { return databento_jl::RecordSourceRef{source}; });
+  }
+
+  // Feed latency histograms of a source opened with them enabled
+  template<typename Source>
+  const databento_jl::FeedLatency& feed_latency(const Source& source)
+  {
+    if (source.Latency() == nullptr) {
+      throw std::invalid_argument{"Feed latency histograms are off for this source; enable them "
+                                  "when opening it"};
+    }
+    return *source.Latency();
+  }
+
+  // The returned histograms live in the source and keep filling as it is read
+  template<typename Source>
+  void add_feed_latency_methods(jlcxx::Module& mod)
+  {
+    mod.method("has_feed_latency", [](const Source& source) -> bool {
+      return source.Latency() != nullptr;
+    });
+    mod.method("recv_delay_histogram", [](const Source& source) -> const databento_jl::LatencyHistogram& {
+      return feed_latency(source).RecvDelay();
+    });
+    mod.method("ts_in_delta_histogram", [](const Source& source) -> const databento_jl::LatencyHistogram& {
+      return feed_latency(source).TsInDelta();
+    });
+    mod.method("send_delay_histogram", [](const Source& source) -> const databento_jl::LatencyHistogram& {
+      return feed_latency(source).SendDelay();
+    });
+  }
+
+  // Options shared by the DbnWriter and DbnFanOut constructors
+  databento_jl::DbnWriterOptions writer_options(bool zstd, int compression_level, std::size_t threads,
+                                                std::size_t frame_bytes, std::size_t max_pending_frames)
+  {
+    databento_jl::DbnWriterOptions options;
+    options.zstd = zstd;
+    options.compression_level = compression_level;
+    options.threads = threads;
+    options.frame_bytes = frame_bytes;
+    options.max_pending_frames = max_pending_frames;
+    return options;
+  }
+
+  // Queries on instruments without a book behave as on an empty book
+  const databento_jl::OrderBook& find_book(const databento_jl::OrderBookEngine& engine, std::uint32_t instrument_id)
+  {
+    static const databento_jl::OrderBook empty_book;
+    const databento_jl::OrderBook* book = engine.Find(instrument_id);
+    return book == nullptr ? empty_book : *book;
+  }
 }
 
 JLCXX_MODULE define_databento_module(jlcxx::Module& mod)
@@ -248,211 +799,33 @@ JLCXX_MODULE define_databento_module(jlcxx::Module& mod)
     return td.count();
   });
 
-  // BidAskPair - Price level data
+  // Field accessors of the structs below are generated from their tables in
+  // record_fields.hpp
   mod.add_bits<databento::BidAskPair>("BidAskPair", jlcxx::julia_type("IsBits"));
-  mod.method("bid_px", [](const databento::BidAskPair& p) { return p.bid_px; });
-  mod.method("ask_px", [](const databento::BidAskPair& p) { return p.ask_px; });
-  mod.method("bid_sz", [](const databento::BidAskPair& p) { return p.bid_sz; });
-  mod.method("ask_sz", [](const databento::BidAskPair& p) { return p.ask_sz; });
-  mod.method("bid_ct", [](const databento::BidAskPair& p) { return p.bid_ct; });
-  mod.method("ask_ct", [](const databento::BidAskPair& p) { return p.ask_ct; });
-
-  // RecordHeader - Common header for all records
+  add_field_methods<databento::BidAskPair>(mod);
+  mod.add_bits<databento::ConsolidatedBidAskPair>("ConsolidatedBidAskPair", jlcxx::julia_type("IsBits"));
+  add_field_methods<databento::ConsolidatedBidAskPair>(mod);
+
   mod.add_bits<databento::RecordHeader>("RecordHeader", jlcxx::julia_type("IsBits"));
-  mod.method("length", [](const databento::RecordHeader& h) { return h.length; });
-  mod.method("rtype", [](const databento::RecordHeader& h) { return h.rtype; });
-  mod.method("publisher_id", [](const databento::RecordHeader& h) { return h.publisher_id; });
-  mod.method("instrument_id", [](const databento::RecordHeader& h) { return h.instrument_id; });
-  mod.method("ts_event", [](const databento::RecordHeader& h) { return h.ts_event; });
+  add_field_methods<databento::RecordHeader>(mod);
   mod.method("size", &databento::RecordHeader::Size);
   mod.method("publisher", &databento::RecordHeader::Publisher);
 
-  // MboMsg - Market By Order message
-  mod.add_bits<databento::MboMsg>("MboMsg", jlcxx::julia_type("IsBits"));
-  mod.method("hd", [](const databento::MboMsg& m) { return m.hd; });
-  mod.method("order_id", [](const databento::MboMsg& m) { return m.order_id; });
-  mod.method("price", [](const databento::MboMsg& m) { return m.price; });
-  mod.method("size", [](const databento::MboMsg& m) { return m.size; });
-  mod.method("flags", [](const databento::MboMsg& m) { return m.flags; });
-  mod.method("channel_id", [](const databento::MboMsg& m) { return m.channel_id; });
-  mod.method("action", [](const databento::MboMsg& m) { return m.action; });
-  mod.method("side", [](const databento::MboMsg& m) { return m.side; });
-  mod.method("ts_recv", [](const databento::MboMsg& m) { return m.ts_recv; });
-  mod.method("ts_in_delta", [](const databento::MboMsg& m) { return m.ts_in_delta; });
-  mod.method("sequence", [](const databento::MboMsg& m) { return m.sequence; });
-  mod.method("index_ts", &databento::MboMsg::IndexTs);
-  mod.method("to_string", [](const databento::MboMsg& m) -> std::string {
-    return databento::ToString(m);
-  });
-
-  // TradeMsg - Trade message
-  mod.add_bits<databento::TradeMsg>("TradeMsg", jlcxx::julia_type("IsBits"));
-  mod.method("hd", [](const databento::TradeMsg& m) { return m.hd; });
-  mod.method("price", [](const databento::TradeMsg& m) { return m.price; });
-  mod.method("size", [](const databento::TradeMsg& m) { return m.size; });
-  mod.method("action", [](const databento::TradeMsg& m) { return m.action; });
-  mod.method("side", [](const databento::TradeMsg& m) { return m.side; });
-  mod.method("flags", [](const databento::TradeMsg& m) { return m.flags; });
-  mod.method("depth", [](const databento::TradeMsg& m) { return m.depth; });
-  mod.method("ts_recv", [](const databento::TradeMsg& m) { return m.ts_recv; });
-  mod.method("ts_in_delta", [](const databento::TradeMsg& m) { return m.ts_in_delta; });
-  mod.method("sequence", [](const databento::TradeMsg& m) { return m.sequence; });
-  mod.method("index_ts", &databento::TradeMsg::IndexTs);
-  mod.method("to_string", [](const databento::TradeMsg& m) -> std::string {
-    return databento::ToString(m);
-  });
-
-  // Mbp1Msg - Market By Price Level 1 message
-  mod.add_bits<databento::Mbp1Msg>("Mbp1Msg", jlcxx::julia_type("IsBits"));
-  mod.method("hd", [](const databento::Mbp1Msg& m) { return m.hd; });
-  mod.method("price", [](const databento::Mbp1Msg& m) { return m.price; });
-  mod.method("size", [](const databento::Mbp1Msg& m) { return m.size; });
-  mod.method("action", [](const databento::Mbp1Msg& m) { return m.action; });
-  mod.method("side", [](const databento::Mbp1Msg& m) { return m.side; });
-  mod.method("flags", [](const databento::Mbp1Msg& m) { return m.flags; });
-  mod.method("depth", [](const databento::Mbp1Msg& m) { return m.depth; });
-  mod.method("ts_recv", [](const databento::Mbp1Msg& m) { return m.ts_recv; });
-  mod.method("ts_in_delta", [](const databento::Mbp1Msg& m) { return m.ts_in_delta; });
-  mod.method("sequence", [](const databento::Mbp1Msg& m) { return m.sequence; });
-  mod.method("levels", [](const databento::Mbp1Msg& m) { return m.levels; });
-  mod.method("index_ts", &databento::Mbp1Msg::IndexTs);
-  mod.method("to_string", [](const databento::Mbp1Msg& m) -> std::string {
-    return databento::ToString(m);
-  });
-
-  // Mbp10Msg - Market By Price Level 10 message
-  mod.add_bits<databento::Mbp10Msg>("Mbp10Msg", jlcxx::julia_type("IsBits"));
-  mod.method("hd", [](const databento::Mbp10Msg& m) { return m.hd; });
-  mod.method("price", [](const databento::Mbp10Msg& m) { return m.price; });
-  mod.method("size", [](const databento::Mbp10Msg& m) { return m.size; });
-  mod.method("action", [](const databento::Mbp10Msg& m) { return m.action; });
-  mod.method("side", [](const databento::Mbp10Msg& m) { return m.side; });
-  mod.method("flags", [](const databento::Mbp10Msg& m) { return m.flags; });
-  mod.method("depth", [](const databento::Mbp10Msg& m) { return m.depth; });
-  mod.method("ts_recv", [](const databento::Mbp10Msg& m) { return m.ts_recv; });
-  mod.method("ts_in_delta", [](const databento::Mbp10Msg& m) { return m.ts_in_delta; });
-  mod.method("sequence", [](const databento::Mbp10Msg& m) { return m.sequence; });
-  mod.method("levels", [](const databento::Mbp10Msg& m) { return m.levels; });
-  mod.method("index_ts", &databento::Mbp10Msg::IndexTs);
-  mod.method("to_string", [](const databento::Mbp10Msg& m) -> std::string {
-    return databento::ToString(m);
-  });
-
-  // InstrumentDefMsg - Instrument definition message
-  mod.add_bits<databento::InstrumentDefMsg>("InstrumentDefMsg", jlcxx::julia_type("IsBits"));
-  mod.method("hd", [](const databento::InstrumentDefMsg& m) { return m.hd; });
-  mod.method("ts_recv", [](const databento::InstrumentDefMsg& m) { return m.ts_recv; });
-  mod.method("min_price_increment", [](const databento::InstrumentDefMsg& m) { return m.min_price_increment; });
-  mod.method("display_factor", [](const databento::InstrumentDefMsg& m) { return m.display_factor; });
-  mod.method("expiration", [](const databento::InstrumentDefMsg& m) { return m.expiration; });
-  mod.method("activation", [](const databento::InstrumentDefMsg& m) { return m.activation; });
-  mod.method("high_limit_price", [](const databento::InstrumentDefMsg& m) { return m.high_limit_price; });
-  mod.method("low_limit_price", [](const databento::InstrumentDefMsg& m) { return m.low_limit_price; });
-  mod.method("max_price_variation", [](const databento::InstrumentDefMsg& m) { return m.max_price_variation; });
-  mod.method("trading_reference_price", [](const databento::InstrumentDefMsg& m) { return m.trading_reference_price; });
-  mod.method("unit_of_measure_qty", [](const databento::InstrumentDefMsg& m) { return m.unit_of_measure_qty; });
-  mod.method("min_price_increment_amount", [](const databento::InstrumentDefMsg& m) { return m.min_price_increment_amount; });
-  mod.method("price_ratio", [](const databento::InstrumentDefMsg& m) { return m.price_ratio; });
-  mod.method("inst_attrib_value", [](const databento::InstrumentDefMsg& m) { return m.inst_attrib_value; });
-  mod.method("underlying_id", [](const databento::InstrumentDefMsg& m) { return m.underlying_id; });
-  mod.method("raw_instrument_id", [](const databento::InstrumentDefMsg& m) { return m.raw_instrument_id; });
-  mod.method("market_depth_implied", [](const databento::InstrumentDefMsg& m) { return m.market_depth_implied; });
-  mod.method("market_depth", [](const databento::InstrumentDefMsg& m) { return m.market_depth; });
-  mod.method("market_segment_id", [](const databento::InstrumentDefMsg& m) { return m.market_segment_id; });
-  mod.method("max_trade_vol", [](const databento::InstrumentDefMsg& m) { return m.max_trade_vol; });
-  mod.method("min_lot_size", [](const databento::InstrumentDefMsg& m) { return m.min_lot_size; });
-  mod.method("min_lot_size_block", [](const databento::InstrumentDefMsg& m) { return m.min_lot_size_block; });
-  mod.method("min_lot_size_round_lot", [](const databento::InstrumentDefMsg& m) { return m.min_lot_size_round_lot; });
-  mod.method("min_trade_vol", [](const databento::InstrumentDefMsg& m) { return m.min_trade_vol; });
-  mod.method("contract_multiplier", [](const databento::InstrumentDefMsg& m) { return m.contract_multiplier; });
-  mod.method("decay_quantity", [](const databento::InstrumentDefMsg& m) { return m.decay_quantity; });
-  mod.method("original_contract_size", [](const databento::InstrumentDefMsg& m) { return m.original_contract_size; });
-  mod.method("trading_reference_date", [](const databento::InstrumentDefMsg& m) { return m.trading_reference_date; });
-  mod.method("appl_id", [](const databento::InstrumentDefMsg& m) { return m.appl_id; });
-  mod.method("maturity_year", [](const databento::InstrumentDefMsg& m) { return m.maturity_year; });
-  mod.method("decay_start_date", [](const databento::InstrumentDefMsg& m) { return m.decay_start_date; });
-  mod.method("channel_id", [](const databento::InstrumentDefMsg& m) { return m.channel_id; });
-  mod.method("currency", [](const databento::InstrumentDefMsg& m) -> std::string {
-    return m.Currency();
-  });
-  mod.method("settl_currency", [](const databento::InstrumentDefMsg& m) -> std::string {
-    return m.SettlCurrency();
-  });
-  mod.method("secsubtype", [](const databento::InstrumentDefMsg& m) -> std::string {
-    return m.SecSubType();
-  });
-  mod.method("raw_symbol", [](const databento::InstrumentDefMsg& m) -> std::string {
-    return m.RawSymbol();
-  });
-  mod.method("group", [](const databento::InstrumentDefMsg& m) -> std::string {
-    return m.Group();
-  });
-  mod.method("exchange", [](const databento::InstrumentDefMsg& m) -> std::string {
-    return m.Exchange();
-  });
-  mod.method("asset", [](const databento::InstrumentDefMsg& m) -> std::string {
-    return m.Asset();
-  });
-  mod.method("cfi", [](const databento::InstrumentDefMsg& m) -> std::string {
-    return m.Cfi();
-  });
-  mod.method("security_type", [](const databento::InstrumentDefMsg& m) -> std::string {
-    return m.SecurityType();
-  });
-  mod.method("unit_of_measure", [](const databento::InstrumentDefMsg& m) -> std::string {
-    return m.UnitOfMeasure();
-  });
-  mod.method("underlying", [](const databento::InstrumentDefMsg& m) -> std::string {
-    return m.Underlying();
-  });
-  mod.method("strike_price_currency", [](const databento::InstrumentDefMsg& m) -> std::string {
-    return m.StrikePriceCurrency();
-  });
-  mod.method("instrument_class", [](const databento::InstrumentDefMsg& m) { return m.instrument_class; });
-  mod.method("strike_price", [](const databento::InstrumentDefMsg& m) { return m.strike_price; });
-  mod.method("match_algorithm", [](const databento::InstrumentDefMsg& m) { return m.match_algorithm; });
-  mod.method("md_security_trading_status", [](const databento::InstrumentDefMsg& m) { return m.md_security_trading_status; });
-  mod.method("main_fraction", [](const databento::InstrumentDefMsg& m) { return m.main_fraction; });
-  mod.method("price_display_format", [](const databento::InstrumentDefMsg& m) { return m.price_display_format; });
-  mod.method("settl_price_type", [](const databento::InstrumentDefMsg& m) { return m.settl_price_type; });
-  mod.method("sub_fraction", [](const databento::InstrumentDefMsg& m) { return m.sub_fraction; });
-  mod.method("underlying_product", [](const databento::InstrumentDefMsg& m) { return m.underlying_product; });
-  mod.method("security_update_action", [](const databento::InstrumentDefMsg& m) { return m.security_update_action; });
-  mod.method("maturity_month", [](const databento::InstrumentDefMsg& m) { return m.maturity_month; });
-  mod.method("maturity_day", [](const databento::InstrumentDefMsg& m) { return m.maturity_day; });
-  mod.method("maturity_week", [](const databento::InstrumentDefMsg& m) { return m.maturity_week; });
-  mod.method("user_defined_instrument", [](const databento::InstrumentDefMsg& m) { return m.user_defined_instrument; });
-  mod.method("contract_multiplier_unit", [](const databento::InstrumentDefMsg& m) { return m.contract_multiplier_unit; });
-  mod.method("flow_schedule_type", [](const databento::InstrumentDefMsg& m) { return m.flow_schedule_type; });
-  mod.method("tick_rule", [](const databento::InstrumentDefMsg& m) { return m.tick_rule; });
-  mod.method("index_ts", &databento::InstrumentDefMsg::IndexTs);
-  mod.method("to_string", [](const databento::InstrumentDefMsg& m) -> std::string {
-    return databento::ToString(m);
-  });
-
-  // ImbalanceMsg - Imbalance message
-  mod.add_bits<databento::ImbalanceMsg>("ImbalanceMsg", jlcxx::julia_type("IsBits"));
-  mod.method("hd", [](const databento::ImbalanceMsg& m) { return m.hd; });
-  mod.method("ts_recv", [](const databento::ImbalanceMsg& m) { return m.ts_recv; });
-  mod.method("ref_price", [](const databento::ImbalanceMsg& m) { return m.ref_price; });
-  mod.method("auction_time", [](const databento::ImbalanceMsg& m) { return m.auction_time; });
-  mod.method("cont_book_clr_price", [](const databento::ImbalanceMsg& m) { return m.cont_book_clr_price; });
-  mod.method("auct_interest_clr_price", [](const databento::ImbalanceMsg& m) { return m.auct_interest_clr_price; });
-  mod.method("ssr_filling_price", [](const databento::ImbalanceMsg& m) { return m.ssr_filling_price; });
-  mod.method("ind_match_price", [](const databento::ImbalanceMsg& m) { return m.ind_match_price; });
-  mod.method("upper_collar", [](const databento::ImbalanceMsg& m) { return m.upper_collar; });
-  mod.method("lower_collar", [](const databento::ImbalanceMsg& m) { return m.lower_collar; });
-  mod.method("paired_qty", [](const databento::ImbalanceMsg& m) { return m.paired_qty; });
-  mod.method("total_imbalance_qty", [](const databento::ImbalanceMsg& m) { return m.total_imbalance_qty; });
-  mod.method("market_imbalance_qty", [](const databento::ImbalanceMsg& m) { return m.market_imbalance_qty; });
-  mod.method("unpaired_qty", [](const databento::ImbalanceMsg& m) { return m.unpaired_qty; });
-  mod.method("auction_type", [](const databento::ImbalanceMsg& m) { return m.auction_type; });
-  mod.method("side", [](const databento::ImbalanceMsg& m) { return m.side; });
-  mod.method("auction_status", [](const databento::ImbalanceMsg& m) { return m.auction_status; });
-  mod.method("index_ts", &databento::ImbalanceMsg::IndexTs);
-  mod.method("to_string", [](const databento::ImbalanceMsg& m) -> std::string {
-    return databento::ToString(m);
-  });
+  add_record_type<databento::MboMsg>(mod);
+  add_record_type<databento::TradeMsg>(mod);
+  add_record_type<databento::Mbp1Msg>(mod);
+  add_record_type<databento::Mbp10Msg>(mod);
+  add_record_type<databento::BboMsg>(mod);
+  add_record_type<databento::Cmbp1Msg>(mod);
+  add_record_type<databento::CbboMsg>(mod);
+  add_record_type<databento::OhlcvMsg>(mod);
+  add_record_type<databento::StatusMsg>(mod);
+  add_record_type<databento::InstrumentDefMsg>(mod);
+  add_record_type<databento::ImbalanceMsg>(mod);
+  add_record_type<databento::StatMsg>(mod);
+  add_record_type<databento::ErrorMsg>(mod);
+  add_record_type<databento::SystemMsg>(mod);
+  add_record_type<databento::SymbolMappingMsg>(mod);
 
   // ============================================================================
   // PHASE 3: Historical Client
@@ -473,6 +846,11 @@ JLCXX_MODULE define_databento_module(jlcxx::Module& mod)
 
   // Historical - Main client for historical data access
   mod.add_type<databento::Historical>("Historical")
+    // Client for the gateway at host `gateway` and `port` over plain HTTP,
+    // e.g. a local stand-in
+    .constructor([](const std::string& key, const std::string& gateway, std::uint16_t port) {
+      return new databento::Historical{databento::ILogReceiver::Default(), key, gateway, port};
+    })
     // Metadata methods
     .method("metadata_list_datasets", [](databento::Historical& client) -> std::vector<std::string> {
       return client.MetadataListDatasets();
@@ -627,4 +1005,1380 @@ JLCXX_MODULE define_databento_module(jlcxx::Module& mod)
     .method("next_record", [](databento::DbnFileStore& store) -> const databento::Record* {
       return store.NextRecord();
     });
+
+  // ============================================================================
+  // Memory-Mapped DBN Reader
+  // ============================================================================
+
+  // MmapDbnReader - Zero-copy random access over uncompressed DBN files.
+  // Indices are 0-based; returned pointers stay valid while the reader lives.
+  mod.add_type<databento_jl::MmapDbnReader>("MmapDbnReader")
+    .constructor<const std::string&>()
+    .method("get_metadata", [](const databento_jl::MmapDbnReader& reader) -> const databento::Metadata& {
+      return reader.GetMetadata();
+    })
+    .method("record_count", [](const databento_jl::MmapDbnReader& reader) -> std::size_t {
+      return reader.RecordCount();
+    })
+    .method("file_size", [](const databento_jl::MmapDbnReader& reader) -> std::size_t {
+      return reader.FileSize();
+    })
+    .method("record_at", [](const databento_jl::MmapDbnReader& reader, std::size_t i) -> const databento::Record* {
+      return &reader.RecordAt(i);
+    })
+    // Sequential cursor, compatible with the DbnFileStore iteration pattern
+    .method("next_record", [](databento_jl::MmapDbnReader& reader) -> const databento::Record* {
+      return reader.NextRecord();
+    })
+    .method("rewind!", [](databento_jl::MmapDbnReader& reader) {
+      reader.Rewind();
+    })
+    .method("seek!", [](databento_jl::MmapDbnReader& reader, std::size_t i) {
+      reader.Seek(i);
+    })
+    .method("position", [](const databento_jl::MmapDbnReader& reader) -> std::size_t {
+      return reader.Position();
+    })
+    // Dense layout access: when is_uniform is true the body is an array of
+    // record_count records of record_stride bytes starting at record_data
+    .method("is_uniform", [](const databento_jl::MmapDbnReader& reader) -> bool {
+      return reader.IsUniform();
+    })
+    .method("record_stride", [](const databento_jl::MmapDbnReader& reader) -> std::size_t {
+      return reader.RecordStride();
+    })
+    .method("record_data", [](const databento_jl::MmapDbnReader& reader) -> const void* {
+      return reader.Data();
+    })
+    // Typed views into the mapped pages (nullptr if the record has another type)
+    .method("mbo_at", [](const databento_jl::MmapDbnReader& reader, std::size_t i) -> const databento::MboMsg* {
+      return reader.GetIf<databento::MboMsg>(i);
+    })
+    .method("trade_at", [](const databento_jl::MmapDbnReader& reader, std::size_t i) -> const databento::TradeMsg* {
+      return reader.GetIf<databento::TradeMsg>(i);
+    })
+    .method("mbp1_at", [](const databento_jl::MmapDbnReader& reader, std::size_t i) -> const databento::Mbp1Msg* {
+      return reader.GetIf<databento::Mbp1Msg>(i);
+    })
+    .method("mbp10_at", [](const databento_jl::MmapDbnReader& reader, std::size_t i) -> const databento::Mbp10Msg* {
+      return reader.GetIf<databento::Mbp10Msg>(i);
+    })
+    .method("ohlcv_at", [](const databento_jl::MmapDbnReader& reader, std::size_t i) -> const databento::OhlcvMsg* {
+      return reader.GetIf<databento::OhlcvMsg>(i);
+    })
+    .method("status_at", [](const databento_jl::MmapDbnReader& reader, std::size_t i) -> const databento::StatusMsg* {
+      return reader.GetIf<databento::StatusMsg>(i);
+    })
+    .method("instrument_def_at", [](const databento_jl::MmapDbnReader& reader, std::size_t i) -> const databento::InstrumentDefMsg* {
+      return reader.GetIf<databento::InstrumentDefMsg>(i);
+    })
+    .method("imbalance_at", [](const databento_jl::MmapDbnReader& reader, std::size_t i) -> const databento::ImbalanceMsg* {
+      return reader.GetIf<databento::ImbalanceMsg>(i);
+    })
+    .method("stat_at", [](const databento_jl::MmapDbnReader& reader, std::size_t i) -> const databento::StatMsg* {
+      return reader.GetIf<databento::StatMsg>(i);
+    });
+
+  // ============================================================================
+  // Multi-File Merged Reader
+  // ============================================================================
+
+  // MultiDbnReader - Decodes several DBN files on a worker pool and merges
+  // them by index timestamp (ties broken by file order)
+  mod.add_type<databento_jl::MultiDbnReader>("MultiDbnReader")
+    .constructor<const std::vector<std::string>&, std::size_t, std::size_t, std::size_t>()
+    .method("file_count", [](const databento_jl::MultiDbnReader& reader) -> std::size_t {
+      return reader.FileCount();
+    })
+    .method("thread_count", [](const databento_jl::MultiDbnReader& reader) -> std::size_t {
+      return reader.ThreadCount();
+    })
+    .method("get_metadata", [](const databento_jl::MultiDbnReader& reader, std::size_t file_index) -> const databento::Metadata& {
+      return reader.GetMetadata(file_index);
+    })
+    .method("next_record", [](databento_jl::MultiDbnReader& reader) -> const databento::Record* {
+      return reader.NextRecord();
+    })
+    .method("current_file_index", [](const databento_jl::MultiDbnReader& reader) -> std::size_t {
+      return reader.CurrentFileIndex();
+    })
+    .method("records_merged", [](const databento_jl::MultiDbnReader& reader) -> std::uint64_t {
+      return reader.RecordsMerged();
+    });
+
+  // ============================================================================
+  // Prefetching DBN Reader
+  // ============================================================================
+
+  // PrefetchDbnFileStore - DbnFileStore that decompresses and frames records
+  // into a ring of blocks on a background thread
+  mod.add_type<databento_jl::PrefetchDbnFileStore>("PrefetchDbnFileStore")
+    .constructor<const std::string&, std::size_t, std::size_t>()
+    .method("get_metadata", [](const databento_jl::PrefetchDbnFileStore& store) -> const databento::Metadata& {
+      return store.GetMetadata();
+    })
+    .method("next_record", [](databento_jl::PrefetchDbnFileStore& store) -> const databento::Record* {
+      return store.NextRecord();
+    })
+    .method("buffer_count", [](const databento_jl::PrefetchDbnFileStore& store) -> std::size_t {
+      return store.BufferCount();
+    })
+    .method("block_bytes", [](const databento_jl::PrefetchDbnFileStore& store) -> std::size_t {
+      return store.BlockBytes();
+    })
+    // Stall counters: time each side spent waiting on the other
+    .method("producer_stall_ns", [](const databento_jl::PrefetchDbnFileStore& store) -> std::uint64_t {
+      return store.ProducerStallNs();
+    })
+    .method("consumer_stall_ns", [](const databento_jl::PrefetchDbnFileStore& store) -> std::uint64_t {
+      return store.ConsumerStallNs();
+    })
+    .method("blocks_filled", [](const databento_jl::PrefetchDbnFileStore& store) -> std::uint64_t {
+      return store.BlocksFilled();
+    })
+    .method("records_delivered", [](const databento_jl::PrefetchDbnFileStore& store) -> std::uint64_t {
+      return store.RecordsDelivered();
+    });
+
+  // ============================================================================
+  // Record Type Demultiplexer
+  // ============================================================================
+
+  // RecordDemux - one growable buffer per record type, filled by demux!.
+  // Slots are addressed by the Julia name of their message type.
+  mod.add_type<databento_jl::RecordDemux>("RecordDemux")
+    .constructor<>()
+    .method("slot_data", [](const databento_jl::RecordDemux& demux, std::size_t slot) -> const void* {
+      return demux.View(slot).data;
+    })
+    .method("slot_count", [](const databento_jl::RecordDemux& demux, std::size_t slot) -> std::size_t {
+      return demux.View(slot).count;
+    })
+    .method("slot_record_size", [](const databento_jl::RecordDemux& demux, std::size_t slot) -> std::size_t {
+      return demux.View(slot).record_size;
+    })
+    .method("records_skipped", [](const databento_jl::RecordDemux& demux) -> std::uint64_t {
+      return demux.Skipped();
+    })
+    .method("clear_demux!", [](databento_jl::RecordDemux& demux) {
+      demux.Clear();
+    });
+  mod.method("demux_slot", [](const std::string& name) -> std::size_t {
+    return databento_jl::RecordDemux::SlotOf(name);
+  });
+  mod.method("demux_slot_names", []() -> std::vector<std::string> {
+    return {std::begin(databento_jl::kDemuxNames), std::end(databento_jl::kDemuxNames)};
+  });
+
+  // ============================================================================
+  // Pipeline Instrumentation
+  // ============================================================================
+
+  // LatencyHistogram - HDR-style nanosecond histogram; values are within 1.6%
+  mod.add_type<databento_jl::LatencyHistogram>("LatencyHistogram")
+    .method("histogram_count", [](const databento_jl::LatencyHistogram& h) -> std::uint64_t {
+      return h.Count();
+    })
+    .method("histogram_negative_count", [](const databento_jl::LatencyHistogram& h) -> std::uint64_t {
+      return h.NegativeCount();
+    })
+    .method("histogram_min", [](const databento_jl::LatencyHistogram& h) -> std::uint64_t {
+      return h.Min();
+    })
+    .method("histogram_max", [](const databento_jl::LatencyHistogram& h) -> std::uint64_t {
+      return h.Max();
+    })
+    .method("histogram_mean", [](const databento_jl::LatencyHistogram& h) -> double {
+      return h.Mean();
+    })
+    .method("value_at_percentile", [](const databento_jl::LatencyHistogram& h, double percentile) -> std::uint64_t {
+      return h.ValueAtPercentile(percentile);
+    });
+
+  // ProfiledDbnFileStore - DbnFileStore with per-stage byte, record and time
+  // counters and optional feed latency histograms
+  mod.add_type<databento_jl::ProfiledDbnFileStore>("ProfiledDbnFileStore")
+    .constructor<const std::string&, bool>()
+    .method("get_metadata", [](const databento_jl::ProfiledDbnFileStore& store) -> const databento::Metadata& {
+      return store.GetMetadata();
+    })
+    .method("next_record", [](databento_jl::ProfiledDbnFileStore& store) -> const databento::Record* {
+      return store.NextRecord();
+    })
+    .method("bytes_read", [](const databento_jl::ProfiledDbnFileStore& store) -> std::uint64_t {
+      return store.BytesRead();
+    })
+    .method("bytes_decompressed", [](const databento_jl::ProfiledDbnFileStore& store) -> std::uint64_t {
+      return store.BytesDecompressed();
+    })
+    .method("records_decoded", [](const databento_jl::ProfiledDbnFileStore& store) -> std::uint64_t {
+      return store.RecordsDecoded();
+    })
+    .method("records_filtered", [](const databento_jl::ProfiledDbnFileStore& store) -> std::uint64_t {
+      return store.RecordsFiltered();
+    })
+    .method("records_delivered", [](const databento_jl::ProfiledDbnFileStore& store) -> std::uint64_t {
+      return store.RecordsDelivered();
+    })
+    .method("read_ns", [](const databento_jl::ProfiledDbnFileStore& store) -> std::uint64_t {
+      return store.ReadNs();
+    })
+    .method("decompress_ns", [](const databento_jl::ProfiledDbnFileStore& store) -> std::uint64_t {
+      return store.DecompressNs();
+    })
+    .method("decode_ns", [](const databento_jl::ProfiledDbnFileStore& store) -> std::uint64_t {
+      return store.DecodeNs();
+    })
+    .method("elapsed_ns", [](const databento_jl::ProfiledDbnFileStore& store) -> std::uint64_t {
+      return store.ElapsedNs();
+    });
+  add_feed_latency_methods<databento_jl::ProfiledDbnFileStore>(mod);
+
+  // ============================================================================
+  // Streaming Historical Requests
+  // ============================================================================
+
+  // HistoricalStream - timeseries request decoded on a background thread as
+  // the HTTP response arrives, instead of going through a file
+  mod.add_type<databento_jl::HistoricalStream>("HistoricalStream")
+    .constructor([](const std::string& key, const std::string& gateway, std::uint16_t port,
+                    const std::string& dataset, const std::vector<std::string>& symbols,
+                    databento::Schema schema, const std::string& start, const std::string& end,
+                    databento::SType stype_in, databento::SType stype_out, std::uint64_t limit,
+                    std::size_t buffer_count, std::size_t block_bytes, bool feed_latency) {
+      databento_jl::HistoricalStreamOptions options;
+      options.key = key;
+      options.gateway = gateway;
+      options.port = port;
+      options.dataset = dataset;
+      options.symbols = symbols;
+      options.schema = schema;
+      options.start = start;
+      options.end = end;
+      options.stype_in = stype_in;
+      options.stype_out = stype_out;
+      options.limit = limit;
+      options.buffer_count = buffer_count;
+      options.block_bytes = block_bytes;
+      options.feed_latency = feed_latency;
+      return new databento_jl::HistoricalStream{options};
+    })
+    .method("get_metadata", [](databento_jl::HistoricalStream& stream) -> const databento::Metadata& {
+      return stream.GetMetadata();
+    })
+    .method("next_record", [](databento_jl::HistoricalStream& stream) -> const databento::Record* {
+      return stream.NextRecord();
+    })
+    .method("buffer_count", [](const databento_jl::HistoricalStream& stream) -> std::size_t {
+      return stream.BufferCount();
+    })
+    .method("block_bytes", [](const databento_jl::HistoricalStream& stream) -> std::size_t {
+      return stream.BlockBytes();
+    })
+    .method("producer_stall_ns", [](const databento_jl::HistoricalStream& stream) -> std::uint64_t {
+      return stream.ProducerStallNs();
+    })
+    .method("consumer_stall_ns", [](const databento_jl::HistoricalStream& stream) -> std::uint64_t {
+      return stream.ConsumerStallNs();
+    })
+    .method("blocks_filled", [](const databento_jl::HistoricalStream& stream) -> std::uint64_t {
+      return stream.BlocksFilled();
+    })
+    .method("records_received", [](const databento_jl::HistoricalStream& stream) -> std::uint64_t {
+      return stream.RecordsReceived();
+    })
+    .method("records_delivered", [](const databento_jl::HistoricalStream& stream) -> std::uint64_t {
+      return stream.RecordsDelivered();
+    })
+    .method("bytes_received", [](const databento_jl::HistoricalStream& stream) -> std::uint64_t {
+      return stream.BytesReceived();
+    })
+    .method("records_filtered", [](const databento_jl::HistoricalStream& stream) -> std::uint64_t {
+      return stream.RecordsFiltered();
+    });
+  add_feed_latency_methods<databento_jl::HistoricalStream>(mod);
+
+  // ============================================================================
+  // Cached Parallel Downloads
+  // ============================================================================
+
+  mod.add_type<databento_jl::DownloadManager>("DownloadManager")
+    .constructor([](const std::string& key, const std::string& gateway, std::uint16_t port,
+                    const std::string& cache_dir, std::size_t max_in_flight,
+                    std::size_t symbols_per_request, std::size_t max_attempts,
+                    std::uint64_t retry_delay_ms, bool split_by_day) {
+      databento_jl::DownloadOptions options;
+      options.key = key;
+      options.gateway = gateway;
+      options.port = port;
+      options.cache_dir = cache_dir;
+      options.max_in_flight = max_in_flight;
+      options.symbols_per_request = symbols_per_request;
+      options.max_attempts = max_attempts;
+      options.retry_delay_ms = retry_delay_ms;
+      options.split_by_day = split_by_day;
+      return new databento_jl::DownloadManager{std::move(options)};
+    })
+    // Paths of the cached responses, downloading the missing ones
+    .method("download_range!", [](databento_jl::DownloadManager& manager, const std::string& dataset,
+                                  const std::vector<std::string>& symbols, databento::Schema schema,
+                                  std::uint64_t start, std::uint64_t end, databento::SType stype_in,
+                                  databento::SType stype_out) -> std::vector<std::string> {
+      return manager.Download(
+          databento_jl::DownloadRequest{dataset, symbols, schema, start, end, stype_in, stype_out});
+    })
+    // Paths the request maps to, and which of them are already cached
+    .method("planned_paths", [](const databento_jl::DownloadManager& manager, const std::string& dataset,
+                                const std::vector<std::string>& symbols, databento::Schema schema,
+                                std::uint64_t start, std::uint64_t end, databento::SType stype_in,
+                                databento::SType stype_out) -> std::vector<std::string> {
+      std::vector<std::string> paths;
+      for (const auto& piece : manager.Plan(databento_jl::DownloadRequest{
+               dataset, symbols, schema, start, end, stype_in, stype_out})) {
+        paths.push_back(piece.path);
+      }
+      return paths;
+    })
+    .method("cache_dir", [](const databento_jl::DownloadManager& manager) -> std::string {
+      return manager.Options().cache_dir;
+    })
+    .method("pieces_planned", [](const databento_jl::DownloadManager& manager) -> std::uint64_t {
+      return manager.PiecesPlanned();
+    })
+    .method("cache_hits", [](const databento_jl::DownloadManager& manager) -> std::uint64_t {
+      return manager.CacheHits();
+    })
+    .method("pieces_downloaded", [](const databento_jl::DownloadManager& manager) -> std::uint64_t {
+      return manager.PiecesDownloaded();
+    })
+    .method("retries", [](const databento_jl::DownloadManager& manager) -> std::uint64_t {
+      return manager.Retries();
+    })
+    .method("pieces_failed", [](const databento_jl::DownloadManager& manager) -> std::uint64_t {
+      return manager.PiecesFailed();
+    })
+    .method("bytes_downloaded", [](const databento_jl::DownloadManager& manager) -> std::uint64_t {
+      return manager.BytesDownloaded();
+    });
+
+  // ============================================================================
+  // L3 Order Book Engine
+  // ============================================================================
+
+  // OrderBookEngine - Full-depth books per instrument_id built from MboMsg
+  mod.add_type<databento_jl::OrderBookEngine>("OrderBookEngine")
+    .constructor<>()
+    .method("apply!", [](databento_jl::OrderBookEngine& engine, const databento::MboMsg& mbo) {
+      engine.Apply(mbo);
+    })
+    .method("apply!", [](databento_jl::OrderBookEngine& engine, const databento::Record& record) -> bool {
+      const auto* mbo = record.GetIf<databento::MboMsg>();
+      if (mbo != nullptr) {
+        engine.Apply(*mbo);
+      }
+      return mbo != nullptr;
+    })
+    .method("book_count", [](const databento_jl::OrderBookEngine& engine) -> std::size_t {
+      return engine.BookCount();
+    })
+    .method("instrument_ids", [](const databento_jl::OrderBookEngine& engine) -> std::vector<std::uint32_t> {
+      return engine.InstrumentIds();
+    })
+    .method("records_applied", [](const databento_jl::OrderBookEngine& engine) -> std::uint64_t {
+      return engine.RecordsApplied();
+    })
+    .method("has_book", [](const databento_jl::OrderBookEngine& engine, std::uint32_t instrument_id) -> bool {
+      return engine.Find(instrument_id) != nullptr;
+    })
+    // Book state flags (FlagSet::IsLast / IsSnapshot handling)
+    .method("is_consistent", [](const databento_jl::OrderBookEngine& engine, std::uint32_t instrument_id) -> bool {
+      return find_book(engine, instrument_id).IsConsistent();
+    })
+    .method("in_snapshot", [](const databento_jl::OrderBookEngine& engine, std::uint32_t instrument_id) -> bool {
+      return find_book(engine, instrument_id).InSnapshot();
+    })
+    // Queries
+    .method("bbo", [](const databento_jl::OrderBookEngine& engine, std::uint32_t instrument_id) -> databento::BidAskPair {
+      return find_book(engine, instrument_id).Bbo();
+    })
+    .method("depth", [](const databento_jl::OrderBookEngine& engine, std::uint32_t instrument_id, std::size_t level) -> databento::BidAskPair {
+      return find_book(engine, instrument_id).Depth(level);
+    })
+    .method("level_count", [](const databento_jl::OrderBookEngine& engine, std::uint32_t instrument_id, databento::Side side) -> std::size_t {
+      return find_book(engine, instrument_id).LevelCount(side);
+    })
+    .method("order_count", [](const databento_jl::OrderBookEngine& engine, std::uint32_t instrument_id) -> std::size_t {
+      return find_book(engine, instrument_id).OrderCount();
+    })
+    // Fills `levels` with the top length(levels) levels; returns how many
+    // levels exist on the deeper side, capped at length(levels)
+    .method("top_levels!", [](const databento_jl::OrderBookEngine& engine, std::uint32_t instrument_id,
+                              jlcxx::ArrayRef<databento::BidAskPair> levels) -> std::size_t {
+      const databento_jl::OrderBook& book = find_book(engine, instrument_id);
+      const std::size_t n = std::min<std::size_t>(
+        levels.size(), std::max(book.LevelCount(databento::Side::Bid), book.LevelCount(databento::Side::Ask)));
+      for (std::size_t i = 0; i < n; ++i) {
+        levels[i] = book.Depth(i);
+      }
+      return n;
+    })
+    // (orders_ahead, size_ahead) at the order's price level, or (-1, -1)
+    .method("queue_position", [](const databento_jl::OrderBookEngine& engine, std::uint32_t instrument_id,
+                                 std::uint64_t order_id) -> std::tuple<std::int64_t, std::int64_t> {
+      std::uint32_t orders_ahead;
+      std::uint64_t size_ahead;
+      if (!find_book(engine, instrument_id).QueuePosition(order_id, &orders_ahead, &size_ahead)) {
+        return {-1, -1};
+      }
+      return {orders_ahead, static_cast<std::int64_t>(size_ahead)};
+    })
+    // Full snapshot: every resting order, bids then asks, best level first and
+    // in queue priority. Returns the total order count; only as many orders as
+    // fit in the shortest buffer are written.
+    .method("snapshot_orders!", [](const databento_jl::OrderBookEngine& engine, std::uint32_t instrument_id,
+                                   jlcxx::ArrayRef<std::uint64_t> order_id,
+                                   jlcxx::ArrayRef<std::int64_t> price,
+                                   jlcxx::ArrayRef<std::uint32_t> size,
+                                   jlcxx::ArrayRef<std::uint8_t> side) -> std::size_t {
+      const databento_jl::OrderBook& book = find_book(engine, instrument_id);
+      const std::size_t capacity = min_length(order_id, price, size, side);
+      std::size_t n = 0;
+      const auto write = [&](const databento_jl::BookOrder& order) {
+        if (n < capacity) {
+          order_id[n] = order.order_id;
+          price[n] = order.price;
+          size[n] = order.size;
+          side[n] = static_cast<std::uint8_t>(order.side);
+        }
+        ++n;
+      };
+      book.ForEachOrder(databento::Side::Bid, write);
+      book.ForEachOrder(databento::Side::Ask, write);
+      return n;
+    });
+
+  // ============================================================================
+  // Bar Aggregation
+  // ============================================================================
+
+  mod.add_bits<databento_jl::BarKind>("BarKind", jlcxx::julia_type("CppEnum"));
+  mod.set_const("BAR_TIME", databento_jl::BarKind::Time);
+  mod.set_const("BAR_TICK", databento_jl::BarKind::Tick);
+  mod.set_const("BAR_VOLUME", databento_jl::BarKind::Volume);
+  mod.set_const("BAR_DOLLAR", databento_jl::BarKind::Dollar);
+
+  // BarAggregator - Time, tick, volume and dollar bars per instrument_id
+  mod.add_type<databento_jl::BarAggregator>("BarAggregator")
+    .constructor<databento_jl::BarKind, double>()
+    .method("add_trade!", [](databento_jl::BarAggregator& aggregator, std::uint32_t instrument_id,
+                             std::uint16_t publisher_id, std::uint64_t ts_event, std::int64_t price,
+                             std::uint32_t size) {
+      aggregator.AddTrade(instrument_id, publisher_id, ts_event, price, size);
+    })
+    .method("apply!", [](databento_jl::BarAggregator& aggregator, const databento::Record& record) -> bool {
+      return aggregator.Apply(record);
+    })
+    .method("flush!", [](databento_jl::BarAggregator& aggregator) {
+      aggregator.Flush();
+    })
+    .method("bar_kind", [](const databento_jl::BarAggregator& aggregator) -> databento_jl::BarKind {
+      return aggregator.Kind();
+    })
+    .method("bar_threshold", [](const databento_jl::BarAggregator& aggregator) -> double {
+      return aggregator.Threshold();
+    })
+    .method("instrument_count", [](const databento_jl::BarAggregator& aggregator) -> std::size_t {
+      return aggregator.InstrumentCount();
+    })
+    .method("trades_applied", [](const databento_jl::BarAggregator& aggregator) -> std::uint64_t {
+      return aggregator.TradesApplied();
+    })
+    .method("pending_bars", [](const databento_jl::BarAggregator& aggregator) -> std::size_t {
+      return aggregator.PendingBars();
+    })
+    // Moves completed bars into a Julia Vector{OhlcvMsg}
+    .method("drain_ohlcv!", [](databento_jl::BarAggregator& aggregator, jlcxx::ArrayRef<databento::OhlcvMsg> out) -> std::size_t {
+      databento::OhlcvMsg* data = out.data();
+      return aggregator.Drain(out.size(), [&](std::size_t i, const databento_jl::Bar& bar) {
+        data[i] = aggregator.ToOhlcv(bar);
+      });
+    })
+    // Moves completed bars into caller-owned columns
+    .method("drain_bars!", [](databento_jl::BarAggregator& aggregator,
+                              jlcxx::ArrayRef<std::uint64_t> ts_open,
+                              jlcxx::ArrayRef<std::uint64_t> ts_close,
+                              jlcxx::ArrayRef<std::uint32_t> instrument_id,
+                              jlcxx::ArrayRef<std::uint16_t> publisher_id,
+                              jlcxx::ArrayRef<std::int64_t> open,
+                              jlcxx::ArrayRef<std::int64_t> high,
+                              jlcxx::ArrayRef<std::int64_t> low,
+                              jlcxx::ArrayRef<std::int64_t> close,
+                              jlcxx::ArrayRef<std::uint64_t> volume,
+                              jlcxx::ArrayRef<std::uint32_t> trade_count,
+                              jlcxx::ArrayRef<double> notional) -> std::size_t {
+      const std::size_t capacity = min_length(ts_open, ts_close, instrument_id, publisher_id, open,
+                                              high, low, close, volume, trade_count, notional);
+      return aggregator.Drain(capacity, [&](std::size_t i, const databento_jl::Bar& bar) {
+        ts_open.data()[i] = bar.ts_open;
+        ts_close.data()[i] = bar.ts_close;
+        instrument_id.data()[i] = bar.instrument_id;
+        publisher_id.data()[i] = bar.publisher_id;
+        open.data()[i] = bar.open;
+        high.data()[i] = bar.high;
+        low.data()[i] = bar.low;
+        close.data()[i] = bar.close;
+        volume.data()[i] = bar.volume;
+        trade_count.data()[i] = bar.trade_count;
+        notional.data()[i] = bar.notional;
+      });
+    });
+
+  // ============================================================================
+  // As-Of Join
+  // ============================================================================
+
+  // RecordSourceRef - borrowed reference to any record source, from source_ref
+  mod.add_type<databento_jl::RecordSourceRef>("RecordSourceRef");
+
+  // AsofJoin - Trades paired with the prevailing quote and quote markouts
+  mod.add_type<databento_jl::AsofJoin>("AsofJoin")
+    .constructor<std::vector<std::uint64_t>, bool, std::uint64_t>()
+    // Both sources behind RecordSourceRef, so one loop serves every pair of
+    // reader types
+    .method("advance_join!", [](databento_jl::AsofJoin& join, databento_jl::RecordSourceRef& trades,
+                                databento_jl::RecordSourceRef& quotes, std::size_t max_rows) {
+      join.Advance(trades, quotes, max_rows);
+    })
+    .method("horizon_count", [](const databento_jl::AsofJoin& join) -> std::size_t {
+      return join.HorizonCount();
+    })
+    // Sorted and without duplicates, 0-based
+    .method("horizon", [](const databento_jl::AsofJoin& join, std::size_t i) -> std::uint64_t {
+      if (i >= join.HorizonCount()) {
+        throw std::out_of_range{"AsofJoin has " + std::to_string(join.HorizonCount()) + " horizons"};
+      }
+      return join.Horizon(i);
+    })
+    .method("join_complete", [](const databento_jl::AsofJoin& join) -> bool {
+      return join.Complete();
+    })
+    .method("trades_joined", [](const databento_jl::AsofJoin& join) -> std::uint64_t {
+      return join.TradesJoined();
+    })
+    .method("trades_without_quote", [](const databento_jl::AsofJoin& join) -> std::uint64_t {
+      return join.TradesWithoutQuote();
+    })
+    .method("quotes_applied", [](const databento_jl::AsofJoin& join) -> std::uint64_t {
+      return join.QuotesApplied();
+    })
+    .method("records_skipped", [](const databento_jl::AsofJoin& join) -> std::uint64_t {
+      return join.RecordsSkipped();
+    })
+    .method("instrument_count", [](const databento_jl::AsofJoin& join) -> std::size_t {
+      return join.InstrumentCount();
+    })
+    .method("pending_rows", [](const databento_jl::AsofJoin& join) -> std::size_t {
+      return join.PendingRows();
+    })
+    // Moves ready rows into caller-owned columns; the markout columns hold
+    // horizon_count values per row
+    .method("drain_join!", [](databento_jl::AsofJoin& join,
+                              jlcxx::ArrayRef<std::uint64_t> ts_recv,
+                              jlcxx::ArrayRef<std::uint64_t> ts_event,
+                              jlcxx::ArrayRef<std::uint32_t> instrument_id,
+                              jlcxx::ArrayRef<std::uint16_t> publisher_id,
+                              jlcxx::ArrayRef<std::int64_t> price,
+                              jlcxx::ArrayRef<std::uint32_t> size,
+                              jlcxx::ArrayRef<std::uint8_t> side,
+                              jlcxx::ArrayRef<std::uint64_t> quote_ts_recv,
+                              jlcxx::ArrayRef<std::int64_t> bid_px,
+                              jlcxx::ArrayRef<std::int64_t> ask_px,
+                              jlcxx::ArrayRef<std::uint32_t> bid_sz,
+                              jlcxx::ArrayRef<std::uint32_t> ask_sz,
+                              jlcxx::ArrayRef<std::int64_t> markout_bid,
+                              jlcxx::ArrayRef<std::int64_t> markout_ask) -> std::size_t {
+      std::size_t capacity = min_length(ts_recv, ts_event, instrument_id, publisher_id, price, size,
+                                        side, quote_ts_recv, bid_px, ask_px, bid_sz, ask_sz);
+      if (join.HorizonCount() > 0) {
+        capacity = std::min(capacity, min_length(markout_bid, markout_ask) / join.HorizonCount());
+      }
+      return join.Drain({capacity, ts_recv.data(), ts_event.data(), instrument_id.data(),
+                         publisher_id.data(), price.data(), size.data(), side.data(),
+                         quote_ts_recv.data(), bid_px.data(), ask_px.data(), bid_sz.data(),
+                         ask_sz.data(), markout_bid.data(), markout_ask.data()});
+    });
+
+  // ============================================================================
+  // Record Filtering
+  // ============================================================================
+
+  mod.add_type<databento_jl::RecordFilter>("RecordFilter")
+    .constructor<>()
+    .method("add_instrument_id!", [](databento_jl::RecordFilter& filter, std::uint32_t id) {
+      filter.AddInstrumentId(id);
+    })
+    .method("add_publisher_id!", [](databento_jl::RecordFilter& filter, std::uint16_t id) {
+      filter.AddPublisherId(id);
+    })
+    .method("add_rtype!", [](databento_jl::RecordFilter& filter, databento::RType rtype) {
+      filter.AddRType(rtype);
+    })
+    .method("add_action!", [](databento_jl::RecordFilter& filter, databento::Action action) {
+      filter.AddAction(action);
+    })
+    .method("add_side!", [](databento_jl::RecordFilter& filter, databento::Side side) {
+      filter.AddSide(side);
+    })
+    .method("set_ts_event_range!", [](databento_jl::RecordFilter& filter, std::uint64_t start, std::uint64_t end) {
+      filter.SetTsEventRange(start, end);
+    })
+    .method("set_ts_recv_range!", [](databento_jl::RecordFilter& filter, std::uint64_t start, std::uint64_t end) {
+      filter.SetTsRecvRange(start, end);
+    })
+    .method("set_stop_at_ts_recv_end!", [](databento_jl::RecordFilter& filter, bool stop) {
+      filter.SetStopAtTsRecvEnd(stop);
+    })
+    .method("reset!", [](databento_jl::RecordFilter& filter) {
+      filter.Reset();
+    })
+    .method("is_empty", [](const databento_jl::RecordFilter& filter) -> bool {
+      return filter.IsEmpty();
+    })
+    .method("records_scanned", [](const databento_jl::RecordFilter& filter) -> std::uint64_t {
+      return filter.RecordsScanned();
+    })
+    .method("records_matched", [](const databento_jl::RecordFilter& filter) -> std::uint64_t {
+      return filter.RecordsMatched();
+    })
+    .method("reset_counters!", [](databento_jl::RecordFilter& filter) {
+      filter.ResetCounters();
+    });
+
+  // ============================================================================
+  // Timestamp Index and Seekable Reader
+  // ============================================================================
+
+  // Builds the sidecar index for a DBN file and writes it to index_path.
+  // Returns the number of blocks.
+  mod.method("build_ts_index", [](const std::string& dbn_path, const std::string& index_path,
+                                  std::size_t stride, bool by_instrument) -> std::size_t {
+    const databento_jl::TsIndex index = databento_jl::BuildTsIndex(dbn_path, stride, by_instrument);
+    index.Save(index_path);
+    return index.blocks.size();
+  });
+
+  // True when index_path holds a readable index of the current dbn_path
+  mod.method("ts_index_is_current", [](const std::string& dbn_path, const std::string& index_path) -> bool {
+    try {
+      return databento_jl::TsIndex::Load(index_path).MatchesSource(dbn_path);
+    } catch (const std::exception&) {
+      return false;
+    }
+  });
+
+  mod.add_type<databento_jl::IndexedDbnReader>("IndexedDbnReader")
+    .constructor<const std::string&, const std::string&>()
+    .method("get_metadata", [](const databento_jl::IndexedDbnReader& reader) -> const databento::Metadata& {
+      return reader.GetMetadata();
+    })
+    .method("next_record", [](databento_jl::IndexedDbnReader& reader) -> const databento::Record* {
+      return reader.NextRecord();
+    })
+    .method("seek_ts!", [](databento_jl::IndexedDbnReader& reader, std::uint64_t ts) {
+      reader.Seek(ts);
+    })
+    .method("seek_ts!", [](databento_jl::IndexedDbnReader& reader, std::uint64_t ts, std::uint32_t instrument_id) {
+      reader.Seek(ts, instrument_id);
+    })
+    .method("rewind!", [](databento_jl::IndexedDbnReader& reader) {
+      reader.Rewind();
+    })
+    .method("current_block", [](const databento_jl::IndexedDbnReader& reader) -> std::size_t {
+      return reader.CurrentBlock();
+    })
+    .method("bytes_read", [](const databento_jl::IndexedDbnReader& reader) -> std::uint64_t {
+      return reader.BytesRead();
+    })
+    .method("block_count", [](const databento_jl::IndexedDbnReader& reader) -> std::size_t {
+      return reader.Index().blocks.size();
+    })
+    .method("indexed_record_count", [](const databento_jl::IndexedDbnReader& reader) -> std::uint64_t {
+      return reader.Index().record_count;
+    })
+    .method("has_instrument_postings", [](const databento_jl::IndexedDbnReader& reader) -> bool {
+      return reader.Index().HasInstrumentPostings();
+    });
+
+  // ============================================================================
+  // Shared Block Cache
+  // ============================================================================
+
+  // The process-wide cache behind every CachedDbnReader
+  mod.method("block_cache_budget", []() -> std::uint64_t {
+    return databento_jl::BlockCache::Shared().Budget();
+  });
+  mod.method("set_block_cache_budget!", [](std::uint64_t budget_bytes) {
+    databento_jl::BlockCache::Shared().SetBudget(budget_bytes);
+  });
+  mod.method("block_cache_bytes", []() -> std::uint64_t {
+    return databento_jl::BlockCache::Shared().Bytes();
+  });
+  mod.method("block_cache_blocks", []() -> std::size_t {
+    return databento_jl::BlockCache::Shared().BlockCount();
+  });
+  mod.method("block_cache_hits", []() -> std::uint64_t {
+    return databento_jl::BlockCache::Shared().Hits();
+  });
+  mod.method("block_cache_misses", []() -> std::uint64_t {
+    return databento_jl::BlockCache::Shared().Misses();
+  });
+  mod.method("block_cache_evictions", []() -> std::uint64_t {
+    return databento_jl::BlockCache::Shared().Evictions();
+  });
+  mod.method("clear_block_cache!", []() {
+    databento_jl::BlockCache::Shared().Clear();
+  });
+
+  mod.add_type<databento_jl::CachedDbnReader>("CachedDbnReader")
+    .constructor([](const std::string& path) {
+      return new databento_jl::CachedDbnReader{path, databento_jl::BlockCache::Shared()};
+    })
+    .method("get_metadata", [](const databento_jl::CachedDbnReader& reader) -> const databento::Metadata& {
+      return reader.GetMetadata();
+    })
+    .method("next_record", [](databento_jl::CachedDbnReader& reader) -> const databento::Record* {
+      return reader.NextRecord();
+    })
+    .method("seek_ts!", [](databento_jl::CachedDbnReader& reader, std::uint64_t ts) {
+      reader.Seek(ts);
+    })
+    .method("rewind!", [](databento_jl::CachedDbnReader& reader) {
+      reader.Rewind();
+    })
+    .method("block_count", [](const databento_jl::CachedDbnReader& reader) -> std::size_t {
+      return reader.BlockCount();
+    })
+    .method("cache_hits", [](const databento_jl::CachedDbnReader& reader) -> std::uint64_t {
+      return reader.Hits();
+    })
+    .method("cache_misses", [](const databento_jl::CachedDbnReader& reader) -> std::uint64_t {
+      return reader.Misses();
+    });
+
+  // ============================================================================
+  // Dataset Catalog
+  // ============================================================================
+
+  mod.add_type<databento_jl::DbnCatalog>("DbnCatalog")
+    .constructor<const std::string&, const std::string&>()
+    .method("refresh_catalog!", [](databento_jl::DbnCatalog& catalog, std::size_t num_threads) {
+      catalog.Refresh(num_threads);
+    })
+    .method("refresh_scanned", [](const databento_jl::DbnCatalog& catalog) -> std::size_t {
+      return catalog.LastRefresh().scanned;
+    })
+    .method("refresh_added", [](const databento_jl::DbnCatalog& catalog) -> std::size_t {
+      return catalog.LastRefresh().added;
+    })
+    .method("refresh_updated", [](const databento_jl::DbnCatalog& catalog) -> std::size_t {
+      return catalog.LastRefresh().updated;
+    })
+    .method("refresh_removed", [](const databento_jl::DbnCatalog& catalog) -> std::size_t {
+      return catalog.LastRefresh().removed;
+    })
+    .method("refresh_failed", [](const databento_jl::DbnCatalog& catalog) -> std::vector<std::string> {
+      return catalog.LastRefresh().failed;
+    })
+    .method("file_count", [](const databento_jl::DbnCatalog& catalog) -> std::size_t {
+      return catalog.Size();
+    })
+    .method("catalog_root", [](const databento_jl::DbnCatalog& catalog) -> std::string {
+      return catalog.Root();
+    })
+    .method("manifest_path", [](const databento_jl::DbnCatalog& catalog) -> std::string {
+      return catalog.ManifestPath();
+    })
+    // Full paths of the files matching the query, in start time order. An
+    // empty dataset or symbol list matches any.
+    .method("plan_files", [](const databento_jl::DbnCatalog& catalog, const std::string& dataset,
+                             bool any_schema, databento::Schema schema,
+                             const std::vector<std::string>& symbols, std::uint64_t start,
+                             std::uint64_t end) -> std::vector<std::string> {
+      databento_jl::CatalogQuery query;
+      query.dataset = dataset;
+      if (!any_schema) {
+        query.schema = schema;
+      }
+      query.symbols = symbols;
+      query.start = start;
+      query.end = end;
+      std::vector<std::string> paths;
+      for (const std::size_t i : catalog.Plan(query)) {
+        paths.push_back(catalog.FullPath(i));
+      }
+      return paths;
+    });
+
+  // ============================================================================
+  // DBN Summary Scan
+  // ============================================================================
+
+  mod.add_type<databento_jl::DbnSummary>("DbnSummary")
+    .method("summary_dbn_version", [](const databento_jl::DbnSummary& s) -> std::uint8_t {
+      return s.dbn_version;
+    })
+    .method("summary_compressed", [](const databento_jl::DbnSummary& s) -> bool {
+      return s.compressed;
+    })
+    .method("summary_file_size", [](const databento_jl::DbnSummary& s) -> std::uint64_t {
+      return s.file_size;
+    })
+    .method("summary_record_count", [](const databento_jl::DbnSummary& s) -> std::uint64_t {
+      return s.record_count;
+    })
+    .method("summary_record_bytes", [](const databento_jl::DbnSummary& s) -> std::uint64_t {
+      return s.record_bytes;
+    })
+    .method("summary_min_ts_event", [](const databento_jl::DbnSummary& s) -> std::uint64_t {
+      return s.min_ts_event;
+    })
+    .method("summary_max_ts_event", [](const databento_jl::DbnSummary& s) -> std::uint64_t {
+      return s.max_ts_event;
+    })
+    .method("summary_frames", [](const databento_jl::DbnSummary& s) -> std::size_t {
+      return s.frames;
+    })
+    .method("summary_runs", [](const databento_jl::DbnSummary& s) -> std::size_t {
+      return s.runs;
+    })
+    .method("summary_runs_rescanned", [](const databento_jl::DbnSummary& s) -> std::size_t {
+      return s.runs_rescanned;
+    })
+    // The rtypes present and their record counts, in rtype order
+    .method("summary_rtypes", [](const databento_jl::DbnSummary& s) -> std::vector<databento::RType> {
+      std::vector<databento::RType> rtypes;
+      for (std::size_t i = 0; i < s.rtype_counts.size(); ++i) {
+        if (s.rtype_counts[i] > 0) {
+          rtypes.push_back(static_cast<databento::RType>(i));
+        }
+      }
+      return rtypes;
+    })
+    .method("summary_rtype_counts", [](const databento_jl::DbnSummary& s) -> std::vector<std::uint64_t> {
+      std::vector<std::uint64_t> counts;
+      std::copy_if(s.rtype_counts.begin(), s.rtype_counts.end(), std::back_inserter(counts),
+                   [](std::uint64_t n) { return n > 0; });
+      return counts;
+    })
+    .method("summary_publisher_ids", [](const databento_jl::DbnSummary& s) -> std::vector<std::uint16_t> {
+      return s.publisher_ids;
+    })
+    .method("summary_publisher_records", [](const databento_jl::DbnSummary& s) -> std::vector<std::uint64_t> {
+      return s.publisher_records;
+    })
+    .method("summary_instrument_count", [](const databento_jl::DbnSummary& s) -> std::size_t {
+      return s.instruments.size();
+    })
+    // Copies the per-instrument table into Julia columns of at least
+    // summary_instrument_count rows
+    .method("read_instrument_summary!", [](const databento_jl::DbnSummary& s,
+                                           jlcxx::ArrayRef<std::uint32_t> instrument_id,
+                                           jlcxx::ArrayRef<std::uint64_t> records,
+                                           jlcxx::ArrayRef<std::uint64_t> min_ts_event,
+                                           jlcxx::ArrayRef<std::uint64_t> max_ts_event,
+                                           jlcxx::ArrayRef<std::uint64_t> sequenced,
+                                           jlcxx::ArrayRef<std::uint32_t> first_sequence,
+                                           jlcxx::ArrayRef<std::uint32_t> last_sequence,
+                                           jlcxx::ArrayRef<std::uint64_t> sequence_gaps,
+                                           jlcxx::ArrayRef<std::uint64_t> missing_sequences,
+                                           jlcxx::ArrayRef<std::uint64_t> sequence_resets) {
+      check_rows(s.instruments.size(), instrument_id, records, min_ts_event, max_ts_event,
+                 sequenced, first_sequence, last_sequence, sequence_gaps, missing_sequences,
+                 sequence_resets);
+      for (std::size_t i = 0; i < s.instruments.size(); ++i) {
+        const databento_jl::InstrumentSummary& row = s.instruments[i];
+        instrument_id[i] = row.instrument_id;
+        records[i] = row.records;
+        min_ts_event[i] = row.min_ts_event;
+        max_ts_event[i] = row.max_ts_event;
+        sequenced[i] = row.sequenced;
+        first_sequence[i] = row.first_sequence;
+        last_sequence[i] = row.last_sequence;
+        sequence_gaps[i] = row.sequence_gaps;
+        missing_sequences[i] = row.missing_sequences;
+        sequence_resets[i] = row.sequence_resets;
+      }
+    });
+
+  mod.method("summarize_dbn", [](const std::string& path, std::size_t num_threads) {
+    return databento_jl::SummarizeDbn(path, num_threads);
+  });
+
+  // ============================================================================
+  // Live Client with Ring Buffer Handoff
+  // ============================================================================
+
+  // LiveClient - LiveThreaded session feeding a lock-free SPSC ring that Julia
+  // drains with next_record or read_columns!
+  mod.add_type<databento_jl::LiveRingClient>("LiveClient")
+    .constructor([](const std::string& key, const std::string& dataset, const std::string& gateway,
+                    std::uint16_t port, bool send_ts_out, std::size_t capacity, std::size_t slot_bytes,
+                    bool block_when_full) {
+      databento_jl::LiveRingOptions options;
+      options.key = key;
+      options.dataset = dataset;
+      options.gateway = gateway;
+      options.port = port;
+      options.send_ts_out = send_ts_out;
+      options.capacity = capacity;
+      options.slot_bytes = slot_bytes;
+      options.block_when_full = block_when_full;
+      return new databento_jl::LiveRingClient{options};
+    })
+    .method("subscribe!", [](databento_jl::LiveRingClient& client, const std::vector<std::string>& symbols,
+                             databento::Schema schema, databento::SType stype_in) {
+      client.Subscribe(symbols, schema, stype_in);
+    })
+    .method("start!", [](databento_jl::LiveRingClient& client) {
+      client.Start();
+    })
+    .method("stop!", [](databento_jl::LiveRingClient& client) {
+      client.Stop();
+    })
+    .method("next_record", [](databento_jl::LiveRingClient& client) -> const databento::Record* {
+      return client.NextRecord();
+    })
+    .method("has_metadata", [](const databento_jl::LiveRingClient& client) -> bool {
+      return client.HasMetadata();
+    })
+    .method("get_metadata", [](const databento_jl::LiveRingClient& client) -> databento::Metadata {
+      return client.GetMetadata();
+    })
+    .method("is_finished", [](const databento_jl::LiveRingClient& client) -> bool {
+      return client.IsFinished();
+    })
+    .method("last_error", [](const databento_jl::LiveRingClient& client) -> std::string {
+      return client.LastError();
+    })
+    .method("ring_capacity", [](const databento_jl::LiveRingClient& client) -> std::size_t {
+      return client.Capacity();
+    })
+    .method("slot_bytes", [](const databento_jl::LiveRingClient& client) -> std::size_t {
+      return client.SlotBytes();
+    })
+    .method("buffered", [](const databento_jl::LiveRingClient& client) -> std::size_t {
+      return client.Buffered();
+    })
+    .method("records_received", [](const databento_jl::LiveRingClient& client) -> std::uint64_t {
+      return client.RecordsReceived();
+    })
+    .method("records_delivered", [](const databento_jl::LiveRingClient& client) -> std::uint64_t {
+      return client.RecordsDelivered();
+    })
+    .method("overruns", [](const databento_jl::LiveRingClient& client) -> std::uint64_t {
+      return client.Overruns();
+    })
+    .method("oversize_drops", [](const databento_jl::LiveRingClient& client) -> std::uint64_t {
+      return client.OversizeDrops();
+    })
+    .method("backpressure_events", [](const databento_jl::LiveRingClient& client) -> std::uint64_t {
+      return client.BackpressureEvents();
+    })
+    .method("backpressure_ns", [](const databento_jl::LiveRingClient& client) -> std::uint64_t {
+      return client.BackpressureNs();
+    })
+    .method("high_water_mark", [](const databento_jl::LiveRingClient& client) -> std::size_t {
+      return client.HighWaterMark();
+    });
+
+  // ============================================================================
+  // Point-in-Time Symbol Map
+  // ============================================================================
+
+  // TsSymbolMap - (instrument_id, date) -> interned symbol, with dates as days
+  // since the UNIX epoch and symbol IDs starting at 1 (0 when unmapped)
+  mod.add_type<databento_jl::TsSymbolMap>("TsSymbolMap")
+    .constructor<>()
+    // Loads a cache file written by save_symbol_map
+    .constructor([](const std::string& cache_path) {
+      return new databento_jl::TsSymbolMap{databento_jl::TsSymbolMap::Load(cache_path)};
+    })
+    .method("insert_mapping!", [](databento_jl::TsSymbolMap& map, std::uint32_t instrument_id,
+                          std::uint32_t start_date, std::uint32_t end_date, const std::string& symbol) {
+      map.Insert(instrument_id, start_date, end_date, symbol);
+    })
+    .method("insert_metadata!", [](databento_jl::TsSymbolMap& map, const databento::Metadata& metadata) {
+      map.InsertMetadata(metadata);
+    })
+    // Resolves `symbols` to instrument IDs over [start_date, end_date) and
+    // inserts the result, without going through JSON
+    .method("resolve!", [](databento_jl::TsSymbolMap& map, databento::Historical& client,
+                           const std::string& dataset, const std::vector<std::string>& symbols,
+                           databento::SType stype_in, const std::string& start_date,
+                           const std::string& end_date) {
+      map.InsertResolution(client.SymbologyResolve(dataset, symbols, stype_in,
+                                                   databento::SType::InstrumentId,
+                                                   databento::DateRange{start_date, end_date}));
+    })
+    .method("apply!", [](databento_jl::TsSymbolMap& map, const databento::Record& record) -> bool {
+      return map.Apply(record);
+    })
+    .method("find_symbol_id", [](const databento_jl::TsSymbolMap& map, std::uint32_t instrument_id,
+                                 std::uint32_t date) -> std::uint32_t {
+      return map.Find(instrument_id, date);
+    })
+    // Vectorized lookups over an instrument_id column, each on the date of
+    // its timestamp or all on one date. Returns the number of IDs written.
+    .method("find_symbol_ids!", [](const databento_jl::TsSymbolMap& map,
+                                   jlcxx::ArrayRef<std::uint32_t> instrument_ids,
+                                   jlcxx::ArrayRef<std::uint64_t> ts,
+                                   jlcxx::ArrayRef<std::uint32_t> symbol_ids) -> std::size_t {
+      const std::size_t n = min_length(instrument_ids, ts, symbol_ids);
+      map.FindAll(instrument_ids.data(), ts.data(), symbol_ids.data(), n);
+      return n;
+    })
+    .method("find_symbol_ids!", [](const databento_jl::TsSymbolMap& map,
+                                   jlcxx::ArrayRef<std::uint32_t> instrument_ids, std::uint32_t date,
+                                   jlcxx::ArrayRef<std::uint32_t> symbol_ids) -> std::size_t {
+      const std::size_t n = min_length(instrument_ids, symbol_ids);
+      map.FindAll(instrument_ids.data(), date, symbol_ids.data(), n);
+      return n;
+    })
+    .method("symbol", [](const databento_jl::TsSymbolMap& map, std::uint32_t symbol_id) -> std::string {
+      return map.Symbol(symbol_id);
+    })
+    .method("symbol_id", [](const databento_jl::TsSymbolMap& map, const std::string& symbol) -> std::uint32_t {
+      return map.SymbolId(symbol);
+    })
+    .method("symbol_table", [](const databento_jl::TsSymbolMap& map) -> std::vector<std::string> {
+      return map.Symbols();
+    })
+    .method("symbol_count", [](const databento_jl::TsSymbolMap& map) -> std::size_t {
+      return map.SymbolCount();
+    })
+    .method("entry_count", [](const databento_jl::TsSymbolMap& map) -> std::size_t {
+      return map.EntryCount();
+    })
+    .method("interval_count", [](const databento_jl::TsSymbolMap& map) -> std::size_t {
+      return map.Intervals().size();
+    })
+    .method("clear_mappings!", [](databento_jl::TsSymbolMap& map) {
+      map.Clear();
+    })
+    .method("save_symbol_map", [](const databento_jl::TsSymbolMap& map, const std::string& cache_path) {
+      map.Save(cache_path);
+    });
+
+  // ============================================================================
+  // Columnar Instrument Definition Store
+  // ============================================================================
+
+  // DefinitionStore - latest InstrumentDefMsg per instrument as columns, with
+  // string fields as IDs into one interned table (0 for empty). Rows are
+  // 0-based here and -1 when absent.
+  mod.add_type<databento_jl::DefinitionStore>("DefinitionStore")
+    .constructor<>()
+    .method("apply!", [](databento_jl::DefinitionStore& store, const databento::Record& record) -> bool {
+      return store.Apply(record);
+    })
+    .method("apply!", [](databento_jl::DefinitionStore& store, const databento::InstrumentDefMsg& def) {
+      store.Apply(def);
+    })
+    .method("find_row", [](const databento_jl::DefinitionStore& store, std::uint32_t instrument_id) -> std::int64_t {
+      const std::size_t row = store.FindRow(instrument_id);
+      return row == databento_jl::DefinitionStore::kNoRow ? -1 : static_cast<std::int64_t>(row);
+    })
+    .method("find_row", [](const databento_jl::DefinitionStore& store, const std::string& raw_symbol) -> std::int64_t {
+      const std::size_t row = store.FindRowBySymbol(raw_symbol);
+      return row == databento_jl::DefinitionStore::kNoRow ? -1 : static_cast<std::int64_t>(row);
+    })
+    .method("instruments_of", [](const databento_jl::DefinitionStore& store, const std::string& underlying) -> std::vector<std::uint32_t> {
+      return store.InstrumentsOf(underlying);
+    })
+    .method("export_definitions!", [](const databento_jl::DefinitionStore& store, std::size_t first_row,
+                                      jlcxx::ArrayRef<std::uint32_t> instrument_id,
+                                      jlcxx::ArrayRef<std::uint16_t> publisher_id,
+                                      jlcxx::ArrayRef<std::uint64_t> ts_event,
+                                      jlcxx::ArrayRef<std::uint64_t> ts_recv,
+                                      jlcxx::ArrayRef<std::uint32_t> raw_symbol,
+                                      jlcxx::ArrayRef<std::uint32_t> underlying,
+                                      jlcxx::ArrayRef<std::uint32_t> exchange,
+                                      jlcxx::ArrayRef<std::uint32_t> asset,
+                                      jlcxx::ArrayRef<std::uint32_t> cfi,
+                                      jlcxx::ArrayRef<std::uint32_t> security_type,
+                                      jlcxx::ArrayRef<std::uint32_t> currency,
+                                      jlcxx::ArrayRef<std::uint8_t> instrument_class,
+                                      jlcxx::ArrayRef<std::int64_t> strike_price,
+                                      jlcxx::ArrayRef<std::uint64_t> expiration,
+                                      jlcxx::ArrayRef<std::uint64_t> activation,
+                                      jlcxx::ArrayRef<std::int64_t> min_price_increment,
+                                      jlcxx::ArrayRef<std::int64_t> display_factor,
+                                      jlcxx::ArrayRef<std::int64_t> high_limit_price,
+                                      jlcxx::ArrayRef<std::int64_t> low_limit_price,
+                                      jlcxx::ArrayRef<std::int64_t> unit_of_measure_qty,
+                                      jlcxx::ArrayRef<std::int32_t> contract_multiplier,
+                                      jlcxx::ArrayRef<std::uint32_t> underlying_id) -> std::size_t {
+      const databento_jl::DefinitionColumns columns{
+        min_length(instrument_id, publisher_id, ts_event, ts_recv, raw_symbol, underlying, exchange,
+                   asset, cfi, security_type, currency, instrument_class, strike_price, expiration,
+                   activation, min_price_increment, display_factor, high_limit_price, low_limit_price,
+                   unit_of_measure_qty, contract_multiplier, underlying_id),
+        instrument_id.data(), publisher_id.data(), ts_event.data(), ts_recv.data(), raw_symbol.data(),
+        underlying.data(), exchange.data(), asset.data(), cfi.data(), security_type.data(),
+        currency.data(), instrument_class.data(), strike_price.data(), expiration.data(),
+        activation.data(), min_price_increment.data(), display_factor.data(), high_limit_price.data(),
+        low_limit_price.data(), unit_of_measure_qty.data(), contract_multiplier.data(),
+        underlying_id.data()};
+      return store.Export(first_row, columns);
+    })
+    .method("definition_strings", [](const databento_jl::DefinitionStore& store) -> std::vector<std::string> {
+      return store.Strings().Strings();
+    })
+    .method("definition_string", [](const databento_jl::DefinitionStore& store, std::uint32_t string_id) -> std::string {
+      return store.Strings().At(string_id);
+    })
+    .method("row_count", [](const databento_jl::DefinitionStore& store) -> std::size_t {
+      return store.RowCount();
+    })
+    .method("definitions_applied", [](const databento_jl::DefinitionStore& store) -> std::uint64_t {
+      return store.DefinitionsApplied();
+    })
+    .method("replacements", [](const databento_jl::DefinitionStore& store) -> std::uint64_t {
+      return store.Replacements();
+    })
+    .method("deletions", [](const databento_jl::DefinitionStore& store) -> std::uint64_t {
+      return store.Deletions();
+    })
+    .method("clear_definitions!", [](databento_jl::DefinitionStore& store) {
+      store.Clear();
+    });
+
+  // ============================================================================
+  // DBN Writer
+  // ============================================================================
+
+  // DbnWriter - encodes records to a DBN file, compressing independent zstd
+  // frames on a thread pool
+  mod.add_type<databento_jl::DbnWriter>("DbnWriter")
+    .constructor([](const std::string& path, const databento::Metadata& metadata, bool zstd,
+                    int compression_level, std::size_t threads, std::size_t frame_bytes,
+                    std::size_t max_pending_frames) {
+      return new databento_jl::DbnWriter{
+          path, metadata,
+          writer_options(zstd, compression_level, threads, frame_bytes, max_pending_frames)};
+    })
+    .method("write_record!", [](databento_jl::DbnWriter& writer, const databento::Record& record) {
+      writer.Write(record);
+    })
+    // `size` bytes of consecutive records, e.g. a Julia Vector{MboMsg}
+    .method("write_bytes!", [](databento_jl::DbnWriter& writer, const void* data, std::size_t size) {
+      writer.WriteRecords(static_cast<const std::byte*>(data), size);
+    })
+    .method("close_writer!", [](databento_jl::DbnWriter& writer) {
+      writer.Close();
+    })
+    .method("is_open", [](const databento_jl::DbnWriter& writer) -> bool {
+      return writer.IsOpen();
+    })
+    .method("records_written", [](const databento_jl::DbnWriter& writer) -> std::uint64_t {
+      return writer.RecordsWritten();
+    })
+    .method("bytes_encoded", [](const databento_jl::DbnWriter& writer) -> std::uint64_t {
+      return writer.BytesEncoded();
+    })
+    .method("bytes_written", [](const databento_jl::DbnWriter& writer) -> std::uint64_t {
+      return writer.BytesWritten();
+    })
+    .method("frames_written", [](const databento_jl::DbnWriter& writer) -> std::uint64_t {
+      return writer.FramesWritten();
+    })
+    .method("stall_ns", [](const databento_jl::DbnWriter& writer) -> std::uint64_t {
+      return writer.StallNs();
+    });
+
+  // DbnFanOut - one pass over a record stream into a DBN file per group of
+  // instruments, sharing one compression pool
+  mod.add_type<databento_jl::DbnFanOut>("DbnFanOut")
+    .constructor([](const std::vector<std::string>& paths, const databento::Metadata& metadata,
+                    bool zstd, int compression_level, std::size_t threads, std::size_t frame_bytes,
+                    std::size_t max_pending_frames) {
+      return new databento_jl::DbnFanOut{
+          paths, metadata,
+          writer_options(zstd, compression_level, threads, frame_bytes, max_pending_frames)};
+    })
+    // Outputs are 0-based; route! and default_output! in Julia take 1-based
+    // indices
+    .method("add_route!", [](databento_jl::DbnFanOut& fan_out, std::uint32_t instrument_id, std::size_t output) {
+      fan_out.Route(instrument_id, output);
+    })
+    .method("set_default_output!", [](databento_jl::DbnFanOut& fan_out, std::size_t output) {
+      fan_out.SetDefaultOutput(output);
+    })
+    .method("drop_unrouted!", [](databento_jl::DbnFanOut& fan_out) {
+      fan_out.SetDefaultOutput(databento_jl::DbnFanOut::kDrop);
+    })
+    // Returns false if the record was dropped
+    .method("write_record!", [](databento_jl::DbnFanOut& fan_out, const databento::Record& record) -> bool {
+      return fan_out.Write(record);
+    })
+    .method("close_writer!", [](databento_jl::DbnFanOut& fan_out) {
+      fan_out.Close();
+    })
+    .method("output_count", [](const databento_jl::DbnFanOut& fan_out) -> std::size_t {
+      return fan_out.OutputCount();
+    })
+    .method("records_written", [](const databento_jl::DbnFanOut& fan_out) -> std::uint64_t {
+      return fan_out.RecordsWritten();
+    })
+    .method("records_dropped", [](const databento_jl::DbnFanOut& fan_out) -> std::uint64_t {
+      return fan_out.RecordsDropped();
+    })
+    // Records written to one output so far, 0 if it has not been opened
+    .method("output_records_written", [](const databento_jl::DbnFanOut& fan_out, std::size_t output) -> std::uint64_t {
+      const databento_jl::DbnWriter* writer = fan_out.Output(output);
+      return writer == nullptr ? 0 : writer->RecordsWritten();
+    });
+
+  // ============================================================================
+  // Arrow Export
+  // ============================================================================
+
+  // ArrowConverter - turns a record stream of one schema into bounded Arrow
+  // record batches
+  mod.add_type<databento_jl::DbnArrowConverter>("ArrowConverter")
+    .constructor([](databento::Schema schema, std::size_t batch_rows, bool scale_prices) {
+      databento_jl::ArrowConvertOptions options;
+      options.schema = schema;
+      options.batch_rows = batch_rows;
+      options.scale_prices = scale_prices;
+      return new databento_jl::DbnArrowConverter{options};
+    })
+    // Exports the struct type of the batches into the ArrowSchema at `out`
+    .method("export_arrow_schema!", [](const databento_jl::DbnArrowConverter& converter, void* out) {
+      databento_jl::ExportArrowSchema(converter.Fields(), static_cast<ArrowSchema*>(out));
+    })
+    .method("batch_rows", [](const databento_jl::DbnArrowConverter& converter) -> std::size_t {
+      return converter.BatchRows();
+    })
+    .method("rows_converted", [](const databento_jl::DbnArrowConverter& converter) -> std::uint64_t {
+      return converter.RowsConverted();
+    });
+
+  // ============================================================================
+  // Analytics Kernels
+  // ============================================================================
+
+  // Element-wise kernels over read_columns! buffers, writing the first `n`
+  // rows of `out`. AVX2 or scalar is chosen at runtime.
+  mod.method("fill_price_to_float!", [](jlcxx::ArrayRef<double> out, jlcxx::ArrayRef<std::int64_t> price, std::size_t n) {
+    check_rows(n, out, price);
+    databento_jl::ScalePrices(price.data(), n, out.data());
+  });
+  mod.method("fill_mid_prices!", [](jlcxx::ArrayRef<double> out, jlcxx::ArrayRef<std::int64_t> bid_px,
+                                    jlcxx::ArrayRef<std::int64_t> ask_px, std::size_t n) {
+    check_rows(n, out, bid_px, ask_px);
+    databento_jl::MidPrices(bid_px.data(), ask_px.data(), n, out.data());
+  });
+  mod.method("fill_spreads!", [](jlcxx::ArrayRef<double> out, jlcxx::ArrayRef<std::int64_t> bid_px,
+                                 jlcxx::ArrayRef<std::int64_t> ask_px, std::size_t n) {
+    check_rows(n, out, bid_px, ask_px);
+    databento_jl::Spreads(bid_px.data(), ask_px.data(), n, out.data());
+  });
+  mod.method("fill_microprices!", [](jlcxx::ArrayRef<double> out, jlcxx::ArrayRef<std::int64_t> bid_px,
+                                     jlcxx::ArrayRef<std::int64_t> ask_px, jlcxx::ArrayRef<std::uint32_t> bid_sz,
+                                     jlcxx::ArrayRef<std::uint32_t> ask_sz, std::size_t n) {
+    check_rows(n, out, bid_px, ask_px, bid_sz, ask_sz);
+    databento_jl::Microprices(bid_px.data(), ask_px.data(), bid_sz.data(), ask_sz.data(), n, out.data());
+  });
+  mod.method("fill_signed_volumes!", [](jlcxx::ArrayRef<std::int64_t> out, jlcxx::ArrayRef<std::uint32_t> size,
+                                        jlcxx::ArrayRef<std::uint8_t> side, std::size_t n) {
+    check_rows(n, out, size, side);
+    databento_jl::SignedVolumes(size.data(), side.data(), n, out.data());
+  });
+  mod.method("simd_avx2_active", []() -> bool {
+    return databento_jl::ActiveSimdLevel() == databento_jl::SimdLevel::kAvx2;
+  });
+  mod.method("set_simd_enabled!", [](bool enabled) {
+    databento_jl::SetSimdEnabled(enabled);
+  });
+
+  // GroupedAnalytics - per-instrument VWAP, volumes and returns, carried
+  // across chunks
+  mod.add_type<databento_jl::GroupedAnalytics>("GroupedAnalytics")
+    .constructor<>()
+    .method("group_count", [](const databento_jl::GroupedAnalytics& analytics) -> std::size_t {
+      return analytics.GroupCount();
+    })
+    // Group indexes are 0-based here; group_indexes! in Julia adds 1
+    .method("fill_group_indexes!", [](databento_jl::GroupedAnalytics& analytics, jlcxx::ArrayRef<std::uint32_t> out,
+                                      jlcxx::ArrayRef<std::uint32_t> instrument_id, std::size_t n) {
+      check_rows(n, out, instrument_id);
+      analytics.GroupIndexes(instrument_id.data(), n, out.data());
+    })
+    .method("accumulate_trades!", [](databento_jl::GroupedAnalytics& analytics, jlcxx::ArrayRef<std::uint32_t> instrument_id,
+                                     jlcxx::ArrayRef<std::int64_t> price, jlcxx::ArrayRef<std::uint32_t> size,
+                                     jlcxx::ArrayRef<std::uint8_t> side, std::size_t n) {
+      check_rows(n, instrument_id, price, size, side);
+      analytics.AddTrades(instrument_id.data(), price.data(), size.data(), side.data(), n);
+    })
+    // Every buffer needs group_count() elements
+    .method("copy_trade_totals!", [](const databento_jl::GroupedAnalytics& analytics, jlcxx::ArrayRef<std::uint32_t> instrument_id,
+                                     jlcxx::ArrayRef<double> vwap, jlcxx::ArrayRef<std::uint64_t> volume,
+                                     jlcxx::ArrayRef<std::int64_t> signed_volume, jlcxx::ArrayRef<std::uint64_t> trades) {
+      check_rows(analytics.GroupCount(), instrument_id, vwap, volume, signed_volume, trades);
+      analytics.TradeTotals(instrument_id.data(), vwap.data(), volume.data(), signed_volume.data(), trades.data());
+    })
+    .method("fill_returns!", [](databento_jl::GroupedAnalytics& analytics, jlcxx::ArrayRef<double> out,
+                                jlcxx::ArrayRef<std::uint32_t> instrument_id, jlcxx::ArrayRef<double> value, std::size_t n) {
+      check_rows(n, out, instrument_id, value);
+      analytics.Returns(instrument_id.data(), value.data(), n, out.data());
+    })
+    .method("clear_groups!", [](databento_jl::GroupedAnalytics& analytics) {
+      analytics.Clear();
+    });
+
+  // ============================================================================
+  // Synthetic DBN Data
+  // ============================================================================
+
+  // Writes a deterministic DBN file for benchmarks and tests. Returns the
+  // number of bytes written.
+  mod.method("write_synthetic_dbn", [](const std::string& path, databento::Schema schema,
+                                       std::uint32_t instrument_count, std::uint64_t record_count,
+                                       bool zstd, std::uint64_t seed, const std::string& dataset,
+                                       std::uint64_t start_ts, std::uint64_t frame_size,
+                                       const std::string& parent,
+                                       databento::SType stype_out) -> std::uint64_t {
+    databento_jl::SyntheticDbnOptions options;
+    options.schema = schema;
+    options.instrument_count = instrument_count;
+    options.record_count = record_count;
+    options.zstd = zstd;
+    options.seed = seed;
+    options.dataset = dataset;
+    options.start_ts = start_ts;
+    options.frame_size = frame_size;
+    options.parent = parent;
+    options.stype_out = stype_out;
+    return databento_jl::WriteSyntheticDbn(path, options);
+  });
+
+  // ============================================================================
+  // Record Source Methods
+  // ============================================================================
+
+  // read_<schema>_columns!, consume! (books and bars) and filtered next_record
+  // for every record source
+  add_record_source_methods<databento::DbnFileStore>(mod);
+  add_record_source_methods<databento_jl::MmapDbnReader>(mod);
+  add_record_source_methods<databento_jl::MultiDbnReader>(mod);
+  add_record_source_methods<databento_jl::PrefetchDbnFileStore>(mod);
+  add_record_source_methods<databento_jl::ProfiledDbnFileStore>(mod);
+  add_record_source_methods<databento_jl::IndexedDbnReader>(mod);
+  add_record_source_methods<databento_jl::CachedDbnReader>(mod);
+  // The live ring is momentarily empty whenever Julia drains it faster than
+  // the gateway sends, so it only gets the methods meant to be polled
+  add_record_poll_methods<databento_jl::LiveRingClient>(mod);
+  add_record_source_methods<databento_jl::HistoricalStream>(mod);
+
 }
@@ -0,0 +1,167 @@
+// Throughput of the C++ decode paths over synthetic DBN files, without Julia.
+//
+// Usage: databento_jl_bench [record_count] [instrument_count] [work_dir]
+//
+// Each path reads an MBO file of `record_count` records end to end and
+// reports records per second and nanoseconds per record. A checksum over the
+// records read is printed so no loop can be optimized away. The Julia
+// harness in benchmark/run.jl measures the same paths through the bindings.
+
+#include <databento/dbn_file_store.hpp>
+#include <databento/record.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include "columnar.hpp"
+#include "mmap_reader.hpp"
+#include "order_book.hpp"
+#include "prefetch_reader.hpp"
+#include "record_filter.hpp"
+#include "synthetic_dbn.hpp"
+
+namespace {
+using databento_jl::SyntheticDbnOptions;
+
+struct Result {
+  std::uint64_t records;
+  std::uint64_t checksum;
+};
+
+template <typename Source>
+Result Drain(Source& source) {
+  Result result{};
+  while (const databento::Record* record = source.NextRecord()) {
+    ++result.records;
+    result.checksum += record->Header().instrument_id;
+  }
+  return result;
+}
+
+template <typename F>
+void Measure(const char* name, F&& run) {
+  const auto start = std::chrono::steady_clock::now();
+  const Result result = run();
+  const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+  const double seconds = elapsed.count();
+  const double n = static_cast<double>(result.records);
+  std::printf("%-28s %12llu %14.0f %10.2f %20llu\n", name,
+              static_cast<unsigned long long>(result.records), n / seconds, seconds * 1e9 / n,
+              static_cast<unsigned long long>(result.checksum));
+}
+
+// MboColumns backed by vectors, refilled chunk by chunk
+struct MboBuffers {
+  explicit MboBuffers(std::size_t n)
+      : ts_event(n), instrument_id(n), publisher_id(n), ts_recv(n), order_id(n), price(n),
+        size(n), flags(n), channel_id(n), action(n), side(n), ts_in_delta(n), sequence(n) {}
+
+  databento_jl::MboColumns Columns() {
+    return {ts_event.size(), ts_event.data(),    instrument_id.data(), publisher_id.data(),
+            ts_recv.data(),  order_id.data(),    price.data(),         size.data(),
+            flags.data(),    channel_id.data(),  action.data(),        side.data(),
+            ts_in_delta.data(), sequence.data()};
+  }
+
+  std::vector<std::uint64_t> ts_event;
+  std::vector<std::uint32_t> instrument_id;
+  std::vector<std::uint16_t> publisher_id;
+  std::vector<std::uint64_t> ts_recv;
+  std::vector<std::uint64_t> order_id;
+  std::vector<std::int64_t> price;
+  std::vector<std::uint32_t> size;
+  std::vector<std::uint8_t> flags;
+  std::vector<std::uint8_t> channel_id;
+  std::vector<std::uint8_t> action;
+  std::vector<std::uint8_t> side;
+  std::vector<std::int32_t> ts_in_delta;
+  std::vector<std::uint32_t> sequence;
+};
+
+template <typename Source>
+Result DrainColumns(Source& source, MboBuffers& buffers) {
+  Result result{};
+  const databento_jl::MboColumns columns = buffers.Columns();
+  while (std::size_t n = databento_jl::DecodeColumns(source, columns)) {
+    result.records += n;
+    for (std::size_t i = 0; i < n; ++i) {
+      result.checksum += columns.instrument_id[i];
+    }
+  }
+  return result;
+}
+
+void Run(std::uint64_t record_count, std::uint32_t instrument_count, const std::string& dir) {
+  SyntheticDbnOptions options;
+  options.instrument_count = instrument_count;
+  options.record_count = record_count;
+  const std::string raw_path = dir + "/bench_mbo.dbn";
+  const std::string zstd_path = dir + "/bench_mbo.dbn.zst";
+  databento_jl::WriteSyntheticDbn(raw_path, options);
+  options.zstd = true;
+  databento_jl::WriteSyntheticDbn(zstd_path, options);
+
+  std::printf("%-28s %12s %14s %10s %20s\n", "path", "records", "records/s", "ns/record",
+              "checksum");
+  Measure("DbnFileStore", [&] {
+    databento::DbnFileStore store{raw_path};
+    return Drain(store);
+  });
+  Measure("DbnFileStore (zstd)", [&] {
+    databento::DbnFileStore store{zstd_path};
+    return Drain(store);
+  });
+  Measure("MmapDbnReader", [&] {
+    databento_jl::MmapDbnReader reader{raw_path};
+    return Drain(reader);
+  });
+  Measure("PrefetchDbnFileStore (zstd)", [&] {
+    databento_jl::PrefetchDbnFileStore store{zstd_path, 4, 1 << 20};
+    return Drain(store);
+  });
+  MboBuffers buffers{65'536};
+  Measure("DecodeColumns", [&] {
+    databento::DbnFileStore store{raw_path};
+    return DrainColumns(store, buffers);
+  });
+  Measure("DecodeColumns (mmap)", [&] {
+    databento_jl::MmapDbnReader reader{raw_path};
+    return DrainColumns(reader, buffers);
+  });
+  Measure("FilteredSource (1 instr.)", [&] {
+    databento_jl::MmapDbnReader reader{raw_path};
+    databento_jl::RecordFilter filter;
+    filter.AddInstrumentId(1);
+    databento_jl::FilteredSource<databento_jl::MmapDbnReader> filtered{reader, filter};
+    Result result = Drain(filtered);
+    // Rate over the records scanned, not the few that matched
+    result.records = filter.RecordsScanned();
+    return result;
+  });
+  Measure("OrderBookEngine::Consume", [&] {
+    databento_jl::MmapDbnReader reader{raw_path};
+    databento_jl::OrderBookEngine engine;
+    const std::uint64_t n = engine.Consume(reader, SIZE_MAX);
+    return Result{n, engine.BookCount()};
+  });
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const std::uint64_t record_count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+  const auto instrument_count =
+      static_cast<std::uint32_t>(argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 16);
+  const std::string dir = argc > 3 ? argv[3] : ".";
+  try {
+    Run(record_count, instrument_count, dir);
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "databento_jl_bench: %s\n", e.what());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,425 @@
+#include "dbn_catalog.hpp"
+
+#include <databento/constants.hpp>
+#include <databento/dbn.hpp>
+#include <databento/dbn_file_store.hpp>
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include "output_file.hpp"
+
+namespace databento_jl {
+
+namespace {
+constexpr char kManifestMagic[8] = {'D', 'B', 'N', 'C', 'A', 'T', 'L', 'G'};
+constexpr std::uint32_t kManifestVersion = 1;
+constexpr std::uint16_t kFlagMixedSchema = 1;
+// Manifest bytes of an entry with an empty path and no symbols: path length,
+// size, mtime, dataset, schema, flags, start, end and symbol count
+constexpr std::uint64_t kMinEntryBytes = 4 + 8 + 8 + 4 + 2 + 2 + 8 + 8 + 4;
+
+bool IsDbnFile(std::string_view name) {
+  const auto ends_with = [name](std::string_view suffix) {
+    return name.size() > suffix.size() &&
+           name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+  };
+  return ends_with(".dbn") || ends_with(".dbn.zst");
+}
+
+void WriteString(OutputFile& out, const std::string& text) {
+  out.WritePod(static_cast<std::uint32_t>(text.size()));
+  out.Write(text.data(), text.size());
+}
+
+template <typename T>
+void ReadPod(std::ifstream& in, T& value, const std::string& path) {
+  if (!in.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+    throw std::runtime_error{path + " is a truncated catalog manifest"};
+  }
+}
+
+std::uint64_t Remaining(std::ifstream& in, std::uint64_t file_size) {
+  return file_size - static_cast<std::uint64_t>(in.tellg());
+}
+
+std::string ReadString(std::ifstream& in, const std::string& path, std::uint64_t file_size) {
+  std::uint32_t size;
+  ReadPod(in, size, path);
+  if (size > Remaining(in, file_size)) {
+    throw std::runtime_error{path + " is a truncated catalog manifest: a string of " +
+                             std::to_string(size) + " bytes with " +
+                             std::to_string(Remaining(in, file_size)) + " left"};
+  }
+  std::string text(size, '\0');
+  if (!in.read(text.data(), size)) {
+    throw std::runtime_error{path + " is a truncated catalog manifest"};
+  }
+  return text;
+}
+
+// A file found by the directory walk whose header needs decoding
+struct StaleFile {
+  std::string path;
+  std::uint64_t size;
+  std::int64_t mtime_ns;
+  bool replaces_entry;
+};
+
+// Decodes the metadata of every file on `num_threads` threads. Files that
+// fail to decode are left empty.
+std::vector<std::optional<databento::Metadata>> DecodeHeaders(
+    const std::string& root, const std::vector<StaleFile>& files, std::size_t num_threads) {
+  std::vector<std::optional<databento::Metadata>> headers(files.size());
+  if (num_threads == 0) {
+    num_threads = std::max(1U, std::thread::hardware_concurrency());
+  }
+  num_threads = std::min(num_threads, files.size());
+  std::atomic<std::size_t> next{0};
+  const auto work = [&] {
+    for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < files.size();) {
+      try {
+        databento::DbnFileStore store{
+            (std::filesystem::path{root} / files[i].path).string()};
+        headers[i] = store.GetMetadata();
+      } catch (const std::exception&) {
+        // Reported through CatalogRefresh::failed
+      }
+    }
+  };
+  std::vector<std::thread> workers;
+  workers.reserve(num_threads);
+  for (std::size_t t = 0; t < num_threads; ++t) {
+    workers.emplace_back(work);
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  return headers;
+}
+}  // namespace
+
+DbnCatalog::DbnCatalog(std::string root, std::string manifest_path)
+    : root_{std::move(root)}, manifest_path_{std::move(manifest_path)} {
+  if (std::filesystem::exists(manifest_path_)) {
+    Load();
+  }
+}
+
+const CatalogEntry& DbnCatalog::Entry(std::size_t i) const {
+  if (i >= entries_.size()) {
+    throw std::out_of_range{"Catalog entry " + std::to_string(i) + " out of range for " +
+                            std::to_string(entries_.size()) + " files"};
+  }
+  return entries_[i];
+}
+
+std::string DbnCatalog::FullPath(std::size_t i) const {
+  return (std::filesystem::path{root_} / Entry(i).path).string();
+}
+
+const CatalogRefresh& DbnCatalog::Refresh(std::size_t num_threads) {
+  last_refresh_ = CatalogRefresh{};
+  std::unordered_map<std::string_view, std::size_t> known;
+  known.reserve(entries_.size());
+  for (std::size_t i = 0; i < entries_.size(); ++i) {
+    known.emplace(entries_[i].path, i);
+  }
+  std::vector<bool> seen(entries_.size());
+  std::vector<StaleFile> stale;
+
+  const std::filesystem::path root{root_};
+  auto it = std::filesystem::recursive_directory_iterator{
+      root, std::filesystem::directory_options::skip_permission_denied};
+  for (const std::filesystem::directory_entry& file : it) {
+    if (!file.is_regular_file() || !IsDbnFile(file.path().filename().string())) {
+      continue;
+    }
+    struct stat st {};
+    if (::stat(file.path().c_str(), &st) != 0) {
+      // Removed since it was listed
+      continue;
+    }
+    ++last_refresh_.scanned;
+    std::string path = file.path().lexically_relative(root).generic_string();
+    const std::uint64_t size = static_cast<std::uint64_t>(st.st_size);
+    const std::int64_t mtime_ns =
+        static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1'000'000'000 + st.st_mtim.tv_nsec;
+    const auto entry = known.find(path);
+    if (entry != known.end()) {
+      seen[entry->second] = true;
+      const CatalogEntry& current = entries_[entry->second];
+      if (current.size == size && current.mtime_ns == mtime_ns) {
+        continue;
+      }
+    }
+    stale.push_back(StaleFile{std::move(path), size, mtime_ns, entry != known.end()});
+  }
+
+  const auto headers = DecodeHeaders(root_, stale, num_threads);
+
+  // Keep the unchanged entries, then add the decoded ones
+  std::vector<CatalogEntry> entries;
+  entries.reserve(entries_.size() + stale.size());
+  std::unordered_map<std::string_view, bool> replaced;
+  for (const StaleFile& file : stale) {
+    if (file.replaces_entry) {
+      replaced.emplace(file.path, true);
+    }
+  }
+  for (std::size_t i = 0; i < entries_.size(); ++i) {
+    if (!seen[i]) {
+      ++last_refresh_.removed;
+    } else if (replaced.count(entries_[i].path) == 0) {
+      entries.push_back(std::move(entries_[i]));
+    }
+  }
+  // Strings of dropped entries would linger in the pool, so re-intern
+  // everything that is kept into a fresh one
+  StringPool strings;
+  const auto reintern = [&](std::uint32_t id) { return strings.Intern(strings_.At(id)); };
+  for (CatalogEntry& entry : entries) {
+    entry.dataset = reintern(entry.dataset);
+    for (std::uint32_t& symbol : entry.symbols) {
+      symbol = reintern(symbol);
+    }
+    std::sort(entry.symbols.begin(), entry.symbols.end());
+  }
+  for (std::size_t i = 0; i < stale.size(); ++i) {
+    if (!headers[i]) {
+      last_refresh_.failed.push_back(stale[i].path);
+      if (stale[i].replaces_entry) {
+        ++last_refresh_.removed;
+      }
+      continue;
+    }
+    const databento::Metadata& metadata = *headers[i];
+    CatalogEntry& entry = entries.emplace_back();
+    entry.path = std::move(stale[i].path);
+    entry.size = stale[i].size;
+    entry.mtime_ns = stale[i].mtime_ns;
+    entry.dataset = strings.Intern(metadata.dataset);
+    entry.mixed_schema = metadata.has_mixed_schema;
+    entry.schema = metadata.schema;
+    entry.start = static_cast<std::uint64_t>(metadata.start.time_since_epoch().count());
+    entry.end = static_cast<std::uint64_t>(metadata.end.time_since_epoch().count());
+    if (entry.end <= entry.start) {
+      entry.end = databento::kUndefTimestamp;
+    }
+    // The mappings resolve the requested symbols to stype_out symbols, so
+    // only raw symbol output names what the records are. A parent or
+    // continuous request resolved to anything else can hold any raw symbol.
+    const bool resolves_to_raw = metadata.stype_out == databento::SType::RawSymbol;
+    const bool all_symbols =
+        metadata.symbols.empty() ||
+        std::find(metadata.symbols.begin(), metadata.symbols.end(), databento::kAllSymbols) !=
+            metadata.symbols.end() ||
+        (metadata.stype_in != databento::SType::RawSymbol && !resolves_to_raw);
+    if (!all_symbols) {
+      for (const std::string& symbol : metadata.symbols) {
+        entry.symbols.push_back(strings.Intern(symbol));
+      }
+      if (resolves_to_raw) {
+        for (const databento::SymbolMapping& mapping : metadata.mappings) {
+          for (const databento::MappingInterval& interval : mapping.intervals) {
+            entry.symbols.push_back(strings.Intern(interval.symbol));
+          }
+        }
+      }
+      std::sort(entry.symbols.begin(), entry.symbols.end());
+      entry.symbols.erase(std::unique(entry.symbols.begin(), entry.symbols.end()),
+                          entry.symbols.end());
+    }
+    if (stale[i].replaces_entry) {
+      ++last_refresh_.updated;
+    } else {
+      ++last_refresh_.added;
+    }
+  }
+
+  entries_ = std::move(entries);
+  strings_ = std::move(strings);
+  Reindex();
+  if (last_refresh_.added + last_refresh_.updated + last_refresh_.removed > 0 ||
+      !std::filesystem::exists(manifest_path_)) {
+    Save();
+  }
+  return last_refresh_;
+}
+
+std::vector<std::size_t> DbnCatalog::Plan(const CatalogQuery& query) const {
+  std::vector<std::size_t> plan;
+  std::uint32_t dataset = StringPool::kEmpty;
+  if (!query.dataset.empty()) {
+    dataset = strings_.Find(query.dataset);
+    if (dataset == StringPool::kEmpty) {
+      return plan;
+    }
+  }
+  std::vector<std::uint32_t> symbols;
+  for (const std::string& symbol : query.symbols) {
+    // Unknown symbols can only be in files of all symbols
+    const std::uint32_t id = strings_.Find(symbol);
+    if (id != StringPool::kEmpty) {
+      symbols.push_back(id);
+    }
+  }
+  if (query.start >= query.end) {
+    return plan;
+  }
+  // First entry that can end after query.start
+  std::size_t i = static_cast<std::size_t>(
+      std::upper_bound(max_end_prefix_.begin(), max_end_prefix_.end(), query.start) -
+      max_end_prefix_.begin());
+  for (; i < entries_.size() && entries_[i].start < query.end; ++i) {
+    const CatalogEntry& entry = entries_[i];
+    if (entry.end <= query.start ||
+        (dataset != StringPool::kEmpty && entry.dataset != dataset) ||
+        (query.schema && !entry.mixed_schema && entry.schema != *query.schema) ||
+        (!query.symbols.empty() && !MatchesSymbols(entry, symbols))) {
+      continue;
+    }
+    plan.push_back(i);
+  }
+  return plan;
+}
+
+bool DbnCatalog::MatchesSymbols(const CatalogEntry& entry,
+                                const std::vector<std::uint32_t>& symbols) const {
+  if (entry.symbols.empty()) {
+    return true;
+  }
+  return std::any_of(symbols.begin(), symbols.end(), [&entry](std::uint32_t symbol) {
+    return std::binary_search(entry.symbols.begin(), entry.symbols.end(), symbol);
+  });
+}
+
+void DbnCatalog::Reindex() {
+  std::sort(entries_.begin(), entries_.end(),
+            [](const CatalogEntry& a, const CatalogEntry& b) {
+              return a.start != b.start ? a.start < b.start : a.path < b.path;
+            });
+  max_end_prefix_.resize(entries_.size());
+  std::uint64_t running = 0;
+  for (std::size_t i = 0; i < entries_.size(); ++i) {
+    running = std::max(running, entries_[i].end);
+    max_end_prefix_[i] = running;
+  }
+}
+
+void DbnCatalog::Save() const {
+  OutputFile out{manifest_path_};
+  out.Write(kManifestMagic, sizeof(kManifestMagic));
+  out.WritePod(kManifestVersion);
+  out.WritePod(std::uint32_t{0});
+  out.WritePod(static_cast<std::uint64_t>(strings_.Size()));
+  for (std::uint32_t id = 1; id <= strings_.Size(); ++id) {
+    WriteString(out, strings_.At(id));
+  }
+  out.WritePod(static_cast<std::uint64_t>(entries_.size()));
+  for (const CatalogEntry& entry : entries_) {
+    WriteString(out, entry.path);
+    out.WritePod(entry.size);
+    out.WritePod(entry.mtime_ns);
+    out.WritePod(entry.dataset);
+    out.WritePod(static_cast<std::uint16_t>(entry.schema));
+    out.WritePod(entry.mixed_schema ? kFlagMixedSchema : std::uint16_t{0});
+    out.WritePod(entry.start);
+    out.WritePod(entry.end);
+    out.WritePod(static_cast<std::uint32_t>(entry.symbols.size()));
+    out.Write(entry.symbols.data(), entry.symbols.size() * sizeof(std::uint32_t));
+  }
+  out.Commit();
+}
+
+void DbnCatalog::Load() {
+  std::ifstream in{manifest_path_, std::ios::binary | std::ios::ate};
+  if (!in) {
+    throw std::runtime_error{"Failed to open catalog manifest " + manifest_path_};
+  }
+  const auto file_size = static_cast<std::uint64_t>(in.tellg());
+  in.seekg(0);
+  // Counts and lengths come from the file, so each is checked against the
+  // bytes left before anything is allocated for it
+  const auto remaining = [&in, file_size] { return Remaining(in, file_size); };
+  char magic[sizeof(kManifestMagic)];
+  if (!in.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, kManifestMagic, sizeof(magic)) != 0) {
+    throw std::runtime_error{manifest_path_ + " is not a DBN catalog manifest"};
+  }
+  std::uint32_t version;
+  std::uint32_t reserved;
+  ReadPod(in, version, manifest_path_);
+  if (version != kManifestVersion) {
+    // Written by another version; the next refresh rebuilds it
+    return;
+  }
+  ReadPod(in, reserved, manifest_path_);
+  std::uint64_t string_count;
+  ReadPod(in, string_count, manifest_path_);
+  if (string_count > remaining() / sizeof(std::uint32_t)) {
+    throw std::runtime_error{manifest_path_ + " is a truncated catalog manifest: it lists " +
+                             std::to_string(string_count) + " strings in " +
+                             std::to_string(remaining()) + " bytes"};
+  }
+  for (std::uint64_t i = 0; i < string_count; ++i) {
+    strings_.Intern(ReadString(in, manifest_path_, file_size));
+  }
+  const auto check_id = [this](std::uint32_t id) {
+    if (id > strings_.Size()) {
+      throw std::runtime_error{manifest_path_ + " is a corrupt catalog manifest"};
+    }
+  };
+  std::uint64_t entry_count;
+  ReadPod(in, entry_count, manifest_path_);
+  if (entry_count > remaining() / kMinEntryBytes) {
+    throw std::runtime_error{manifest_path_ + " is a truncated catalog manifest: it lists " +
+                             std::to_string(entry_count) + " files in " +
+                             std::to_string(remaining()) + " bytes"};
+  }
+  entries_.resize(static_cast<std::size_t>(entry_count));
+  for (CatalogEntry& entry : entries_) {
+    std::uint16_t schema;
+    std::uint16_t flags;
+    std::uint32_t symbol_count;
+    entry.path = ReadString(in, manifest_path_, file_size);
+    ReadPod(in, entry.size, manifest_path_);
+    ReadPod(in, entry.mtime_ns, manifest_path_);
+    ReadPod(in, entry.dataset, manifest_path_);
+    ReadPod(in, schema, manifest_path_);
+    ReadPod(in, flags, manifest_path_);
+    ReadPod(in, entry.start, manifest_path_);
+    ReadPod(in, entry.end, manifest_path_);
+    ReadPod(in, symbol_count, manifest_path_);
+    check_id(entry.dataset);
+    entry.schema = static_cast<databento::Schema>(schema);
+    entry.mixed_schema = (flags & kFlagMixedSchema) != 0;
+    if (symbol_count > remaining() / sizeof(std::uint32_t)) {
+      throw std::runtime_error{manifest_path_ + " is a truncated catalog manifest: " +
+                               entry.path + " lists " + std::to_string(symbol_count) +
+                               " symbols with " + std::to_string(remaining()) + " bytes left"};
+    }
+    entry.symbols.resize(symbol_count);
+    if (!in.read(reinterpret_cast<char*>(entry.symbols.data()),
+                 static_cast<std::streamsize>(symbol_count * sizeof(std::uint32_t)))) {
+      throw std::runtime_error{manifest_path_ + " is a truncated catalog manifest"};
+    }
+    for (const std::uint32_t symbol : entry.symbols) {
+      check_id(symbol);
+    }
+  }
+  Reindex();
+}
+
+}  // namespace databento_jl
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <databento/enums.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "string_pool.hpp"
+
+namespace databento_jl {
+
+// What the catalog knows about one DBN file, from its metadata header
+struct CatalogEntry {
+  // Relative to the catalog root, '/'-separated
+  std::string path;
+  std::uint64_t size{};
+  std::int64_t mtime_ns{};
+  // Pool ID of the dataset
+  std::uint32_t dataset{};
+  bool mixed_schema{};
+  databento::Schema schema{};
+  // Requested time range [start, end) of the file's records. An open-ended
+  // file (live data, or no end in its metadata) has end kUndefTimestamp.
+  std::uint64_t start{};
+  std::uint64_t end{};
+  // Sorted pool IDs of the requested symbols and, when they were resolved to
+  // raw symbols, of those too. Empty when the file can hold any symbol: all
+  // symbols were requested, or non-raw symbols (e.g. parent or continuous)
+  // were resolved to something other than raw symbols.
+  std::vector<std::uint32_t> symbols;
+};
+
+// Files to scan; empty fields and the default range match everything
+struct CatalogQuery {
+  std::string dataset;
+  std::optional<databento::Schema> schema;
+  std::vector<std::string> symbols;
+  std::uint64_t start{};
+  std::uint64_t end{std::numeric_limits<std::uint64_t>::max()};
+};
+
+// Outcome of the last DbnCatalog::Refresh
+struct CatalogRefresh {
+  std::size_t scanned{};
+  std::size_t added{};
+  std::size_t updated{};
+  std::size_t removed{};
+  // Paths whose header could not be decoded; they are left out of the
+  // catalog and retried by the next refresh
+  std::vector<std::string> failed;
+};
+
+// Catalog of the .dbn and .dbn.zst files under a directory tree, so queries
+// over a large partitioned archive are planned without opening any file.
+//
+// Refresh walks the tree, stats every file and decodes the metadata header
+// only of files that are new or whose size or modification time changed,
+// on a pool of threads, then saves the manifest: a compact binary file in
+// which dataset and symbol strings are stored once. A later catalog over the
+// same root loads the manifest and refreshes incrementally.
+//
+// Entries are kept sorted by start time with a running maximum of their
+// ends, like the blocks of a TsIndex, so Plan binary-searches to the first
+// file that can overlap the query's range and stops at the first that
+// starts after it; only those files are matched on dataset, schema and
+// symbols. Planning is conservative: mixed-schema files match any schema
+// and files of all symbols match any symbols.
+class DbnCatalog {
+ public:
+  // Loads the manifest at `manifest_path` if it exists. Throws if it is not
+  // a catalog manifest or is truncated; one of another manifest version is
+  // ignored and rebuilt by the next refresh.
+  DbnCatalog(std::string root, std::string manifest_path);
+
+  // Brings the catalog up to date with the tree, decoding headers on
+  // `num_threads` threads (0 for one per core), and saves the manifest if
+  // anything changed
+  const CatalogRefresh& Refresh(std::size_t num_threads);
+  const CatalogRefresh& LastRefresh() const { return last_refresh_; }
+  void Save() const;
+
+  // Numbers of the entries matching `query`, in start time order
+  std::vector<std::size_t> Plan(const CatalogQuery& query) const;
+
+  std::size_t Size() const { return entries_.size(); }
+  // Throws std::out_of_range for a bad entry number
+  const CatalogEntry& Entry(std::size_t i) const;
+  std::string FullPath(std::size_t i) const;
+  const StringPool& Strings() const { return strings_; }
+  const std::string& Root() const { return root_; }
+  const std::string& ManifestPath() const { return manifest_path_; }
+
+ private:
+  void Load();
+  // Sorts the entries and rebuilds max_end_prefix_
+  void Reindex();
+  bool MatchesSymbols(const CatalogEntry& entry,
+                      const std::vector<std::uint32_t>& symbols) const;
+
+  const std::string root_;
+  const std::string manifest_path_;
+  StringPool strings_;
+  std::vector<CatalogEntry> entries_;
+  std::vector<std::uint64_t> max_end_prefix_;
+  CatalogRefresh last_refresh_;
+};
+
+}  // namespace databento_jl
@@ -0,0 +1,482 @@
+#include "dbn_summary.hpp"
+
+#include <databento/constants.hpp>
+#include <databento/dbn_decoder.hpp>
+#include <databento/record.hpp>
+
+#include <zstd.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include "flat_hash_map.hpp"
+
+namespace databento_jl {
+
+namespace {
+// "DBN" + version byte followed by the little-endian metadata length
+constexpr std::size_t kPreludeSize = 8;
+constexpr std::uint32_t kZstdMagic = 0xFD2FB528;
+// Bytes read of each record: the header and any sequence field
+constexpr std::size_t kPrefixSize = 64;
+
+template <typename Msg>
+constexpr std::size_t SequenceEnd() {
+  return offsetof(Msg, sequence) + sizeof(std::uint32_t);
+}
+static_assert(SequenceEnd<databento::MboMsg>() <= kPrefixSize &&
+                  SequenceEnd<databento::TradeMsg>() <= kPrefixSize &&
+                  SequenceEnd<databento::Mbp1Msg>() <= kPrefixSize &&
+                  SequenceEnd<databento::Mbp10Msg>() <= kPrefixSize &&
+                  SequenceEnd<databento::BboMsg>() <= kPrefixSize &&
+                  SequenceEnd<databento::StatMsg>() <= kPrefixSize,
+              "Sequence fields must lie within the prefix read of a record");
+
+// Offset of the sequence field in a record of `length` bytes, or 0 when the
+// record is not a Msg. Another length means another DBN version, whose
+// layout may differ, so it counts as having none.
+template <typename Msg>
+std::size_t SequenceOffset(std::size_t length) {
+  return length == sizeof(Msg) ? offsetof(Msg, sequence) : 0;
+}
+
+std::size_t SequenceOffset(databento::RType rtype, std::size_t length) {
+  switch (rtype) {
+    case databento::RType::Mbo:
+      return SequenceOffset<databento::MboMsg>(length);
+    case databento::RType::Mbp0:
+      return SequenceOffset<databento::TradeMsg>(length);
+    case databento::RType::Mbp1:
+      return SequenceOffset<databento::Mbp1Msg>(length);
+    case databento::RType::Mbp10:
+      return SequenceOffset<databento::Mbp10Msg>(length);
+    case databento::RType::Bbo1S:
+    case databento::RType::Bbo1M:
+      return SequenceOffset<databento::BboMsg>(length);
+    case databento::RType::Statistics:
+      return SequenceOffset<databento::StatMsg>(length);
+    default:
+      return 0;
+  }
+}
+
+struct InstrumentCounts {
+  std::uint64_t records{};
+  std::uint64_t min_ts_event{std::numeric_limits<std::uint64_t>::max()};
+  std::uint64_t max_ts_event{};
+  std::uint64_t sequenced{};
+  std::uint32_t first_sequence{};
+  std::uint32_t last_sequence{};
+  std::uint64_t gaps{};
+  std::uint64_t missing{};
+  std::uint64_t resets{};
+};
+
+void AddSequence(InstrumentCounts& counts, std::uint32_t sequence) {
+  if (counts.sequenced++ == 0) {
+    counts.first_sequence = sequence;
+  } else if (sequence > std::uint64_t{counts.last_sequence} + 1) {
+    ++counts.gaps;
+    counts.missing += sequence - counts.last_sequence - 1;
+  } else if (sequence < counts.last_sequence) {
+    ++counts.resets;
+  }
+  counts.last_sequence = sequence;
+}
+
+// The histograms of one run of records
+class SummaryTables {
+ public:
+  void Add(const std::byte* record, std::size_t length) {
+    databento::RecordHeader hd;
+    std::memcpy(&hd, record, sizeof(hd));
+    ++record_count_;
+    record_bytes_ += length;
+    ++rtype_counts_[static_cast<std::uint8_t>(hd.rtype)];
+    ++publishers_[hd.publisher_id];
+    InstrumentCounts& counts = instruments_[hd.instrument_id];
+    ++counts.records;
+    const std::uint64_t ts_event = hd.ts_event.time_since_epoch().count();
+    if (ts_event != databento::kUndefTimestamp) {
+      counts.min_ts_event = std::min(counts.min_ts_event, ts_event);
+      counts.max_ts_event = std::max(counts.max_ts_event, ts_event);
+      min_ts_event_ = std::min(min_ts_event_, ts_event);
+      max_ts_event_ = std::max(max_ts_event_, ts_event);
+    }
+    if (const std::size_t offset = SequenceOffset(hd.rtype, length)) {
+      std::uint32_t sequence;
+      std::memcpy(&sequence, record + offset, sizeof(sequence));
+      AddSequence(counts, sequence);
+    }
+  }
+
+  // Merges the tables of the run that follows this one in the file
+  void Append(const SummaryTables& later) {
+    record_count_ += later.record_count_;
+    record_bytes_ += later.record_bytes_;
+    min_ts_event_ = std::min(min_ts_event_, later.min_ts_event_);
+    max_ts_event_ = std::max(max_ts_event_, later.max_ts_event_);
+    for (std::size_t i = 0; i < rtype_counts_.size(); ++i) {
+      rtype_counts_[i] += later.rtype_counts_[i];
+    }
+    later.publishers_.ForEach([this](std::uint16_t id, std::uint64_t n) { publishers_[id] += n; });
+    later.instruments_.ForEach([this](std::uint32_t id, const InstrumentCounts& next) {
+      InstrumentCounts& counts = instruments_[id];
+      counts.records += next.records;
+      counts.min_ts_event = std::min(counts.min_ts_event, next.min_ts_event);
+      counts.max_ts_event = std::max(counts.max_ts_event, next.max_ts_event);
+      if (next.sequenced > 0) {
+        // The step into the later run is checked like any other
+        const std::uint64_t sequenced = counts.sequenced;
+        AddSequence(counts, next.first_sequence);
+        counts.sequenced = sequenced + next.sequenced;
+        counts.gaps += next.gaps;
+        counts.missing += next.missing;
+        counts.resets += next.resets;
+        counts.last_sequence = next.last_sequence;
+      }
+    });
+  }
+
+  void Fill(DbnSummary& summary) const {
+    summary.record_count = record_count_;
+    summary.record_bytes = record_bytes_;
+    summary.min_ts_event = min_ts_event_;
+    summary.max_ts_event = max_ts_event_;
+    summary.rtype_counts = rtype_counts_;
+    std::vector<std::pair<std::uint16_t, std::uint64_t>> publishers;
+    publishers_.ForEach([&publishers](std::uint16_t id, std::uint64_t n) {
+      publishers.emplace_back(id, n);
+    });
+    std::sort(publishers.begin(), publishers.end());
+    for (const auto& [id, n] : publishers) {
+      summary.publisher_ids.push_back(id);
+      summary.publisher_records.push_back(n);
+    }
+    instruments_.ForEach([&summary](std::uint32_t id, const InstrumentCounts& counts) {
+      summary.instruments.push_back(InstrumentSummary{
+          id, counts.records, counts.min_ts_event, counts.max_ts_event, counts.sequenced,
+          counts.first_sequence, counts.last_sequence, counts.gaps, counts.missing,
+          counts.resets});
+    });
+    std::sort(summary.instruments.begin(), summary.instruments.end(),
+              [](const InstrumentSummary& a, const InstrumentSummary& b) {
+                return a.instrument_id < b.instrument_id;
+              });
+  }
+
+ private:
+  std::uint64_t record_count_{};
+  std::uint64_t record_bytes_{};
+  std::uint64_t min_ts_event_{databento::kUndefTimestamp};
+  std::uint64_t max_ts_event_{};
+  std::array<std::uint64_t, 256> rtype_counts_{};
+  FlatHashMap<std::uint16_t, std::uint64_t> publishers_;
+  FlatHashMap<std::uint32_t, InstrumentCounts> instruments_;
+};
+
+// Where the scan of the decompressed stream is, carried from one run into
+// the next when a record straddles them
+struct StreamState {
+  // Past the metadata
+  bool in_records{};
+  std::array<std::byte, kPreludeSize> prelude{};
+  std::size_t prelude_have{};
+  std::uint8_t dbn_version{};
+  // Bytes to pass over: the metadata, or the rest of the record in partial
+  std::uint64_t skip{};
+  // Prefix of a record read so far, counted once the whole record is seen
+  std::array<std::byte, kPrefixSize> partial{};
+  std::size_t partial_have{};
+  std::size_t record_length{};
+
+  bool AtRecord() const { return in_records && skip == 0 && partial_have == 0; }
+};
+
+// Walks a decompressed DBN stream handed to it in arbitrary chunks. Only the
+// prefix of a record that straddles two chunks is copied; the rest is read
+// in place.
+class Scanner {
+ public:
+  explicit Scanner(const StreamState& start) : state_{start} {}
+
+  // False at a record length no DBN record can have, which is how a run
+  // that does not start on a record usually shows
+  bool Feed(const std::byte* data, std::size_t n) {
+    StreamState& s = state_;
+    std::size_t i = 0;
+    while (i < n) {
+      if (s.skip > 0) {
+        const std::size_t take = static_cast<std::size_t>(std::min<std::uint64_t>(s.skip, n - i));
+        s.skip -= take;
+        i += take;
+        if (s.skip == 0 && s.partial_have > 0) {
+          tables_.Add(s.partial.data(), s.record_length);
+          s.partial_have = 0;
+        }
+        continue;
+      }
+      if (!s.in_records) {
+        const std::size_t take = std::min(kPreludeSize - s.prelude_have, n - i);
+        std::memcpy(s.prelude.data() + s.prelude_have, data + i, take);
+        s.prelude_have += take;
+        i += take;
+        if (s.prelude_have == kPreludeSize) {
+          const auto [version, metadata_size] =
+              databento::DbnDecoder::DecodeMetadataVersionAndSize(s.prelude.data(),
+                                                                  kPreludeSize);
+          s.dbn_version = version;
+          s.skip = metadata_size;
+          s.in_records = true;
+        }
+        continue;
+      }
+      if (s.partial_have == 0) {
+        const std::size_t length = std::to_integer<std::size_t>(data[i]) *
+                                   databento::RecordHeader::kLengthMultiplier;
+        if (length < sizeof(databento::RecordHeader)) {
+          return false;
+        }
+        if (n - i >= length) {
+          tables_.Add(data + i, length);
+          i += length;
+          continue;
+        }
+        s.record_length = length;
+      }
+      const std::size_t wanted = std::min(s.record_length, kPrefixSize);
+      const std::size_t take = std::min(wanted - s.partial_have, n - i);
+      std::memcpy(s.partial.data() + s.partial_have, data + i, take);
+      s.partial_have += take;
+      i += take;
+      if (s.partial_have == wanted) {
+        s.skip = s.record_length - wanted;
+        if (s.skip == 0) {
+          tables_.Add(s.partial.data(), s.record_length);
+          s.partial_have = 0;
+        }
+      }
+    }
+    return true;
+  }
+
+  const StreamState& State() const { return state_; }
+  SummaryTables& Tables() { return tables_; }
+
+ private:
+  StreamState state_;
+  SummaryTables tables_;
+};
+
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& path) : path_{path} {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::system_error{errno, std::generic_category(), "Failed to open " + path};
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+      const int err = errno;
+      ::close(fd);
+      throw std::system_error{err, std::generic_category(), "Failed to stat " + path};
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ < kPreludeSize) {
+      ::close(fd);
+      throw std::runtime_error{path + " is too small to be a DBN file"};
+    }
+    void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    const int err = errno;
+    // The mapping keeps its own reference to the file
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+      throw std::system_error{err, std::generic_category(), "Failed to mmap " + path};
+    }
+    ::madvise(addr, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const std::byte*>(addr);
+  }
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile() { ::munmap(const_cast<std::byte*>(data_), size_); }
+
+  const std::string& Path() const { return path_; }
+  const std::byte* Data() const { return data_; }
+  std::size_t Size() const { return size_; }
+
+ private:
+  std::string path_;
+  const std::byte* data_{};
+  std::size_t size_{};
+};
+
+struct DCtxDeleter {
+  void operator()(ZSTD_DCtx* dctx) const { ZSTD_freeDCtx(dctx); }
+};
+
+// Offsets of the zstd frames of the file, then its size. Only frame and
+// block headers are read.
+std::vector<std::size_t> FrameOffsets(const MappedFile& file) {
+  std::vector<std::size_t> offsets;
+  std::size_t pos = 0;
+  while (pos < file.Size()) {
+    const std::size_t size = ZSTD_findFrameCompressedSize(file.Data() + pos, file.Size() - pos);
+    if (ZSTD_isError(size)) {
+      throw std::runtime_error{"Failed to find the zstd frames of " + file.Path() + ": " +
+                               ZSTD_getErrorName(size)};
+    }
+    offsets.push_back(pos);
+    pos += size;
+  }
+  offsets.push_back(pos);
+  return offsets;
+}
+
+// Decompresses the whole frames in [begin, end) of the file into `scanner`.
+// Returns false when the scanner rejects the stream.
+bool ScanFrames(const MappedFile& file, std::size_t begin, std::size_t end, Scanner& scanner) {
+  std::unique_ptr<ZSTD_DCtx, DCtxDeleter> dctx{ZSTD_createDCtx()};
+  std::vector<std::byte> out(ZSTD_DStreamOutSize());
+  ZSTD_inBuffer input{file.Data() + begin, end - begin, 0};
+  ZSTD_outBuffer output{};
+  do {
+    output = ZSTD_outBuffer{out.data(), out.size(), 0};
+    const std::size_t ret = ZSTD_decompressStream(dctx.get(), &output, &input);
+    if (ZSTD_isError(ret)) {
+      throw std::runtime_error{"Failed to decompress " + file.Path() + ": " +
+                               ZSTD_getErrorName(ret)};
+    }
+    if (!scanner.Feed(out.data(), output.pos)) {
+      return false;
+    }
+  } while (input.pos < input.size || output.pos == output.size);
+  return true;
+}
+
+// Joins every thread in `threads` on scope exit, so those started before a
+// failed spawn are not destroyed while still running
+struct ThreadJoiner {
+  std::vector<std::thread>& threads;
+  ~ThreadJoiner() {
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+  }
+};
+
+std::runtime_error InvalidRecord(const std::string& path) {
+  return std::runtime_error{"Invalid record length in " + path};
+}
+}  // namespace
+
+DbnSummary SummarizeDbn(const std::string& path, std::size_t num_threads) {
+  const MappedFile file{path};
+  DbnSummary summary;
+  summary.file_size = file.Size();
+  std::uint32_t magic;
+  std::memcpy(&magic, file.Data(), sizeof(magic));
+
+  std::vector<Scanner> scanners;
+  if (magic != kZstdMagic) {
+    Scanner& scanner = scanners.emplace_back(StreamState{});
+    if (!scanner.Feed(file.Data(), file.Size())) {
+      throw InvalidRecord(path);
+    }
+  } else {
+    summary.compressed = true;
+    const std::vector<std::size_t> offsets = FrameOffsets(file);
+    summary.frames = offsets.size() - 1;
+    if (num_threads == 0) {
+      num_threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    num_threads = std::max<std::size_t>(std::min(num_threads, summary.frames), 1);
+
+    // Runs of whole frames with about the same compressed size
+    std::vector<std::size_t> runs{0};
+    const std::size_t target = file.Size() / num_threads;
+    for (std::size_t f = 1; f < summary.frames && runs.size() < num_threads; ++f) {
+      if (offsets[f] - offsets[runs.back()] >= target) {
+        runs.push_back(f);
+      }
+    }
+    runs.push_back(summary.frames);
+    const std::size_t num_runs = runs.size() - 1;
+    const auto begin = [&](std::size_t r) { return offsets[runs[r]]; };
+    const auto end = [&](std::size_t r) { return offsets[runs[r + 1]]; };
+
+    // Every run after the first is assumed to start on a record
+    StreamState at_record;
+    at_record.in_records = true;
+    for (std::size_t r = 0; r < num_runs; ++r) {
+      scanners.emplace_back(r == 0 ? StreamState{} : at_record);
+    }
+    std::vector<char> valid(num_runs);
+    std::vector<std::exception_ptr> errors(num_runs);
+    const auto scan = [&](std::size_t r) {
+      try {
+        valid[r] = ScanFrames(file, begin(r), end(r), scanners[r]);
+      } catch (...) {
+        errors[r] = std::current_exception();
+      }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(num_runs - 1);
+    {
+      const ThreadJoiner joiner{threads};
+      for (std::size_t r = 1; r < num_runs; ++r) {
+        threads.emplace_back(scan, r);
+      }
+      scan(0);
+    }
+    for (const auto& error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+    if (!valid[0]) {
+      throw InvalidRecord(path);
+    }
+
+    // Runs whose predecessor ended inside a record are scanned again,
+    // continuing from where it stopped
+    for (std::size_t r = 1; r < num_runs; ++r) {
+      const StreamState& previous = scanners[r - 1].State();
+      if (previous.AtRecord() && valid[r]) {
+        continue;
+      }
+      scanners[r] = Scanner{previous};
+      if (!ScanFrames(file, begin(r), end(r), scanners[r])) {
+        throw InvalidRecord(path);
+      }
+      ++summary.runs_rescanned;
+    }
+  }
+
+  if (!scanners.front().State().in_records) {
+    throw std::runtime_error{path + " ends before its metadata header"};
+  }
+  summary.dbn_version = scanners.front().State().dbn_version;
+  summary.runs = scanners.size();
+  // A record cut off by the end of the file is not counted
+  SummaryTables& tables = scanners.front().Tables();
+  for (std::size_t r = 1; r < scanners.size(); ++r) {
+    tables.Append(scanners[r].Tables());
+  }
+  tables.Fill(summary);
+  return summary;
+}
+
+}  // namespace databento_jl
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <databento/enums.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace databento_jl {
+
+// Per-instrument counts of a DbnSummary
+struct InstrumentSummary {
+  std::uint32_t instrument_id{};
+  std::uint64_t records{};
+  std::uint64_t min_ts_event{};
+  std::uint64_t max_ts_event{};
+  // Records carrying a sequence number: MBO, trades, MBP-1, MBP-10, BBO and
+  // statistics. The fields below are about those only.
+  std::uint64_t sequenced{};
+  std::uint32_t first_sequence{};
+  std::uint32_t last_sequence{};
+  // Steps forward by more than one, and the numbers they skip. Repeats are
+  // not gaps: one event can span several records.
+  std::uint64_t sequence_gaps{};
+  std::uint64_t missing_sequences{};
+  // Steps backward, e.g. after a session restart
+  std::uint64_t sequence_resets{};
+};
+
+struct DbnSummary {
+  std::uint8_t dbn_version{};
+  bool compressed{};
+  std::uint64_t file_size{};
+  std::uint64_t record_count{};
+  std::uint64_t record_bytes{};
+  // Over the records with a defined ts_event; kUndefTimestamp and 0 when
+  // there are none
+  std::uint64_t min_ts_event{};
+  std::uint64_t max_ts_event{};
+  // Indexed by rtype
+  std::array<std::uint64_t, 256> rtype_counts{};
+  // Sorted by publisher ID
+  std::vector<std::uint16_t> publisher_ids;
+  std::vector<std::uint64_t> publisher_records;
+  // Sorted by instrument ID
+  std::vector<InstrumentSummary> instruments;
+  // zstd frames in the file, 0 when uncompressed
+  std::size_t frames{};
+  // Runs of frames decoded concurrently, and those decoded again because
+  // the run before them ended inside a record
+  std::size_t runs{};
+  std::size_t runs_rescanned{};
+};
+
+// Profiles a DBN file, zstd-compressed or not, from its record headers and
+// sequence numbers alone: no record is decoded into a message.
+//
+// A compressed file is split into runs of whole zstd frames, which
+// `num_threads` threads (0 for one per core) decompress concurrently, each
+// counting into its own tables. The frames are found first by walking every
+// frame and block header of the file on the calling thread, a serial pass
+// before any parallel work that reads headers only. A run is
+// scanned on the assumption that it starts on a record; when the run before
+// it turns out to end inside a record, it is scanned again from the right
+// offset after the others finish. Frames written by DbnWriter always start
+// on a record, so that never happens for them. The per-run tables are then
+// merged in file order, which keeps sequence gaps across run boundaries
+// exact. A single-frame file is scanned on one thread, as are uncompressed
+// files, whose record headers are walked in the mapped file.
+DbnSummary SummarizeDbn(const std::string& path, std::size_t num_threads);
+
+}  // namespace databento_jl
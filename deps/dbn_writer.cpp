@@ -0,0 +1,360 @@
+#include "dbn_writer.hpp"
+
+#include <databento/constants.hpp>
+#include <databento/dbn_encoder.hpp>
+#include <databento/iwritable.hpp>
+
+#include <zstd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
+
+namespace databento_jl {
+
+namespace {
+// Collects the encoded metadata into the first frame
+class FrameSink : public databento::IWritable {
+ public:
+  explicit FrameSink(std::vector<std::byte>& frame) : frame_{frame} {}
+  void WriteAll(const std::byte* buffer, std::size_t length) override {
+    frame_.insert(frame_.end(), buffer, buffer + length);
+  }
+
+ private:
+  std::vector<std::byte>& frame_;
+};
+
+std::size_t DefaultThreads(std::size_t threads) {
+  if (threads != 0) {
+    return threads;
+  }
+  return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+}
+}  // namespace
+
+// ============================================================================
+// CompressionPool
+// ============================================================================
+
+CompressionPool::CompressionPool(std::size_t threads) {
+  const std::size_t n = DefaultThreads(threads);
+  workers_.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    workers_.emplace_back(&CompressionPool::WorkerLoop, this);
+  }
+}
+
+CompressionPool::~CompressionPool() {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    stopping_ = true;
+  }
+  job_ready_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+void CompressionPool::Submit(std::shared_ptr<Job> job) {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    job->done = false;
+    job->error = nullptr;
+    queue_.push_back(std::move(job));
+  }
+  job_ready_.notify_one();
+}
+
+bool CompressionPool::IsDone(const Job& job) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  return job.done;
+}
+
+void CompressionPool::Wait(const Job& job) {
+  std::unique_lock<std::mutex> lock{mutex_};
+  job_done_.wait(lock, [&job] { return job.done; });
+  if (job.error) {
+    std::rethrow_exception(job.error);
+  }
+}
+
+void CompressionPool::WorkerLoop() {
+  ZSTD_CCtx* cctx = ZSTD_createCCtx();
+  std::unique_lock<std::mutex> lock{mutex_};
+  while (true) {
+    job_ready_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      break;
+    }
+    std::shared_ptr<Job> job = std::move(queue_.front());
+    queue_.pop_front();
+    lock.unlock();
+
+    std::exception_ptr error;
+    try {
+      if (cctx == nullptr) {
+        throw std::bad_alloc{};
+      }
+      job->output.resize(ZSTD_compressBound(job->input.size()));
+      const std::size_t size = ZSTD_compressCCtx(cctx, job->output.data(), job->output.size(),
+                                                 job->input.data(), job->input.size(), job->level);
+      if (ZSTD_isError(size)) {
+        throw std::runtime_error{std::string{"zstd compression failed: "} +
+                                 ZSTD_getErrorName(size)};
+      }
+      job->output.resize(size);
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    lock.lock();
+    job->error = error;
+    job->done = true;
+    job_done_.notify_all();
+  }
+  lock.unlock();
+  ZSTD_freeCCtx(cctx);
+}
+
+// ============================================================================
+// DbnWriter
+// ============================================================================
+
+DbnWriter::DbnWriter(const std::string& path, const databento::Metadata& metadata,
+                     const DbnWriterOptions& options)
+    : DbnWriter{path, metadata, options,
+                options.zstd ? std::make_shared<CompressionPool>(options.threads) : nullptr} {}
+
+DbnWriter::DbnWriter(const std::string& path, const databento::Metadata& metadata,
+                     const DbnWriterOptions& options, std::shared_ptr<CompressionPool> pool)
+    : file_{path}, options_{options}, pool_{std::move(pool)} {
+  options_.frame_bytes = std::max<std::size_t>(options_.frame_bytes, 1);
+  options_.max_pending_frames = std::max<std::size_t>(options_.max_pending_frames, 1);
+  if (options_.zstd && pool_ == nullptr) {
+    throw std::invalid_argument{"DbnWriter needs a compression pool for zstd output"};
+  }
+  current_ = NewJob();
+  try {
+    databento::Metadata header = metadata;
+    header.version = databento::kDbnVersion;
+    FrameSink sink{current_->input};
+    databento::DbnEncoder encoder{header, &sink};
+    bytes_encoded_ += current_->input.size();
+    SealFrame();
+  } catch (...) {
+    Abandon();
+    throw;
+  }
+}
+
+DbnWriter::~DbnWriter() {
+  if (IsOpen()) {
+    Abandon();
+  }
+}
+
+void DbnWriter::WriteRecords(const std::byte* data, std::size_t size) {
+  std::size_t offset = 0;
+  while (offset < size) {
+    const auto length = static_cast<std::size_t>(std::to_integer<std::uint8_t>(data[offset])) *
+                        databento::RecordHeader::kLengthMultiplier;
+    if (length < sizeof(databento::RecordHeader) || length > size - offset) {
+      throw std::invalid_argument{"Record lengths at byte " + std::to_string(offset) +
+                                  " do not match the buffer size"};
+    }
+    Append(data + offset, length);
+    ++records_;
+    offset += length;
+  }
+}
+
+void DbnWriter::Close() {
+  if (!IsOpen()) {
+    return;
+  }
+  try {
+    SealFrame();
+    while (!pending_.empty()) {
+      WriteFront();
+    }
+  } catch (...) {
+    Abandon();
+    throw;
+  }
+  file_.Commit();
+}
+
+void DbnWriter::Append(const void* data, std::size_t size) {
+  if (!IsOpen()) {
+    throw std::logic_error{"DbnWriter for " + Path() + " is closed"};
+  }
+  if (!current_->input.empty() && current_->input.size() + size > options_.frame_bytes) {
+    SealFrame();
+  }
+  const auto* bytes = static_cast<const std::byte*>(data);
+  current_->input.insert(current_->input.end(), bytes, bytes + size);
+  bytes_encoded_ += size;
+}
+
+void DbnWriter::SealFrame() {
+  if (current_->input.empty()) {
+    return;
+  }
+  if (!options_.zstd) {
+    file_.Write(current_->input.data(), current_->input.size());
+    current_->input.clear();
+    ++frames_written_;
+    return;
+  }
+  current_->level = options_.compression_level;
+  pending_.push_back(current_);
+  pool_->Submit(current_);
+  current_ = NewJob();
+  // Write whatever is already compressed, then block only if this output
+  // has too many frames in flight
+  while (!pending_.empty() && pool_->IsDone(*pending_.front())) {
+    WriteFront();
+  }
+  while (pending_.size() > options_.max_pending_frames) {
+    WriteFront();
+  }
+}
+
+void DbnWriter::WriteFront() {
+  std::shared_ptr<Job> job = std::move(pending_.front());
+  pending_.pop_front();
+  const auto start = std::chrono::steady_clock::now();
+  pool_->Wait(*job);
+  stall_ns_ += static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                           start)
+          .count());
+  file_.Write(job->output.data(), job->output.size());
+  ++frames_written_;
+  job->input.clear();
+  free_jobs_.push_back(std::move(job));
+}
+
+std::shared_ptr<DbnWriter::Job> DbnWriter::NewJob() {
+  if (free_jobs_.empty()) {
+    auto job = std::make_shared<Job>();
+    job->input.reserve(options_.frame_bytes);
+    return job;
+  }
+  std::shared_ptr<Job> job = std::move(free_jobs_.back());
+  free_jobs_.pop_back();
+  return job;
+}
+
+void DbnWriter::Abandon() {
+  // Jobs still in the pool are kept alive by its queue
+  pending_.clear();
+  file_.Discard();
+}
+
+// ============================================================================
+// DbnFanOut
+// ============================================================================
+
+DbnFanOut::DbnFanOut(std::vector<std::string> paths, const databento::Metadata& metadata,
+                     const DbnWriterOptions& options)
+    : paths_{std::move(paths)},
+      metadata_{metadata},
+      options_{options},
+      pool_{options.zstd ? std::make_shared<CompressionPool>(options.threads) : nullptr} {
+  writers_.resize(paths_.size());
+}
+
+void DbnFanOut::Route(std::uint32_t instrument_id, std::size_t output) {
+  CheckOutput(output);
+  routes_[instrument_id] = static_cast<std::uint32_t>(output);
+}
+
+void DbnFanOut::SetDefaultOutput(std::size_t output) {
+  if (output != kDrop) {
+    CheckOutput(output);
+  }
+  default_output_ = output;
+}
+
+bool DbnFanOut::Write(const databento::Record& record) {
+  const std::size_t output = OutputOf(record.Header().instrument_id);
+  if (output == kDrop) {
+    ++records_dropped_;
+    return false;
+  }
+  Open(output).Write(record);
+  ++records_written_;
+  return true;
+}
+
+void DbnFanOut::Close() {
+  for (std::size_t i = 0; i < writers_.size(); ++i) {
+    Open(i).Close();
+  }
+}
+
+DbnWriter& DbnFanOut::Open(std::size_t output) {
+  std::unique_ptr<DbnWriter>& writer = writers_[output];
+  if (writer == nullptr) {
+    writer = std::make_unique<DbnWriter>(paths_[output], MetadataFor(output), options_, pool_);
+  }
+  return *writer;
+}
+
+databento::Metadata DbnFanOut::MetadataFor(std::size_t output) const {
+  databento::Metadata metadata = metadata_;
+  if (metadata.stype_out != databento::SType::InstrumentId) {
+    return metadata;
+  }
+  // Mapping intervals name the instrument ID as their symbol; keep those
+  // whose instrument is written to this output
+  const auto belongs = [this, output](const databento::MappingInterval& interval) {
+    char* end = nullptr;
+    const unsigned long id = std::strtoul(interval.symbol.c_str(), &end, 10);
+    return end == interval.symbol.c_str() || *end != '\0' ||
+           OutputOf(static_cast<std::uint32_t>(id)) == output;
+  };
+  std::unordered_set<std::string> kept_symbols;
+  auto& mappings = metadata.mappings;
+  for (databento::SymbolMapping& mapping : mappings) {
+    auto& intervals = mapping.intervals;
+    intervals.erase(
+        std::remove_if(intervals.begin(), intervals.end(),
+                       [&belongs](const databento::MappingInterval& interval) {
+                         return !belongs(interval);
+                       }),
+        intervals.end());
+    if (!intervals.empty()) {
+      kept_symbols.insert(mapping.raw_symbol);
+    }
+  }
+  mappings.erase(std::remove_if(mappings.begin(), mappings.end(),
+                                [](const databento::SymbolMapping& mapping) {
+                                  return mapping.intervals.empty();
+                                }),
+                 mappings.end());
+  if (!metadata_.mappings.empty()) {
+    auto& symbols = metadata.symbols;
+    symbols.erase(std::remove_if(symbols.begin(), symbols.end(),
+                                 [&kept_symbols](const std::string& symbol) {
+                                   return kept_symbols.count(symbol) == 0;
+                                 }),
+                  symbols.end());
+  }
+  return metadata;
+}
+
+void DbnFanOut::CheckOutput(std::size_t output) const {
+  if (output >= paths_.size()) {
+    throw std::out_of_range{"Output " + std::to_string(output) + " of " +
+                            std::to_string(paths_.size())};
+  }
+}
+
+}  // namespace databento_jl
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <databento/dbn.hpp>
+#include <databento/record.hpp>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "flat_hash_map.hpp"
+#include "output_file.hpp"
+
+namespace databento_jl {
+
+struct DbnWriterOptions {
+  bool zstd{true};
+  int compression_level{3};
+  // Compression threads; 0 uses one per core
+  std::size_t threads{0};
+  // Uncompressed bytes per zstd frame, also the write granularity without zstd
+  std::size_t frame_bytes{1 << 20};
+  // Frames of one output queued or being compressed before a write blocks
+  std::size_t max_pending_frames{4};
+};
+
+// Worker threads compressing independent zstd frames for any number of
+// DbnWriters. Jobs are taken in submission order.
+class CompressionPool {
+ public:
+  struct Job {
+    std::vector<std::byte> input;
+    std::vector<std::byte> output;
+    int level{};
+    // Guarded by the pool mutex
+    bool done{};
+    std::exception_ptr error;
+  };
+
+  explicit CompressionPool(std::size_t threads);
+  CompressionPool(const CompressionPool&) = delete;
+  CompressionPool& operator=(const CompressionPool&) = delete;
+  // Finishes the queued jobs before joining the workers
+  ~CompressionPool();
+
+  std::size_t ThreadCount() const { return workers_.size(); }
+  void Submit(std::shared_ptr<Job> job);
+  bool IsDone(const Job& job);
+  // Blocks until `job` is compressed, rethrowing its compression error
+  void Wait(const Job& job);
+
+ private:
+  void WorkerLoop();
+
+  std::mutex mutex_;
+  std::condition_variable job_ready_;
+  std::condition_variable job_done_;
+  std::deque<std::shared_ptr<Job>> queue_;
+  bool stopping_{};
+  std::vector<std::thread> workers_;
+};
+
+// Encodes a DBN stream to a file.
+//
+// Records are appended to a frame buffer; each full buffer becomes an
+// independent zstd frame compressed on a CompressionPool while the caller
+// keeps writing, and frames are written out in order as they complete. The
+// metadata is a frame of its own and every frame starts at a record
+// boundary, so the output can be indexed and decompressed from any frame.
+// Memory is bounded by (1 + max_pending_frames) frame buffers per writer.
+//
+// The header declares the current DBN version, which is what DbnFileStore
+// and the other readers here hand out. Output goes to `path` + ".tmp" and is
+// renamed on Close, so a failed or abandoned writer never leaves a truncated
+// file at `path`.
+class DbnWriter {
+ public:
+  DbnWriter(const std::string& path, const databento::Metadata& metadata,
+            const DbnWriterOptions& options);
+  // Shares `pool` with other writers instead of starting threads
+  DbnWriter(const std::string& path, const databento::Metadata& metadata,
+            const DbnWriterOptions& options, std::shared_ptr<CompressionPool> pool);
+  DbnWriter(const DbnWriter&) = delete;
+  DbnWriter& operator=(const DbnWriter&) = delete;
+  // Discards the output unless Close succeeded
+  ~DbnWriter();
+
+  void Write(const databento::Record& record) {
+    Append(&record.Header(), record.Size());
+    ++records_;
+  }
+  // Writes `size` bytes of consecutive records, e.g. a Julia vector of
+  // messages. Throws std::invalid_argument unless the record lengths add up
+  // to exactly `size`.
+  void WriteRecords(const std::byte* data, std::size_t size);
+  // Copies up to `max_records` records from `source`. Returns the number
+  // copied.
+  template <typename Source>
+  std::size_t WriteFrom(Source& source, std::size_t max_records) {
+    std::size_t n = 0;
+    while (n < max_records) {
+      const databento::Record* record = source.NextRecord();
+      if (record == nullptr) {
+        break;
+      }
+      Write(*record);
+      ++n;
+    }
+    return n;
+  }
+
+  // Writes the buffered frames and moves the file to its path. Writing
+  // afterwards throws.
+  void Close();
+  bool IsOpen() const { return file_.IsOpen(); }
+  const std::string& Path() const { return file_.Path(); }
+
+  std::uint64_t RecordsWritten() const { return records_; }
+  // Uncompressed DBN bytes, metadata included
+  std::uint64_t BytesEncoded() const { return bytes_encoded_; }
+  std::uint64_t BytesWritten() const { return file_.Position(); }
+  std::uint64_t FramesWritten() const { return frames_written_; }
+  // Nanoseconds writes spent waiting for compression to catch up
+  std::uint64_t StallNs() const { return stall_ns_; }
+
+ private:
+  using Job = CompressionPool::Job;
+
+  void Append(const void* data, std::size_t size);
+  void SealFrame();
+  void WriteFront();
+  std::shared_ptr<Job> NewJob();
+  void Abandon();
+
+  OutputFile file_;
+  DbnWriterOptions options_;
+  std::shared_ptr<CompressionPool> pool_;
+  std::shared_ptr<Job> current_;
+  std::deque<std::shared_ptr<Job>> pending_;
+  std::vector<std::shared_ptr<Job>> free_jobs_;
+  std::uint64_t records_{};
+  std::uint64_t bytes_encoded_{};
+  std::uint64_t frames_written_{};
+  std::uint64_t stall_ns_{};
+};
+
+// Splits one record stream into several DBN files by instrument_id, in a
+// single pass.
+//
+// Each output is a DbnWriter, and all of them share one CompressionPool, so
+// the thread count does not grow with the number of files while memory stays
+// bounded per output. An output is opened on its first record (or on Close),
+// with the metadata narrowed to the symbol mappings of the instruments routed
+// to it when the metadata maps to instrument IDs; routes should therefore be
+// set up before writing.
+class DbnFanOut {
+ public:
+  static constexpr std::size_t kDrop = std::numeric_limits<std::size_t>::max();
+
+  DbnFanOut(std::vector<std::string> paths, const databento::Metadata& metadata,
+            const DbnWriterOptions& options);
+
+  // Sends the records of `instrument_id` to output `output`
+  void Route(std::uint32_t instrument_id, std::size_t output);
+  // Output for instruments without a route; kDrop, the default, discards them
+  void SetDefaultOutput(std::size_t output);
+  std::size_t OutputOf(std::uint32_t instrument_id) const {
+    const std::uint32_t* output = routes_.Find(instrument_id);
+    return output == nullptr ? default_output_ : *output;
+  }
+
+  // Returns false if the record was dropped
+  bool Write(const databento::Record& record);
+  template <typename Source>
+  std::size_t WriteFrom(Source& source, std::size_t max_records) {
+    std::size_t n = 0;
+    while (n < max_records) {
+      const databento::Record* record = source.NextRecord();
+      if (record == nullptr) {
+        break;
+      }
+      Write(*record);
+      ++n;
+    }
+    return n;
+  }
+  // Closes every output, opening the ones that received no records so each
+  // path ends up with a valid file
+  void Close();
+
+  std::size_t OutputCount() const { return paths_.size(); }
+  // nullptr until output `output` has been opened
+  const DbnWriter* Output(std::size_t output) const { return writers_.at(output).get(); }
+  std::uint64_t RecordsWritten() const { return records_written_; }
+  std::uint64_t RecordsDropped() const { return records_dropped_; }
+
+ private:
+  DbnWriter& Open(std::size_t output);
+  databento::Metadata MetadataFor(std::size_t output) const;
+  void CheckOutput(std::size_t output) const;
+
+  std::vector<std::string> paths_;
+  databento::Metadata metadata_;
+  DbnWriterOptions options_;
+  std::shared_ptr<CompressionPool> pool_;
+  std::vector<std::unique_ptr<DbnWriter>> writers_;
+  FlatHashMap<std::uint32_t, std::uint32_t> routes_;
+  std::size_t default_output_{kDrop};
+  std::uint64_t records_written_{};
+  std::uint64_t records_dropped_{};
+};
+
+}  // namespace databento_jl
@@ -0,0 +1,183 @@
+#include "definition_store.hpp"
+
+#include <databento/enums.hpp>
+
+#include <algorithm>
+#include <array>
+
+namespace databento_jl {
+
+namespace {
+// The string fields of a definition are NUL-padded fixed-size arrays
+template <std::size_t N>
+std::string_view FixedString(const std::array<char, N>& field) {
+  return {field.data(), static_cast<std::size_t>(
+                            std::find(field.begin(), field.end(), '\0') - field.begin())};
+}
+
+std::uint64_t Nanos(databento::UnixNanos ts) {
+  return static_cast<std::uint64_t>(ts.time_since_epoch().count());
+}
+}  // namespace
+
+bool DefinitionStore::Apply(const databento::Record& record) {
+  if (!record.Holds<databento::InstrumentDefMsg>()) {
+    return false;
+  }
+  Apply(record.Get<databento::InstrumentDefMsg>());
+  return true;
+}
+
+void DefinitionStore::Apply(const databento::InstrumentDefMsg& def) {
+  ++applied_;
+  const std::uint32_t instrument_id = def.hd.instrument_id;
+  std::size_t row = FindRow(instrument_id);
+  if (def.security_update_action == databento::SecurityUpdateAction::Delete) {
+    if (row != kNoRow) {
+      RemoveRow(row);
+      ++deleted_;
+    }
+    return;
+  }
+  if (row == kNoRow) {
+    row = table_.Size();
+    table_.ForEachColumn([](auto& column) { column.emplace_back(); });
+    rows_[instrument_id] = static_cast<std::uint32_t>(row);
+  } else {
+    Unindex(row);
+    ++replaced_;
+  }
+  Store(row, def);
+  Index(row);
+}
+
+std::size_t DefinitionStore::FindRowBySymbol(std::string_view raw_symbol) const {
+  const std::uint32_t symbol_id = strings_.Find(raw_symbol);
+  if (symbol_id == StringPool::kEmpty) {
+    return kNoRow;
+  }
+  const std::uint32_t* instrument_id = by_symbol_.Find(symbol_id);
+  return instrument_id == nullptr ? kNoRow : FindRow(*instrument_id);
+}
+
+std::vector<std::uint32_t> DefinitionStore::InstrumentsOf(std::string_view underlying) const {
+  const std::uint32_t underlying_id = strings_.Find(underlying);
+  if (underlying_id == StringPool::kEmpty) {
+    return {};
+  }
+  const std::vector<std::uint32_t>* instruments = by_underlying_.Find(underlying_id);
+  return instruments == nullptr ? std::vector<std::uint32_t>{} : *instruments;
+}
+
+std::size_t DefinitionStore::Export(std::size_t first_row,
+                                    const DefinitionColumns& columns) const {
+  if (first_row >= table_.Size()) {
+    return 0;
+  }
+  const std::size_t n = std::min(columns.capacity, table_.Size() - first_row);
+  const auto copy = [first_row, n](const auto& column, auto* out) {
+    std::copy_n(column.begin() + static_cast<std::ptrdiff_t>(first_row), n, out);
+  };
+  copy(table_.instrument_id, columns.instrument_id);
+  copy(table_.publisher_id, columns.publisher_id);
+  copy(table_.ts_event, columns.ts_event);
+  copy(table_.ts_recv, columns.ts_recv);
+  copy(table_.raw_symbol, columns.raw_symbol);
+  copy(table_.underlying, columns.underlying);
+  copy(table_.exchange, columns.exchange);
+  copy(table_.asset, columns.asset);
+  copy(table_.cfi, columns.cfi);
+  copy(table_.security_type, columns.security_type);
+  copy(table_.currency, columns.currency);
+  copy(table_.instrument_class, columns.instrument_class);
+  copy(table_.strike_price, columns.strike_price);
+  copy(table_.expiration, columns.expiration);
+  copy(table_.activation, columns.activation);
+  copy(table_.min_price_increment, columns.min_price_increment);
+  copy(table_.display_factor, columns.display_factor);
+  copy(table_.high_limit_price, columns.high_limit_price);
+  copy(table_.low_limit_price, columns.low_limit_price);
+  copy(table_.unit_of_measure_qty, columns.unit_of_measure_qty);
+  copy(table_.contract_multiplier, columns.contract_multiplier);
+  copy(table_.underlying_id, columns.underlying_id);
+  return n;
+}
+
+void DefinitionStore::Clear() {
+  table_.ForEachColumn([](auto& column) { column.clear(); });
+  strings_.Clear();
+  rows_.Clear();
+  by_symbol_.Clear();
+  by_underlying_.Clear();
+  applied_ = 0;
+  replaced_ = 0;
+  deleted_ = 0;
+}
+
+void DefinitionStore::Store(std::size_t row, const databento::InstrumentDefMsg& def) {
+  table_.instrument_id[row] = def.hd.instrument_id;
+  table_.publisher_id[row] = def.hd.publisher_id;
+  table_.ts_event[row] = Nanos(def.hd.ts_event);
+  table_.ts_recv[row] = Nanos(def.ts_recv);
+  table_.raw_symbol[row] = strings_.Intern(FixedString(def.raw_symbol));
+  table_.underlying[row] = strings_.Intern(FixedString(def.underlying));
+  table_.exchange[row] = strings_.Intern(FixedString(def.exchange));
+  table_.asset[row] = strings_.Intern(FixedString(def.asset));
+  table_.cfi[row] = strings_.Intern(FixedString(def.cfi));
+  table_.security_type[row] = strings_.Intern(FixedString(def.security_type));
+  table_.currency[row] = strings_.Intern(FixedString(def.currency));
+  table_.instrument_class[row] = static_cast<std::uint8_t>(def.instrument_class);
+  table_.strike_price[row] = def.strike_price;
+  table_.expiration[row] = Nanos(def.expiration);
+  table_.activation[row] = Nanos(def.activation);
+  table_.min_price_increment[row] = def.min_price_increment;
+  table_.display_factor[row] = def.display_factor;
+  table_.high_limit_price[row] = def.high_limit_price;
+  table_.low_limit_price[row] = def.low_limit_price;
+  table_.unit_of_measure_qty[row] = def.unit_of_measure_qty;
+  table_.contract_multiplier[row] = def.contract_multiplier;
+  table_.underlying_id[row] = def.underlying_id;
+}
+
+void DefinitionStore::Index(std::size_t row) {
+  const std::uint32_t instrument_id = table_.instrument_id[row];
+  if (table_.raw_symbol[row] != StringPool::kEmpty) {
+    by_symbol_[table_.raw_symbol[row]] = instrument_id;
+  }
+  if (table_.underlying[row] != StringPool::kEmpty) {
+    by_underlying_[table_.underlying[row]].push_back(instrument_id);
+  }
+}
+
+void DefinitionStore::Unindex(std::size_t row) {
+  const std::uint32_t instrument_id = table_.instrument_id[row];
+  const std::uint32_t* symbol_owner = by_symbol_.Find(table_.raw_symbol[row]);
+  // Another instrument may have been defined with the symbol since
+  if (symbol_owner != nullptr && *symbol_owner == instrument_id) {
+    by_symbol_.Erase(table_.raw_symbol[row]);
+  }
+  std::vector<std::uint32_t>* instruments = by_underlying_.Find(table_.underlying[row]);
+  if (instruments != nullptr) {
+    const auto it = std::find(instruments->begin(), instruments->end(), instrument_id);
+    if (it != instruments->end()) {
+      *it = instruments->back();
+      instruments->pop_back();
+    }
+    if (instruments->empty()) {
+      by_underlying_.Erase(table_.underlying[row]);
+    }
+  }
+}
+
+void DefinitionStore::RemoveRow(std::size_t row) {
+  Unindex(row);
+  rows_.Erase(table_.instrument_id[row]);
+  const std::size_t last = table_.Size() - 1;
+  if (row != last) {
+    table_.ForEachColumn([row, last](auto& column) { column[row] = column[last]; });
+    rows_[table_.instrument_id[row]] = static_cast<std::uint32_t>(row);
+  }
+  table_.ForEachColumn([](auto& column) { column.pop_back(); });
+}
+
+}  // namespace databento_jl
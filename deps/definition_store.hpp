@@ -0,0 +1,177 @@
+#pragma once
+
+#include <databento/record.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+#include "flat_hash_map.hpp"
+#include "string_pool.hpp"
+
+namespace databento_jl {
+
+// Instrument definitions as columns: row i of every vector describes the
+// same instrument. String fields hold IDs into the store's StringPool.
+struct DefinitionTable {
+  std::vector<std::uint32_t> instrument_id;
+  std::vector<std::uint16_t> publisher_id;
+  std::vector<std::uint64_t> ts_event;
+  std::vector<std::uint64_t> ts_recv;
+  std::vector<std::uint32_t> raw_symbol;
+  std::vector<std::uint32_t> underlying;
+  std::vector<std::uint32_t> exchange;
+  std::vector<std::uint32_t> asset;
+  std::vector<std::uint32_t> cfi;
+  std::vector<std::uint32_t> security_type;
+  std::vector<std::uint32_t> currency;
+  std::vector<std::uint8_t> instrument_class;
+  std::vector<std::int64_t> strike_price;
+  std::vector<std::uint64_t> expiration;
+  std::vector<std::uint64_t> activation;
+  std::vector<std::int64_t> min_price_increment;
+  std::vector<std::int64_t> display_factor;
+  std::vector<std::int64_t> high_limit_price;
+  std::vector<std::int64_t> low_limit_price;
+  std::vector<std::int64_t> unit_of_measure_qty;
+  std::vector<std::int32_t> contract_multiplier;
+  std::vector<std::uint32_t> underlying_id;
+
+  std::size_t Size() const { return instrument_id.size(); }
+
+  // Calls `f` on every column, in declaration order
+  template <typename F>
+  void ForEachColumn(F&& f) {
+    f(instrument_id);
+    f(publisher_id);
+    f(ts_event);
+    f(ts_recv);
+    f(raw_symbol);
+    f(underlying);
+    f(exchange);
+    f(asset);
+    f(cfi);
+    f(security_type);
+    f(currency);
+    f(instrument_class);
+    f(strike_price);
+    f(expiration);
+    f(activation);
+    f(min_price_increment);
+    f(display_factor);
+    f(high_limit_price);
+    f(low_limit_price);
+    f(unit_of_measure_qty);
+    f(contract_multiplier);
+    f(underlying_id);
+  }
+};
+
+// Caller-owned destination for DefinitionStore::Export, one pointer per
+// DefinitionTable column, each with room for `capacity` rows
+struct DefinitionColumns {
+  std::size_t capacity;
+  std::uint32_t* instrument_id;
+  std::uint16_t* publisher_id;
+  std::uint64_t* ts_event;
+  std::uint64_t* ts_recv;
+  std::uint32_t* raw_symbol;
+  std::uint32_t* underlying;
+  std::uint32_t* exchange;
+  std::uint32_t* asset;
+  std::uint32_t* cfi;
+  std::uint32_t* security_type;
+  std::uint32_t* currency;
+  std::uint8_t* instrument_class;
+  std::int64_t* strike_price;
+  std::uint64_t* expiration;
+  std::uint64_t* activation;
+  std::int64_t* min_price_increment;
+  std::int64_t* display_factor;
+  std::int64_t* high_limit_price;
+  std::int64_t* low_limit_price;
+  std::int64_t* unit_of_measure_qty;
+  std::int32_t* contract_multiplier;
+  std::uint32_t* underlying_id;
+};
+
+// Latest definition of every instrument, ingested from InstrumentDefMsg
+// records into a DefinitionTable.
+//
+// The fixed-width string fields of each record are interned without
+// allocating for strings already seen, so a definition file with millions of
+// options over a few thousand underlyings holds each underlying, exchange or
+// currency once. Rows are indexed by instrument_id and raw_symbol, and the
+// instruments of each underlying are listed, all in flat hash maps.
+//
+// A definition for a known instrument_id replaces its row, whether its
+// security_update_action is Add or Modify; Delete removes the row, moving
+// the last row into its place.
+class DefinitionStore {
+ public:
+  static constexpr std::size_t kNoRow = std::numeric_limits<std::size_t>::max();
+
+  // Ingests an InstrumentDefMsg. Returns false for any other record.
+  bool Apply(const databento::Record& record);
+  void Apply(const databento::InstrumentDefMsg& def);
+
+  // Reads up to `max_records` records from `source`, applying the
+  // definitions among them. Returns the number of records read.
+  template <typename Source>
+  std::size_t Consume(Source& source, std::size_t max_records) {
+    std::size_t n = 0;
+    while (n < max_records) {
+      const databento::Record* record = source.NextRecord();
+      if (record == nullptr) {
+        break;
+      }
+      ++n;
+      Apply(*record);
+    }
+    return n;
+  }
+
+  // Row of `instrument_id`, or kNoRow
+  std::size_t FindRow(std::uint32_t instrument_id) const {
+    const std::uint32_t* row = rows_.Find(instrument_id);
+    return row == nullptr ? kNoRow : *row;
+  }
+  // Row of the instrument most recently defined with `raw_symbol`, or kNoRow
+  std::size_t FindRowBySymbol(std::string_view raw_symbol) const;
+  // Instrument IDs defined with `underlying`, in no particular order
+  std::vector<std::uint32_t> InstrumentsOf(std::string_view underlying) const;
+
+  const DefinitionTable& Table() const { return table_; }
+  const StringPool& Strings() const { return strings_; }
+  std::size_t RowCount() const { return table_.Size(); }
+
+  // Copies rows [first_row, first_row + columns.capacity) into `columns`.
+  // Returns the number of rows copied.
+  std::size_t Export(std::size_t first_row, const DefinitionColumns& columns) const;
+
+  std::uint64_t DefinitionsApplied() const { return applied_; }
+  std::uint64_t Replacements() const { return replaced_; }
+  std::uint64_t Deletions() const { return deleted_; }
+  void Clear();
+
+ private:
+  void Store(std::size_t row, const databento::InstrumentDefMsg& def);
+  void Unindex(std::size_t row);
+  void Index(std::size_t row);
+  void RemoveRow(std::size_t row);
+
+  DefinitionTable table_;
+  StringPool strings_;
+  FlatHashMap<std::uint32_t, std::uint32_t> rows_;
+  // raw_symbol string ID -> instrument_id
+  FlatHashMap<std::uint32_t, std::uint32_t> by_symbol_;
+  // underlying string ID -> instrument IDs
+  FlatHashMap<std::uint32_t, std::vector<std::uint32_t>> by_underlying_;
+  std::uint64_t applied_{};
+  std::uint64_t replaced_{};
+  std::uint64_t deleted_{};
+};
+
+}  // namespace databento_jl
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <databento/constants.hpp>
+#include <databento/record.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace databento_jl {
+
+// Dense MBP-10 depth destination for DecodeColumns.
+//
+// `depth` holds kFields values for each of the kLevels levels of each record,
+// record-major: row i, level l, field f is at
+// depth[(i * kLevels + l) * kFields + f], with the fields in BidAskPair order
+// (bid_px, ask_px, bid_sz, ask_sz, bid_ct, ask_ct). In Julia that is an
+// Array{Float64,3} of size (6, 10, N), so each record's book is one contiguous
+// block and a partly filled batch is a prefix.
+//
+// `features`, if not null, receives kFeatures derived values per level in the
+// same layout, computed in the same pass:
+//   cumulative bid size through the level, cumulative ask size through the
+//   level, level imbalance (bid_sz - ask_sz) / (bid_sz + ask_sz), and the
+//   size-weighted mid of the level (bid_px * ask_sz + ask_px * bid_sz) /
+//   (bid_sz + ask_sz).
+// Empty levels (undefined price) give NaN prices, imbalances and mids.
+struct Mbp10TensorColumns {
+  using Msg = databento::Mbp10Msg;
+
+  static constexpr std::size_t kLevels = 10;
+  static constexpr std::size_t kFields = 6;
+  static constexpr std::size_t kFeatures = 4;
+
+  std::size_t capacity;
+  std::uint64_t* ts_event;
+  std::uint64_t* ts_recv;
+  std::uint32_t* instrument_id;
+  double* depth;
+  double* features;
+  // Prices in currency units instead of raw 1e-9 fixed-point values
+  bool scale_prices;
+
+  void Store(std::size_t i, const Msg& m) const {
+    constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+    const double scale = scale_prices ? 1e-9 : 1.0;
+    ts_event[i] = m.hd.ts_event.time_since_epoch().count();
+    ts_recv[i] = m.ts_recv.time_since_epoch().count();
+    instrument_id[i] = m.hd.instrument_id;
+    double* row = depth + i * kLevels * kFields;
+    double* derived = features == nullptr ? nullptr : features + i * kLevels * kFeatures;
+    double cum_bid = 0;
+    double cum_ask = 0;
+    for (std::size_t l = 0; l < kLevels; ++l) {
+      const databento::BidAskPair& level = m.levels[l];
+      const double bid_px = level.bid_px == databento::kUndefPrice
+                                ? kNaN
+                                : static_cast<double>(level.bid_px) * scale;
+      const double ask_px = level.ask_px == databento::kUndefPrice
+                                ? kNaN
+                                : static_cast<double>(level.ask_px) * scale;
+      const double bid_sz = level.bid_sz;
+      const double ask_sz = level.ask_sz;
+      double* out = row + l * kFields;
+      out[0] = bid_px;
+      out[1] = ask_px;
+      out[2] = bid_sz;
+      out[3] = ask_sz;
+      out[4] = level.bid_ct;
+      out[5] = level.ask_ct;
+      if (derived != nullptr) {
+        cum_bid += bid_sz;
+        cum_ask += ask_sz;
+        const double total = bid_sz + ask_sz;
+        double* f = derived + l * kFeatures;
+        f[0] = cum_bid;
+        f[1] = cum_ask;
+        // 0 / 0 is NaN for a level empty on both sides
+        f[2] = (bid_sz - ask_sz) / total;
+        f[3] = (bid_px * ask_sz + ask_px * bid_sz) / total;
+      }
+    }
+  }
+};
+
+}  // namespace databento_jl
@@ -0,0 +1,321 @@
+#include "download_manager.hpp"
+
+#include <databento/constants.hpp>
+#include <databento/datetime.hpp>
+#include <databento/log.hpp>
+
+#include <signal.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace databento_jl {
+
+namespace {
+constexpr std::uint64_t kNanosPerDay = 86'400'000'000'000ULL;
+constexpr const char* kPartSuffix = ".part";
+
+databento::Historical MakeClient(const DownloadOptions& options) {
+  if (options.gateway.empty()) {
+    return databento::HistoricalBuilder{}.SetKey(options.key).Build();
+  }
+  return databento::Historical{databento::ILogReceiver::Default(), options.key,
+                               options.gateway, options.port};
+}
+
+databento::UnixNanos ToUnixNanos(std::uint64_t ts) {
+  return databento::UnixNanos{databento::UnixNanos::duration{ts}};
+}
+
+std::uint64_t Fnv1a(const std::string& text, std::uint64_t hash) {
+  for (const char c : text) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+std::uint64_t Mix(std::uint64_t x) {
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+  return x;
+}
+
+// 32 hex digits from two independently seeded hashes of `key`
+std::string Digest(const std::string& key) {
+  char hex[33];
+  std::snprintf(hex, sizeof(hex), "%016llx%016llx",
+                static_cast<unsigned long long>(Mix(Fnv1a(key, 0xcbf29ce484222325ULL))),
+                static_cast<unsigned long long>(Mix(Fnv1a(key, 0x84222325cbf29ce4ULL))));
+  return hex;
+}
+
+std::string CacheKey(const DownloadPiece& piece) {
+  std::ostringstream key;
+  key << "dataset=" << piece.dataset << "\nschema=" << databento::ToString(piece.schema)
+      << "\nstype_in=" << databento::ToString(piece.stype_in)
+      << "\nstype_out=" << databento::ToString(piece.stype_out) << "\nstart=" << piece.start
+      << "\nend=" << piece.end << "\nsymbols=";
+  for (std::size_t i = 0; i < piece.symbols.size(); ++i) {
+    key << (i == 0 ? "" : ",") << piece.symbols[i];
+  }
+  key << '\n';
+  return key.str();
+}
+
+struct HashedSymbol {
+  std::uint64_t hash;
+  std::string symbol;
+  bool operator<(const HashedSymbol& other) const {
+    return hash != other.hash ? hash < other.hash : symbol < other.symbol;
+  }
+  bool operator==(const HashedSymbol& other) const { return symbol == other.symbol; }
+};
+using HashedSymbolIt = std::vector<HashedSymbol>::const_iterator;
+
+// Splits symbols sorted by hash into batches of at most `batch` by the hash
+// bits from `bit` down, halving only the ranges that are too big. A batch is
+// then determined by the symbols sharing its hash prefix alone, so adding or
+// removing a symbol changes only its own batch and the others stay cached.
+void SplitBatches(HashedSymbolIt first, HashedSymbolIt last, int bit, std::size_t batch,
+                  std::vector<std::vector<std::string>>& batches) {
+  if (static_cast<std::size_t>(last - first) > batch && bit < 64) {
+    const std::uint64_t mask = std::uint64_t{1} << (63 - bit);
+    const auto mid = std::partition_point(
+        first, last, [mask](const HashedSymbol& symbol) { return (symbol.hash & mask) == 0; });
+    SplitBatches(first, mid, bit + 1, batch, batches);
+    SplitBatches(mid, last, bit + 1, batch, batches);
+    return;
+  }
+  // A range that fits is one batch; past the last bit only symbols with equal
+  // hashes are left, cut by position
+  for (auto it = first; it != last;) {
+    const auto end = it + static_cast<std::ptrdiff_t>(
+                              std::min<std::size_t>(batch, static_cast<std::size_t>(last - it)));
+    std::vector<std::string>& symbols = batches.emplace_back();
+    for (; it != end; ++it) {
+      symbols.push_back(it->symbol);
+    }
+    // Sorted so the same symbols in any order make the same pieces
+    std::sort(symbols.begin(), symbols.end());
+  }
+}
+
+// True when `pid`, parsed from a part file name, is no longer running
+bool PartIsAbandoned(const std::string& name) {
+  // <digest>.<pid>-<n>[.key].part
+  const std::size_t begin = name.find('.');
+  const std::size_t end = name.find('-', begin);
+  if (begin == std::string::npos || end == std::string::npos) {
+    return false;
+  }
+  char* parsed = nullptr;
+  const long pid = std::strtol(name.c_str() + begin + 1, &parsed, 10);
+  if (parsed != name.c_str() + end || pid <= 0) {
+    return false;
+  }
+  return ::kill(static_cast<::pid_t>(pid), 0) != 0 && errno == ESRCH;
+}
+}  // namespace
+
+DownloadManager::DownloadManager(DownloadOptions options) : options_{std::move(options)} {
+  if (options_.cache_dir.empty()) {
+    throw std::invalid_argument{"Download cache directory must not be empty"};
+  }
+  std::filesystem::create_directories(options_.cache_dir);
+  for (const auto& file : std::filesystem::directory_iterator{options_.cache_dir}) {
+    const std::string name = file.path().filename().string();
+    const std::size_t suffix = std::char_traits<char>::length(kPartSuffix);
+    if (name.size() > suffix && name.compare(name.size() - suffix, suffix, kPartSuffix) == 0 &&
+        PartIsAbandoned(name)) {
+      std::error_code ignored;
+      std::filesystem::remove(file.path(), ignored);
+    }
+  }
+}
+
+std::vector<DownloadPiece> DownloadManager::Plan(const DownloadRequest& request) const {
+  if (request.start >= request.end) {
+    throw std::invalid_argument{"Download range must have start < end"};
+  }
+  std::vector<std::vector<std::string>> batches;
+  if (request.symbols.empty()) {
+    batches.push_back({databento::kAllSymbols});
+  } else {
+    std::vector<HashedSymbol> symbols;
+    symbols.reserve(request.symbols.size());
+    for (const std::string& symbol : request.symbols) {
+      symbols.push_back({Mix(Fnv1a(symbol, 0xcbf29ce484222325ULL)), symbol});
+    }
+    std::sort(symbols.begin(), symbols.end());
+    symbols.erase(std::unique(symbols.begin(), symbols.end()), symbols.end());
+    SplitBatches(symbols.begin(), symbols.end(), 0,
+                 std::max<std::size_t>(options_.symbols_per_request, 1), batches);
+  }
+  std::vector<DownloadPiece> pieces;
+  std::uint64_t start = request.start;
+  while (start < request.end) {
+    std::uint64_t end = request.end;
+    if (options_.split_by_day) {
+      const std::uint64_t midnight = (start / kNanosPerDay + 1) * kNanosPerDay;
+      end = std::min(end, midnight);
+    }
+    for (const auto& symbols : batches) {
+      DownloadPiece& piece = pieces.emplace_back();
+      piece.dataset = request.dataset;
+      piece.symbols = symbols;
+      piece.schema = request.schema;
+      piece.start = start;
+      piece.end = end;
+      piece.stype_in = request.stype_in;
+      piece.stype_out = request.stype_out;
+      piece.cache_key = CacheKey(piece);
+      piece.path =
+          (std::filesystem::path{options_.cache_dir} / (Digest(piece.cache_key) + ".dbn"))
+              .string();
+    }
+    start = end;
+  }
+  return pieces;
+}
+
+bool DownloadManager::IsCached(const DownloadPiece& piece) const {
+  std::ifstream key_file{piece.path + ".key", std::ios::binary};
+  if (!key_file || !std::filesystem::exists(piece.path)) {
+    return false;
+  }
+  const std::string key{std::istreambuf_iterator<char>{key_file},
+                        std::istreambuf_iterator<char>{}};
+  return key == piece.cache_key;
+}
+
+std::vector<std::string> DownloadManager::Download(const DownloadRequest& request) {
+  const std::vector<DownloadPiece> pieces = Plan(request);
+  planned_.fetch_add(pieces.size(), std::memory_order_relaxed);
+  std::vector<std::size_t> missing;
+  for (std::size_t i = 0; i < pieces.size(); ++i) {
+    if (IsCached(pieces[i])) {
+      cache_hits_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      missing.push_back(i);
+    }
+  }
+
+  std::atomic<std::size_t> next{0};
+  std::atomic<std::size_t> completed{0};
+  std::mutex error_mutex;
+  std::exception_ptr first_error;
+  const auto work = [&] {
+    try {
+      databento::Historical client = MakeClient(options_);
+      for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < missing.size();) {
+        try {
+          Fetch(pieces[missing[i]], client);
+          completed.fetch_add(1, std::memory_order_relaxed);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock{error_mutex};
+          if (!first_error) {
+            first_error = std::current_exception();
+          }
+        }
+      }
+    } catch (...) {
+      // The client could not be created; the pieces left count as failed
+      std::lock_guard<std::mutex> lock{error_mutex};
+      if (!first_error) {
+        first_error = std::current_exception();
+      }
+    }
+  };
+  const std::size_t workers =
+      std::min(std::max<std::size_t>(options_.max_in_flight, 1), missing.size());
+  std::vector<std::thread> threads;
+  threads.reserve(workers);
+  for (std::size_t w = 0; w < workers; ++w) {
+    threads.emplace_back(work);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  const std::size_t failures = missing.size() - completed.load();
+  if (failures > 0) {
+    failed_.fetch_add(failures, std::memory_order_relaxed);
+    std::string reason = "unknown error";
+    try {
+      std::rethrow_exception(first_error);
+    } catch (const std::exception& e) {
+      reason = e.what();
+    } catch (...) {
+    }
+    throw std::runtime_error{std::to_string(failures) + " of " + std::to_string(pieces.size()) +
+                             " download pieces failed, completed ones are cached. First error: " +
+                             reason};
+  }
+  std::vector<std::string> paths;
+  paths.reserve(pieces.size());
+  for (const DownloadPiece& piece : pieces) {
+    paths.push_back(piece.path);
+  }
+  return paths;
+}
+
+void DownloadManager::Fetch(const DownloadPiece& piece, databento::Historical& client) {
+  // Unique per process and call, so concurrent downloads of the piece never
+  // share a part file
+  const std::string part = piece.path.substr(0, piece.path.size() - 4) + "." +
+                           std::to_string(::getpid()) + "-" +
+                           std::to_string(next_part_.fetch_add(1)) + kPartSuffix;
+  const std::string key_part = part.substr(0, part.size() - 5) + ".key" + kPartSuffix;
+  for (std::size_t attempt = 1;; ++attempt) {
+    try {
+      client.TimeseriesGetRangeToFile(
+          piece.dataset,
+          databento::DateTimeRange<databento::UnixNanos>{ToUnixNanos(piece.start),
+                                                         ToUnixNanos(piece.end)},
+          piece.symbols, piece.schema, piece.stype_in, piece.stype_out, 0, part);
+      {
+        std::ofstream key_file{key_part, std::ios::binary | std::ios::trunc};
+        key_file << piece.cache_key;
+        if (!key_file.flush()) {
+          throw std::runtime_error{"Failed to write " + key_part};
+        }
+      }
+      const std::uint64_t size = std::filesystem::file_size(part);
+      // The key goes first: a response in place always has its key
+      std::filesystem::rename(key_part, piece.path + ".key");
+      std::filesystem::rename(part, piece.path);
+      bytes_.fetch_add(size, std::memory_order_relaxed);
+      downloaded_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    } catch (...) {
+      std::remove(part.c_str());
+      std::remove(key_part.c_str());
+      if (attempt >= std::max<std::size_t>(options_.max_attempts, 1)) {
+        throw;
+      }
+      retries_.fetch_add(1, std::memory_order_relaxed);
+      const std::uint64_t delay_ms = options_.retry_delay_ms << std::min<std::size_t>(attempt - 1, 16);
+      std::this_thread::sleep_for(std::chrono::milliseconds{delay_ms});
+    }
+  }
+}
+
+}  // namespace databento_jl
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <databento/enums.hpp>
+#include <databento/historical.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace databento_jl {
+
+struct DownloadOptions {
+  std::string key;
+  // Empty to use the default historical gateway. A host and port can point
+  // the client at a local stand-in HTTP server in tests.
+  std::string gateway;
+  std::uint16_t port{80};
+  std::string cache_dir;
+  // Requests running at once, each on its own thread and connection
+  std::size_t max_in_flight{4};
+  // Upper bound on a batch; batches average about 70% of it
+  std::size_t symbols_per_request{500};
+  // Attempts per piece before the download fails
+  std::size_t max_attempts{3};
+  // Wait before the first retry of a piece, doubled for every further one
+  std::uint64_t retry_delay_ms{1000};
+  bool split_by_day{true};
+};
+
+struct DownloadRequest {
+  std::string dataset;
+  // Empty for all symbols
+  std::vector<std::string> symbols;
+  databento::Schema schema{databento::Schema::Trades};
+  // Nanoseconds since the UNIX epoch, end exclusive
+  std::uint64_t start{};
+  std::uint64_t end{};
+  databento::SType stype_in{databento::SType::RawSymbol};
+  databento::SType stype_out{databento::SType::InstrumentId};
+};
+
+// One timeseries request of a split download and its place in the cache
+struct DownloadPiece {
+  std::string dataset;
+  std::vector<std::string> symbols;
+  databento::Schema schema;
+  std::uint64_t start;
+  std::uint64_t end;
+  databento::SType stype_in;
+  databento::SType stype_out;
+  // Everything the response depends on, in a canonical form
+  std::string cache_key;
+  // Where the response is cached: the hex digest of cache_key + ".dbn"
+  std::string path;
+};
+
+// Historical timeseries downloads split into pieces that run concurrently
+// and are cached on disk by the request they answer.
+//
+// A request is split at UTC midnights and into symbol batches keyed on the
+// symbols' hashes, so adding a symbol to a request only changes the batch it
+// hashes into; each piece is one TimeseriesGetRangeToFile call. The response of a piece
+// is stored under the 128-bit digest of its canonical key (dataset, symbols,
+// schema, time range and symbology types) next to a .key file holding the
+// key itself, which a hit must match, so a repeated or overlapping request
+// only downloads the pieces not already cached. A piece is written to a part
+// file and renamed into place once complete: an interrupted download
+// resumes from its unfinished pieces, and concurrent downloads of the same
+// piece, even from other processes, never see partial files.
+//
+// Pieces are fetched by up to max_in_flight threads, each with its own
+// client. A failed piece is retried with exponential backoff; Download
+// throws only after every other piece has finished, so the completed ones
+// are cached for the next attempt.
+class DownloadManager {
+ public:
+  // Creates the cache directory if needed and removes part files left by
+  // processes that no longer run
+  explicit DownloadManager(DownloadOptions options);
+
+  // The pieces of `request`, by start time then symbol batch. Throws
+  // std::invalid_argument for an empty time range.
+  std::vector<DownloadPiece> Plan(const DownloadRequest& request) const;
+  // Downloads the pieces of `request` that are not cached and returns the
+  // paths of all of them in Plan order. The files hold the DBN responses as
+  // sent by the gateway, zstd-compressed or not.
+  std::vector<std::string> Download(const DownloadRequest& request);
+  bool IsCached(const DownloadPiece& piece) const;
+
+  const DownloadOptions& Options() const { return options_; }
+  std::uint64_t PiecesPlanned() const { return planned_.load(std::memory_order_relaxed); }
+  std::uint64_t CacheHits() const { return cache_hits_.load(std::memory_order_relaxed); }
+  std::uint64_t PiecesDownloaded() const { return downloaded_.load(std::memory_order_relaxed); }
+  // Failed attempts that were retried
+  std::uint64_t Retries() const { return retries_.load(std::memory_order_relaxed); }
+  std::uint64_t PiecesFailed() const { return failed_.load(std::memory_order_relaxed); }
+  std::uint64_t BytesDownloaded() const { return bytes_.load(std::memory_order_relaxed); }
+
+ private:
+  // Downloads `piece` into the cache, retrying; rethrows the last error
+  void Fetch(const DownloadPiece& piece, databento::Historical& client);
+
+  const DownloadOptions options_;
+  std::atomic<std::uint64_t> next_part_{};
+  std::atomic<std::uint64_t> planned_{};
+  std::atomic<std::uint64_t> cache_hits_{};
+  std::atomic<std::uint64_t> downloaded_{};
+  std::atomic<std::uint64_t> retries_{};
+  std::atomic<std::uint64_t> failed_{};
+  std::atomic<std::uint64_t> bytes_{};
+};
+
+}  // namespace databento_jl
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace databento_jl {
+
+// Open-addressing hash map for integer keys such as order IDs and instrument
+// IDs. Entries live in one contiguous array probed linearly, so lookups touch
+// one or two cache lines instead of chasing std::unordered_map nodes.
+// Deletion uses backward shifting, so there are no tombstones to degrade
+// probe lengths over a long replay.
+//
+// Pointers returned by Find and TryEmplace are invalidated by any insertion
+// or erasure.
+template <typename K, typename V>
+class FlatHashMap {
+  static_assert(std::is_integral<K>::value, "FlatHashMap keys must be integers");
+
+ public:
+  explicit FlatHashMap(std::size_t initial_capacity = 16) {
+    std::size_t capacity = 16;
+    while (capacity < initial_capacity * 2) {
+      capacity *= 2;
+    }
+    slots_.resize(capacity);
+  }
+
+  std::size_t Size() const { return size_; }
+  bool Empty() const { return size_ == 0; }
+
+  V* Find(K key) {
+    for (std::size_t i = Home(key);; i = Next(i)) {
+      Slot& slot = slots_[i];
+      if (!slot.used) {
+        return nullptr;
+      }
+      if (slot.key == key) {
+        return &slot.value;
+      }
+    }
+  }
+  const V* Find(K key) const {
+    return const_cast<FlatHashMap*>(this)->Find(key);
+  }
+
+  // Inserts `value` under `key` unless the key is present. Returns the
+  // stored value and whether an insertion took place.
+  std::pair<V*, bool> TryEmplace(K key, V value) {
+    // Keep the load factor at or below 3/4
+    if ((size_ + 1) * 4 > slots_.size() * 3) {
+      Rehash(slots_.size() * 2);
+    }
+    for (std::size_t i = Home(key);; i = Next(i)) {
+      Slot& slot = slots_[i];
+      if (!slot.used) {
+        slot.used = true;
+        slot.key = key;
+        slot.value = std::move(value);
+        ++size_;
+        return {&slot.value, true};
+      }
+      if (slot.key == key) {
+        return {&slot.value, false};
+      }
+    }
+  }
+
+  V& operator[](K key) { return *TryEmplace(key, V{}).first; }
+
+  bool Erase(K key) {
+    std::size_t i = Home(key);
+    while (true) {
+      if (!slots_[i].used) {
+        return false;
+      }
+      if (slots_[i].key == key) {
+        break;
+      }
+      i = Next(i);
+    }
+    // Shift later members of the probe run back into the hole
+    std::size_t hole = i;
+    for (std::size_t j = Next(hole);; j = Next(j)) {
+      Slot& slot = slots_[j];
+      if (!slot.used) {
+        break;
+      }
+      const std::size_t home = Home(slot.key);
+      // Move the entry if its home is not cyclically within (hole, j]
+      const bool in_range =
+          hole <= j ? (hole < home && home <= j) : (hole < home || home <= j);
+      if (!in_range) {
+        slots_[hole] = std::move(slot);
+        hole = j;
+      }
+    }
+    slots_[hole].used = false;
+    slots_[hole].value = V{};
+    --size_;
+    return true;
+  }
+
+  void Clear() {
+    for (Slot& slot : slots_) {
+      slot = Slot{};
+    }
+    size_ = 0;
+  }
+
+  template <typename F>
+  void ForEach(F&& f) const {
+    for (const Slot& slot : slots_) {
+      if (slot.used) {
+        f(slot.key, slot.value);
+      }
+    }
+  }
+  template <typename F>
+  void ForEach(F&& f) {
+    for (Slot& slot : slots_) {
+      if (slot.used) {
+        f(slot.key, slot.value);
+      }
+    }
+  }
+
+ private:
+  struct Slot {
+    K key{};
+    bool used{};
+    V value{};
+  };
+
+  static std::uint64_t Mix(std::uint64_t x) {
+    // splitmix64 finalizer: sequential IDs spread across the table
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+  }
+  std::size_t Home(K key) const {
+    return static_cast<std::size_t>(Mix(static_cast<std::uint64_t>(key))) &
+           (slots_.size() - 1);
+  }
+  std::size_t Next(std::size_t i) const { return (i + 1) & (slots_.size() - 1); }
+
+  void Rehash(std::size_t capacity) {
+    std::vector<Slot> old = std::move(slots_);
+    slots_.clear();
+    slots_.resize(capacity);
+    size_ = 0;
+    for (Slot& slot : old) {
+      if (slot.used) {
+        TryEmplace(slot.key, std::move(slot.value));
+      }
+    }
+  }
+
+  std::vector<Slot> slots_;
+  std::size_t size_{};
+};
+
+}  // namespace databento_jl
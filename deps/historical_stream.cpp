@@ -0,0 +1,129 @@
+#include "historical_stream.hpp"
+
+#include <databento/datetime.hpp>
+#include <databento/log.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace databento_jl {
+
+namespace {
+databento::Historical MakeClient(const HistoricalStreamOptions& options) {
+  if (options.gateway.empty()) {
+    return databento::HistoricalBuilder{}.SetKey(options.key).Build();
+  }
+  return databento::Historical{databento::ILogReceiver::Default(), options.key,
+                               options.gateway, options.port};
+}
+}  // namespace
+
+HistoricalStream::HistoricalStream(const HistoricalStreamOptions& options)
+    : client_{MakeClient(options)},
+      block_bytes_{std::max<std::size_t>(options.block_bytes, 1)},
+      queue_{options.buffer_count},
+      latency_{options.feed_latency ? std::make_unique<FeedLatency>() : nullptr},
+      producer_{&HistoricalStream::ProducerLoop, this, options} {}
+
+HistoricalStream::~HistoricalStream() {
+  stopping_.store(true, std::memory_order_release);
+  queue_.Stop();
+  producer_.join();
+}
+
+void HistoricalStream::ProducerLoop(HistoricalStreamOptions options) {
+  RecordBlock* block = queue_.AcquireFree();
+  if (block == nullptr) {
+    return;
+  }
+  bool ts_out = false;
+  try {
+    client_.TimeseriesGetRange(
+        options.dataset, databento::DateTimeRange<std::string>{options.start, options.end},
+        options.symbols, options.schema, options.stype_in, options.stype_out, options.limit,
+        [this, &ts_out](databento::Metadata&& metadata) {
+          ts_out = metadata.ts_out;
+          SetMetadata(std::move(metadata));
+        },
+        [this, &block, &ts_out](const databento::Record& record) {
+          if (stopping_.load(std::memory_order_acquire)) {
+            return databento::KeepGoing::Stop;
+          }
+          received_.fetch_add(1, std::memory_order_relaxed);
+          bytes_received_.fetch_add(record.Size(), std::memory_order_relaxed);
+          if (latency_ != nullptr) {
+            latency_->Record(record, ts_out);
+          }
+          block->Append(record);
+          if (block->bytes.size() >= block_bytes_) {
+            queue_.Publish(false);
+            block = nullptr;
+            block = queue_.AcquireFree();
+            if (block == nullptr) {
+              return databento::KeepGoing::Stop;
+            }
+          }
+          return databento::KeepGoing::Continue;
+        });
+  } catch (...) {
+    FailMetadata(std::current_exception());
+    if (block != nullptr) {
+      // The records received before the error are delivered ahead of it
+      queue_.Publish(false);
+    }
+    queue_.Fail(std::current_exception());
+    return;
+  }
+  // No-op once the header arrived
+  FailMetadata(std::make_exception_ptr(
+      std::runtime_error{"Historical response ended before its DBN header"}));
+  if (block != nullptr) {
+    // Records of a partial block, and the end of the stream
+    queue_.Publish(true);
+  }
+}
+
+void HistoricalStream::SetMetadata(databento::Metadata&& metadata) {
+  {
+    std::lock_guard<std::mutex> lock{metadata_mutex_};
+    metadata_ = std::move(metadata);
+    has_metadata_ = true;
+  }
+  metadata_ready_.notify_all();
+}
+
+void HistoricalStream::FailMetadata(std::exception_ptr error) {
+  {
+    std::lock_guard<std::mutex> lock{metadata_mutex_};
+    if (has_metadata_) {
+      return;
+    }
+    metadata_error_ = std::move(error);
+  }
+  metadata_ready_.notify_all();
+}
+
+const databento::Metadata& HistoricalStream::GetMetadata() {
+  std::unique_lock<std::mutex> lock{metadata_mutex_};
+  metadata_ready_.wait(lock, [&] { return has_metadata_ || metadata_error_; });
+  if (!has_metadata_) {
+    std::rethrow_exception(metadata_error_);
+  }
+  return metadata_;
+}
+
+const databento::Record* HistoricalStream::NextRecord() {
+  if (current_ == nullptr || current_->next >= current_->Size()) {
+    current_ = queue_.NextFilled();
+    if (current_ == nullptr) {
+      return nullptr;
+    }
+  }
+  current_record_ = current_->RecordAt(current_->next++);
+  ++records_delivered_;
+  return &current_record_;
+}
+
+}  // namespace databento_jl
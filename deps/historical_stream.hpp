@@ -0,0 +1,117 @@
+#pragma once
+
+#include <databento/dbn.hpp>
+#include <databento/enums.hpp>
+#include <databento/historical.hpp>
+#include <databento/record.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "block_queue.hpp"
+#include "pipeline_stats.hpp"
+#include "record_block.hpp"
+
+namespace databento_jl {
+
+struct HistoricalStreamOptions {
+  std::string key;
+  // Empty to use the default historical gateway. A host and port can point
+  // the client at a local stand-in HTTP server in tests.
+  std::string gateway;
+  std::uint16_t port{80};
+  std::string dataset;
+  std::vector<std::string> symbols;
+  databento::Schema schema{databento::Schema::Trades};
+  std::string start;
+  std::string end;
+  databento::SType stype_in{databento::SType::RawSymbol};
+  databento::SType stype_out{databento::SType::InstrumentId};
+  // 0 for no limit
+  std::uint64_t limit{};
+  std::size_t buffer_count{4};
+  std::size_t block_bytes{1 << 20};
+  // Build feed latency histograms of the records as they arrive
+  bool feed_latency{};
+};
+
+// Historical timeseries request decoded as the response arrives, without
+// writing it to disk.
+//
+// A background thread runs the client's callback-based TimeseriesGetRange,
+// which decodes records from each HTTP chunk as it is received, and packs
+// them into a ring of `buffer_count` blocks of about `block_bytes` bytes. The
+// consumer iterates them through NextRecord like a file reader. Memory stays
+// bounded by the ring: when it is full the callback waits, which stops
+// reading from the connection until the consumer catches up.
+class HistoricalStream {
+ public:
+  explicit HistoricalStream(const HistoricalStreamOptions& options);
+  HistoricalStream(const HistoricalStream&) = delete;
+  HistoricalStream& operator=(const HistoricalStream&) = delete;
+  // Abandons the request at the next record received; waits for the
+  // background thread, so it can block while the server sends nothing
+  ~HistoricalStream();
+
+  // Waits for the DBN header of the response. Throws the request's error if
+  // it failed before the header arrived.
+  const databento::Metadata& GetMetadata();
+  // Returns the next record, or nullptr at the end of the response. Rethrows
+  // the request's error after the records received before it. The record is
+  // valid until the next call.
+  const databento::Record* NextRecord();
+
+  std::size_t BufferCount() const { return queue_.BlockCount(); }
+  std::size_t BlockBytes() const { return block_bytes_; }
+  // Nanoseconds the request thread spent waiting for a free block
+  std::uint64_t ProducerStallNs() const { return queue_.ProducerStallNs(); }
+  // Nanoseconds NextRecord spent waiting for records to arrive
+  std::uint64_t ConsumerStallNs() const { return queue_.ConsumerStallNs(); }
+  std::uint64_t BlocksFilled() const { return queue_.BlocksFilled(); }
+  std::uint64_t RecordsReceived() const { return received_.load(std::memory_order_relaxed); }
+  std::uint64_t RecordsDelivered() const { return records_delivered_; }
+  // DBN bytes of the records received so far
+  std::uint64_t BytesReceived() const { return bytes_received_.load(std::memory_order_relaxed); }
+  std::uint64_t RecordsFiltered() const { return records_filtered_; }
+  // Called by FilteredSource for every record its filter rejects
+  void NoteFiltered() { ++records_filtered_; }
+  // Recorded on the request thread; nullptr unless `feed_latency` was set
+  const FeedLatency* Latency() const { return latency_.get(); }
+
+ private:
+  void ProducerLoop(HistoricalStreamOptions options);
+  void SetMetadata(databento::Metadata&& metadata);
+  void FailMetadata(std::exception_ptr error);
+
+  databento::Historical client_;
+  const std::size_t block_bytes_;
+  BlockQueue queue_;
+  std::atomic<bool> stopping_{};
+  std::atomic<std::uint64_t> received_{};
+  std::atomic<std::uint64_t> bytes_received_{};
+  const std::unique_ptr<FeedLatency> latency_;
+
+  std::mutex metadata_mutex_;
+  std::condition_variable metadata_ready_;
+  bool has_metadata_{};
+  databento::Metadata metadata_{};
+  std::exception_ptr metadata_error_;
+
+  // Owned by the consuming thread
+  RecordBlock* current_{};
+  databento::Record current_record_{nullptr};
+  std::uint64_t records_delivered_{};
+  std::uint64_t records_filtered_{};
+
+  std::thread producer_;
+};
+
+}  // namespace databento_jl
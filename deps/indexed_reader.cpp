@@ -0,0 +1,284 @@
+#include "indexed_reader.hpp"
+
+#include <databento/constants.hpp>
+#include <databento/dbn_decoder.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace databento_jl {
+
+namespace {
+// "DBN" + version byte followed by the little-endian metadata length
+constexpr std::size_t kPreludeSize = 8;
+constexpr std::size_t kReadChunk = 1 << 20;
+// Reads after a jump start small and double, so a seek into a short block
+// does not pull in a full chunk
+constexpr std::size_t kFirstRead = 64 << 10;
+constexpr std::uint64_t kNoBlockEnd = std::numeric_limits<std::uint64_t>::max();
+}  // namespace
+
+IndexedDbnReader::IndexedDbnReader(const std::string& dbn_path,
+                                   const std::string& index_path)
+    : IndexedDbnReader{dbn_path, TsIndex::Load(index_path), index_path} {}
+
+IndexedDbnReader::IndexedDbnReader(const std::string& dbn_path, TsIndex index)
+    : IndexedDbnReader{dbn_path, std::move(index), "The timestamp index"} {}
+
+IndexedDbnReader::IndexedDbnReader(const std::string& dbn_path, TsIndex index,
+                                   const std::string& index_name)
+    : file_{dbn_path}, index_{std::move(index)} {
+  if (index_.source_size != file_.Size() || index_.source_mtime_ns != file_.MtimeNs()) {
+    throw std::invalid_argument{index_name + " was not built from the current " +
+                                dbn_path + "; rebuild the timestamp index"};
+  }
+  if (index_.dbn_version != databento::kDbnVersion) {
+    throw std::invalid_argument{
+        dbn_path + " is DBN version " + std::to_string(index_.dbn_version) +
+        "; IndexedDbnReader requires version " +
+        std::to_string(databento::kDbnVersion) +
+        ", use DbnFileStore to upgrade records while reading"};
+  }
+  if (index_.compressed) {
+    dctx_.reset(ZSTD_createDCtx());
+    in_.resize(kReadChunk);
+  }
+  out_.resize(kReadChunk);
+  read_size_ = kFirstRead;
+
+  // Decode the metadata from the start of the stream, then position the
+  // reader at the first block
+  if (!Fill(kPreludeSize)) {
+    throw std::runtime_error{dbn_path + " ends before its metadata header"};
+  }
+  const auto [version, metadata_size] =
+      databento::DbnDecoder::DecodeMetadataVersionAndSize(out_.data(), out_size_);
+  if (!Fill(kPreludeSize + metadata_size)) {
+    throw std::runtime_error{dbn_path + " has a truncated metadata header"};
+  }
+  const std::byte* metadata_begin = out_.data() + kPreludeSize;
+  metadata_ = databento::DbnDecoder::DecodeMetadataFields(
+      version, metadata_begin, metadata_begin + metadata_size);
+  if (index_.blocks.empty()) {
+    exhausted_ = true;
+  } else {
+    JumpToBlock(0);
+  }
+}
+
+const databento::Record* IndexedDbnReader::NextRecord() {
+  if (peeked_) {
+    peeked_ = false;
+    return &record_;
+  }
+  if (exhausted_) {
+    return nullptr;
+  }
+  if (cursor_ >= block_end_ && !AdvanceBlock()) {
+    return nullptr;
+  }
+  if (!Fill(sizeof(databento::RecordHeader))) {
+    exhausted_ = true;
+    return nullptr;
+  }
+  databento::RecordHeader header;
+  std::memcpy(&header, out_.data() + (cursor_ - out_base_), sizeof(header));
+  const std::size_t length = header.Size();
+  if (length < sizeof(databento::RecordHeader)) {
+    throw std::runtime_error{"Invalid record length at DBN offset " +
+                             std::to_string(cursor_) + " of " + file_.Path()};
+  }
+  if (!Fill(length)) {
+    // A partially-written trailing record is ignored, like a truncated stream
+    exhausted_ = true;
+    return nullptr;
+  }
+  const std::byte* data = out_.data() + (cursor_ - out_base_);
+  if (reinterpret_cast<std::uintptr_t>(data) % alignof(std::uint64_t) != 0) {
+    aligned_.resize((length + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t));
+    std::memcpy(aligned_.data(), data, length);
+    data = reinterpret_cast<const std::byte*>(aligned_.data());
+  }
+  cursor_ += length;
+  record_ = databento::Record{
+      reinterpret_cast<databento::RecordHeader*>(const_cast<std::byte*>(data))};
+  return &record_;
+}
+
+void IndexedDbnReader::Seek(std::uint64_t ts) {
+  visit_ = visit_end_ = nullptr;
+  peeked_ = false;
+  exhausted_ = false;
+  const std::size_t block = index_.FindBlock(ts);
+  if (block == index_.blocks.size()) {
+    exhausted_ = true;
+    return;
+  }
+  JumpToBlock(block);
+  while (const databento::Record* record = NextRecord()) {
+    if (static_cast<std::uint64_t>(
+            record->Header().ts_event.time_since_epoch().count()) >= ts) {
+      peeked_ = true;
+      return;
+    }
+  }
+}
+
+void IndexedDbnReader::Seek(std::uint64_t ts, std::uint32_t instrument_id) {
+  if (!index_.HasInstrumentPostings()) {
+    throw std::invalid_argument{"Timestamp index for " + file_.Path() +
+                                " was built without instrument postings"};
+  }
+  peeked_ = false;
+  exhausted_ = false;
+  const auto [first, last] = index_.BlocksFor(instrument_id);
+  const std::uint32_t start = static_cast<std::uint32_t>(index_.FindBlock(ts));
+  visit_ = std::lower_bound(first, last, start);
+  visit_end_ = last;
+  if (visit_ == visit_end_) {
+    exhausted_ = true;
+    return;
+  }
+  JumpToBlock(*visit_);
+  while (const databento::Record* record = NextRecord()) {
+    const databento::RecordHeader& header = record->Header();
+    if (header.instrument_id == instrument_id &&
+        static_cast<std::uint64_t>(header.ts_event.time_since_epoch().count()) >= ts) {
+      peeked_ = true;
+      return;
+    }
+  }
+}
+
+void IndexedDbnReader::ReadBlock(std::size_t block, RecordBlock& out) {
+  if (block >= index_.blocks.size()) {
+    throw std::out_of_range{file_.Path() + " has no index block " + std::to_string(block)};
+  }
+  out.Clear();
+  const bool follows = !exhausted_ && !peeked_ && visit_ == nullptr && block == block_ + 1 &&
+                       cursor_ == block_end_;
+  visit_ = visit_end_ = nullptr;
+  peeked_ = false;
+  exhausted_ = false;
+  if (follows) {
+    AdvanceBlock();
+  } else {
+    JumpToBlock(block);
+  }
+  while (cursor_ < block_end_) {
+    const databento::Record* record = NextRecord();
+    if (record == nullptr) {
+      break;
+    }
+    out.Append(*record);
+  }
+}
+
+void IndexedDbnReader::JumpToBlock(std::size_t block) {
+  const TsIndexBlock& entry = index_.blocks[block];
+  block_ = block;
+  block_end_ = block + 1 < index_.blocks.size() ? index_.blocks[block + 1].record_offset
+                                                : kNoBlockEnd;
+  file_pos_ = entry.file_offset;
+  in_pos_ = in_size_ = 0;
+  input_done_ = false;
+  read_size_ = kFirstRead;
+  out_base_ = entry.data_offset;
+  out_size_ = 0;
+  eof_ = false;
+  // Bytes of a record straddling the frame boundary are decoded and skipped
+  cursor_ = entry.record_offset;
+  if (dctx_) {
+    ZSTD_DCtx_reset(dctx_.get(), ZSTD_reset_session_only);
+  }
+}
+
+bool IndexedDbnReader::AdvanceBlock() {
+  if (visit_ == nullptr) {
+    ++block_;
+    block_end_ = block_ + 1 < index_.blocks.size()
+                     ? index_.blocks[block_ + 1].record_offset
+                     : kNoBlockEnd;
+    return true;
+  }
+  if (++visit_ == visit_end_) {
+    exhausted_ = true;
+    return false;
+  }
+  if (*visit_ == block_ + 1) {
+    // The next listed block follows on directly, keep streaming
+    ++block_;
+    block_end_ = block_ + 1 < index_.blocks.size()
+                     ? index_.blocks[block_ + 1].record_offset
+                     : kNoBlockEnd;
+  } else {
+    JumpToBlock(*visit_);
+  }
+  return true;
+}
+
+bool IndexedDbnReader::Fill(std::size_t n) {
+  while (out_base_ + out_size_ < cursor_ + n) {
+    if (eof_) {
+      return false;
+    }
+    if (cursor_ >= out_base_ + out_size_) {
+      // Nothing buffered is needed any more
+      out_base_ += out_size_;
+      out_size_ = 0;
+    } else if (cursor_ > out_base_) {
+      // Keep the partial record, moved to the (aligned) start of the buffer
+      const std::size_t offset = static_cast<std::size_t>(cursor_ - out_base_);
+      std::memmove(out_.data(), out_.data() + offset, out_size_ - offset);
+      out_size_ -= offset;
+      out_base_ = cursor_;
+    }
+    if (out_.size() - out_size_ < kReadChunk / 2) {
+      out_.resize(std::max(out_.size() * 2, out_size_ + kReadChunk));
+    }
+    Produce();
+  }
+  return true;
+}
+
+void IndexedDbnReader::Produce() {
+  std::byte* dest = out_.data() + out_size_;
+  const std::size_t room = out_.size() - out_size_;
+  const std::size_t read_size = read_size_;
+  read_size_ = std::min(read_size_ * 2, kReadChunk);
+  if (!dctx_) {
+    const std::size_t got = file_.ReadAt(dest, std::min(room, read_size), file_pos_);
+    if (got == 0) {
+      eof_ = true;
+    }
+    file_pos_ += got;
+    bytes_read_ += got;
+    out_size_ += got;
+    return;
+  }
+  if (in_pos_ == in_size_ && !input_done_) {
+    in_size_ = file_.ReadAt(in_.data(), read_size, file_pos_);
+    in_pos_ = 0;
+    input_done_ = in_size_ == 0;
+    file_pos_ += in_size_;
+    bytes_read_ += in_size_;
+  }
+  ZSTD_inBuffer input{in_.data(), in_size_, in_pos_};
+  ZSTD_outBuffer output{dest, room, 0};
+  const std::size_t ret = ZSTD_decompressStream(dctx_.get(), &output, &input);
+  if (ZSTD_isError(ret)) {
+    throw std::runtime_error{"Failed to decompress " + file_.Path() + ": " +
+                             ZSTD_getErrorName(ret)};
+  }
+  in_pos_ = input.pos;
+  out_size_ += output.pos;
+  if (output.pos == 0 && input_done_) {
+    eof_ = true;
+  }
+}
+
+}  // namespace databento_jl
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <databento/dbn.hpp>
+#include <databento/record.hpp>
+
+#include <zstd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "posix_file.hpp"
+#include "record_block.hpp"
+#include "ts_index.hpp"
+
+namespace databento_jl {
+
+// DBN reader that can seek by timestamp using a sidecar TsIndex.
+//
+// Seek jumps straight to the first index block that can hold the requested
+// ts_event and only decompresses from there, so an intraday slice of a
+// full-day file costs a few blocks of I/O instead of a scan from the start.
+// With instrument postings in the index, a seek can also be restricted to
+// the blocks holding one instrument; records of other instruments within
+// those blocks are still returned, so pair it with a RecordFilter to drop
+// them.
+//
+// Like MmapDbnReader, records are returned as stored and only files in the
+// current DBN version are accepted.
+class IndexedDbnReader {
+ public:
+  // Throws std::invalid_argument if the index was built from a different or
+  // since modified file
+  IndexedDbnReader(const std::string& dbn_path, const std::string& index_path);
+  // Reads with an index already in memory, e.g. one built by BuildTsIndex
+  // without saving it
+  IndexedDbnReader(const std::string& dbn_path, TsIndex index);
+  IndexedDbnReader(const IndexedDbnReader&) = delete;
+  IndexedDbnReader& operator=(const IndexedDbnReader&) = delete;
+
+  const databento::Metadata& GetMetadata() const { return metadata_; }
+  const TsIndex& Index() const { return index_; }
+
+  // Returns the next record, or nullptr at the end of the file. The record
+  // is valid until the next call.
+  const databento::Record* NextRecord();
+
+  // Positions the reader at the first record in file order with
+  // ts_event >= ts
+  void Seek(std::uint64_t ts);
+  // Positions the reader at the first record of `instrument_id` with
+  // ts_event >= ts and restricts further reading to the blocks that hold
+  // the instrument, until the next Seek. Throws std::invalid_argument if
+  // the index has no instrument postings.
+  void Seek(std::uint64_t ts, std::uint32_t instrument_id);
+  void Rewind() { Seek(0); }
+
+  // Clears `out` and fills it with every record of index block `block`,
+  // leaving the reader positioned at the start of the next block. Reading
+  // blocks in order streams on without restarting the decompressor.
+  void ReadBlock(std::size_t block, RecordBlock& out);
+
+  // Block holding the next record
+  std::size_t CurrentBlock() const { return block_; }
+  // File bytes read since opening, to compare against a full scan
+  std::uint64_t BytesRead() const { return bytes_read_; }
+
+ private:
+  struct DCtxDeleter {
+    void operator()(ZSTD_DCtx* dctx) const { ZSTD_freeDCtx(dctx); }
+  };
+
+  IndexedDbnReader(const std::string& dbn_path, TsIndex index, const std::string& index_name);
+
+  // Restarts decoding at the beginning of `block`
+  void JumpToBlock(std::size_t block);
+  // Moves on once the cursor has passed the last record of the current block
+  bool AdvanceBlock();
+  // Makes `n` bytes from the cursor available in the buffer. Returns false
+  // at the end of the file.
+  bool Fill(std::size_t n);
+  // Decodes more of the file into the buffer
+  void Produce();
+
+  PosixFile file_;
+  TsIndex index_;
+  databento::Metadata metadata_{};
+  std::unique_ptr<ZSTD_DCtx, DCtxDeleter> dctx_;
+
+  // Compressed input not yet consumed
+  std::vector<std::byte> in_;
+  std::size_t in_pos_{};
+  std::size_t in_size_{};
+  bool input_done_{};
+  std::uint64_t file_pos_{};
+  std::size_t read_size_{};
+  // Decompressed bytes [out_base_, out_base_ + out_size_) of the DBN stream
+  std::vector<std::byte> out_;
+  std::uint64_t out_base_{};
+  std::size_t out_size_{};
+  bool eof_{};
+  // Stream offset of the next record
+  std::uint64_t cursor_{};
+
+  std::size_t block_{};
+  // Stream offset at which the next block's records begin
+  std::uint64_t block_end_{};
+  // Blocks still to visit after a Seek restricted to one instrument
+  const std::uint32_t* visit_{};
+  const std::uint32_t* visit_end_{};
+  bool exhausted_{};
+
+  databento::Record record_{nullptr};
+  // The record at record_ is returned again by the next NextRecord call
+  bool peeked_{};
+  // Copy of a record whose offset in the buffer is not 8-byte aligned
+  std::vector<std::uint64_t> aligned_;
+  std::uint64_t bytes_read_{};
+};
+
+}  // namespace databento_jl
@@ -0,0 +1,129 @@
+#include "live_client.hpp"
+
+#include <databento/live.hpp>
+
+#include <chrono>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace databento_jl {
+
+LiveRingClient::LiveRingClient(const LiveRingOptions& options)
+    : block_when_full_{options.block_when_full},
+      ring_{options.capacity, options.slot_bytes} {
+  databento::LiveBuilder builder;
+  builder.SetKey(options.key).SetDataset(options.dataset).SetSendTsOut(options.send_ts_out);
+  if (!options.gateway.empty()) {
+    builder.SetAddress(options.gateway, options.port);
+  }
+  // Connects and authenticates
+  client_.emplace(builder.BuildThreaded());
+}
+
+LiveRingClient::~LiveRingClient() { Stop(); }
+
+void LiveRingClient::Subscribe(const std::vector<std::string>& symbols,
+                               databento::Schema schema, databento::SType stype_in) {
+  if (!client_) {
+    throw std::logic_error{"Live session has been stopped"};
+  }
+  client_->Subscribe(symbols, schema, stype_in);
+}
+
+void LiveRingClient::Start() {
+  if (!client_) {
+    throw std::logic_error{"Live session has been stopped"};
+  }
+  client_->Start(
+      [this](databento::Metadata&& metadata) {
+        {
+          const std::lock_guard<std::mutex> lock{mutex_};
+          metadata_ = std::move(metadata);
+        }
+        has_metadata_.store(true, std::memory_order_release);
+      },
+      [this](const databento::Record& record) { return OnRecord(record); },
+      [this](const std::exception& exc) {
+        {
+          const std::lock_guard<std::mutex> lock{mutex_};
+          last_error_ = exc.what();
+        }
+        finished_.store(true, std::memory_order_release);
+        return databento::LiveThreaded::ExceptionAction::Stop;
+      });
+}
+
+void LiveRingClient::Stop() {
+  stop_requested_.store(true, std::memory_order_release);
+  // Destroying the client closes the connection and joins its thread
+  client_.reset();
+  finished_.store(true, std::memory_order_release);
+}
+
+databento::KeepGoing LiveRingClient::OnRecord(const databento::Record& record) {
+  received_.fetch_add(1, std::memory_order_relaxed);
+  auto result = ring_.TryPush(record);
+  if (result == SpscRecordRing::PushResult::Full && block_when_full_) {
+    backpressure_events_.fetch_add(1, std::memory_order_relaxed);
+    const auto start = std::chrono::steady_clock::now();
+    while (result == SpscRecordRing::PushResult::Full &&
+           !stop_requested_.load(std::memory_order_acquire)) {
+      std::this_thread::yield();
+      result = ring_.TryPush(record);
+    }
+    backpressure_ns_.fetch_add(
+        static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                       std::chrono::steady_clock::now() - start)
+                                       .count()),
+        std::memory_order_relaxed);
+  }
+  switch (result) {
+    case SpscRecordRing::PushResult::Ok: {
+      const std::size_t buffered = ring_.Size();
+      if (buffered > high_water_.load(std::memory_order_relaxed)) {
+        high_water_.store(buffered, std::memory_order_relaxed);
+      }
+      break;
+    }
+    case SpscRecordRing::PushResult::Full:
+      overruns_.fetch_add(1, std::memory_order_relaxed);
+      break;
+    case SpscRecordRing::PushResult::Oversize:
+      oversize_.fetch_add(1, std::memory_order_relaxed);
+      break;
+  }
+  return stop_requested_.load(std::memory_order_acquire) ? databento::KeepGoing::Stop
+                                                         : databento::KeepGoing::Continue;
+}
+
+const databento::Record* LiveRingClient::NextRecord() {
+  // The previous record's slot is released only now, so it stays valid
+  // until this call
+  if (holding_) {
+    ring_.Pop();
+    holding_ = false;
+  }
+  const databento::Record* record = ring_.Front();
+  if (record != nullptr) {
+    holding_ = true;
+    ++delivered_;
+  }
+  return record;
+}
+
+databento::Metadata LiveRingClient::GetMetadata() const {
+  if (!HasMetadata()) {
+    throw std::logic_error{"Live session has not received metadata yet"};
+  }
+  const std::lock_guard<std::mutex> lock{mutex_};
+  return metadata_;
+}
+
+std::string LiveRingClient::LastError() const {
+  const std::lock_guard<std::mutex> lock{mutex_};
+  return last_error_;
+}
+
+}  // namespace databento_jl
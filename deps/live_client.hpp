@@ -0,0 +1,108 @@
+#pragma once
+
+#include <databento/dbn.hpp>
+#include <databento/enums.hpp>
+#include <databento/live_threaded.hpp>
+#include <databento/record.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "spsc_ring.hpp"
+
+namespace databento_jl {
+
+struct LiveRingOptions {
+  std::string key;
+  std::string dataset;
+  // Empty to use the dataset's default gateway. A host and port can point
+  // the client at a local stand-in gateway in tests.
+  std::string gateway;
+  std::uint16_t port{13000};
+  bool send_ts_out{};
+  std::size_t capacity{1 << 16};
+  std::size_t slot_bytes{512};
+  // When the ring is full, wait for the consumer (backpressure on the
+  // gateway connection) instead of dropping the record (overrun)
+  bool block_when_full{};
+};
+
+// databento::LiveThreaded whose receive thread hands records to the consumer
+// through a lock-free SPSC ring.
+//
+// The client's callback copies every record into the next fixed-size ring
+// slot; the consuming thread drains it through NextRecord, which never
+// blocks and returns nullptr when the ring is momentarily empty, so batch
+// decoders return a short batch instead of waiting. Records larger than a
+// slot are dropped and counted.
+class LiveRingClient {
+ public:
+  explicit LiveRingClient(const LiveRingOptions& options);
+  LiveRingClient(const LiveRingClient&) = delete;
+  LiveRingClient& operator=(const LiveRingClient&) = delete;
+  ~LiveRingClient();
+
+  void Subscribe(const std::vector<std::string>& symbols, databento::Schema schema,
+                 databento::SType stype_in);
+  void Start();
+  // Ends the session and joins the receive thread. Records already in the
+  // ring can still be drained.
+  void Stop();
+
+  // Consumer side. The record is valid until the next call.
+  const databento::Record* NextRecord();
+  bool HasMetadata() const { return has_metadata_.load(std::memory_order_acquire); }
+  // A copy, since a reconnect replaces the metadata from the receive thread.
+  // Throws std::logic_error before the gateway has sent the metadata
+  databento::Metadata GetMetadata() const;
+  // True once the session ended, by Stop or an error
+  bool IsFinished() const { return finished_.load(std::memory_order_acquire); }
+  std::string LastError() const;
+
+  std::size_t Capacity() const { return ring_.Capacity(); }
+  std::size_t SlotBytes() const { return ring_.SlotBytes(); }
+  std::size_t Buffered() const { return ring_.Size(); }
+  std::uint64_t RecordsReceived() const { return received_.load(std::memory_order_relaxed); }
+  std::uint64_t RecordsDelivered() const { return delivered_; }
+  // Records dropped because the ring was full
+  std::uint64_t Overruns() const { return overruns_.load(std::memory_order_relaxed); }
+  // Records dropped because they did not fit in a slot
+  std::uint64_t OversizeDrops() const { return oversize_.load(std::memory_order_relaxed); }
+  // Times and total nanoseconds the receive thread waited on a full ring
+  std::uint64_t BackpressureEvents() const { return backpressure_events_.load(std::memory_order_relaxed); }
+  std::uint64_t BackpressureNs() const { return backpressure_ns_.load(std::memory_order_relaxed); }
+  std::size_t HighWaterMark() const { return high_water_.load(std::memory_order_relaxed); }
+
+ private:
+  databento::KeepGoing OnRecord(const databento::Record& record);
+
+  const bool block_when_full_;
+  SpscRecordRing ring_;
+  std::optional<databento::LiveThreaded> client_;
+
+  mutable std::mutex mutex_;
+  databento::Metadata metadata_{};
+  std::string last_error_;
+  std::atomic<bool> has_metadata_{};
+  std::atomic<bool> finished_{};
+  std::atomic<bool> stop_requested_{};
+
+  // Written by the receive thread
+  std::atomic<std::uint64_t> received_{};
+  std::atomic<std::uint64_t> overruns_{};
+  std::atomic<std::uint64_t> oversize_{};
+  std::atomic<std::uint64_t> backpressure_events_{};
+  std::atomic<std::uint64_t> backpressure_ns_{};
+  std::atomic<std::size_t> high_water_{};
+
+  // Owned by the consuming thread
+  bool holding_{};
+  std::uint64_t delivered_{};
+};
+
+}  // namespace databento_jl
@@ -0,0 +1,137 @@
+#include "mmap_reader.hpp"
+
+#include <databento/constants.hpp>
+#include <databento/dbn_decoder.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+namespace databento_jl {
+
+namespace {
+// "DBN" + version byte followed by the little-endian metadata length
+constexpr std::size_t kPreludeSize = 8;
+constexpr std::uint32_t kZstdMagic = 0xFD2FB528;
+}  // namespace
+
+MmapDbnReader::MmapDbnReader(const std::string& file_path) : path_{file_path} {
+  const int fd = ::open(file_path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::system_error{errno, std::generic_category(),
+                            "Failed to open " + file_path};
+  }
+  struct stat st {};
+  if (::fstat(fd, &st) != 0) {
+    const int err = errno;
+    ::close(fd);
+    throw std::system_error{err, std::generic_category(),
+                            "Failed to stat " + file_path};
+  }
+  size_ = static_cast<std::size_t>(st.st_size);
+  if (size_ < kPreludeSize) {
+    ::close(fd);
+    throw std::runtime_error{file_path + " is too small to be a DBN file"};
+  }
+  void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  const int err = errno;
+  // The mapping keeps its own reference to the file
+  ::close(fd);
+  if (addr == MAP_FAILED) {
+    throw std::system_error{err, std::generic_category(),
+                            "Failed to mmap " + file_path};
+  }
+  data_ = static_cast<std::byte*>(addr);
+
+  try {
+    std::uint32_t magic;
+    std::memcpy(&magic, data_, sizeof(magic));
+    if (magic == kZstdMagic) {
+      throw std::invalid_argument{
+          file_path +
+          " is zstd-compressed; MmapDbnReader only maps uncompressed DBN, "
+          "use DbnFileStore instead"};
+    }
+    const auto [version, metadata_size] =
+        databento::DbnDecoder::DecodeMetadataVersionAndSize(data_, size_);
+    if (version != databento::kDbnVersion) {
+      throw std::invalid_argument{
+          file_path + " is DBN version " + std::to_string(version) +
+          "; MmapDbnReader requires version " +
+          std::to_string(databento::kDbnVersion) +
+          ", use DbnFileStore to upgrade records while reading"};
+    }
+    const std::byte* metadata_begin = data_ + kPreludeSize;
+    if (metadata_size > size_ - kPreludeSize) {
+      throw std::runtime_error{file_path + " has a truncated metadata header"};
+    }
+    metadata_ = databento::DbnDecoder::DecodeMetadataFields(
+        version, metadata_begin, metadata_begin + metadata_size);
+    body_ = metadata_begin + metadata_size;
+    BuildRecordTable();
+  } catch (...) {
+    ::munmap(data_, size_);
+    throw;
+  }
+}
+
+MmapDbnReader::~MmapDbnReader() { ::munmap(data_, size_); }
+
+void MmapDbnReader::BuildRecordTable() {
+  const std::byte* const end = data_ + size_;
+  const std::byte* pos = body_;
+  std::size_t first_length = 0;
+  databento::RType first_rtype{};
+  while (static_cast<std::size_t>(end - pos) >= sizeof(databento::RecordHeader)) {
+    auto* header =
+        reinterpret_cast<databento::RecordHeader*>(const_cast<std::byte*>(pos));
+    const std::size_t length = header->Size();
+    if (length < sizeof(databento::RecordHeader) ||
+        length > static_cast<std::size_t>(end - pos)) {
+      // A partially-written trailing record is ignored, like a truncated stream
+      break;
+    }
+    if (records_.empty()) {
+      first_length = length;
+      first_rtype = header->rtype;
+    } else if (length != first_length || header->rtype != first_rtype) {
+      is_uniform_ = false;
+    }
+    records_.emplace_back(header);
+    pos += length;
+  }
+  stride_ = first_length;
+}
+
+const databento::Record& MmapDbnReader::RecordAt(std::size_t index) const {
+  if (index >= records_.size()) {
+    throw std::out_of_range{"Record index " + std::to_string(index) +
+                            " out of range for " + path_ + " with " +
+                            std::to_string(records_.size()) + " records"};
+  }
+  return records_[index];
+}
+
+const databento::Record* MmapDbnReader::NextRecord() {
+  if (cursor_ >= records_.size()) {
+    return nullptr;
+  }
+  return &records_[cursor_++];
+}
+
+void MmapDbnReader::Seek(std::size_t index) {
+  if (index > records_.size()) {
+    throw std::out_of_range{"Cannot seek to record " + std::to_string(index) +
+                            " in " + path_ + " with " +
+                            std::to_string(records_.size()) + " records"};
+  }
+  cursor_ = index;
+}
+
+}  // namespace databento_jl
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <databento/dbn.hpp>
+#include <databento/record.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace databento_jl {
+
+// Zero-copy reader for uncompressed DBN files.
+//
+// The file is memory-mapped read-only, the Metadata header is decoded once and
+// a table with one databento::Record per record is built in a single pass over
+// the record headers. Every Record and typed message pointer handed out refers
+// directly into the mapped pages and stays valid for the lifetime of the
+// reader, so random access and repeated scans cost no copies and no syscalls.
+//
+// Only files in the current DBN version are accepted: records are viewed in
+// place and cannot be upgraded. Use databento::DbnFileStore for older versions
+// and for zstd-compressed files.
+class MmapDbnReader {
+ public:
+  explicit MmapDbnReader(const std::string& file_path);
+  MmapDbnReader(const MmapDbnReader&) = delete;
+  MmapDbnReader& operator=(const MmapDbnReader&) = delete;
+  ~MmapDbnReader();
+
+  const databento::Metadata& GetMetadata() const { return metadata_; }
+  std::size_t RecordCount() const { return records_.size(); }
+  std::size_t FileSize() const { return size_; }
+
+  // Random access. Throws std::out_of_range for an invalid index.
+  const databento::Record& RecordAt(std::size_t index) const;
+  template <typename T>
+  const T* GetIf(std::size_t index) const {
+    return RecordAt(index).GetIf<T>();
+  }
+
+  // Sequential cursor so the reader can stand in for DbnFileStore. Returns
+  // nullptr once all records have been visited.
+  const databento::Record* NextRecord();
+  void Rewind() { cursor_ = 0; }
+  void Seek(std::size_t index);
+  std::size_t Position() const { return cursor_; }
+
+  // True when every record has the same rtype and length, in which case the
+  // body is a dense array of RecordStride()-byte records starting at Data().
+  bool IsUniform() const { return is_uniform_; }
+  std::size_t RecordStride() const { return is_uniform_ ? stride_ : 0; }
+  const std::byte* Data() const { return body_; }
+
+ private:
+  void BuildRecordTable();
+
+  std::string path_;
+  std::byte* data_{};
+  std::size_t size_{};
+  const std::byte* body_{};
+  databento::Metadata metadata_{};
+  std::vector<databento::Record> records_;
+  std::size_t cursor_{};
+  bool is_uniform_{true};
+  std::size_t stride_{};
+};
+
+}  // namespace databento_jl
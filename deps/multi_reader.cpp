@@ -0,0 +1,183 @@
+#include "multi_reader.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace databento_jl {
+
+namespace {
+constexpr std::size_t kNoFile = std::numeric_limits<std::size_t>::max();
+}  // namespace
+
+MultiDbnReader::MultiDbnReader(const std::vector<std::string>& file_paths,
+                               std::size_t num_threads,
+                               std::size_t block_records,
+                               std::size_t max_blocks_per_file)
+    : block_records_{std::max<std::size_t>(block_records, 1)},
+      max_blocks_per_file_{std::max<std::size_t>(max_blocks_per_file, 1)},
+      files_(file_paths.size()),
+      pending_file_{kNoFile},
+      current_file_{kNoFile} {
+  // Open every file up front so bad paths and corrupt headers throw here
+  for (std::size_t i = 0; i < file_paths.size(); ++i) {
+    files_[i].store = std::make_unique<databento::DbnFileStore>(file_paths[i]);
+    files_[i].metadata = files_[i].store->GetMetadata();
+  }
+  if (num_threads == 0) {
+    num_threads = std::max(1U, std::thread::hardware_concurrency());
+  }
+  num_workers_ = std::min(num_threads, files_.size());
+  workers_.reserve(num_workers_);
+  for (std::size_t w = 0; w < num_workers_; ++w) {
+    workers_.emplace_back(&MultiDbnReader::WorkerLoop, this, w);
+  }
+}
+
+MultiDbnReader::~MultiDbnReader() {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    stopping_ = true;
+  }
+  slot_free_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+const databento::Metadata& MultiDbnReader::GetMetadata(
+    std::size_t file_index) const {
+  if (file_index >= files_.size()) {
+    throw std::out_of_range{"File index " + std::to_string(file_index) +
+                            " out of range for " +
+                            std::to_string(files_.size()) + " files"};
+  }
+  return files_[file_index].metadata;
+}
+
+void MultiDbnReader::WorkerLoop(std::size_t worker_index) {
+  // Worker w owns files w, w + stride, w + 2 * stride, ...
+  const std::size_t stride = num_workers_;
+  std::size_t cursor = worker_index;
+  while (true) {
+    std::size_t index = kNoFile;
+    std::unique_ptr<Block> block;
+    {
+      std::unique_lock<std::mutex> lock{mutex_};
+      // Pick the next owned file, round-robin, that still has room queued
+      slot_free_.wait(lock, [&] {
+        if (stopping_) {
+          return true;
+        }
+        bool any_open = false;
+        for (std::size_t n = 0; n < files_.size(); n += stride) {
+          std::size_t i = cursor;
+          cursor += stride;
+          if (cursor >= files_.size()) {
+            cursor = worker_index;
+          }
+          if (files_[i].done) {
+            continue;
+          }
+          any_open = true;
+          if (files_[i].ready.size() < max_blocks_per_file_) {
+            index = i;
+            return true;
+          }
+        }
+        // Nothing left to decode for this worker
+        return !any_open;
+      });
+      if (index == kNoFile) {
+        return;
+      }
+      if (free_blocks_.empty()) {
+        block = std::make_unique<Block>();
+      } else {
+        block = std::move(free_blocks_.back());
+        free_blocks_.pop_back();
+      }
+    }
+
+    bool more = true;
+    try {
+      more = FillBlock(*files_[index].store, *block, block_records_,
+                       std::numeric_limits<std::size_t>::max());
+    } catch (...) {
+      std::lock_guard<std::mutex> lock{mutex_};
+      if (!worker_error_) {
+        worker_error_ = std::current_exception();
+      }
+      files_[index].done = true;
+      block_ready_.notify_all();
+      continue;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      File& file = files_[index];
+      if (!more) {
+        file.done = true;
+      }
+      if (block->Empty()) {
+        free_blocks_.push_back(std::move(block));
+      } else {
+        file.ready.push_back(std::move(block));
+      }
+    }
+    block_ready_.notify_all();
+  }
+}
+
+bool MultiDbnReader::Advance(std::size_t index) {
+  File& file = files_[index];
+  if (file.current && file.current->next + 1 < file.current->Size()) {
+    ++file.current->next;
+  } else {
+    std::unique_lock<std::mutex> lock{mutex_};
+    if (file.current) {
+      free_blocks_.push_back(std::move(file.current));
+    }
+    block_ready_.wait(lock, [&] {
+      return !file.ready.empty() || file.done || worker_error_;
+    });
+    if (worker_error_) {
+      std::rethrow_exception(worker_error_);
+    }
+    if (file.ready.empty()) {
+      return false;
+    }
+    file.current = std::move(file.ready.front());
+    file.ready.pop_front();
+    lock.unlock();
+    slot_free_.notify_all();
+  }
+  heap_.emplace(file.current->index_ts[file.current->next], index);
+  return true;
+}
+
+const databento::Record* MultiDbnReader::NextRecord() {
+  if (!started_) {
+    started_ = true;
+    for (std::size_t i = 0; i < files_.size(); ++i) {
+      Advance(i);
+    }
+  } else if (pending_file_ != kNoFile) {
+    // Advance lazily so the record returned last time stays valid until now
+    Advance(pending_file_);
+  }
+  pending_file_ = kNoFile;
+  if (heap_.empty()) {
+    return nullptr;
+  }
+  const std::size_t index = heap_.top().second;
+  heap_.pop();
+  Block& block = *files_[index].current;
+  current_record_ = block.RecordAt(block.next);
+  pending_file_ = index;
+  current_file_ = index;
+  ++records_merged_;
+  return &current_record_;
+}
+
+}  // namespace databento_jl
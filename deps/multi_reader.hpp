@@ -0,0 +1,91 @@
+#pragma once
+
+#include <databento/dbn.hpp>
+#include <databento/dbn_file_store.hpp>
+#include <databento/record.hpp>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "record_block.hpp"
+
+namespace databento_jl {
+
+// Replays several DBN files as one stream ordered by index timestamp.
+//
+// Each file is decoded (and decompressed) by a worker thread into blocks of
+// copied records; files are distributed round-robin over the pool. The
+// consuming thread only performs a k-way heap merge over the head record of
+// each file, with ties broken by file order so the output is deterministic.
+// Records within a file keep their on-disk order.
+class MultiDbnReader {
+ public:
+  MultiDbnReader(const std::vector<std::string>& file_paths,
+                 std::size_t num_threads, std::size_t block_records,
+                 std::size_t max_blocks_per_file);
+  MultiDbnReader(const MultiDbnReader&) = delete;
+  MultiDbnReader& operator=(const MultiDbnReader&) = delete;
+  ~MultiDbnReader();
+
+  std::size_t FileCount() const { return files_.size(); }
+  std::size_t ThreadCount() const { return num_workers_; }
+  const databento::Metadata& GetMetadata(std::size_t file_index) const;
+
+  // Returns the next record in merged order, or nullptr once every file is
+  // exhausted. The record is valid until the next call.
+  const databento::Record* NextRecord();
+  // Index of the file the last record returned by NextRecord came from.
+  std::size_t CurrentFileIndex() const { return current_file_; }
+  std::uint64_t RecordsMerged() const { return records_merged_; }
+
+ private:
+  using Block = RecordBlock;
+  struct File {
+    std::unique_ptr<databento::DbnFileStore> store;
+    databento::Metadata metadata;
+    // Guarded by mutex_
+    std::deque<std::unique_ptr<Block>> ready;
+    bool done{};
+    // Owned by the consuming thread
+    std::unique_ptr<Block> current;
+  };
+  // (index_ts, file index); min-heap ordering gives stable ties by file
+  using HeapEntry = std::pair<std::uint64_t, std::size_t>;
+
+  void WorkerLoop(std::size_t worker_index);
+  // Moves file `index` to its next record, fetching a new block if needed,
+  // and pushes the new head onto the heap. Returns false at end of file.
+  bool Advance(std::size_t index);
+
+  const std::size_t block_records_;
+  const std::size_t max_blocks_per_file_;
+  std::vector<File> files_;
+  std::size_t num_workers_{};
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable block_ready_;
+  std::condition_variable slot_free_;
+  std::vector<std::unique_ptr<Block>> free_blocks_;
+  std::exception_ptr worker_error_;
+  bool stopping_{};
+
+  std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<>> heap_;
+  bool started_{};
+  std::size_t pending_file_;
+  std::size_t current_file_;
+  databento::Record current_record_{nullptr};
+  std::uint64_t records_merged_{};
+};
+
+}  // namespace databento_jl
@@ -0,0 +1,284 @@
+#include "order_book.hpp"
+
+#include <databento/constants.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace databento_jl {
+namespace {
+std::uint32_t SaturatedSize(std::uint64_t size) {
+  return static_cast<std::uint32_t>(
+      std::min<std::uint64_t>(size, std::numeric_limits<std::uint32_t>::max()));
+}
+}  // namespace
+
+void OrderBook::Apply(const databento::MboMsg& mbo) {
+  switch (mbo.action) {
+    case databento::Action::Clear:
+      Clear();
+      break;
+    case databento::Action::Add:
+      Add(mbo);
+      break;
+    case databento::Action::Cancel:
+      Cancel(mbo);
+      break;
+    case databento::Action::Modify:
+      Modify(mbo);
+      break;
+    default:
+      // Trade, Fill and None don't change the book: fills are followed by
+      // the cancels or modifies that reduce the resting orders
+      break;
+  }
+  consistent_ = mbo.flags.IsLast();
+  // Every snapshot record carries IsSnapshot; the final one also IsLast
+  in_snapshot_ = mbo.flags.IsSnapshot() && !mbo.flags.IsLast();
+}
+
+void OrderBook::Clear() {
+  bids_.clear();
+  asks_.clear();
+  nodes_.clear();
+  free_nodes_.clear();
+  orders_.Clear();
+}
+
+databento::BidAskPair OrderBook::Depth(std::size_t depth) const {
+  databento::BidAskPair pair{databento::kUndefPrice, databento::kUndefPrice, 0, 0, 0, 0};
+  if (const PriceLevel* bid = LevelAt(databento::Side::Bid, depth)) {
+    pair.bid_px = bid->price;
+    pair.bid_sz = SaturatedSize(bid->size);
+    pair.bid_ct = bid->count;
+  }
+  if (const PriceLevel* ask = LevelAt(databento::Side::Ask, depth)) {
+    pair.ask_px = ask->price;
+    pair.ask_sz = SaturatedSize(ask->size);
+    pair.ask_ct = ask->count;
+  }
+  return pair;
+}
+
+std::size_t OrderBook::LevelCount(databento::Side side) const {
+  if (side != databento::Side::Bid && side != databento::Side::Ask) {
+    return 0;
+  }
+  return Levels(side).size();
+}
+
+const PriceLevel* OrderBook::LevelAt(databento::Side side,
+                                     std::size_t depth) const {
+  if (depth >= LevelCount(side)) {
+    return nullptr;
+  }
+  const std::vector<PriceLevel>& levels = Levels(side);
+  return &levels[levels.size() - 1 - depth];
+}
+
+bool OrderBook::QueuePosition(std::uint64_t order_id,
+                              std::uint32_t* orders_ahead,
+                              std::uint64_t* size_ahead) const {
+  const std::uint32_t* index = orders_.Find(order_id);
+  if (index == nullptr) {
+    return false;
+  }
+  std::uint32_t count = 0;
+  std::uint64_t size = 0;
+  for (std::uint32_t i = nodes_[*index].prev; i != kNil; i = nodes_[i].prev) {
+    ++count;
+    size += nodes_[i].size;
+  }
+  *orders_ahead = count;
+  *size_ahead = size;
+  return true;
+}
+
+std::size_t OrderBook::LevelIndex(databento::Side side,
+                                  std::int64_t price) const {
+  const std::vector<PriceLevel>& levels = Levels(side);
+  const auto it =
+      side == databento::Side::Bid
+          ? std::lower_bound(levels.begin(), levels.end(), price,
+                             [](const PriceLevel& level, std::int64_t px) {
+                               return level.price < px;
+                             })
+          : std::lower_bound(levels.begin(), levels.end(), price,
+                             [](const PriceLevel& level, std::int64_t px) {
+                               return level.price > px;
+                             });
+  return static_cast<std::size_t>(it - levels.begin());
+}
+
+PriceLevel& OrderBook::GetOrInsertLevel(databento::Side side,
+                                        std::int64_t price) {
+  std::vector<PriceLevel>& levels = Levels(side);
+  const std::size_t index = LevelIndex(side, price);
+  if (index == levels.size() || levels[index].price != price) {
+    levels.insert(levels.begin() + static_cast<std::ptrdiff_t>(index),
+                  PriceLevel{price, 0, 0, kNil, kNil});
+  }
+  return levels[index];
+}
+
+void OrderBook::Add(const databento::MboMsg& mbo) {
+  if (mbo.side != databento::Side::Bid && mbo.side != databento::Side::Ask) {
+    return;
+  }
+  if (mbo.flags.IsTob()) {
+    // Top-of-book publishers send the whole side as one record; an undefined
+    // price means the side is empty
+    ClearSide(mbo.side);
+    if (mbo.price == databento::kUndefPrice) {
+      return;
+    }
+  }
+  if (const std::uint32_t* existing = orders_.Find(mbo.order_id)) {
+    // A repeated order ID replaces the previous order
+    RemoveOrder(*existing);
+  }
+  const std::uint32_t index = AllocateNode();
+  nodes_[index] = Node{mbo.order_id, mbo.price, mbo.size, mbo.side, kNil, kNil};
+  LinkBack(GetOrInsertLevel(mbo.side, mbo.price), index);
+  orders_.TryEmplace(mbo.order_id, index);
+}
+
+void OrderBook::Cancel(const databento::MboMsg& mbo) {
+  const std::uint32_t* found = orders_.Find(mbo.order_id);
+  if (found == nullptr) {
+    ++unknown_orders_;
+    return;
+  }
+  const std::uint32_t index = *found;
+  Node& node = nodes_[index];
+  const std::uint32_t removed = std::min(mbo.size, node.size);
+  if (removed == node.size) {
+    RemoveOrder(index);
+    return;
+  }
+  node.size -= removed;
+  std::vector<PriceLevel>& levels = Levels(node.side);
+  levels[LevelIndex(node.side, node.price)].size -= removed;
+}
+
+void OrderBook::Modify(const databento::MboMsg& mbo) {
+  const std::uint32_t* found = orders_.Find(mbo.order_id);
+  if (found == nullptr) {
+    // Modifies for orders we haven't seen (e.g. joining mid-session) add them
+    ++unknown_orders_;
+    Add(mbo);
+    return;
+  }
+  const std::uint32_t index = *found;
+  Node& node = nodes_[index];
+  if (node.price != mbo.price || node.side != mbo.side) {
+    // Price changes lose priority: re-add at the back of the new level
+    RemoveOrder(index);
+    Add(mbo);
+    return;
+  }
+  if (mbo.size == 0) {
+    RemoveOrder(index);
+    return;
+  }
+  std::vector<PriceLevel>& levels = Levels(node.side);
+  PriceLevel& level = levels[LevelIndex(node.side, node.price)];
+  if (mbo.size > node.size) {
+    // Size increases lose priority within the level
+    Unlink(level, index);
+    level.size -= node.size;
+    node.size = mbo.size;
+    LinkBack(level, index);
+  } else {
+    level.size -= node.size - mbo.size;
+    node.size = mbo.size;
+  }
+}
+
+void OrderBook::ClearSide(databento::Side side) {
+  for (const PriceLevel& level : Levels(side)) {
+    for (std::uint32_t i = level.head; i != kNil;) {
+      const std::uint32_t next = nodes_[i].next;
+      orders_.Erase(nodes_[i].order_id);
+      free_nodes_.push_back(i);
+      i = next;
+    }
+  }
+  Levels(side).clear();
+}
+
+std::uint32_t OrderBook::AllocateNode() {
+  if (!free_nodes_.empty()) {
+    const std::uint32_t index = free_nodes_.back();
+    free_nodes_.pop_back();
+    return index;
+  }
+  nodes_.emplace_back();
+  return static_cast<std::uint32_t>(nodes_.size() - 1);
+}
+
+void OrderBook::LinkBack(PriceLevel& level, std::uint32_t index) {
+  Node& node = nodes_[index];
+  node.prev = level.tail;
+  node.next = kNil;
+  if (level.tail == kNil) {
+    level.head = index;
+  } else {
+    nodes_[level.tail].next = index;
+  }
+  level.tail = index;
+  level.size += node.size;
+  ++level.count;
+}
+
+void OrderBook::Unlink(PriceLevel& level, std::uint32_t index) {
+  Node& node = nodes_[index];
+  if (node.prev == kNil) {
+    level.head = node.next;
+  } else {
+    nodes_[node.prev].next = node.next;
+  }
+  if (node.next == kNil) {
+    level.tail = node.prev;
+  } else {
+    nodes_[node.next].prev = node.prev;
+  }
+  --level.count;
+}
+
+void OrderBook::RemoveOrder(std::uint32_t index) {
+  const Node node = nodes_[index];
+  std::vector<PriceLevel>& levels = Levels(node.side);
+  const std::size_t level_index = LevelIndex(node.side, node.price);
+  PriceLevel& level = levels[level_index];
+  Unlink(level, index);
+  level.size -= node.size;
+  if (level.count == 0) {
+    levels.erase(levels.begin() + static_cast<std::ptrdiff_t>(level_index));
+  }
+  orders_.Erase(node.order_id);
+  free_nodes_.push_back(index);
+}
+
+void OrderBookEngine::Apply(const databento::MboMsg& mbo) {
+  const std::uint32_t instrument_id = mbo.hd.instrument_id;
+  const auto [index, inserted] = index_.TryEmplace(
+      instrument_id, static_cast<std::uint32_t>(books_.size()));
+  if (inserted) {
+    books_.push_back(std::make_unique<OrderBook>());
+    instrument_ids_.push_back(instrument_id);
+  }
+  books_[*index]->Apply(mbo);
+  ++records_applied_;
+}
+
+const OrderBook* OrderBookEngine::Find(std::uint32_t instrument_id) const {
+  const std::uint32_t* index = index_.Find(instrument_id);
+  return index == nullptr ? nullptr : books_[*index].get();
+}
+
+std::vector<std::uint32_t> OrderBookEngine::InstrumentIds() const {
+  return instrument_ids_;
+}
+
+}  // namespace databento_jl
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <databento/enums.hpp>
+#include <databento/record.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "flat_hash_map.hpp"
+
+namespace databento_jl {
+
+// Aggregated state of one price level. Orders at the level form a FIFO queue
+// threaded through the owning OrderBook's node pool.
+struct PriceLevel {
+  std::int64_t price;
+  // Total resting size; wider than an order's size so it cannot overflow
+  std::uint64_t size;
+  std::uint32_t count;
+  std::uint32_t head;
+  std::uint32_t tail;
+};
+
+// A resting order as seen from outside the book.
+struct BookOrder {
+  std::uint64_t order_id;
+  std::int64_t price;
+  std::uint32_t size;
+  databento::Side side;
+};
+
+// Full-depth (L3) book for a single instrument, maintained from MboMsg.
+//
+// Each side is a vector of price levels sorted so the best level is at the
+// back: updates cluster near the top of the book, which keeps insertions and
+// erasures cheap and the hot levels in cache. Orders live in a pooled node
+// array linked into per-level FIFO queues and are indexed by order ID in a
+// flat hash map.
+//
+// The book follows Databento's MBO semantics: Add inserts an order, Cancel
+// removes `size` from it, Modify changes price and/or size (losing queue
+// priority on a price change or size increase), Clear empties the book, and
+// Trade and Fill leave it untouched. A top-of-book Add (FlagSet::IsTob)
+// replaces its whole side. The book is consistent only after a record with
+// FlagSet::IsLast, see IsConsistent().
+class OrderBook {
+ public:
+  static constexpr std::uint32_t kNil = std::numeric_limits<std::uint32_t>::max();
+
+  void Apply(const databento::MboMsg& mbo);
+  void Clear();
+
+  // Best bid and offer; absent sides report kUndefPrice with zero size
+  databento::BidAskPair Bbo() const { return Depth(0); }
+  // Aggregated bid and ask at `depth` levels from the top (0 = best). Sizes
+  // above what BidAskPair's 32-bit fields hold saturate at UINT32_MAX.
+  databento::BidAskPair Depth(std::size_t depth) const;
+  std::size_t LevelCount(databento::Side side) const;
+  const PriceLevel* LevelAt(databento::Side side, std::size_t depth) const;
+  std::size_t OrderCount() const { return orders_.Size(); }
+  bool HasOrder(std::uint64_t order_id) const {
+    return orders_.Find(order_id) != nullptr;
+  }
+  // Orders and size queued ahead of `order_id` at its price level. Returns
+  // false if the order is not in the book.
+  bool QueuePosition(std::uint64_t order_id, std::uint32_t* orders_ahead,
+                     std::uint64_t* size_ahead) const;
+
+  // Visits every resting order on `side`, best level first and in queue
+  // priority within a level.
+  template <typename F>
+  void ForEachOrder(databento::Side side, F&& f) const {
+    const std::vector<PriceLevel>& levels = Levels(side);
+    for (auto level = levels.rbegin(); level != levels.rend(); ++level) {
+      for (std::uint32_t i = level->head; i != kNil; i = nodes_[i].next) {
+        const Node& node = nodes_[i];
+        f(BookOrder{node.order_id, node.price, node.size, node.side});
+      }
+    }
+  }
+
+  // True when the last applied record ended an event (FlagSet::IsLast)
+  bool IsConsistent() const { return consistent_; }
+  // True while replaying the snapshot that follows a Clear
+  bool InSnapshot() const { return in_snapshot_; }
+  std::uint64_t UnknownOrderCount() const { return unknown_orders_; }
+
+ private:
+  struct Node {
+    std::uint64_t order_id;
+    std::int64_t price;
+    std::uint32_t size;
+    databento::Side side;
+    std::uint32_t prev;
+    std::uint32_t next;
+  };
+
+  std::vector<PriceLevel>& Levels(databento::Side side) {
+    return side == databento::Side::Bid ? bids_ : asks_;
+  }
+  const std::vector<PriceLevel>& Levels(databento::Side side) const {
+    return side == databento::Side::Bid ? bids_ : asks_;
+  }
+  // Index of the level at `price`, or of the position where it belongs
+  std::size_t LevelIndex(databento::Side side, std::int64_t price) const;
+  PriceLevel& GetOrInsertLevel(databento::Side side, std::int64_t price);
+
+  void Add(const databento::MboMsg& mbo);
+  void Cancel(const databento::MboMsg& mbo);
+  void Modify(const databento::MboMsg& mbo);
+  void ClearSide(databento::Side side);
+
+  std::uint32_t AllocateNode();
+  void LinkBack(PriceLevel& level, std::uint32_t index);
+  void Unlink(PriceLevel& level, std::uint32_t index);
+  // Unlinks the order and frees its node, erasing the level if it empties
+  void RemoveOrder(std::uint32_t index);
+
+  // Sorted so the best price is at the back: bids ascending, asks descending
+  std::vector<PriceLevel> bids_;
+  std::vector<PriceLevel> asks_;
+  std::vector<Node> nodes_;
+  std::vector<std::uint32_t> free_nodes_;
+  FlatHashMap<std::uint64_t, std::uint32_t> orders_;
+  bool consistent_{true};
+  bool in_snapshot_{};
+  std::uint64_t unknown_orders_{};
+};
+
+// Order books for every instrument in an MBO stream, keyed by instrument_id.
+class OrderBookEngine {
+ public:
+  void Apply(const databento::MboMsg& mbo);
+  // Applies MBO records from `source` until it is exhausted or `max_records`
+  // records have been read. Other record types are skipped. Returns the
+  // number of records read.
+  template <typename Source>
+  std::size_t Consume(Source& source, std::size_t max_records) {
+    std::size_t n = 0;
+    while (n < max_records) {
+      const databento::Record* record = source.NextRecord();
+      if (record == nullptr) {
+        break;
+      }
+      ++n;
+      if (const auto* mbo = record->GetIf<databento::MboMsg>()) {
+        Apply(*mbo);
+      }
+    }
+    return n;
+  }
+
+  std::size_t BookCount() const { return books_.size(); }
+  // nullptr if no record for `instrument_id` has been applied
+  const OrderBook* Find(std::uint32_t instrument_id) const;
+  std::vector<std::uint32_t> InstrumentIds() const;
+  std::uint64_t RecordsApplied() const { return records_applied_; }
+
+ private:
+  FlatHashMap<std::uint32_t, std::uint32_t> index_;
+  std::vector<std::unique_ptr<OrderBook>> books_;
+  std::vector<std::uint32_t> instrument_ids_;
+  std::uint64_t records_applied_{};
+};
+
+}  // namespace databento_jl
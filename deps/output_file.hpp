@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+namespace databento_jl {
+
+// Write-only file that is built at `path` + ".tmp" and moved to `path` by
+// Commit, so a failed or abandoned writer never leaves a truncated file
+// behind and readers never see a partially-written one. Every writer and
+// cache file here saves through it. Tracks the write position for formats
+// with offset tables.
+class OutputFile {
+ public:
+  explicit OutputFile(const std::string& path) : path_{path}, tmp_path_{path + ".tmp"} {
+    file_ = std::fopen(tmp_path_.c_str(), "wb");
+    if (file_ == nullptr) {
+      throw std::system_error{errno, std::generic_category(), "Failed to create " + tmp_path_};
+    }
+  }
+  OutputFile(const OutputFile&) = delete;
+  OutputFile& operator=(const OutputFile&) = delete;
+  // Discards the output unless Commit succeeded
+  ~OutputFile() { Discard(); }
+
+  const std::string& Path() const { return path_; }
+  bool IsOpen() const { return file_ != nullptr; }
+  std::uint64_t Position() const { return position_; }
+
+  void Write(const void* data, std::size_t size) {
+    if (file_ == nullptr) {
+      throw std::logic_error{"Output " + path_ + " is closed"};
+    }
+    if (size != 0 && std::fwrite(data, 1, size, file_) != size) {
+      throw std::system_error{errno, std::generic_category(), "Failed to write " + tmp_path_};
+    }
+    position_ += size;
+  }
+  template <typename T>
+  void WritePod(const T& value) {
+    Write(&value, sizeof(T));
+  }
+  // Writes zero bytes up to the next multiple of `alignment`
+  void Pad(std::size_t alignment) {
+    static constexpr char kZeros[64]{};
+    Write(kZeros, static_cast<std::size_t>((alignment - position_ % alignment) % alignment));
+  }
+
+  void Commit() {
+    if (file_ == nullptr) {
+      throw std::logic_error{"Output " + path_ + " is closed"};
+    }
+    const int status = std::fclose(file_);
+    file_ = nullptr;
+    if (status != 0) {
+      const int err = errno;
+      std::remove(tmp_path_.c_str());
+      throw std::system_error{err, std::generic_category(), "Failed to write " + tmp_path_};
+    }
+    if (std::rename(tmp_path_.c_str(), path_.c_str()) != 0) {
+      std::remove(tmp_path_.c_str());
+      throw std::runtime_error{"Failed to move output to " + path_};
+    }
+  }
+  // Closes and removes the temporary file; a no-op once committed
+  void Discard() {
+    if (file_ != nullptr) {
+      std::fclose(file_);
+      file_ = nullptr;
+      std::remove(tmp_path_.c_str());
+    }
+  }
+
+ private:
+  std::string path_;
+  std::string tmp_path_;
+  std::FILE* file_{};
+  std::uint64_t position_{};
+};
+
+}  // namespace databento_jl
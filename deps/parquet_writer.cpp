@@ -0,0 +1,358 @@
+#include "parquet_writer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace databento_jl {
+
+namespace {
+constexpr char kParquetMagic[4] = {'P', 'A', 'R', '1'};
+
+// parquet.thrift enums
+constexpr std::int32_t kTypeInt32 = 1;
+constexpr std::int32_t kTypeInt64 = 2;
+constexpr std::int32_t kTypeDouble = 5;
+constexpr std::int32_t kRequired = 0;
+constexpr std::int32_t kEncodingPlain = 0;
+constexpr std::int32_t kEncodingRle = 3;
+constexpr std::int32_t kCodecUncompressed = 0;
+constexpr std::int32_t kCodecZstd = 6;
+constexpr std::int32_t kDataPage = 0;
+constexpr std::int32_t kConvertedUInt8 = 11;
+
+// Thrift compact protocol types
+constexpr std::uint8_t kCompactTrue = 1;
+constexpr std::uint8_t kCompactFalse = 2;
+constexpr std::uint8_t kCompactByte = 3;
+constexpr std::uint8_t kCompactI32 = 5;
+constexpr std::uint8_t kCompactI64 = 6;
+constexpr std::uint8_t kCompactBinary = 8;
+constexpr std::uint8_t kCompactList = 9;
+constexpr std::uint8_t kCompactStruct = 12;
+
+// Serializes Thrift structs in the compact protocol used by Parquet metadata.
+// Fields must be written in increasing id order within each struct.
+class ThriftWriter {
+ public:
+  void I32(std::int16_t id, std::int32_t value) {
+    FieldHeader(id, kCompactI32);
+    Varint(ZigZag(value));
+  }
+  void I64(std::int16_t id, std::int64_t value) {
+    FieldHeader(id, kCompactI64);
+    Varint(ZigZag(value));
+  }
+  void Byte(std::int16_t id, std::int8_t value) {
+    FieldHeader(id, kCompactByte);
+    out_.push_back(static_cast<std::uint8_t>(value));
+  }
+  void Bool(std::int16_t id, bool value) {
+    FieldHeader(id, value ? kCompactTrue : kCompactFalse);
+  }
+  void Binary(std::int16_t id, const std::string& value) {
+    FieldHeader(id, kCompactBinary);
+    String(value);
+  }
+
+  void BeginStruct(std::int16_t id) {
+    FieldHeader(id, kCompactStruct);
+    BeginListStruct();
+  }
+  // Starts a struct element of a list
+  void BeginListStruct() {
+    last_ids_.push_back(last_id_);
+    last_id_ = 0;
+  }
+  void EndStruct() {
+    out_.push_back(0);
+    last_id_ = last_ids_.back();
+    last_ids_.pop_back();
+  }
+
+  void BeginList(std::int16_t id, std::uint8_t element_type, std::size_t size) {
+    FieldHeader(id, kCompactList);
+    if (size < 15) {
+      out_.push_back(static_cast<std::uint8_t>(size << 4 | element_type));
+    } else {
+      out_.push_back(static_cast<std::uint8_t>(0xF0 | element_type));
+      Varint(size);
+    }
+  }
+  void ListI32(std::int32_t value) { Varint(ZigZag(value)); }
+  void ListBinary(const std::string& value) { String(value); }
+
+  // Ends the top-level struct and returns its encoding
+  std::vector<std::uint8_t> Finish() {
+    out_.push_back(0);
+    return std::move(out_);
+  }
+
+ private:
+  static std::uint64_t ZigZag(std::int64_t v) {
+    return (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63);
+  }
+  void Varint(std::uint64_t v) {
+    while (v >= 0x80) {
+      out_.push_back(static_cast<std::uint8_t>(v | 0x80));
+      v >>= 7;
+    }
+    out_.push_back(static_cast<std::uint8_t>(v));
+  }
+  void String(const std::string& value) {
+    Varint(value.size());
+    out_.insert(out_.end(), value.begin(), value.end());
+  }
+  void FieldHeader(std::int16_t id, std::uint8_t type) {
+    const int delta = id - last_id_;
+    if (delta > 0 && delta <= 15) {
+      out_.push_back(static_cast<std::uint8_t>(delta << 4 | type));
+    } else {
+      out_.push_back(type);
+      Varint(ZigZag(id));
+    }
+    last_id_ = id;
+  }
+
+  std::vector<std::uint8_t> out_;
+  std::int16_t last_id_{};
+  std::vector<std::int16_t> last_ids_;
+};
+
+std::int32_t PhysicalType(ArrowType type) {
+  switch (type) {
+    case ArrowType::kUInt8:
+    case ArrowType::kUInt16:
+    case ArrowType::kUInt32:
+    case ArrowType::kInt32:
+      return kTypeInt32;
+    case ArrowType::kFloat64:
+      return kTypeDouble;
+    default:
+      return kTypeInt64;
+  }
+}
+
+bool IsUnsigned(ArrowType type) {
+  return type == ArrowType::kUInt8 || type == ArrowType::kUInt16 ||
+         type == ArrowType::kUInt32 || type == ArrowType::kUInt64;
+}
+
+// PLAIN encoding of `rows` values of column `i` from `first_row` on:
+// little-endian values of the physical type, so only the narrow unsigned
+// columns need converting
+void EncodePlain(const ArrowBatch& batch, std::size_t i, std::size_t first_row,
+                 std::size_t rows, std::vector<std::byte>& out) {
+  const ArrowType type = batch.Fields()[i].type;
+  const std::size_t width = ArrowTypeWidth(type);
+  const std::byte* column = batch.Column(i) + first_row * width;
+  if (type != ArrowType::kUInt8 && type != ArrowType::kUInt16) {
+    out.assign(column, column + rows * width);
+    return;
+  }
+  out.resize(rows * sizeof(std::int32_t));
+  for (std::size_t row = 0; row < rows; ++row) {
+    std::int32_t value;
+    if (type == ArrowType::kUInt8) {
+      value = std::to_integer<std::uint8_t>(column[row]);
+    } else {
+      std::uint16_t narrow;
+      std::memcpy(&narrow, column + row * sizeof(narrow), sizeof(narrow));
+      value = narrow;
+    }
+    std::memcpy(out.data() + row * sizeof(value), &value, sizeof(value));
+  }
+}
+}  // namespace
+
+ParquetFileWriter::ParquetFileWriter(const std::string& path, std::vector<ArrowField> fields,
+                                     const ParquetWriterOptions& options)
+    : fields_{std::move(fields)},
+      options_{options},
+      pool_{options.zstd ? std::make_shared<CompressionPool>(options.threads) : nullptr},
+      file_{path},
+      pending_(fields_.size()) {
+  if (options_.row_group_rows == 0) {
+    throw std::invalid_argument{"Parquet row groups need at least one row"};
+  }
+  jobs_.reserve(fields_.size());
+  for (std::size_t i = 0; i < fields_.size(); ++i) {
+    jobs_.push_back(std::make_shared<CompressionPool::Job>());
+  }
+  file_.Write(kParquetMagic, sizeof(kParquetMagic));
+}
+
+void ParquetFileWriter::Write(const ArrowBatch& batch) {
+  const std::size_t n = fields_.size();
+  if (batch.ColumnCount() != n) {
+    throw std::invalid_argument{"Batch has " + std::to_string(batch.ColumnCount()) +
+                                " columns, the file " + std::to_string(n)};
+  }
+  if (batch.Length() * sizeof(std::int64_t) >
+      static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max())) {
+    throw std::invalid_argument{"Batch of " + std::to_string(batch.Length()) +
+                                " rows exceeds the Parquet page size limit"};
+  }
+  for (std::size_t row = 0; row < batch.Length();) {
+    const std::size_t rows =
+        std::min(batch.Length() - row, options_.row_group_rows - pending_rows_);
+    AddPages(batch, row, rows);
+    row += rows;
+    if (pending_rows_ == options_.row_group_rows) {
+      FlushRowGroup();
+    }
+  }
+}
+
+void ParquetFileWriter::AddPages(const ArrowBatch& batch, std::size_t first_row,
+                                 std::size_t rows) {
+  const std::size_t n = fields_.size();
+  for (std::size_t i = 0; i < n; ++i) {
+    EncodePlain(batch, i, first_row, rows, jobs_[i]->input);
+    if (pool_ != nullptr) {
+      jobs_[i]->level = options_.compression_level;
+      pool_->Submit(jobs_[i]);
+    }
+  }
+  for (std::size_t i = 0; i < n; ++i) {
+    CompressionPool::Job& job = *jobs_[i];
+    const std::vector<std::byte>* page = &job.input;
+    if (pool_ != nullptr) {
+      pool_->Wait(job);
+      page = &job.output;
+    }
+    ThriftWriter header;
+    header.I32(1, kDataPage);
+    header.I32(2, static_cast<std::int32_t>(job.input.size()));
+    header.I32(3, static_cast<std::int32_t>(page->size()));
+    header.BeginStruct(5);
+    header.I32(1, static_cast<std::int32_t>(rows));
+    header.I32(2, kEncodingPlain);
+    header.I32(3, kEncodingRle);
+    header.I32(4, kEncodingRle);
+    header.EndStruct();
+    const std::vector<std::uint8_t> header_bytes = header.Finish();
+
+    PendingChunk& chunk = pending_[i];
+    const auto* page_bytes = reinterpret_cast<const std::uint8_t*>(page->data());
+    chunk.bytes.insert(chunk.bytes.end(), header_bytes.begin(), header_bytes.end());
+    chunk.bytes.insert(chunk.bytes.end(), page_bytes, page_bytes + page->size());
+    chunk.uncompressed_size +=
+        static_cast<std::int64_t>(header_bytes.size() + job.input.size());
+  }
+  pending_rows_ += rows;
+}
+
+void ParquetFileWriter::FlushRowGroup() {
+  RowGroup group{static_cast<std::int64_t>(pending_rows_), {}};
+  group.columns.reserve(pending_.size());
+  for (PendingChunk& chunk : pending_) {
+    const auto offset = static_cast<std::int64_t>(file_.Position());
+    file_.Write(chunk.bytes.data(), chunk.bytes.size());
+    group.columns.push_back({offset, chunk.uncompressed_size,
+                             static_cast<std::int64_t>(chunk.bytes.size())});
+    chunk.bytes.clear();
+    chunk.uncompressed_size = 0;
+  }
+  row_groups_.push_back(std::move(group));
+  pending_rows_ = 0;
+}
+
+void ParquetFileWriter::Close() {
+  if (!IsOpen()) {
+    return;
+  }
+  if (pending_rows_ > 0) {
+    FlushRowGroup();
+  }
+  const std::vector<std::uint8_t> metadata = FileMetaData();
+  file_.Write(metadata.data(), metadata.size());
+  const auto metadata_length = static_cast<std::uint32_t>(metadata.size());
+  file_.Write(&metadata_length, sizeof(metadata_length));
+  file_.Write(kParquetMagic, sizeof(kParquetMagic));
+  file_.Commit();
+}
+
+std::vector<std::uint8_t> ParquetFileWriter::FileMetaData() const {
+  std::int64_t rows = 0;
+  for (const RowGroup& group : row_groups_) {
+    rows += group.rows;
+  }
+  ThriftWriter meta;
+  meta.I32(1, 1);
+  meta.BeginList(2, kCompactStruct, fields_.size() + 1);
+  meta.BeginListStruct();
+  meta.Binary(4, "schema");
+  meta.I32(5, static_cast<std::int32_t>(fields_.size()));
+  meta.EndStruct();
+  for (const ArrowField& field : fields_) {
+    meta.BeginListStruct();
+    meta.I32(1, PhysicalType(field.type));
+    meta.I32(3, kRequired);
+    meta.Binary(4, field.name);
+    if (IsUnsigned(field.type)) {
+      // UINT_8, UINT_16, UINT_32 and UINT_64 are consecutive
+      const int log_width = field.type == ArrowType::kUInt8    ? 0
+                            : field.type == ArrowType::kUInt16 ? 1
+                            : field.type == ArrowType::kUInt32 ? 2
+                                                               : 3;
+      meta.I32(6, kConvertedUInt8 + log_width);
+      meta.BeginStruct(10);
+      meta.BeginStruct(10);  // INTEGER
+      meta.Byte(1, static_cast<std::int8_t>(ArrowTypeWidth(field.type) * 8));
+      meta.Bool(2, false);
+      meta.EndStruct();
+      meta.EndStruct();
+    } else if (field.type == ArrowType::kTimestampNs) {
+      meta.BeginStruct(10);
+      meta.BeginStruct(8);  // TIMESTAMP
+      meta.Bool(1, true);
+      meta.BeginStruct(2);
+      meta.BeginStruct(3);  // NANOS
+      meta.EndStruct();
+      meta.EndStruct();
+      meta.EndStruct();
+      meta.EndStruct();
+    }
+    meta.EndStruct();
+  }
+  meta.I64(3, rows);
+  meta.BeginList(4, kCompactStruct, row_groups_.size());
+  for (const RowGroup& group : row_groups_) {
+    std::int64_t uncompressed = 0;
+    std::int64_t compressed = 0;
+    meta.BeginListStruct();
+    meta.BeginList(1, kCompactStruct, group.columns.size());
+    for (std::size_t i = 0; i < group.columns.size(); ++i) {
+      const ColumnChunk& chunk = group.columns[i];
+      uncompressed += chunk.uncompressed_size;
+      compressed += chunk.compressed_size;
+      meta.BeginListStruct();
+      meta.I64(2, chunk.data_page_offset);
+      meta.BeginStruct(3);
+      meta.I32(1, PhysicalType(fields_[i].type));
+      meta.BeginList(2, kCompactI32, 1);
+      meta.ListI32(kEncodingPlain);
+      meta.BeginList(3, kCompactBinary, 1);
+      meta.ListBinary(fields_[i].name);
+      meta.I32(4, options_.zstd ? kCodecZstd : kCodecUncompressed);
+      meta.I64(5, group.rows);
+      meta.I64(6, chunk.uncompressed_size);
+      meta.I64(7, chunk.compressed_size);
+      meta.I64(9, chunk.data_page_offset);
+      meta.EndStruct();
+      meta.EndStruct();
+    }
+    meta.I64(2, uncompressed);
+    meta.I64(3, group.rows);
+    meta.I64(5, group.columns.empty() ? 0 : group.columns.front().data_page_offset);
+    meta.I64(6, compressed);
+    meta.EndStruct();
+  }
+  meta.Binary(6, "databento_jl");
+  return meta.Finish();
+}
+
+}  // namespace databento_jl
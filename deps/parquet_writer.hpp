@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow_batch.hpp"
+#include "dbn_writer.hpp"
+#include "output_file.hpp"
+
+namespace databento_jl {
+
+struct ParquetWriterOptions {
+  bool zstd{true};
+  int compression_level{3};
+  // Compression threads; 0 uses one per core
+  std::size_t threads{0};
+  // Rows per row group, independent of the batch size; the last row group
+  // holds the remainder
+  std::size_t row_group_rows{1 << 20};
+};
+
+// Writes ArrowBatches as a Parquet file with row groups of `row_group_rows`
+// rows.
+//
+// Each batch, or each part of one that crosses a row group boundary, adds a
+// PLAIN-encoded data page of required values to every column chunk of the
+// current row group. Pages are compressed with zstd on a CompressionPool so
+// the columns compress in parallel, and held in memory until the row group is
+// complete, since a column chunk must be contiguous in the file; the footer's
+// metadata grows by one row group at a time. uint8 and uint16
+// columns are widened to INT32 as Parquet requires, with the unsigned integer
+// logical type recording their width; timestamps carry the
+// TIMESTAMP(NANOS, UTC) logical type. The file is complete once Close
+// returns.
+class ParquetFileWriter {
+ public:
+  ParquetFileWriter(const std::string& path, std::vector<ArrowField> fields,
+                    const ParquetWriterOptions& options);
+
+  void Write(const ArrowBatch& batch);
+  // Writes the last row group and the footer and moves the file to its path
+  void Close();
+  bool IsOpen() const { return file_.IsOpen(); }
+  std::uint64_t RowGroupsWritten() const { return row_groups_.size(); }
+
+ private:
+  struct ColumnChunk {
+    std::int64_t data_page_offset;
+    std::int64_t uncompressed_size;
+    std::int64_t compressed_size;
+  };
+  struct RowGroup {
+    std::int64_t rows;
+    std::vector<ColumnChunk> columns;
+  };
+
+  // Pages of one column of the row group being filled
+  struct PendingChunk {
+    std::vector<std::uint8_t> bytes;
+    std::int64_t uncompressed_size{};
+  };
+
+  // Adds `rows` rows of `batch` from `first_row` on as one page per column
+  void AddPages(const ArrowBatch& batch, std::size_t first_row, std::size_t rows);
+  void FlushRowGroup();
+  std::vector<std::uint8_t> FileMetaData() const;
+
+  std::vector<ArrowField> fields_;
+  ParquetWriterOptions options_;
+  std::shared_ptr<CompressionPool> pool_;
+  std::vector<std::shared_ptr<CompressionPool::Job>> jobs_;
+  OutputFile file_;
+  std::vector<PendingChunk> pending_;
+  std::size_t pending_rows_{};
+  std::vector<RowGroup> row_groups_;
+};
+
+}  // namespace databento_jl
@@ -0,0 +1,154 @@
+#include "pipeline_stats.hpp"
+
+#include <databento/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace databento_jl {
+
+LatencyHistogram::LatencyHistogram()
+    : counts_{new std::atomic<std::uint64_t>[kBucketCount]} {
+  Reset();
+}
+
+std::uint64_t LatencyHistogram::Min() const {
+  return Count() == 0 ? 0 : min_.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::Mean() const {
+  const std::uint64_t count = Count();
+  return count == 0 ? std::numeric_limits<double>::quiet_NaN()
+                    : static_cast<double>(sum_.load(std::memory_order_relaxed)) /
+                          static_cast<double>(count);
+}
+
+std::uint64_t LatencyHistogram::BucketMax(std::size_t bucket) {
+  if (bucket < kSubBuckets) {
+    return bucket;
+  }
+  const std::size_t shift = bucket / kHalf - 1;
+  const std::uint64_t lowest = (bucket - shift * kHalf) << shift;
+  return lowest + (std::uint64_t{1} << shift) - 1;
+}
+
+std::uint64_t LatencyHistogram::ValueAtPercentile(double percentile) const {
+  // Totals from the buckets themselves, so a concurrent Record cannot leave
+  // the target out of reach
+  std::uint64_t total = 0;
+  for (std::size_t i = 0; i < kBucketCount; ++i) {
+    total += counts_[i].load(std::memory_order_relaxed);
+  }
+  if (total == 0) {
+    return 0;
+  }
+  const double clamped = std::fmin(std::fmax(percentile, 0.0), 100.0);
+  const auto target = std::max<std::uint64_t>(
+      1, static_cast<std::uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(total))));
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i < kBucketCount; ++i) {
+    seen += counts_[i].load(std::memory_order_relaxed);
+    if (seen >= target) {
+      // The bucket's upper edge can overshoot what was actually recorded
+      return std::min(std::max(BucketMax(i), Min()), Max());
+    }
+  }
+  return Max();
+}
+
+void LatencyHistogram::Reset() {
+  for (std::size_t i = 0; i < kBucketCount; ++i) {
+    counts_[i].store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  negative_.store(0, std::memory_order_relaxed);
+  sum_.store(0, std::memory_order_relaxed);
+  min_.store(std::numeric_limits<std::uint64_t>::max(), std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+namespace {
+// ts_recv and, when the schema has it, ts_in_delta of a record
+struct RecvTimes {
+  std::uint64_t ts_recv{databento::kUndefTimestamp};
+  bool has_delta{};
+  std::int32_t ts_in_delta{};
+};
+
+template <typename Msg>
+RecvTimes WithDelta(const databento::Record& record) {
+  const Msg& msg = record.Get<Msg>();
+  return {static_cast<std::uint64_t>(msg.ts_recv.time_since_epoch().count()), true,
+          static_cast<std::int32_t>(msg.ts_in_delta.count())};
+}
+
+template <typename Msg>
+RecvTimes WithoutDelta(const databento::Record& record) {
+  const Msg& msg = record.Get<Msg>();
+  return {static_cast<std::uint64_t>(msg.ts_recv.time_since_epoch().count()), false, 0};
+}
+
+RecvTimes RecvTimesOf(const databento::Record& record) {
+  switch (record.RType()) {
+    case databento::RType::Mbo:
+      return WithDelta<databento::MboMsg>(record);
+    case databento::RType::Mbp0:
+      return WithDelta<databento::TradeMsg>(record);
+    case databento::RType::Mbp1:
+      return WithDelta<databento::Mbp1Msg>(record);
+    case databento::RType::Mbp10:
+      return WithDelta<databento::Mbp10Msg>(record);
+    case databento::RType::Cmbp1:
+    case databento::RType::Tcbbo:
+      return WithDelta<databento::Cmbp1Msg>(record);
+    case databento::RType::Statistics:
+      return WithDelta<databento::StatMsg>(record);
+    case databento::RType::Bbo1S:
+    case databento::RType::Bbo1M:
+      return WithoutDelta<databento::BboMsg>(record);
+    case databento::RType::Cbbo1S:
+    case databento::RType::Cbbo1M:
+      return WithoutDelta<databento::CbboMsg>(record);
+    case databento::RType::Status:
+      return WithoutDelta<databento::StatusMsg>(record);
+    case databento::RType::InstrumentDef:
+      return WithoutDelta<databento::InstrumentDefMsg>(record);
+    case databento::RType::Imbalance:
+      return WithoutDelta<databento::ImbalanceMsg>(record);
+    default:
+      return {};
+  }
+}
+
+std::int64_t Difference(std::uint64_t later, std::uint64_t earlier) {
+  return static_cast<std::int64_t>(later - earlier);
+}
+}  // namespace
+
+void FeedLatency::Record(const databento::Record& record, bool has_ts_out) {
+  const std::uint64_t ts_event = record.Header().ts_event.time_since_epoch().count();
+  const RecvTimes times = RecvTimesOf(record);
+  const bool has_recv = times.ts_recv != databento::kUndefTimestamp;
+  if (has_recv && ts_event != databento::kUndefTimestamp) {
+    recv_delay_.Record(Difference(times.ts_recv, ts_event));
+  }
+  if (times.has_delta) {
+    ts_in_delta_.Record(times.ts_in_delta);
+  }
+  if (has_ts_out && record.Size() >= sizeof(databento::RecordHeader) + sizeof(std::uint64_t)) {
+    // ts_out is appended to the record's own fields
+    std::uint64_t ts_out;
+    std::memcpy(&ts_out,
+                reinterpret_cast<const std::byte*>(&record.Header()) + record.Size() -
+                    sizeof(ts_out),
+                sizeof(ts_out));
+    const std::uint64_t captured = has_recv ? times.ts_recv : ts_event;
+    if (ts_out != databento::kUndefTimestamp && captured != databento::kUndefTimestamp) {
+      send_delay_.Record(Difference(ts_out, captured));
+    }
+  }
+}
+
+}  // namespace databento_jl
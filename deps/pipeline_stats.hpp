@@ -0,0 +1,111 @@
+#pragma once
+
+#include <databento/record.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace databento_jl {
+
+// Log-linear histogram of non-negative nanosecond values in the style of
+// HdrHistogram.
+//
+// Values below 128 get a bucket each; above that every power of two is split
+// into 64 linear buckets, so a reported value is within 1/64 (1.6%) of the
+// recorded one over the whole int64 range in about 30 KiB. Negative values
+// (clock skew between capture points) are only counted. One thread records
+// while others may read: the counters are relaxed atomics, so a reader sees
+// a slightly stale but never torn histogram.
+class LatencyHistogram {
+ public:
+  LatencyHistogram();
+
+  void Record(std::int64_t value) {
+    if (value < 0) {
+      Bump(negative_);
+      return;
+    }
+    const auto v = static_cast<std::uint64_t>(value);
+    Bump(counts_[BucketOf(v)]);
+    Bump(count_);
+    sum_.store(sum_.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+    if (v < min_.load(std::memory_order_relaxed)) {
+      min_.store(v, std::memory_order_relaxed);
+    }
+    if (v > max_.load(std::memory_order_relaxed)) {
+      max_.store(v, std::memory_order_relaxed);
+    }
+  }
+
+  // Non-negative values recorded
+  std::uint64_t Count() const { return count_.load(std::memory_order_relaxed); }
+  std::uint64_t NegativeCount() const { return negative_.load(std::memory_order_relaxed); }
+  // 0 when empty
+  std::uint64_t Min() const;
+  std::uint64_t Max() const { return max_.load(std::memory_order_relaxed); }
+  double Mean() const;
+  // Smallest value v such that `percentile` percent of the recorded values
+  // are <= v, up to the bucket resolution; 0 when empty
+  std::uint64_t ValueAtPercentile(double percentile) const;
+
+  void Reset();
+
+ private:
+  static constexpr unsigned kSubBucketBits = 7;
+  static constexpr std::uint64_t kSubBuckets = 1ULL << kSubBucketBits;
+  static constexpr std::uint64_t kHalf = kSubBuckets / 2;
+  // Recorded values fit in 63 bits, so the largest shift is 63 - kSubBucketBits
+  static constexpr std::size_t kBucketCount = (64 - kSubBucketBits + 1) * kHalf;
+
+  static std::size_t BucketOf(std::uint64_t v) {
+    if (v < kSubBuckets) {
+      return static_cast<std::size_t>(v);
+    }
+    const unsigned shift = 63 - __builtin_clzll(v) - (kSubBucketBits - 1);
+    return static_cast<std::size_t>((std::uint64_t{shift} << (kSubBucketBits - 1)) + (v >> shift));
+  }
+  // Largest value that falls into `bucket`
+  static std::uint64_t BucketMax(std::size_t bucket);
+
+  static void Bump(std::atomic<std::uint64_t>& counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  std::unique_ptr<std::atomic<std::uint64_t>[]> counts_;
+  std::atomic<std::uint64_t> count_{};
+  std::atomic<std::uint64_t> negative_{};
+  std::atomic<std::uint64_t> sum_{};
+  std::atomic<std::uint64_t> min_;
+  std::atomic<std::uint64_t> max_{};
+};
+
+// Feed latencies carried by the records themselves:
+//   recv_delay   ts_recv - ts_event, capture time behind the venue's timestamp
+//   ts_in_delta  the venue's send-to-receive delta reported in the record
+//   send_delay   ts_out - ts_recv, Databento gateway send time behind capture,
+//                for streams encoded with ts_out
+// Records without a field are skipped for that histogram, as are undefined
+// timestamps.
+class FeedLatency {
+ public:
+  void Record(const databento::Record& record, bool has_ts_out);
+
+  const LatencyHistogram& RecvDelay() const { return recv_delay_; }
+  const LatencyHistogram& TsInDelta() const { return ts_in_delta_; }
+  const LatencyHistogram& SendDelay() const { return send_delay_; }
+
+  void Reset() {
+    recv_delay_.Reset();
+    ts_in_delta_.Reset();
+    send_delay_.Reset();
+  }
+
+ private:
+  LatencyHistogram recv_delay_;
+  LatencyHistogram ts_in_delta_;
+  LatencyHistogram send_delay_;
+};
+
+}  // namespace databento_jl
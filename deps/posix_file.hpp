@@ -0,0 +1,65 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <system_error>
+
+namespace databento_jl {
+
+// Read-only file descriptor with positional reads, so several readers can
+// share one open file without a common seek position.
+class PosixFile {
+ public:
+  explicit PosixFile(const std::string& path) : path_{path} {
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+      throw std::system_error{errno, std::generic_category(),
+                              "Failed to open " + path};
+    }
+    struct stat st {};
+    if (::fstat(fd_, &st) != 0) {
+      const int err = errno;
+      ::close(fd_);
+      throw std::system_error{err, std::generic_category(),
+                              "Failed to stat " + path};
+    }
+    size_ = static_cast<std::uint64_t>(st.st_size);
+    mtime_ns_ = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1'000'000'000 +
+                st.st_mtim.tv_nsec;
+  }
+  PosixFile(const PosixFile&) = delete;
+  PosixFile& operator=(const PosixFile&) = delete;
+  ~PosixFile() { ::close(fd_); }
+
+  const std::string& Path() const { return path_; }
+  std::uint64_t Size() const { return size_; }
+  std::int64_t MtimeNs() const { return mtime_ns_; }
+
+  // Reads up to `n` bytes at `offset`, returning 0 only at the end of the file
+  std::size_t ReadAt(void* buffer, std::size_t n, std::uint64_t offset) const {
+    while (true) {
+      const ::ssize_t got = ::pread(fd_, buffer, n, static_cast<::off_t>(offset));
+      if (got >= 0) {
+        return static_cast<std::size_t>(got);
+      }
+      if (errno != EINTR) {
+        throw std::system_error{errno, std::generic_category(),
+                                "Failed to read " + path_};
+      }
+    }
+  }
+
+ private:
+  std::string path_;
+  int fd_{-1};
+  std::uint64_t size_{};
+  std::int64_t mtime_ns_{};
+};
+
+}  // namespace databento_jl
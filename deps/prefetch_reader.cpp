@@ -0,0 +1,53 @@
+#include "prefetch_reader.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <limits>
+
+namespace databento_jl {
+
+PrefetchDbnFileStore::PrefetchDbnFileStore(const std::string& file_path,
+                                           std::size_t buffer_count,
+                                           std::size_t block_bytes)
+    : store_{file_path},
+      // Decode the header before the producer starts using the store
+      metadata_{store_.GetMetadata()},
+      block_bytes_{std::max<std::size_t>(block_bytes, 1)},
+      queue_{buffer_count},
+      producer_{&PrefetchDbnFileStore::ProducerLoop, this} {}
+
+PrefetchDbnFileStore::~PrefetchDbnFileStore() {
+  queue_.Stop();
+  producer_.join();
+}
+
+void PrefetchDbnFileStore::ProducerLoop() {
+  while (RecordBlock* block = queue_.AcquireFree()) {
+    bool more;
+    try {
+      more = FillBlock(store_, *block, std::numeric_limits<std::size_t>::max(),
+                       block_bytes_);
+    } catch (...) {
+      queue_.Fail(std::current_exception());
+      return;
+    }
+    queue_.Publish(!more);
+    if (!more) {
+      return;
+    }
+  }
+}
+
+const databento::Record* PrefetchDbnFileStore::NextRecord() {
+  if (current_ == nullptr || current_->next >= current_->Size()) {
+    current_ = queue_.NextFilled();
+    if (current_ == nullptr) {
+      return nullptr;
+    }
+  }
+  current_record_ = current_->RecordAt(current_->next++);
+  ++records_delivered_;
+  return &current_record_;
+}
+
+}  // namespace databento_jl
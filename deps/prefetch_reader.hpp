@@ -0,0 +1,64 @@
+#pragma once
+
+#include <databento/dbn.hpp>
+#include <databento/dbn_file_store.hpp>
+#include <databento/record.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "block_queue.hpp"
+#include "record_block.hpp"
+
+namespace databento_jl {
+
+// DbnFileStore with read-ahead on a background thread.
+//
+// The producer thread runs the decoder (zstd decompression and record
+// framing) and fills a ring of `buffer_count` blocks of about `block_bytes`
+// bytes each, while the consumer iterates the previous block. Throughput is
+// then bounded by the slower of the two sides rather than their sum. Stall
+// counters report how long each side waited on the other: a large consumer
+// stall means decoding is the bottleneck, a large producer stall means the
+// consumer is.
+class PrefetchDbnFileStore {
+ public:
+  PrefetchDbnFileStore(const std::string& file_path, std::size_t buffer_count,
+                       std::size_t block_bytes);
+  PrefetchDbnFileStore(const PrefetchDbnFileStore&) = delete;
+  PrefetchDbnFileStore& operator=(const PrefetchDbnFileStore&) = delete;
+  ~PrefetchDbnFileStore();
+
+  const databento::Metadata& GetMetadata() const { return metadata_; }
+  // Returns the next record, or nullptr at the end of the file. The record
+  // is valid until the next call.
+  const databento::Record* NextRecord();
+
+  std::size_t BufferCount() const { return queue_.BlockCount(); }
+  std::size_t BlockBytes() const { return block_bytes_; }
+  // Nanoseconds the background thread spent waiting for a free block
+  std::uint64_t ProducerStallNs() const { return queue_.ProducerStallNs(); }
+  // Nanoseconds NextRecord spent waiting for a filled block
+  std::uint64_t ConsumerStallNs() const { return queue_.ConsumerStallNs(); }
+  std::uint64_t BlocksFilled() const { return queue_.BlocksFilled(); }
+  std::uint64_t RecordsDelivered() const { return records_delivered_; }
+
+ private:
+  void ProducerLoop();
+
+  databento::DbnFileStore store_;
+  databento::Metadata metadata_;
+  const std::size_t block_bytes_;
+  BlockQueue queue_;
+
+  // Owned by the consuming thread
+  RecordBlock* current_{};
+  databento::Record current_record_{nullptr};
+  std::uint64_t records_delivered_{};
+
+  std::thread producer_;
+};
+
+}  // namespace databento_jl
@@ -0,0 +1,182 @@
+#include "profiled_reader.hpp"
+
+#include <databento/ireadable.hpp>
+#include <databento/log.hpp>
+
+#include <zstd.h>
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "posix_file.hpp"
+
+namespace databento_jl {
+
+namespace {
+constexpr std::size_t kReadChunk = 1 << 20;
+constexpr std::uint8_t kZstdMagic[] = {0x28, 0xB5, 0x2F, 0xFD};
+
+std::uint64_t NsSince(std::chrono::steady_clock::time_point start) {
+  return static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                           start)
+          .count());
+}
+}  // namespace
+
+// File input for the decoder that times its reads and does its own zstd
+// decompression, which the decoder then never sees
+class ProfiledInput : public databento::IReadable {
+ public:
+  explicit ProfiledInput(const std::string& path) : file_{path} {
+    std::uint8_t magic[sizeof(kZstdMagic)]{};
+    if (file_.ReadAt(magic, sizeof(magic), 0) == sizeof(magic) &&
+        std::memcmp(magic, kZstdMagic, sizeof(magic)) == 0) {
+      dctx_.reset(ZSTD_createDCtx());
+      in_.resize(kReadChunk);
+    }
+  }
+
+  void ReadExact(std::byte* buffer, std::size_t length) override {
+    while (length > 0) {
+      const std::size_t got = ReadSome(buffer, length);
+      if (got == 0) {
+        throw std::runtime_error{file_.Path() + " ended unexpectedly"};
+      }
+      buffer += got;
+      length -= got;
+    }
+  }
+
+  std::size_t ReadSome(std::byte* buffer, std::size_t max_length) override {
+    if (dctx_ == nullptr) {
+      const std::size_t got = Read(buffer, max_length);
+      bytes_decompressed_ += got;
+      return got;
+    }
+    ZSTD_outBuffer out{buffer, max_length, 0};
+    while (out.pos == 0 && max_length > 0) {
+      if (in_pos_ == in_size_) {
+        in_size_ = Read(in_.data(), in_.size());
+        in_pos_ = 0;
+        if (in_size_ == 0) {
+          if (frame_remaining_ != 0) {
+            throw std::runtime_error{file_.Path() + " ends in the middle of a zstd frame"};
+          }
+          return 0;
+        }
+      }
+      ZSTD_inBuffer in{in_.data(), in_size_, in_pos_};
+      const auto start = std::chrono::steady_clock::now();
+      frame_remaining_ = ZSTD_decompressStream(dctx_.get(), &out, &in);
+      decompress_ns_ += NsSince(start);
+      if (ZSTD_isError(frame_remaining_)) {
+        throw std::runtime_error{"Failed to decompress " + file_.Path() + ": " +
+                                 ZSTD_getErrorName(frame_remaining_)};
+      }
+      in_pos_ = in.pos;
+    }
+    bytes_decompressed_ += out.pos;
+    return out.pos;
+  }
+
+  std::uint64_t BytesRead() const { return offset_; }
+  std::uint64_t BytesDecompressed() const { return bytes_decompressed_; }
+  std::uint64_t ReadNs() const { return read_ns_; }
+  std::uint64_t DecompressNs() const { return decompress_ns_; }
+
+ private:
+  struct DCtxDeleter {
+    void operator()(ZSTD_DCtx* dctx) const { ZSTD_freeDCtx(dctx); }
+  };
+
+  std::size_t Read(void* buffer, std::size_t n) {
+    const auto start = std::chrono::steady_clock::now();
+    const std::size_t got = file_.ReadAt(buffer, n, offset_);
+    read_ns_ += NsSince(start);
+    offset_ += got;
+    return got;
+  }
+
+  PosixFile file_;
+  std::unique_ptr<ZSTD_DCtx, DCtxDeleter> dctx_;
+  std::vector<std::byte> in_;
+  std::size_t in_pos_{};
+  std::size_t in_size_{};
+  std::size_t frame_remaining_{};
+  std::uint64_t offset_{};
+  std::uint64_t bytes_decompressed_{};
+  std::uint64_t read_ns_{};
+  std::uint64_t decompress_ns_{};
+};
+
+ProfiledDbnFileStore::ProfiledDbnFileStore(const std::string& file_path, bool feed_latency)
+    : opened_{Clock::now()},
+      decoder_{databento::ILogReceiver::Default(), OpenInput(file_path)},
+      metadata_{decoder_.DecodeMetadata()},
+      latency_{feed_latency ? std::make_unique<FeedLatency>() : nullptr} {}
+
+ProfiledDbnFileStore::~ProfiledDbnFileStore() = default;
+
+std::unique_ptr<databento::IReadable> ProfiledDbnFileStore::OpenInput(
+    const std::string& file_path) {
+  auto input = std::make_unique<ProfiledInput>(file_path);
+  input_ = input.get();
+  return input;
+}
+
+const databento::Record* ProfiledDbnFileStore::NextRecord() {
+  const databento::Record* record;
+  if (calls_++ % kDecodeSampleEvery == 0) {
+    const std::uint64_t io_before = input_->ReadNs() + input_->DecompressNs();
+    const auto start = Clock::now();
+    record = decoder_.DecodeRecord();
+    const std::uint64_t total = NsSince(start);
+    const std::uint64_t io = input_->ReadNs() + input_->DecompressNs() - io_before;
+    sampled_ns_ += total > io ? total - io : 0;
+    ++sampled_calls_;
+  } else {
+    record = decoder_.DecodeRecord();
+  }
+  if (record == nullptr) {
+    if (finished_ == Clock::time_point{}) {
+      finished_ = Clock::now();
+    }
+    return nullptr;
+  }
+  ++records_decoded_;
+  if (latency_ != nullptr) {
+    latency_->Record(*record, metadata_.ts_out);
+  }
+  return record;
+}
+
+std::uint64_t ProfiledDbnFileStore::BytesRead() const { return input_->BytesRead(); }
+
+std::uint64_t ProfiledDbnFileStore::BytesDecompressed() const {
+  return input_->BytesDecompressed();
+}
+
+std::uint64_t ProfiledDbnFileStore::ReadNs() const { return input_->ReadNs(); }
+
+std::uint64_t ProfiledDbnFileStore::DecompressNs() const { return input_->DecompressNs(); }
+
+std::uint64_t ProfiledDbnFileStore::DecodeNs() const {
+  if (sampled_calls_ == 0) {
+    return 0;
+  }
+  return static_cast<std::uint64_t>(static_cast<double>(sampled_ns_) *
+                                    static_cast<double>(calls_) /
+                                    static_cast<double>(sampled_calls_));
+}
+
+std::uint64_t ProfiledDbnFileStore::ElapsedNs() const {
+  const Clock::time_point end = finished_ == Clock::time_point{} ? Clock::now() : finished_;
+  return static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - opened_).count());
+}
+
+}  // namespace databento_jl
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <databento/dbn.hpp>
+#include <databento/dbn_decoder.hpp>
+#include <databento/record.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "pipeline_stats.hpp"
+
+namespace databento_jl {
+
+class ProfiledInput;
+
+// DbnFileStore that accounts for where reading time goes.
+//
+// The file is read and, for .dbn.zst, decompressed here rather than inside
+// the decoder, so bytes and time are counted per stage: reading from disk,
+// zstd decompression and record decoding. Read and decompression times are
+// exact since they are taken once per chunk; decode time is measured on one
+// NextRecord call in kDecodeSampleEvery and scaled to all calls, which keeps
+// the clock off the per-record path. Whatever elapsed beyond these three was
+// spent by the consumer: FFI crossings, column stores and the caller's own
+// code.
+//
+// Records a RecordFilter rejects are counted too, so decoded = filtered +
+// delivered. With `feed_latency` the store also builds histograms of the
+// latencies carried by each decoded record.
+class ProfiledDbnFileStore {
+ public:
+  static constexpr std::uint64_t kDecodeSampleEvery = 64;
+
+  ProfiledDbnFileStore(const std::string& file_path, bool feed_latency);
+  ProfiledDbnFileStore(const ProfiledDbnFileStore&) = delete;
+  ProfiledDbnFileStore& operator=(const ProfiledDbnFileStore&) = delete;
+  ~ProfiledDbnFileStore();
+
+  const databento::Metadata& GetMetadata() const { return metadata_; }
+  // Returns the next record, or nullptr at the end of the file. The record
+  // is valid until the next call.
+  const databento::Record* NextRecord();
+
+  // Called by FilteredSource for every record its filter rejects
+  void NoteFiltered() { ++records_filtered_; }
+
+  // Bytes of the file read so far, compressed for .dbn.zst
+  std::uint64_t BytesRead() const;
+  // Uncompressed DBN bytes passed to the decoder; equals BytesRead for plain
+  // .dbn files
+  std::uint64_t BytesDecompressed() const;
+  std::uint64_t RecordsDecoded() const { return records_decoded_; }
+  std::uint64_t RecordsFiltered() const { return records_filtered_; }
+  std::uint64_t RecordsDelivered() const { return records_decoded_ - records_filtered_; }
+  std::uint64_t ReadNs() const;
+  std::uint64_t DecompressNs() const;
+  // Estimated from the sampled NextRecord calls
+  std::uint64_t DecodeNs() const;
+  // Since the store was opened, up to the end of the file once it is reached
+  std::uint64_t ElapsedNs() const;
+
+  // nullptr unless constructed with `feed_latency`
+  const FeedLatency* Latency() const { return latency_.get(); }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  std::unique_ptr<databento::IReadable> OpenInput(const std::string& file_path);
+
+  const Clock::time_point opened_;
+  Clock::time_point finished_{};
+  // Owned by decoder_
+  ProfiledInput* input_{};
+  databento::DbnDecoder decoder_;
+  databento::Metadata metadata_;
+  std::unique_ptr<FeedLatency> latency_;
+
+  std::uint64_t calls_{};
+  std::uint64_t sampled_calls_{};
+  std::uint64_t sampled_ns_{};
+  std::uint64_t records_decoded_{};
+  std::uint64_t records_filtered_{};
+};
+
+}  // namespace databento_jl
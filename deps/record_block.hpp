@@ -0,0 +1,71 @@
+#pragma once
+
+#include <databento/record.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "record_util.hpp"
+
+namespace databento_jl {
+
+// A reusable buffer of records copied out of a decoder, used to hand work
+// between a decoding thread and a consuming thread. Records are packed at
+// 8-byte aligned offsets so they can be viewed in place as message structs.
+struct RecordBlock {
+  static constexpr std::size_t kAlignment = 8;
+
+  std::vector<std::byte> bytes;
+  std::vector<std::size_t> offsets;
+  // Index timestamp of each record, computed by the producer so consumers
+  // that order records never dispatch on rtype
+  std::vector<std::uint64_t> index_ts;
+  // Consumer cursor
+  std::size_t next{};
+
+  std::size_t Size() const { return offsets.size(); }
+  bool Empty() const { return offsets.empty(); }
+
+  void Clear() {
+    bytes.clear();
+    offsets.clear();
+    index_ts.clear();
+    next = 0;
+  }
+
+  void Append(const databento::Record& record) {
+    const std::size_t offset = bytes.size();
+    const std::size_t size = record.Size();
+    const std::size_t padded = (size + kAlignment - 1) / kAlignment * kAlignment;
+    bytes.resize(offset + padded);
+    std::memcpy(bytes.data() + offset, &record.Header(), size);
+    offsets.push_back(offset);
+    index_ts.push_back(IndexTs(record).time_since_epoch().count());
+  }
+
+  databento::Record RecordAt(std::size_t i) {
+    return databento::Record{
+        reinterpret_cast<databento::RecordHeader*>(bytes.data() + offsets[i])};
+  }
+};
+
+// Clears `block` and refills it from `source` until it holds `max_records`
+// records or at least `max_bytes` bytes. Returns false once `source` is
+// exhausted, in which case the block holds whatever records remained.
+template <typename Source>
+bool FillBlock(Source& source, RecordBlock& block, std::size_t max_records,
+               std::size_t max_bytes) {
+  block.Clear();
+  while (block.Size() < max_records && block.bytes.size() < max_bytes) {
+    const databento::Record* record = source.NextRecord();
+    if (record == nullptr) {
+      return false;
+    }
+    block.Append(*record);
+  }
+  return true;
+}
+
+}  // namespace databento_jl
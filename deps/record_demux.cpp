@@ -0,0 +1,40 @@
+#include "record_demux.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace databento_jl {
+
+std::size_t RecordDemux::SlotOf(const std::string& name) {
+  for (std::size_t slot = 0; slot < kSlotCount; ++slot) {
+    if (name == kDemuxNames[slot]) {
+      return slot;
+    }
+  }
+  throw std::invalid_argument{name + " is not a record type RecordDemux splits out"};
+}
+
+RecordDemux::SlotView RecordDemux::View(std::size_t slot) const {
+  if (slot >= kSlotCount) {
+    throw std::out_of_range{"RecordDemux has no slot " + std::to_string(slot)};
+  }
+  SlotView view{};
+  std::size_t i = 0;
+  std::apply(
+      [&](const auto&... buffers) {
+        ((i++ == slot ? void(view = {buffers.data(), buffers.size(),
+                                     sizeof(typename std::decay_t<decltype(buffers)>::value_type)})
+                      : void()),
+         ...);
+      },
+      buffers_);
+  return view;
+}
+
+void RecordDemux::Clear() {
+  std::apply([](auto&... buffers) { (buffers.clear(), ...); }, buffers_);
+  skipped_ = 0;
+}
+
+}  // namespace databento_jl
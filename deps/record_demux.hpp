@@ -0,0 +1,143 @@
+#pragma once
+
+#include <databento/record.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace databento_jl {
+
+// Every record type with a Julia bits type, in slot order
+using DemuxMessages =
+    std::tuple<databento::MboMsg, databento::TradeMsg, databento::Mbp1Msg,
+               databento::Mbp10Msg, databento::BboMsg, databento::CbboMsg,
+               databento::Cmbp1Msg, databento::OhlcvMsg, databento::StatusMsg,
+               databento::InstrumentDefMsg, databento::ImbalanceMsg, databento::StatMsg,
+               databento::ErrorMsg, databento::SystemMsg, databento::SymbolMappingMsg>;
+// Julia names of the DemuxMessages
+inline constexpr const char* kDemuxNames[] = {
+    "MboMsg",       "TradeMsg",  "Mbp1Msg",          "Mbp10Msg",     "BboMsg",
+    "CbboMsg",      "Cmbp1Msg",  "OhlcvMsg",         "StatusMsg",    "InstrumentDefMsg",
+    "ImbalanceMsg", "StatMsg",   "ErrorMsg",         "SystemMsg",    "SymbolMappingMsg"};
+static_assert(std::size(kDemuxNames) == std::tuple_size_v<DemuxMessages>);
+
+// Splits a mixed-schema stream into one contiguous, growable buffer per
+// record type in a single pass.
+//
+// Add dispatches on the RType with one switch, which compiles to a jump
+// table, and copies the record into the std::vector of its message type;
+// there are no per-type probes and no virtual calls. Records of types outside
+// DemuxMessages, or shorter than their message type, are counted as skipped.
+// Buffers keep their capacity across Clear, so a reused demultiplexer stops
+// allocating once it has seen a typical batch.
+class RecordDemux {
+ public:
+  static constexpr std::size_t kSlotCount = std::tuple_size_v<DemuxMessages>;
+
+  // Slot of the message type with Julia name `name`; throws
+  // std::invalid_argument for other names
+  static std::size_t SlotOf(const std::string& name);
+
+  void Add(const databento::Record& record) {
+    switch (record.RType()) {
+      case databento::RType::Mbo:
+        return Append<databento::MboMsg>(record);
+      case databento::RType::Mbp0:
+        return Append<databento::TradeMsg>(record);
+      case databento::RType::Mbp1:
+        return Append<databento::Mbp1Msg>(record);
+      case databento::RType::Mbp10:
+        return Append<databento::Mbp10Msg>(record);
+      case databento::RType::Bbo1S:
+      case databento::RType::Bbo1M:
+        return Append<databento::BboMsg>(record);
+      case databento::RType::Cbbo1S:
+      case databento::RType::Cbbo1M:
+        return Append<databento::CbboMsg>(record);
+      case databento::RType::Cmbp1:
+      case databento::RType::Tcbbo:
+        return Append<databento::Cmbp1Msg>(record);
+      case databento::RType::OhlcvDeprecated:
+      case databento::RType::Ohlcv1S:
+      case databento::RType::Ohlcv1M:
+      case databento::RType::Ohlcv1H:
+      case databento::RType::Ohlcv1D:
+      case databento::RType::OhlcvEod:
+        return Append<databento::OhlcvMsg>(record);
+      case databento::RType::Status:
+        return Append<databento::StatusMsg>(record);
+      case databento::RType::InstrumentDef:
+        return Append<databento::InstrumentDefMsg>(record);
+      case databento::RType::Imbalance:
+        return Append<databento::ImbalanceMsg>(record);
+      case databento::RType::Statistics:
+        return Append<databento::StatMsg>(record);
+      case databento::RType::Error:
+        return Append<databento::ErrorMsg>(record);
+      case databento::RType::System:
+        return Append<databento::SystemMsg>(record);
+      case databento::RType::SymbolMapping:
+        return Append<databento::SymbolMappingMsg>(record);
+      default:
+        ++skipped_;
+    }
+  }
+
+  // Adds up to `max_records` records from `source`; returns the number read
+  template <typename Source>
+  std::uint64_t Split(Source& source, std::uint64_t max_records) {
+    std::uint64_t n = 0;
+    while (n < max_records) {
+      const databento::Record* record = source.NextRecord();
+      if (record == nullptr) {
+        break;
+      }
+      Add(*record);
+      ++n;
+    }
+    return n;
+  }
+
+  template <typename Msg>
+  const std::vector<Msg>& Records() const {
+    return std::get<std::vector<Msg>>(buffers_);
+  }
+
+  // Untyped view of a slot's buffer, valid until the next Add or Clear
+  struct SlotView {
+    const void* data;
+    std::size_t count;
+    std::size_t record_size;
+  };
+  SlotView View(std::size_t slot) const;
+
+  std::uint64_t Skipped() const { return skipped_; }
+  // Empties every buffer, keeping its capacity
+  void Clear();
+
+ private:
+  template <typename Msg>
+  void Append(const databento::Record& record) {
+    if (record.Size() < sizeof(Msg)) {
+      ++skipped_;
+      return;
+    }
+    std::get<std::vector<Msg>>(buffers_).push_back(record.Get<Msg>());
+  }
+
+  template <typename Tuple>
+  struct VectorsOf;
+  template <typename... Msgs>
+  struct VectorsOf<std::tuple<Msgs...>> {
+    using type = std::tuple<std::vector<Msgs>...>;
+  };
+
+  typename VectorsOf<DemuxMessages>::type buffers_;
+  std::uint64_t skipped_{};
+};
+
+}  // namespace databento_jl
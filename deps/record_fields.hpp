@@ -0,0 +1,278 @@
+#pragma once
+
+#include <databento/record.hpp>
+
+#include <cstddef>
+#include <tuple>
+#include <vector>
+
+namespace databento_jl {
+
+// One data member of a record struct: its name and a pointer to it
+template <typename Msg, typename T>
+struct Field {
+  const char* name;
+  T Msg::*member;
+};
+
+template <typename Msg, typename T>
+Field(const char*, T Msg::*) -> Field<Msg, T>;
+
+// Where a field sits in its struct, for readers that load it directly
+struct FieldLayout {
+  const char* name;
+  std::size_t offset;
+  std::size_t size;
+};
+
+// Field table of a record struct: kName, the name it is bound under, and
+// kFields, a tuple of Field in declaration order. Reserved padding is left
+// out. The Julia bindings generate one accessor per field from these
+// tables, so a field is added to the bindings by adding it here.
+template <typename Msg>
+struct RecordFields;
+
+#define DATABENTO_JL_FIELD(name) Field{#name, &Msg::name}
+
+template <>
+struct RecordFields<databento::RecordHeader> {
+  using Msg = databento::RecordHeader;
+  static constexpr const char* kName = "RecordHeader";
+  static constexpr auto kFields =
+      std::make_tuple(DATABENTO_JL_FIELD(length), DATABENTO_JL_FIELD(rtype),
+                      DATABENTO_JL_FIELD(publisher_id), DATABENTO_JL_FIELD(instrument_id),
+                      DATABENTO_JL_FIELD(ts_event));
+};
+
+template <>
+struct RecordFields<databento::BidAskPair> {
+  using Msg = databento::BidAskPair;
+  static constexpr const char* kName = "BidAskPair";
+  static constexpr auto kFields =
+      std::make_tuple(DATABENTO_JL_FIELD(bid_px), DATABENTO_JL_FIELD(ask_px),
+                      DATABENTO_JL_FIELD(bid_sz), DATABENTO_JL_FIELD(ask_sz),
+                      DATABENTO_JL_FIELD(bid_ct), DATABENTO_JL_FIELD(ask_ct));
+};
+
+template <>
+struct RecordFields<databento::ConsolidatedBidAskPair> {
+  using Msg = databento::ConsolidatedBidAskPair;
+  static constexpr const char* kName = "ConsolidatedBidAskPair";
+  static constexpr auto kFields =
+      std::make_tuple(DATABENTO_JL_FIELD(bid_px), DATABENTO_JL_FIELD(ask_px),
+                      DATABENTO_JL_FIELD(bid_sz), DATABENTO_JL_FIELD(ask_sz),
+                      DATABENTO_JL_FIELD(bid_pb), DATABENTO_JL_FIELD(ask_pb));
+};
+
+template <>
+struct RecordFields<databento::MboMsg> {
+  using Msg = databento::MboMsg;
+  static constexpr const char* kName = "MboMsg";
+  static constexpr auto kFields = std::make_tuple(
+      DATABENTO_JL_FIELD(hd), DATABENTO_JL_FIELD(order_id), DATABENTO_JL_FIELD(price),
+      DATABENTO_JL_FIELD(size), DATABENTO_JL_FIELD(flags), DATABENTO_JL_FIELD(channel_id),
+      DATABENTO_JL_FIELD(action), DATABENTO_JL_FIELD(side), DATABENTO_JL_FIELD(ts_recv),
+      DATABENTO_JL_FIELD(ts_in_delta), DATABENTO_JL_FIELD(sequence));
+};
+
+template <>
+struct RecordFields<databento::TradeMsg> {
+  using Msg = databento::TradeMsg;
+  static constexpr const char* kName = "TradeMsg";
+  static constexpr auto kFields = std::make_tuple(
+      DATABENTO_JL_FIELD(hd), DATABENTO_JL_FIELD(price), DATABENTO_JL_FIELD(size),
+      DATABENTO_JL_FIELD(action), DATABENTO_JL_FIELD(side), DATABENTO_JL_FIELD(flags),
+      DATABENTO_JL_FIELD(depth), DATABENTO_JL_FIELD(ts_recv), DATABENTO_JL_FIELD(ts_in_delta),
+      DATABENTO_JL_FIELD(sequence));
+};
+
+template <>
+struct RecordFields<databento::Mbp1Msg> {
+  using Msg = databento::Mbp1Msg;
+  static constexpr const char* kName = "Mbp1Msg";
+  static constexpr auto kFields = std::make_tuple(
+      DATABENTO_JL_FIELD(hd), DATABENTO_JL_FIELD(price), DATABENTO_JL_FIELD(size),
+      DATABENTO_JL_FIELD(action), DATABENTO_JL_FIELD(side), DATABENTO_JL_FIELD(flags),
+      DATABENTO_JL_FIELD(depth), DATABENTO_JL_FIELD(ts_recv), DATABENTO_JL_FIELD(ts_in_delta),
+      DATABENTO_JL_FIELD(sequence), DATABENTO_JL_FIELD(levels));
+};
+
+template <>
+struct RecordFields<databento::Mbp10Msg> {
+  using Msg = databento::Mbp10Msg;
+  static constexpr const char* kName = "Mbp10Msg";
+  static constexpr auto kFields = std::make_tuple(
+      DATABENTO_JL_FIELD(hd), DATABENTO_JL_FIELD(price), DATABENTO_JL_FIELD(size),
+      DATABENTO_JL_FIELD(action), DATABENTO_JL_FIELD(side), DATABENTO_JL_FIELD(flags),
+      DATABENTO_JL_FIELD(depth), DATABENTO_JL_FIELD(ts_recv), DATABENTO_JL_FIELD(ts_in_delta),
+      DATABENTO_JL_FIELD(sequence), DATABENTO_JL_FIELD(levels));
+};
+
+template <>
+struct RecordFields<databento::BboMsg> {
+  using Msg = databento::BboMsg;
+  static constexpr const char* kName = "BboMsg";
+  static constexpr auto kFields = std::make_tuple(
+      DATABENTO_JL_FIELD(hd), DATABENTO_JL_FIELD(price), DATABENTO_JL_FIELD(size),
+      DATABENTO_JL_FIELD(side), DATABENTO_JL_FIELD(flags), DATABENTO_JL_FIELD(ts_recv),
+      DATABENTO_JL_FIELD(sequence), DATABENTO_JL_FIELD(levels));
+};
+
+template <>
+struct RecordFields<databento::Cmbp1Msg> {
+  using Msg = databento::Cmbp1Msg;
+  static constexpr const char* kName = "Cmbp1Msg";
+  static constexpr auto kFields = std::make_tuple(
+      DATABENTO_JL_FIELD(hd), DATABENTO_JL_FIELD(price), DATABENTO_JL_FIELD(size),
+      DATABENTO_JL_FIELD(action), DATABENTO_JL_FIELD(side), DATABENTO_JL_FIELD(flags),
+      DATABENTO_JL_FIELD(ts_recv), DATABENTO_JL_FIELD(ts_in_delta), DATABENTO_JL_FIELD(levels));
+};
+
+template <>
+struct RecordFields<databento::CbboMsg> {
+  using Msg = databento::CbboMsg;
+  static constexpr const char* kName = "CbboMsg";
+  static constexpr auto kFields = std::make_tuple(
+      DATABENTO_JL_FIELD(hd), DATABENTO_JL_FIELD(price), DATABENTO_JL_FIELD(size),
+      DATABENTO_JL_FIELD(side), DATABENTO_JL_FIELD(flags), DATABENTO_JL_FIELD(ts_recv),
+      DATABENTO_JL_FIELD(levels));
+};
+
+template <>
+struct RecordFields<databento::OhlcvMsg> {
+  using Msg = databento::OhlcvMsg;
+  static constexpr const char* kName = "OhlcvMsg";
+  static constexpr auto kFields =
+      std::make_tuple(DATABENTO_JL_FIELD(hd), DATABENTO_JL_FIELD(open), DATABENTO_JL_FIELD(high),
+                      DATABENTO_JL_FIELD(low), DATABENTO_JL_FIELD(close),
+                      DATABENTO_JL_FIELD(volume));
+};
+
+template <>
+struct RecordFields<databento::StatusMsg> {
+  using Msg = databento::StatusMsg;
+  static constexpr const char* kName = "StatusMsg";
+  static constexpr auto kFields = std::make_tuple(
+      DATABENTO_JL_FIELD(hd), DATABENTO_JL_FIELD(ts_recv), DATABENTO_JL_FIELD(action),
+      DATABENTO_JL_FIELD(reason), DATABENTO_JL_FIELD(trading_event),
+      DATABENTO_JL_FIELD(is_trading), DATABENTO_JL_FIELD(is_quoting),
+      DATABENTO_JL_FIELD(is_short_sell_restricted));
+};
+
+template <>
+struct RecordFields<databento::InstrumentDefMsg> {
+  using Msg = databento::InstrumentDefMsg;
+  static constexpr const char* kName = "InstrumentDefMsg";
+  static constexpr auto kFields = std::make_tuple(
+      DATABENTO_JL_FIELD(hd), DATABENTO_JL_FIELD(ts_recv),
+      DATABENTO_JL_FIELD(min_price_increment), DATABENTO_JL_FIELD(display_factor),
+      DATABENTO_JL_FIELD(expiration), DATABENTO_JL_FIELD(activation),
+      DATABENTO_JL_FIELD(high_limit_price), DATABENTO_JL_FIELD(low_limit_price),
+      DATABENTO_JL_FIELD(max_price_variation), DATABENTO_JL_FIELD(trading_reference_price),
+      DATABENTO_JL_FIELD(unit_of_measure_qty), DATABENTO_JL_FIELD(min_price_increment_amount),
+      DATABENTO_JL_FIELD(price_ratio), DATABENTO_JL_FIELD(strike_price),
+      DATABENTO_JL_FIELD(inst_attrib_value), DATABENTO_JL_FIELD(underlying_id),
+      DATABENTO_JL_FIELD(raw_instrument_id), DATABENTO_JL_FIELD(market_depth_implied),
+      DATABENTO_JL_FIELD(market_depth), DATABENTO_JL_FIELD(market_segment_id),
+      DATABENTO_JL_FIELD(max_trade_vol), DATABENTO_JL_FIELD(min_lot_size),
+      DATABENTO_JL_FIELD(min_lot_size_block), DATABENTO_JL_FIELD(min_lot_size_round_lot),
+      DATABENTO_JL_FIELD(min_trade_vol), DATABENTO_JL_FIELD(contract_multiplier),
+      DATABENTO_JL_FIELD(decay_quantity), DATABENTO_JL_FIELD(original_contract_size),
+      DATABENTO_JL_FIELD(trading_reference_date), DATABENTO_JL_FIELD(appl_id),
+      DATABENTO_JL_FIELD(maturity_year), DATABENTO_JL_FIELD(decay_start_date),
+      DATABENTO_JL_FIELD(channel_id), DATABENTO_JL_FIELD(currency),
+      DATABENTO_JL_FIELD(settl_currency), DATABENTO_JL_FIELD(secsubtype),
+      DATABENTO_JL_FIELD(raw_symbol), DATABENTO_JL_FIELD(group), DATABENTO_JL_FIELD(exchange),
+      DATABENTO_JL_FIELD(asset), DATABENTO_JL_FIELD(cfi), DATABENTO_JL_FIELD(security_type),
+      DATABENTO_JL_FIELD(unit_of_measure), DATABENTO_JL_FIELD(underlying),
+      DATABENTO_JL_FIELD(strike_price_currency), DATABENTO_JL_FIELD(instrument_class),
+      DATABENTO_JL_FIELD(match_algorithm), DATABENTO_JL_FIELD(md_security_trading_status),
+      DATABENTO_JL_FIELD(main_fraction), DATABENTO_JL_FIELD(price_display_format),
+      DATABENTO_JL_FIELD(settl_price_type), DATABENTO_JL_FIELD(sub_fraction),
+      DATABENTO_JL_FIELD(underlying_product), DATABENTO_JL_FIELD(security_update_action),
+      DATABENTO_JL_FIELD(maturity_month), DATABENTO_JL_FIELD(maturity_day),
+      DATABENTO_JL_FIELD(maturity_week), DATABENTO_JL_FIELD(user_defined_instrument),
+      DATABENTO_JL_FIELD(contract_multiplier_unit), DATABENTO_JL_FIELD(flow_schedule_type),
+      DATABENTO_JL_FIELD(tick_rule));
+};
+
+template <>
+struct RecordFields<databento::ImbalanceMsg> {
+  using Msg = databento::ImbalanceMsg;
+  static constexpr const char* kName = "ImbalanceMsg";
+  static constexpr auto kFields = std::make_tuple(
+      DATABENTO_JL_FIELD(hd), DATABENTO_JL_FIELD(ts_recv), DATABENTO_JL_FIELD(ref_price),
+      DATABENTO_JL_FIELD(auction_time), DATABENTO_JL_FIELD(cont_book_clr_price),
+      DATABENTO_JL_FIELD(auct_interest_clr_price), DATABENTO_JL_FIELD(ssr_filling_price),
+      DATABENTO_JL_FIELD(ind_match_price), DATABENTO_JL_FIELD(upper_collar),
+      DATABENTO_JL_FIELD(lower_collar), DATABENTO_JL_FIELD(paired_qty),
+      DATABENTO_JL_FIELD(total_imbalance_qty), DATABENTO_JL_FIELD(market_imbalance_qty),
+      DATABENTO_JL_FIELD(unpaired_qty), DATABENTO_JL_FIELD(auction_type),
+      DATABENTO_JL_FIELD(side), DATABENTO_JL_FIELD(auction_status),
+      DATABENTO_JL_FIELD(freeze_status), DATABENTO_JL_FIELD(num_extensions),
+      DATABENTO_JL_FIELD(unpaired_side), DATABENTO_JL_FIELD(significant_imbalance));
+};
+
+template <>
+struct RecordFields<databento::StatMsg> {
+  using Msg = databento::StatMsg;
+  static constexpr const char* kName = "StatMsg";
+  static constexpr auto kFields = std::make_tuple(
+      DATABENTO_JL_FIELD(hd), DATABENTO_JL_FIELD(ts_recv), DATABENTO_JL_FIELD(ts_ref),
+      DATABENTO_JL_FIELD(price), DATABENTO_JL_FIELD(quantity), DATABENTO_JL_FIELD(sequence),
+      DATABENTO_JL_FIELD(ts_in_delta), DATABENTO_JL_FIELD(stat_type),
+      DATABENTO_JL_FIELD(channel_id), DATABENTO_JL_FIELD(update_action),
+      DATABENTO_JL_FIELD(stat_flags));
+};
+
+template <>
+struct RecordFields<databento::ErrorMsg> {
+  using Msg = databento::ErrorMsg;
+  static constexpr const char* kName = "ErrorMsg";
+  static constexpr auto kFields = std::make_tuple(DATABENTO_JL_FIELD(hd), DATABENTO_JL_FIELD(err),
+                                                  DATABENTO_JL_FIELD(code),
+                                                  DATABENTO_JL_FIELD(is_last));
+};
+
+template <>
+struct RecordFields<databento::SystemMsg> {
+  using Msg = databento::SystemMsg;
+  static constexpr const char* kName = "SystemMsg";
+  static constexpr auto kFields =
+      std::make_tuple(DATABENTO_JL_FIELD(hd), DATABENTO_JL_FIELD(msg), DATABENTO_JL_FIELD(code));
+};
+
+template <>
+struct RecordFields<databento::SymbolMappingMsg> {
+  using Msg = databento::SymbolMappingMsg;
+  static constexpr const char* kName = "SymbolMappingMsg";
+  static constexpr auto kFields = std::make_tuple(
+      DATABENTO_JL_FIELD(hd), DATABENTO_JL_FIELD(stype_in), DATABENTO_JL_FIELD(stype_in_symbol),
+      DATABENTO_JL_FIELD(stype_out), DATABENTO_JL_FIELD(stype_out_symbol),
+      DATABENTO_JL_FIELD(start_ts), DATABENTO_JL_FIELD(end_ts));
+};
+
+#undef DATABENTO_JL_FIELD
+
+// Calls `fn` with every Field of Msg's table, in order
+template <typename Msg, typename Fn>
+void ForEachField(Fn&& fn) {
+  std::apply([&fn](const auto&... fields) { (fn(fields), ...); }, RecordFields<Msg>::kFields);
+}
+
+// Offsets and sizes of Msg's fields, in table order
+template <typename Msg>
+std::vector<FieldLayout> Layout() {
+  static const Msg probe{};
+  const auto* base = reinterpret_cast<const char*>(&probe);
+  std::vector<FieldLayout> layout;
+  ForEachField<Msg>([&](const auto& field) {
+    const auto& value = probe.*field.member;
+    layout.push_back({field.name,
+                      static_cast<std::size_t>(reinterpret_cast<const char*>(&value) - base),
+                      sizeof(value)});
+  });
+  return layout;
+}
+
+}  // namespace databento_jl
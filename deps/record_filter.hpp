@@ -0,0 +1,212 @@
+#pragma once
+
+#include <databento/enums.hpp>
+#include <databento/record.hpp>
+
+#include <algorithm>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "record_util.hpp"
+
+namespace databento_jl {
+
+// Predicate evaluated inside the decode loop so rejected records never cross
+// into Julia.
+//
+// Conditions are combined with AND; an unset condition accepts everything,
+// so a default-constructed filter matches every record. RType, instrument,
+// publisher and ts_event checks read only the RecordHeader and run first;
+// the index timestamp (ts_recv for most schemas) and the MBO/MBP action and
+// side are only inspected for records that pass the header checks.
+class RecordFilter {
+ public:
+  static constexpr std::uint64_t kMinTs = 0;
+  static constexpr std::uint64_t kMaxTs = std::numeric_limits<std::uint64_t>::max();
+
+  void AddInstrumentId(std::uint32_t id) {
+    instrument_ids_.insert(
+        std::upper_bound(instrument_ids_.begin(), instrument_ids_.end(), id), id);
+  }
+  void AddPublisherId(std::uint16_t id) {
+    publisher_ids_.insert(
+        std::upper_bound(publisher_ids_.begin(), publisher_ids_.end(), id), id);
+  }
+  void AddRType(databento::RType rtype) { rtypes_.set(static_cast<std::uint8_t>(rtype)); }
+  void AddAction(databento::Action action) { actions_.set(static_cast<unsigned char>(action)); }
+  void AddSide(databento::Side side) { sides_.set(static_cast<unsigned char>(side)); }
+  // Half-open [start, end) ranges in nanoseconds since the UNIX epoch
+  void SetTsEventRange(std::uint64_t start, std::uint64_t end) {
+    ts_event_start_ = start;
+    ts_event_end_ = end;
+  }
+  void SetTsRecvRange(std::uint64_t start, std::uint64_t end) {
+    ts_recv_start_ = start;
+    ts_recv_end_ = end;
+  }
+  // Lets FilteredSource stop at the first record at or past the end of the
+  // ts_recv range. Only correct for sources ordered by index timestamp, which
+  // DBN files are not guaranteed to be, so it is off by default.
+  void SetStopAtTsRecvEnd(bool stop) { stop_at_ts_recv_end_ = stop; }
+  bool StopsAtTsRecvEnd() const { return stop_at_ts_recv_end_ && HasTsRecvRange(); }
+  // Clears every condition; the counters keep their totals until
+  // ResetCounters()
+  void Reset() {
+    const std::uint64_t scanned = records_scanned_;
+    const std::uint64_t matched = records_matched_;
+    *this = RecordFilter{};
+    records_scanned_ = scanned;
+    records_matched_ = matched;
+  }
+
+  // Totals over every FilteredSource that used this filter
+  std::uint64_t RecordsScanned() const { return records_scanned_; }
+  std::uint64_t RecordsMatched() const { return records_matched_; }
+  void ResetCounters() {
+    records_scanned_ = 0;
+    records_matched_ = 0;
+  }
+
+  bool IsEmpty() const {
+    return instrument_ids_.empty() && publisher_ids_.empty() && rtypes_.none() &&
+           actions_.none() && sides_.none() && ts_event_start_ == kMinTs &&
+           ts_event_end_ == kMaxTs && !HasTsRecvRange();
+  }
+  bool HasTsRecvRange() const {
+    return ts_recv_start_ != kMinTs || ts_recv_end_ != kMaxTs;
+  }
+  std::uint64_t TsRecvEnd() const { return ts_recv_end_; }
+
+  bool MatchesHeader(const databento::RecordHeader& hd) const {
+    if (rtypes_.any() && !rtypes_.test(static_cast<std::uint8_t>(hd.rtype))) {
+      return false;
+    }
+    if (!instrument_ids_.empty() &&
+        !std::binary_search(instrument_ids_.begin(), instrument_ids_.end(),
+                            hd.instrument_id)) {
+      return false;
+    }
+    if (!publisher_ids_.empty() &&
+        !std::binary_search(publisher_ids_.begin(), publisher_ids_.end(),
+                            hd.publisher_id)) {
+      return false;
+    }
+    const std::uint64_t ts_event = hd.ts_event.time_since_epoch().count();
+    return ts_event >= ts_event_start_ && ts_event < ts_event_end_;
+  }
+
+  bool Matches(const databento::Record& record) const {
+    if (!MatchesHeader(record.Header())) {
+      return false;
+    }
+    if (HasTsRecvRange()) {
+      const std::uint64_t ts = IndexTs(record).time_since_epoch().count();
+      if (ts < ts_recv_start_ || ts >= ts_recv_end_) {
+        return false;
+      }
+    }
+    if (actions_.any() || sides_.any()) {
+      databento::Action action;
+      databento::Side side;
+      if (!ActionAndSide(record, &action, &side)) {
+        // Action and side conditions only constrain records that carry them
+        return true;
+      }
+      if (actions_.any() && !actions_.test(static_cast<unsigned char>(action))) {
+        return false;
+      }
+      if (sides_.any() && !sides_.test(static_cast<unsigned char>(side))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  static bool ActionAndSide(const databento::Record& record,
+                            databento::Action* action, databento::Side* side) {
+    if (const auto* mbo = record.GetIf<databento::MboMsg>()) {
+      *action = mbo->action;
+      *side = mbo->side;
+    } else if (const auto* trade = record.GetIf<databento::TradeMsg>()) {
+      *action = trade->action;
+      *side = trade->side;
+    } else if (const auto* mbp1 = record.GetIf<databento::Mbp1Msg>()) {
+      *action = mbp1->action;
+      *side = mbp1->side;
+    } else if (const auto* mbp10 = record.GetIf<databento::Mbp10Msg>()) {
+      *action = mbp10->action;
+      *side = mbp10->side;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  std::vector<std::uint32_t> instrument_ids_;
+  std::vector<std::uint16_t> publisher_ids_;
+  std::bitset<256> rtypes_;
+  std::bitset<256> actions_;
+  std::bitset<256> sides_;
+  std::uint64_t ts_event_start_{kMinTs};
+  std::uint64_t ts_event_end_{kMaxTs};
+  std::uint64_t ts_recv_start_{kMinTs};
+  std::uint64_t ts_recv_end_{kMaxTs};
+  bool stop_at_ts_recv_end_{};
+  std::uint64_t records_scanned_{};
+  std::uint64_t records_matched_{};
+
+  template <typename Source>
+  friend class FilteredSource;
+};
+
+// Sources that keep pipeline counters (NoteFiltered) learn which of their
+// records a filter rejected
+template <typename Source>
+auto NoteFiltered(Source& source, int) -> decltype(source.NoteFiltered()) {
+  source.NoteFiltered();
+}
+template <typename Source>
+void NoteFiltered(Source&, long) {}
+
+// Record source adapter that yields only the records of `Source` accepted by
+// `filter`, adding to the filter's counters. When the filter stops at the end
+// of its ts_recv range (SetStopAtTsRecvEnd), iteration ends at the first
+// record at or past it instead of scanning the rest of the source.
+template <typename Source>
+class FilteredSource {
+ public:
+  FilteredSource(Source& source, RecordFilter& filter)
+      : source_{source}, filter_{filter} {}
+
+  const databento::Record* NextRecord() {
+    if (done_) {
+      return nullptr;
+    }
+    while (const databento::Record* record = source_.NextRecord()) {
+      ++filter_.records_scanned_;
+      if (filter_.Matches(*record)) {
+        ++filter_.records_matched_;
+        return record;
+      }
+      NoteFiltered(source_, 0);
+      if (filter_.StopsAtTsRecvEnd() &&
+          static_cast<std::uint64_t>(IndexTs(*record).time_since_epoch().count()) >=
+              filter_.TsRecvEnd()) {
+        break;
+      }
+    }
+    done_ = true;
+    return nullptr;
+  }
+
+ private:
+  Source& source_;
+  RecordFilter& filter_;
+  bool done_{};
+};
+
+}  // namespace databento_jl
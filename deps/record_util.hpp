@@ -0,0 +1,62 @@
+#pragma once
+
+#include <databento/datetime.hpp>
+#include <databento/enums.hpp>
+#include <databento/record.hpp>
+
+namespace databento_jl {
+
+// Index timestamp of any record, matching the IndexTs() member of the
+// concrete message type: ts_recv where the schema has one and ts_event for
+// OHLCV bars and gateway records (error, system, symbol mapping).
+inline databento::UnixNanos IndexTs(const databento::Record& record) {
+  switch (record.RType()) {
+    case databento::RType::Mbo:
+      return record.Get<databento::MboMsg>().IndexTs();
+    case databento::RType::Mbp0:
+      return record.Get<databento::TradeMsg>().IndexTs();
+    case databento::RType::Mbp1:
+      return record.Get<databento::Mbp1Msg>().IndexTs();
+    case databento::RType::Mbp10:
+      return record.Get<databento::Mbp10Msg>().IndexTs();
+    case databento::RType::Bbo1S:
+    case databento::RType::Bbo1M:
+      return record.Get<databento::BboMsg>().IndexTs();
+    case databento::RType::Cmbp1:
+    case databento::RType::Tcbbo:
+      return record.Get<databento::Cmbp1Msg>().IndexTs();
+    case databento::RType::Cbbo1S:
+    case databento::RType::Cbbo1M:
+      return record.Get<databento::CbboMsg>().IndexTs();
+    case databento::RType::Status:
+      return record.Get<databento::StatusMsg>().IndexTs();
+    case databento::RType::InstrumentDef:
+      return record.Get<databento::InstrumentDefMsg>().IndexTs();
+    case databento::RType::Imbalance:
+      return record.Get<databento::ImbalanceMsg>().IndexTs();
+    case databento::RType::Statistics:
+      return record.Get<databento::StatMsg>().IndexTs();
+    default:
+      return record.Header().ts_event;
+  }
+}
+
+// Non-owning handle to any record source, so code generic over sources can
+// be compiled once for all of them at the cost of an indirect call per
+// record. The source must outlive the handle.
+class RecordSourceRef {
+ public:
+  template <typename Source>
+  explicit RecordSourceRef(Source& source)
+      : source_{&source}, next_record_{[](void* s) -> const databento::Record* {
+          return static_cast<Source*>(s)->NextRecord();
+        }} {}
+
+  const databento::Record* NextRecord() { return next_record_(source_); }
+
+ private:
+  void* source_;
+  const databento::Record* (*next_record_)(void*);
+};
+
+}  // namespace databento_jl
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <databento/record.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+namespace databento_jl {
+
+// Bounded single-producer single-consumer queue of DBN records.
+//
+// Storage is allocated once as `capacity` fixed-size slots of `slot_bytes`
+// bytes; pushing copies a record into the next free slot and pulling hands
+// out a Record pointing into its slot, so neither side locks or allocates.
+// Head and tail live on separate cache lines and each side keeps a cached
+// copy of the other's index to avoid touching the shared line on every call.
+class SpscRecordRing {
+ public:
+  enum class PushResult : std::uint8_t { Ok, Full, Oversize };
+
+  SpscRecordRing(std::size_t capacity, std::size_t slot_bytes) {
+    if (capacity < 2) {
+      throw std::invalid_argument{"Ring capacity must be at least 2 slots"};
+    }
+    if (slot_bytes < sizeof(databento::RecordHeader)) {
+      throw std::invalid_argument{"Ring slots must hold at least a record header"};
+    }
+    std::size_t rounded = 2;
+    while (rounded < capacity) {
+      rounded *= 2;
+    }
+    mask_ = rounded - 1;
+    slot_words_ = (slot_bytes + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+    storage_ = std::make_unique<std::uint64_t[]>(rounded * slot_words_);
+  }
+  SpscRecordRing(const SpscRecordRing&) = delete;
+  SpscRecordRing& operator=(const SpscRecordRing&) = delete;
+
+  std::size_t Capacity() const { return mask_ + 1; }
+  std::size_t SlotBytes() const { return slot_words_ * sizeof(std::uint64_t); }
+  // Approximate when called from neither side
+  std::size_t Size() const {
+    return static_cast<std::size_t>(head_.load(std::memory_order_acquire) -
+                                    tail_.load(std::memory_order_acquire));
+  }
+
+  // Producer side
+  PushResult TryPush(const databento::Record& record) {
+    const std::size_t size = record.Size();
+    if (size > SlotBytes()) {
+      return PushResult::Oversize;
+    }
+    const std::uint64_t head = head_.load(std::memory_order_relaxed);
+    if (head - cached_tail_ > mask_) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head - cached_tail_ > mask_) {
+        return PushResult::Full;
+      }
+    }
+    std::memcpy(Slot(head), &record.Header(), size);
+    head_.store(head + 1, std::memory_order_release);
+    return PushResult::Ok;
+  }
+
+  // Consumer side: the oldest record, or nullptr if the ring is empty. The
+  // record stays valid until Pop.
+  const databento::Record* Front() {
+    const std::uint64_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == cached_head_) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail == cached_head_) {
+        return nullptr;
+      }
+    }
+    front_ = databento::Record{reinterpret_cast<databento::RecordHeader*>(Slot(tail))};
+    return &front_;
+  }
+  void Pop() { tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+ private:
+  std::uint64_t* Slot(std::uint64_t index) {
+    return storage_.get() + (index & mask_) * slot_words_;
+  }
+
+  std::size_t mask_{};
+  std::size_t slot_words_{};
+  std::unique_ptr<std::uint64_t[]> storage_;
+
+  alignas(64) std::atomic<std::uint64_t> head_{0};
+  std::uint64_t cached_tail_{0};  // producer's view of tail_
+
+  alignas(64) std::atomic<std::uint64_t> tail_{0};
+  std::uint64_t cached_head_{0};  // consumer's view of head_
+  databento::Record front_{nullptr};
+};
+
+}  // namespace databento_jl
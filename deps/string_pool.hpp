@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace databento_jl {
+
+// Interned strings referred to by 1-based 32-bit IDs, with 0 standing for
+// the empty string. Strings are stored once in a deque, whose elements never
+// move, so the index can key on views of them and interning a string that
+// is already present allocates nothing.
+class StringPool {
+ public:
+  static constexpr std::uint32_t kEmpty = 0;
+
+  StringPool() = default;
+  // The index refers into this pool's own strings, so a copy rebuilds it
+  StringPool(const StringPool& other) : strings_{other.strings_} { Reindex(); }
+  StringPool& operator=(const StringPool& other) {
+    if (this != &other) {
+      strings_ = other.strings_;
+      Reindex();
+    }
+    return *this;
+  }
+  StringPool(StringPool&&) = default;
+  StringPool& operator=(StringPool&&) = default;
+
+  std::uint32_t Intern(std::string_view text) {
+    if (text.empty()) {
+      return kEmpty;
+    }
+    const auto it = ids_.find(text);
+    if (it != ids_.end()) {
+      return it->second;
+    }
+    const std::string& stored = strings_.emplace_back(text);
+    const auto id = static_cast<std::uint32_t>(strings_.size());
+    ids_.emplace(stored, id);
+    return id;
+  }
+
+  // ID of an interned string, or kEmpty
+  std::uint32_t Find(std::string_view text) const {
+    const auto it = ids_.find(text);
+    return it == ids_.end() ? kEmpty : it->second;
+  }
+
+  // Throws std::out_of_range unless id <= Size()
+  const std::string& At(std::uint32_t id) const {
+    static const std::string empty;
+    if (id == kEmpty) {
+      return empty;
+    }
+    if (id > strings_.size()) {
+      throw std::out_of_range{"No string with ID " + std::to_string(id)};
+    }
+    return strings_[id - 1];
+  }
+
+  std::size_t Size() const { return strings_.size(); }
+  // The strings in ID order, so the string with ID i is element i - 1
+  std::vector<std::string> Strings() const {
+    return std::vector<std::string>(strings_.begin(), strings_.end());
+  }
+
+  void Clear() {
+    ids_.clear();
+    strings_.clear();
+  }
+
+ private:
+  void Reindex() {
+    ids_.clear();
+    for (std::size_t i = 0; i < strings_.size(); ++i) {
+      ids_.emplace(strings_[i], static_cast<std::uint32_t>(i + 1));
+    }
+  }
+
+  std::deque<std::string> strings_;
+  std::unordered_map<std::string_view, std::uint32_t> ids_;
+};
+
+}  // namespace databento_jl
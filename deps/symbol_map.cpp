@@ -0,0 +1,266 @@
+#include "symbol_map.hpp"
+
+#include <date/date.h>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#include "output_file.hpp"
+
+namespace databento_jl {
+
+namespace {
+constexpr char kCacheMagic[8] = {'D', 'B', 'N', 'S', 'Y', 'M', 'A', 'P'};
+constexpr std::uint32_t kCacheVersion = 1;
+
+static_assert(std::is_trivially_copyable<SymbolInterval>::value &&
+                  sizeof(SymbolInterval) == 4 * sizeof(std::uint32_t),
+              "SymbolInterval is written to disk as-is");
+
+std::uint32_t DaysSinceEpoch(const date::year_month_day& ymd) {
+  return static_cast<std::uint32_t>(date::sys_days{ymd}.time_since_epoch().count());
+}
+
+// Instrument IDs arrive as decimal strings in symbology; anything else, such
+// as an unresolved symbol, is skipped
+bool ParseInstrumentId(const std::string& text, std::uint32_t& instrument_id) {
+  const char* end = text.data() + text.size();
+  const auto [ptr, ec] = std::from_chars(text.data(), end, instrument_id);
+  return ec == std::errc{} && ptr == end && !text.empty();
+}
+
+template <typename T>
+void ReadPod(std::ifstream& in, T& value, const std::string& path) {
+  if (!in.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+    throw std::runtime_error{path + " is a truncated symbol map cache"};
+  }
+}
+}  // namespace
+
+void TsSymbolMap::Insert(std::uint32_t instrument_id, std::uint32_t start_date,
+                         std::uint32_t end_date, const std::string& symbol) {
+  if (start_date >= end_date || symbol.empty()) {
+    return;
+  }
+  const SymbolInterval interval{instrument_id, start_date, end_date, symbols_.Intern(symbol)};
+  intervals_.push_back(interval);
+  Map(interval);
+}
+
+void TsSymbolMap::InsertMetadata(const databento::Metadata& metadata) {
+  const bool by_instrument_id = metadata.stype_in == databento::SType::InstrumentId;
+  for (const auto& mapping : metadata.mappings) {
+    for (const auto& interval : mapping.intervals) {
+      const std::string& id_text = by_instrument_id ? mapping.raw_symbol : interval.symbol;
+      const std::string& symbol = by_instrument_id ? interval.symbol : mapping.raw_symbol;
+      std::uint32_t instrument_id;
+      if (ParseInstrumentId(id_text, instrument_id)) {
+        Insert(instrument_id, DaysSinceEpoch(interval.start_date),
+               DaysSinceEpoch(interval.end_date), symbol);
+      }
+    }
+  }
+}
+
+void TsSymbolMap::InsertResolution(const databento::SymbologyResolution& resolution) {
+  const bool by_instrument_id = resolution.stype_in == databento::SType::InstrumentId;
+  for (const auto& [requested, intervals] : resolution.mappings) {
+    for (const auto& interval : intervals) {
+      const std::string& id_text = by_instrument_id ? requested : interval.symbol;
+      const std::string& symbol = by_instrument_id ? interval.symbol : requested;
+      std::uint32_t instrument_id;
+      if (ParseInstrumentId(id_text, instrument_id)) {
+        Insert(instrument_id, DaysSinceEpoch(interval.start_date),
+               DaysSinceEpoch(interval.end_date), symbol);
+      }
+    }
+  }
+}
+
+bool TsSymbolMap::Apply(const databento::Record& record) {
+  if (!record.Holds<databento::SymbolMappingMsg>()) {
+    return false;
+  }
+  const auto& msg = record.Get<databento::SymbolMappingMsg>();
+  const std::uint64_t start_ts = msg.start_ts.time_since_epoch().count();
+  const std::uint64_t end_ts = msg.end_ts.time_since_epoch().count();
+  const std::uint32_t start_date = DateOf(start_ts);
+  // end_ts is exclusive: a mapping ending at midnight does not cover that day
+  const std::uint32_t end_date =
+      (end_ts == std::numeric_limits<std::uint64_t>::max() || end_ts <= start_ts)
+          ? start_date + 1
+          : DateOf(end_ts - 1) + 1;
+  Insert(msg.hd.instrument_id, start_date, end_date, msg.STypeOutSymbol());
+  return true;
+}
+
+std::uint32_t TsSymbolMap::Find(std::uint32_t instrument_id, std::uint32_t date) const {
+  const std::vector<SymbolSpan>* spans = spans_.Find(instrument_id);
+  if (spans == nullptr) {
+    return kNoSymbol;
+  }
+  // Spans don't overlap, so the first one ending after `date` is the only
+  // one that can hold it
+  const auto it = std::upper_bound(
+      spans->begin(), spans->end(), date,
+      [](std::uint32_t d, const SymbolSpan& span) { return d < span.end_date; });
+  return it != spans->end() && it->start_date <= date ? it->symbol_id : kNoSymbol;
+}
+
+void TsSymbolMap::FindAll(const std::uint32_t* instrument_ids, const std::uint64_t* ts,
+                          std::uint32_t* symbol_ids, std::size_t n) const {
+  for (std::size_t i = 0; i < n; ++i) {
+    symbol_ids[i] = Find(instrument_ids[i], DateOf(ts[i]));
+  }
+}
+
+void TsSymbolMap::FindAll(const std::uint32_t* instrument_ids, std::uint32_t date,
+                          std::uint32_t* symbol_ids, std::size_t n) const {
+  for (std::size_t i = 0; i < n; ++i) {
+    symbol_ids[i] = Find(instrument_ids[i], date);
+  }
+}
+
+const std::string& TsSymbolMap::Symbol(std::uint32_t symbol_id) const {
+  if (symbol_id == kNoSymbol) {
+    throw std::out_of_range{"Symbol ID 0 stands for no symbol"};
+  }
+  return symbols_.At(symbol_id);
+}
+
+std::uint32_t TsSymbolMap::SymbolId(const std::string& symbol) const {
+  return symbols_.Find(symbol);
+}
+
+void TsSymbolMap::Clear() {
+  symbols_.Clear();
+  spans_.Clear();
+  span_count_ = 0;
+  intervals_.clear();
+}
+
+void TsSymbolMap::Map(const SymbolInterval& interval) {
+  std::vector<SymbolSpan>& spans = spans_[interval.instrument_id];
+  // [first, last) are the spans the new interval overlaps
+  const auto first = std::upper_bound(
+      spans.begin(), spans.end(), interval.start_date,
+      [](std::uint32_t d, const SymbolSpan& span) { return d < span.end_date; });
+  auto last = first;
+  while (last != spans.end() && last->start_date < interval.end_date) {
+    ++last;
+  }
+  // The parts of overlapped spans outside the new interval keep their symbol
+  std::array<SymbolSpan, 3> replacement;
+  std::size_t n = 0;
+  if (first != last && first->start_date < interval.start_date) {
+    replacement[n++] = SymbolSpan{first->start_date, interval.start_date, first->symbol_id};
+  }
+  replacement[n++] = SymbolSpan{interval.start_date, interval.end_date, interval.symbol_id};
+  if (first != last && std::prev(last)->end_date > interval.end_date) {
+    const SymbolSpan& tail = *std::prev(last);
+    replacement[n++] = SymbolSpan{interval.end_date, tail.end_date, tail.symbol_id};
+  }
+  span_count_ = span_count_ - static_cast<std::size_t>(last - first) + n;
+  const auto at = spans.erase(first, last);
+  spans.insert(at, replacement.begin(), replacement.begin() + n);
+}
+
+void TsSymbolMap::Save(const std::string& cache_path) const {
+  OutputFile out{cache_path};
+  out.Write(kCacheMagic, sizeof(kCacheMagic));
+  out.WritePod(kCacheVersion);
+  out.WritePod(std::uint32_t{0});
+  out.WritePod(static_cast<std::uint64_t>(symbols_.Size()));
+  out.WritePod(static_cast<std::uint64_t>(intervals_.size()));
+  // Symbols as length-prefixed strings, in symbol ID order
+  for (std::uint32_t id = 1; id <= symbols_.Size(); ++id) {
+    const std::string& symbol = symbols_.At(id);
+    out.WritePod(static_cast<std::uint32_t>(symbol.size()));
+    out.Write(symbol.data(), symbol.size());
+  }
+  out.Write(intervals_.data(), intervals_.size() * sizeof(SymbolInterval));
+  out.Commit();
+}
+
+TsSymbolMap TsSymbolMap::Load(const std::string& cache_path) {
+  std::ifstream in{cache_path, std::ios::binary | std::ios::ate};
+  if (!in) {
+    throw std::runtime_error{"Failed to open symbol map cache " + cache_path};
+  }
+  const auto file_size = static_cast<std::uint64_t>(in.tellg());
+  in.seekg(0);
+  // Counts and lengths come from the file, so each is checked against the
+  // bytes left before anything is allocated for it
+  const auto remaining = [&in, file_size] {
+    return file_size - static_cast<std::uint64_t>(in.tellg());
+  };
+  char magic[sizeof(kCacheMagic)];
+  if (!in.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, kCacheMagic, sizeof(magic)) != 0) {
+    throw std::runtime_error{cache_path + " is not a symbol map cache"};
+  }
+  std::uint32_t version;
+  std::uint32_t reserved;
+  std::uint64_t symbol_count;
+  std::uint64_t interval_count;
+  ReadPod(in, version, cache_path);
+  if (version != kCacheVersion) {
+    throw std::runtime_error{cache_path + " has unsupported cache version " +
+                             std::to_string(version)};
+  }
+  ReadPod(in, reserved, cache_path);
+  ReadPod(in, symbol_count, cache_path);
+  ReadPod(in, interval_count, cache_path);
+  if (symbol_count > remaining() / sizeof(std::uint32_t) ||
+      interval_count > remaining() / sizeof(SymbolInterval)) {
+    throw std::runtime_error{cache_path + " is a truncated symbol map cache: it lists " +
+                             std::to_string(symbol_count) + " symbols and " +
+                             std::to_string(interval_count) + " intervals in " +
+                             std::to_string(remaining()) + " bytes"};
+  }
+
+  TsSymbolMap map;
+  for (std::uint64_t i = 0; i < symbol_count; ++i) {
+    std::uint32_t size;
+    ReadPod(in, size, cache_path);
+    if (size > remaining()) {
+      throw std::runtime_error{cache_path + " is a truncated symbol map cache: symbol " +
+                               std::to_string(i + 1) + " is " + std::to_string(size) +
+                               " bytes long with " + std::to_string(remaining()) + " left"};
+    }
+    std::string symbol(size, '\0');
+    if (!in.read(symbol.data(), size)) {
+      throw std::runtime_error{cache_path + " is a truncated symbol map cache"};
+    }
+    map.symbols_.Intern(symbol);
+  }
+  if (interval_count * sizeof(SymbolInterval) > remaining()) {
+    throw std::runtime_error{cache_path + " is a truncated symbol map cache: " +
+                             std::to_string(interval_count) + " intervals need " +
+                             std::to_string(interval_count * sizeof(SymbolInterval)) +
+                             " bytes, " + std::to_string(remaining()) + " left"};
+  }
+  map.intervals_.resize(static_cast<std::size_t>(interval_count));
+  if (!in.read(reinterpret_cast<char*>(map.intervals_.data()),
+               static_cast<std::streamsize>(interval_count * sizeof(SymbolInterval)))) {
+    throw std::runtime_error{cache_path + " is a truncated symbol map cache"};
+  }
+  // Replaying in insertion order reproduces later mappings replacing
+  // earlier ones
+  for (const SymbolInterval& interval : map.intervals_) {
+    if (interval.symbol_id == kNoSymbol || interval.symbol_id > map.symbols_.Size()) {
+      throw std::runtime_error{cache_path + " refers to an unknown symbol"};
+    }
+    map.Map(interval);
+  }
+  return map;
+}
+
+}  // namespace databento_jl
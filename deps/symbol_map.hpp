@@ -0,0 +1,120 @@
+#pragma once
+
+#include <databento/dbn.hpp>
+#include <databento/record.hpp>
+#include <databento/symbology.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "flat_hash_map.hpp"
+#include "string_pool.hpp"
+
+namespace databento_jl {
+
+// `instrument_id` stands for the interned symbol `symbol_id` on the UTC dates
+// [start_date, end_date), counted in days since the UNIX epoch
+struct SymbolInterval {
+  std::uint32_t instrument_id;
+  std::uint32_t start_date;
+  std::uint32_t end_date;
+  std::uint32_t symbol_id;
+};
+
+// Dates [start_date, end_date) on which an instrument maps to `symbol_id`
+struct SymbolSpan {
+  std::uint32_t start_date;
+  std::uint32_t end_date;
+  std::uint32_t symbol_id;
+};
+
+// Point-in-time map from (instrument_id, date) to symbol.
+//
+// Every symbol is stored once and referred to by a 1-based symbol ID, with 0
+// meaning unmapped, so lookups over a column of instrument IDs produce a
+// column of small integers instead of strings. Each instrument has a sorted
+// run of non-overlapping spans, found with one probe of a flat hash map, and
+// a lookup binary-searches that run, so memory grows with the number of
+// mappings rather than with the days they cover.
+//
+// The map is filled from DBN metadata, symbology resolutions and in-stream
+// SymbolMappingMsg records. A later mapping for the same instrument and day
+// replaces the earlier one. The intervals are kept in insertion order so the
+// map can be saved to a compact cache file and rebuilt from it.
+class TsSymbolMap {
+ public:
+  static constexpr std::uint32_t kNoSymbol = StringPool::kEmpty;
+
+  TsSymbolMap() = default;
+
+  void Insert(std::uint32_t instrument_id, std::uint32_t start_date,
+              std::uint32_t end_date, const std::string& symbol);
+  // Mappings from a DBN header. Metadata with stype_in instrument_id maps
+  // the other way round from symbology requests by symbol.
+  void InsertMetadata(const databento::Metadata& metadata);
+  void InsertResolution(const databento::SymbologyResolution& resolution);
+  // Applies a SymbolMappingMsg, mapping its output symbol on the dates from
+  // start_ts to end_ts. An open-ended mapping covers the date of start_ts.
+  // Returns false for any other record.
+  bool Apply(const databento::Record& record);
+
+  // Reads up to `max_records` records from `source`, applying the symbol
+  // mappings among them. Returns the number of records read.
+  template <typename Source>
+  std::size_t Consume(Source& source, std::size_t max_records) {
+    std::size_t n = 0;
+    while (n < max_records) {
+      const databento::Record* record = source.NextRecord();
+      if (record == nullptr) {
+        break;
+      }
+      ++n;
+      Apply(*record);
+    }
+    return n;
+  }
+
+  // Symbol ID of `instrument_id` on `date`, or kNoSymbol
+  std::uint32_t Find(std::uint32_t instrument_id, std::uint32_t date) const;
+  // Symbol IDs of `n` instruments, each on the UTC date of its timestamp
+  void FindAll(const std::uint32_t* instrument_ids, const std::uint64_t* ts,
+               std::uint32_t* symbol_ids, std::size_t n) const;
+  // Symbol IDs of `n` instruments on one date
+  void FindAll(const std::uint32_t* instrument_ids, std::uint32_t date,
+               std::uint32_t* symbol_ids, std::size_t n) const;
+
+  // Throws std::out_of_range unless 1 <= symbol_id <= SymbolCount()
+  const std::string& Symbol(std::uint32_t symbol_id) const;
+  // Symbol ID of an interned symbol, or kNoSymbol
+  std::uint32_t SymbolId(const std::string& symbol) const;
+  std::vector<std::string> Symbols() const { return symbols_.Strings(); }
+
+  std::size_t SymbolCount() const { return symbols_.Size(); }
+  // Spans across all instruments once later mappings have cut earlier ones
+  std::size_t EntryCount() const { return span_count_; }
+  const std::vector<SymbolInterval>& Intervals() const { return intervals_; }
+  bool Empty() const { return intervals_.empty(); }
+  void Clear();
+
+  void Save(const std::string& cache_path) const;
+  static TsSymbolMap Load(const std::string& cache_path);
+
+  static std::uint32_t DateOf(std::uint64_t ts) {
+    return static_cast<std::uint32_t>(ts / kNanosPerDay);
+  }
+
+ private:
+  static constexpr std::uint64_t kNanosPerDay = 86'400'000'000'000ULL;
+
+  void Map(const SymbolInterval& interval);
+
+  StringPool symbols_;
+  // Spans of each instrument, sorted by date
+  FlatHashMap<std::uint32_t, std::vector<SymbolSpan>> spans_;
+  std::size_t span_count_{};
+  std::vector<SymbolInterval> intervals_;
+};
+
+}  // namespace databento_jl
@@ -0,0 +1,403 @@
+#include "synthetic_dbn.hpp"
+
+#include <databento/constants.hpp>
+#include <databento/dbn.hpp>
+#include <databento/dbn_encoder.hpp>
+#include <databento/iwritable.hpp>
+#include <databento/record.hpp>
+
+#include <date/date.h>
+#include <zstd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+namespace databento_jl {
+
+namespace {
+constexpr std::uint64_t kNanosPerDay = 86'400'000'000'000ULL;
+constexpr std::int64_t kTick = 250'000'000;  // 0.25 at 1e-9 precision
+constexpr std::size_t kMaxRestingOrders = 1'000;
+
+// DBN output to a file, optionally zstd-compressed. With a nonzero
+// `frame_size` a new frame starts every `frame_size` uncompressed bytes,
+// wherever that falls in a record; otherwise the file is a single frame.
+class FileSink : public databento::IWritable {
+ public:
+  FileSink(const std::string& path, bool zstd, std::size_t frame_size)
+      : path_{path}, frame_size_{frame_size} {
+    file_ = std::fopen(path.c_str(), "wb");
+    if (file_ == nullptr) {
+      throw std::system_error{errno, std::generic_category(), "Failed to create " + path};
+    }
+    if (zstd) {
+      cctx_ = ZSTD_createCCtx();
+      out_.resize(ZSTD_CStreamOutSize());
+    }
+  }
+  FileSink(const FileSink&) = delete;
+  FileSink& operator=(const FileSink&) = delete;
+  ~FileSink() override {
+    ZSTD_freeCCtx(cctx_);
+    if (file_ != nullptr) {
+      std::fclose(file_);
+    }
+  }
+
+  void WriteAll(const std::byte* buffer, std::size_t length) override {
+    if (cctx_ == nullptr) {
+      WriteRaw(buffer, length);
+      return;
+    }
+    while (length > 0) {
+      const std::size_t take =
+          frame_size_ == 0 ? length : std::min(length, frame_size_ - in_frame_);
+      ZSTD_inBuffer in{buffer, take, 0};
+      while (in.pos < in.size) {
+        Compress(in, ZSTD_e_continue);
+      }
+      buffer += take;
+      length -= take;
+      in_frame_ += take;
+      if (frame_size_ != 0 && in_frame_ == frame_size_) {
+        EndFrame();
+      }
+    }
+  }
+
+  // Ends the last zstd frame and closes the file. Returns the file size.
+  std::uint64_t Finish() {
+    if (cctx_ != nullptr && (frame_size_ == 0 || in_frame_ != 0)) {
+      EndFrame();
+    }
+    const int status = std::fclose(file_);
+    file_ = nullptr;
+    if (status != 0) {
+      throw std::system_error{errno, std::generic_category(), "Failed to write " + path_};
+    }
+    return written_;
+  }
+
+ private:
+  void EndFrame() {
+    ZSTD_inBuffer in{nullptr, 0, 0};
+    while (Compress(in, ZSTD_e_end) != 0) {
+    }
+    in_frame_ = 0;
+  }
+
+  std::size_t Compress(ZSTD_inBuffer& in, ZSTD_EndDirective mode) {
+    ZSTD_outBuffer out{out_.data(), out_.size(), 0};
+    const std::size_t remaining = ZSTD_compressStream2(cctx_, &out, &in, mode);
+    if (ZSTD_isError(remaining)) {
+      throw std::runtime_error{std::string{"zstd compression failed: "} +
+                               ZSTD_getErrorName(remaining)};
+    }
+    WriteRaw(out_.data(), out.pos);
+    return remaining;
+  }
+
+  void WriteRaw(const void* data, std::size_t n) {
+    if (n != 0 && std::fwrite(data, 1, n, file_) != n) {
+      throw std::system_error{errno, std::generic_category(), "Failed to write " + path_};
+    }
+    written_ += n;
+  }
+
+  std::string path_;
+  std::size_t frame_size_;
+  std::size_t in_frame_{};
+  std::FILE* file_{};
+  ZSTD_CCtx* cctx_{};
+  std::vector<char> out_;
+  std::uint64_t written_{};
+};
+
+class SplitMix64 {
+ public:
+  explicit SplitMix64(std::uint64_t seed) : state_{seed} {}
+
+  std::uint64_t Next() {
+    std::uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+  // Uniform enough in [0, n) for n far below 2^64
+  std::uint64_t Below(std::uint64_t n) { return Next() % n; }
+
+ private:
+  std::uint64_t state_;
+};
+
+struct RestingOrder {
+  std::uint64_t order_id;
+  std::int64_t price;
+  std::uint32_t size;
+  databento::Side side;
+};
+
+struct SyntheticInstrument {
+  std::int64_t mid;
+  std::vector<RestingOrder> orders;
+};
+
+databento::UnixNanos ToUnixNanos(std::uint64_t ts) {
+  return databento::UnixNanos{databento::UnixNanos::duration{ts}};
+}
+
+date::year_month_day DateOf(std::uint64_t ts) {
+  return date::year_month_day{date::sys_days{date::days{static_cast<int>(ts / kNanosPerDay)}}};
+}
+
+template <typename Msg>
+databento::RecordHeader Header(databento::RType rtype, std::uint32_t instrument_id,
+                               std::uint64_t ts) {
+  databento::RecordHeader hd{};
+  hd.length = static_cast<std::uint8_t>(sizeof(Msg) / databento::RecordHeader::kLengthMultiplier);
+  hd.rtype = rtype;
+  hd.publisher_id = 1;
+  hd.instrument_id = instrument_id;
+  hd.ts_event = ToUnixNanos(ts);
+  return hd;
+}
+
+databento::Metadata MakeMetadata(const SyntheticDbnOptions& options, std::uint64_t end_ts) {
+  databento::Metadata metadata{};
+  metadata.version = databento::kDbnVersion;
+  metadata.dataset = options.dataset;
+  metadata.schema = options.schema;
+  metadata.start = ToUnixNanos(options.start_ts);
+  metadata.end = ToUnixNanos(end_ts);
+  metadata.limit = 0;
+  metadata.stype_in =
+      options.parent.empty() ? databento::SType::RawSymbol : databento::SType::Parent;
+  metadata.stype_out =
+      options.parent.empty() ? databento::SType::InstrumentId : options.stype_out;
+  metadata.ts_out = false;
+  metadata.symbol_cstr_len = databento::kSymbolCstrLen;
+  const date::year_month_day start_date = DateOf(options.start_ts);
+  const date::year_month_day end_date = DateOf(end_ts + kNanosPerDay);
+  if (!options.parent.empty()) {
+    // One mapping of the parent, with an interval per child
+    databento::SymbolMapping& mapping =
+        metadata.mappings.emplace_back(databento::SymbolMapping{options.parent, {}});
+    for (std::uint32_t id = 1; id <= options.instrument_count; ++id) {
+      mapping.intervals.push_back(databento::MappingInterval{
+          start_date, end_date,
+          options.stype_out == databento::SType::RawSymbol ? "SYN" + std::to_string(id)
+                                                           : std::to_string(id)});
+    }
+    metadata.symbols.push_back(options.parent);
+    return metadata;
+  }
+  for (std::uint32_t id = 1; id <= options.instrument_count; ++id) {
+    const std::string symbol = "SYN" + std::to_string(id);
+    metadata.symbols.push_back(symbol);
+    metadata.mappings.push_back(databento::SymbolMapping{
+        symbol, {databento::MappingInterval{start_date, end_date, std::to_string(id)}}});
+  }
+  return metadata;
+}
+
+class RecordGenerator {
+ public:
+  RecordGenerator(const SyntheticDbnOptions& options, databento::DbnEncoder& encoder)
+      : options_{options}, encoder_{encoder}, rng_{options.seed} {
+    instruments_.resize(options.instrument_count);
+    for (std::uint32_t i = 0; i < options.instrument_count; ++i) {
+      instruments_[i].mid = 4'000'000'000'000 + static_cast<std::int64_t>(i) * 1'000'000'000;
+    }
+  }
+
+  void Emit(std::uint64_t sequence, std::uint64_t ts) {
+    const auto instrument_id = static_cast<std::uint32_t>(1 + rng_.Below(options_.instrument_count));
+    SyntheticInstrument& instrument = instruments_[instrument_id - 1];
+    instrument.mid += (static_cast<std::int64_t>(rng_.Below(3)) - 1) * kTick;
+    switch (options_.schema) {
+      case databento::Schema::Mbo:
+        EmitMbo(instrument_id, instrument, sequence, ts);
+        break;
+      case databento::Schema::Trades:
+        EmitTrade(instrument_id, instrument, sequence, ts);
+        break;
+      case databento::Schema::Mbp1:
+        EmitMbp1(instrument_id, instrument, sequence, ts);
+        break;
+      case databento::Schema::Mbp10:
+        EmitMbp10(instrument_id, instrument, sequence, ts);
+        break;
+      case databento::Schema::Ohlcv1S:
+        EmitOhlcv(instrument_id, instrument, ts);
+        break;
+      default:
+        throw std::invalid_argument{"Synthetic DBN supports the mbo, trades, mbp-1, "
+                                    "mbp-10 and ohlcv-1s schemas"};
+    }
+  }
+
+ private:
+  databento::Side RandomSide() {
+    return rng_.Below(2) == 0 ? databento::Side::Bid : databento::Side::Ask;
+  }
+
+  void EmitMbo(std::uint32_t instrument_id, SyntheticInstrument& instrument,
+               std::uint64_t sequence, std::uint64_t ts) {
+    databento::MboMsg msg{};
+    msg.hd = Header<databento::MboMsg>(databento::RType::Mbo, instrument_id, ts);
+    msg.flags = databento::FlagSet{databento::FlagSet::kLast};
+    msg.ts_recv = ToUnixNanos(ts + 1'000);
+    msg.sequence = static_cast<std::uint32_t>(sequence);
+    std::vector<RestingOrder>& orders = instrument.orders;
+    const std::uint64_t roll = rng_.Below(100);
+    if (orders.empty() || (orders.size() < kMaxRestingOrders && roll < 45)) {
+      RestingOrder order{next_order_id_++, 0,
+                         static_cast<std::uint32_t>(1 + rng_.Below(100)), RandomSide()};
+      const auto offset = static_cast<std::int64_t>(1 + rng_.Below(10)) * kTick;
+      order.price = order.side == databento::Side::Bid ? instrument.mid - offset
+                                                       : instrument.mid + offset;
+      orders.push_back(order);
+      msg.action = databento::Action::Add;
+      Describe(msg, order);
+    } else if (roll < 80) {
+      const std::size_t i = rng_.Below(orders.size());
+      msg.action = databento::Action::Cancel;
+      Describe(msg, orders[i]);
+      orders[i] = orders.back();
+      orders.pop_back();
+    } else if (roll < 90) {
+      RestingOrder& order = orders[rng_.Below(orders.size())];
+      order.size = static_cast<std::uint32_t>(1 + rng_.Below(100));
+      msg.action = databento::Action::Modify;
+      Describe(msg, order);
+    } else {
+      // Trades carry no order ID and leave the book to later cancels
+      msg.action = databento::Action::Trade;
+      msg.side = RandomSide();
+      msg.price = instrument.mid;
+      msg.size = static_cast<std::uint32_t>(1 + rng_.Below(20));
+    }
+    encoder_.EncodeRecord(databento::Record{&msg.hd});
+  }
+
+  static void Describe(databento::MboMsg& msg, const RestingOrder& order) {
+    msg.order_id = order.order_id;
+    msg.price = order.price;
+    msg.size = order.size;
+    msg.side = order.side;
+  }
+
+  void EmitTrade(std::uint32_t instrument_id, const SyntheticInstrument& instrument,
+                 std::uint64_t sequence, std::uint64_t ts) {
+    databento::TradeMsg msg{};
+    msg.hd = Header<databento::TradeMsg>(databento::RType::Mbp0, instrument_id, ts);
+    msg.price = instrument.mid + static_cast<std::int64_t>(rng_.Below(2)) * kTick;
+    msg.size = static_cast<std::uint32_t>(1 + rng_.Below(50));
+    msg.action = databento::Action::Trade;
+    msg.side = RandomSide();
+    msg.flags = databento::FlagSet{databento::FlagSet::kLast};
+    msg.ts_recv = ToUnixNanos(ts + 1'000);
+    msg.sequence = static_cast<std::uint32_t>(sequence);
+    encoder_.EncodeRecord(databento::Record{&msg.hd});
+  }
+
+  void EmitMbp1(std::uint32_t instrument_id, const SyntheticInstrument& instrument,
+                std::uint64_t sequence, std::uint64_t ts) {
+    static constexpr databento::Action kActions[] = {
+        databento::Action::Add, databento::Action::Cancel, databento::Action::Modify,
+        databento::Action::Trade};
+    databento::Mbp1Msg msg{};
+    msg.hd = Header<databento::Mbp1Msg>(databento::RType::Mbp1, instrument_id, ts);
+    msg.action = kActions[rng_.Below(4)];
+    msg.side = RandomSide();
+    msg.price = msg.side == databento::Side::Bid ? instrument.mid - kTick : instrument.mid + kTick;
+    msg.size = static_cast<std::uint32_t>(1 + rng_.Below(100));
+    msg.flags = databento::FlagSet{databento::FlagSet::kLast};
+    msg.ts_recv = ToUnixNanos(ts + 1'000);
+    msg.sequence = static_cast<std::uint32_t>(sequence);
+    databento::BidAskPair& level = msg.levels[0];
+    level.bid_px = instrument.mid - kTick;
+    level.ask_px = instrument.mid + kTick;
+    level.bid_sz = static_cast<std::uint32_t>(1 + rng_.Below(500));
+    level.ask_sz = static_cast<std::uint32_t>(1 + rng_.Below(500));
+    level.bid_ct = static_cast<std::uint32_t>(1 + rng_.Below(20));
+    level.ask_ct = static_cast<std::uint32_t>(1 + rng_.Below(20));
+    encoder_.EncodeRecord(databento::Record{&msg.hd});
+  }
+
+  // A full ladder one tick apart on each side of the mid; the deepest levels
+  // are sometimes empty, as in thin books
+  void EmitMbp10(std::uint32_t instrument_id, const SyntheticInstrument& instrument,
+                 std::uint64_t sequence, std::uint64_t ts) {
+    databento::Mbp10Msg msg{};
+    msg.hd = Header<databento::Mbp10Msg>(databento::RType::Mbp10, instrument_id, ts);
+    msg.action = databento::Action::Modify;
+    msg.side = RandomSide();
+    msg.flags = databento::FlagSet{databento::FlagSet::kLast};
+    msg.ts_recv = ToUnixNanos(ts + 1'000);
+    msg.sequence = static_cast<std::uint32_t>(sequence);
+    const std::size_t filled = msg.levels.size() - rng_.Below(3);
+    for (std::size_t l = 0; l < msg.levels.size(); ++l) {
+      databento::BidAskPair& level = msg.levels[l];
+      if (l >= filled) {
+        level.bid_px = databento::kUndefPrice;
+        level.ask_px = databento::kUndefPrice;
+        continue;
+      }
+      const auto offset = static_cast<std::int64_t>(l + 1) * kTick;
+      level.bid_px = instrument.mid - offset;
+      level.ask_px = instrument.mid + offset;
+      level.bid_sz = static_cast<std::uint32_t>(1 + rng_.Below(500));
+      level.ask_sz = static_cast<std::uint32_t>(1 + rng_.Below(500));
+      level.bid_ct = static_cast<std::uint32_t>(1 + rng_.Below(20));
+      level.ask_ct = static_cast<std::uint32_t>(1 + rng_.Below(20));
+    }
+    msg.depth = static_cast<std::uint8_t>(rng_.Below(filled));
+    const databento::BidAskPair& updated = msg.levels[msg.depth];
+    msg.price = msg.side == databento::Side::Bid ? updated.bid_px : updated.ask_px;
+    msg.size = static_cast<std::uint32_t>(1 + rng_.Below(100));
+    encoder_.EncodeRecord(databento::Record{&msg.hd});
+  }
+
+  void EmitOhlcv(std::uint32_t instrument_id, const SyntheticInstrument& instrument,
+                 std::uint64_t ts) {
+    databento::OhlcvMsg msg{};
+    msg.hd = Header<databento::OhlcvMsg>(databento::RType::Ohlcv1S, instrument_id, ts);
+    msg.open = instrument.mid;
+    msg.high = instrument.mid + static_cast<std::int64_t>(rng_.Below(4)) * kTick;
+    msg.low = instrument.mid - static_cast<std::int64_t>(rng_.Below(4)) * kTick;
+    msg.close = msg.low + static_cast<std::int64_t>(rng_.Below(
+                              static_cast<std::uint64_t>((msg.high - msg.low) / kTick) + 1)) *
+                              kTick;
+    msg.volume = 1 + rng_.Below(1'000);
+    encoder_.EncodeRecord(databento::Record{&msg.hd});
+  }
+
+  const SyntheticDbnOptions& options_;
+  databento::DbnEncoder& encoder_;
+  SplitMix64 rng_;
+  std::vector<SyntheticInstrument> instruments_;
+  std::uint64_t next_order_id_{1};
+};
+}  // namespace
+
+std::uint64_t WriteSyntheticDbn(const std::string& path, const SyntheticDbnOptions& options) {
+  if (options.instrument_count == 0) {
+    throw std::invalid_argument{"Synthetic DBN needs at least one instrument"};
+  }
+  const std::uint64_t end_ts = options.start_ts + options.record_count * options.ts_step_ns;
+  FileSink sink{path, options.zstd, options.frame_size};
+  databento::DbnEncoder encoder{MakeMetadata(options, end_ts), &sink};
+  RecordGenerator generator{options, encoder};
+  for (std::uint64_t i = 0; i < options.record_count; ++i) {
+    generator.Emit(i, options.start_ts + i * options.ts_step_ns);
+  }
+  return sink.Finish();
+}
+
+}  // namespace databento_jl
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <databento/enums.hpp>
+
+#include <cstdint>
+#include <string>
+
+namespace databento_jl {
+
+struct SyntheticDbnOptions {
+  // One of Mbo, Trades, Mbp1, Mbp10 or Ohlcv1S
+  databento::Schema schema{databento::Schema::Mbo};
+  std::uint32_t instrument_count{16};
+  std::uint64_t record_count{1'000'000};
+  bool zstd{};
+  // Uncompressed bytes per zstd frame, 0 for a single frame. Frames end at
+  // exact byte counts, so records straddle frame boundaries.
+  std::uint64_t frame_size{};
+  std::uint64_t seed{1};
+  std::string dataset{"GLBX.MDP3"};
+  // When set, the metadata describes a parent symbology request for this
+  // symbol instead of one per instrument, resolved to `stype_out`:
+  // instrument IDs or the raw symbols "SYN<id>"
+  std::string parent;
+  databento::SType stype_out{databento::SType::InstrumentId};
+  // 2024-01-02T00:00:00Z
+  std::uint64_t start_ts{1'704'153'600'000'000'000ULL};
+  // Gap between consecutive records' ts_event
+  std::uint64_t ts_step_ns{1'000};
+};
+
+// Writes a DBN file of synthetic records for benchmarks and tests.
+//
+// The output depends only on the options: the generator uses its own
+// splitmix64 stream rather than <random> distributions, whose results vary
+// between standard libraries. Instrument IDs run from 1 to
+// `instrument_count`, each mapped to the symbol "SYN<id>" in the metadata, and
+// records are spread over them at random with non-decreasing timestamps.
+// MBO streams are book-consistent: cancels and modifies only refer to orders
+// added earlier and still resting, so they can drive the order book engine.
+// Returns the number of bytes written.
+std::uint64_t WriteSyntheticDbn(const std::string& path,
+                                const SyntheticDbnOptions& options);
+
+}  // namespace databento_jl
@@ -0,0 +1,403 @@
+#include "ts_index.hpp"
+
+#include <databento/dbn_decoder.hpp>
+#include <databento/record.hpp>
+
+#include <zstd.h>
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#include "flat_hash_map.hpp"
+#include "output_file.hpp"
+#include "posix_file.hpp"
+
+namespace databento_jl {
+
+namespace {
+// "DBN" + version byte followed by the little-endian metadata length
+constexpr std::size_t kPreludeSize = 8;
+constexpr std::uint32_t kZstdMagic = 0xFD2FB528;
+constexpr std::size_t kReadChunk = 1 << 20;
+
+constexpr char kIndexMagic[8] = {'D', 'B', 'N', 'T', 'S', 'I', 'D', 'X'};
+constexpr std::uint32_t kIndexVersion = 1;
+constexpr std::uint32_t kFlagCompressed = 1;
+constexpr std::uint32_t kFlagPostings = 2;
+
+static_assert(std::is_trivially_copyable<TsIndexBlock>::value &&
+                  sizeof(TsIndexBlock) == 6 * sizeof(std::uint64_t),
+              "TsIndexBlock is written to disk as-is");
+
+// Walks the decompressed DBN stream handed to it in arbitrary chunks,
+// reporting each record header and grouping records into blocks. Only the
+// 16-byte headers are copied; record bodies are skipped over.
+class IndexBuilder {
+ public:
+  IndexBuilder(TsIndex& index, bool by_instrument)
+      : index_{index}, by_instrument_{by_instrument} {
+    if (index_.compressed) {
+      // Frame 0 holds the metadata and the first records
+      index_.blocks.push_back(NewBlock(0, 0));
+    }
+  }
+
+  void Feed(const std::byte* data, std::size_t n) {
+    const std::uint64_t base = data_pos_;
+    data_pos_ += n;
+    std::size_t i = 0;
+    while (i < n) {
+      if (prelude_have_ < kPreludeSize) {
+        const std::size_t take = std::min(kPreludeSize - prelude_have_, n - i);
+        std::memcpy(prelude_.data() + prelude_have_, data + i, take);
+        prelude_have_ += take;
+        i += take;
+        if (prelude_have_ == kPreludeSize) {
+          const auto [version, metadata_size] =
+              databento::DbnDecoder::DecodeMetadataVersionAndSize(prelude_.data(),
+                                                                  kPreludeSize);
+          index_.dbn_version = version;
+          index_.metadata_end = kPreludeSize + metadata_size;
+          next_start_ = index_.metadata_end;
+        }
+        continue;
+      }
+      const std::uint64_t pos = base + i;
+      if (header_have_ == 0 && pos < next_start_) {
+        i += static_cast<std::size_t>(std::min<std::uint64_t>(next_start_ - pos, n - i));
+        continue;
+      }
+      if (header_have_ == 0) {
+        // The frame holding a record's first byte owns it, even when the rest
+        // of the record only arrives after later frame boundaries
+        record_block_ = index_.blocks.size() - 1;
+      }
+      const std::size_t take = std::min(sizeof(header_) - header_have_, n - i);
+      std::memcpy(reinterpret_cast<std::byte*>(&header_) + header_have_, data + i, take);
+      header_have_ += take;
+      i += take;
+      if (header_have_ == sizeof(header_)) {
+        header_have_ = 0;
+        OnRecord(next_start_);
+        next_start_ += header_.Size();
+      }
+    }
+  }
+
+  // A zstd frame ended at `file_offset`; a new block may start here
+  void FrameBoundary(std::uint64_t file_offset) {
+    if (index_.blocks.back().record_count >= index_.stride) {
+      index_.blocks.push_back(NewBlock(file_offset, data_pos_));
+    }
+  }
+
+  void Finish() {
+    if (prelude_have_ < kPreludeSize) {
+      throw std::runtime_error{"DBN stream ends before its metadata header"};
+    }
+    // A header whose body was cut off is a truncated trailing record
+    if (header_have_ == 0 && next_start_ > data_pos_ && last_block_ != kNoBlock) {
+      --index_.blocks[last_block_].record_count;
+      --index_.record_count;
+    }
+    while (!index_.blocks.empty() && index_.blocks.back().record_count == 0) {
+      index_.blocks.pop_back();
+    }
+    if (by_instrument_) {
+      std::vector<std::pair<std::uint32_t, std::vector<std::uint32_t>*>> lists;
+      postings_.ForEach([&lists](std::uint32_t id, std::vector<std::uint32_t>& blocks) {
+        lists.emplace_back(id, &blocks);
+      });
+      std::sort(lists.begin(), lists.end());
+      index_.posting_offsets.push_back(0);
+      for (const auto& [id, blocks] : lists) {
+        index_.instrument_ids.push_back(id);
+        index_.postings.insert(index_.postings.end(), blocks->begin(), blocks->end());
+        index_.posting_offsets.push_back(index_.postings.size());
+      }
+    }
+  }
+
+ private:
+  static constexpr std::size_t kNoBlock = std::numeric_limits<std::size_t>::max();
+
+  static TsIndexBlock NewBlock(std::uint64_t file_offset, std::uint64_t data_offset) {
+    return TsIndexBlock{file_offset, data_offset, data_offset, 0,
+                        std::numeric_limits<std::uint64_t>::max(), 0};
+  }
+
+  void OnRecord(std::uint64_t start) {
+    if (header_.Size() < sizeof(databento::RecordHeader)) {
+      throw std::runtime_error{"Invalid record length at DBN offset " +
+                               std::to_string(start)};
+    }
+    std::vector<TsIndexBlock>& blocks = index_.blocks;
+    if (!index_.compressed &&
+        (blocks.empty() || blocks.back().record_count >= index_.stride)) {
+      blocks.push_back(NewBlock(start, start));
+      record_block_ = blocks.size() - 1;
+    }
+    const std::size_t b = record_block_;
+    TsIndexBlock& block = blocks[b];
+    if (block.record_count == 0) {
+      block.record_offset = start;
+    }
+    ++block.record_count;
+    ++index_.record_count;
+    const std::uint64_t ts_event = header_.ts_event.time_since_epoch().count();
+    block.min_ts_event = std::min(block.min_ts_event, ts_event);
+    block.max_ts_event = std::max(block.max_ts_event, ts_event);
+    last_block_ = b;
+    if (by_instrument_) {
+      std::vector<std::uint32_t>& list = postings_[header_.instrument_id];
+      if (list.empty() || list.back() != b) {
+        list.push_back(static_cast<std::uint32_t>(b));
+      }
+    }
+  }
+
+  TsIndex& index_;
+  const bool by_instrument_;
+  std::array<std::byte, kPreludeSize> prelude_{};
+  std::size_t prelude_have_{};
+  databento::RecordHeader header_{};
+  std::size_t header_have_{};
+  std::uint64_t data_pos_{};
+  std::uint64_t next_start_{};
+  // Block that was current when the pending record's first byte was fed
+  std::size_t record_block_{};
+  std::size_t last_block_{kNoBlock};
+  FlatHashMap<std::uint32_t, std::vector<std::uint32_t>> postings_;
+};
+
+struct DCtxDeleter {
+  void operator()(ZSTD_DCtx* dctx) const { ZSTD_freeDCtx(dctx); }
+};
+
+void IndexCompressed(const PosixFile& file, IndexBuilder& builder) {
+  std::unique_ptr<ZSTD_DCtx, DCtxDeleter> dctx{ZSTD_createDCtx()};
+  std::vector<std::byte> in(kReadChunk);
+  std::vector<std::byte> out(ZSTD_DStreamOutSize());
+  std::uint64_t file_pos = 0;
+  while (const std::size_t got = file.ReadAt(in.data(), in.size(), file_pos)) {
+    ZSTD_inBuffer input{in.data(), got, 0};
+    ZSTD_outBuffer output{};
+    do {
+      output = ZSTD_outBuffer{out.data(), out.size(), 0};
+      const std::size_t ret = ZSTD_decompressStream(dctx.get(), &output, &input);
+      if (ZSTD_isError(ret)) {
+        throw std::runtime_error{"Failed to decompress " + file.Path() + ": " +
+                                 ZSTD_getErrorName(ret)};
+      }
+      builder.Feed(out.data(), output.pos);
+      if (ret == 0) {
+        builder.FrameBoundary(file_pos + input.pos);
+      }
+    } while (input.pos < input.size || output.pos == output.size);
+    file_pos += got;
+  }
+}
+
+void IndexUncompressed(const PosixFile& file, IndexBuilder& builder) {
+  std::vector<std::byte> buffer(kReadChunk);
+  std::uint64_t file_pos = 0;
+  while (const std::size_t got = file.ReadAt(buffer.data(), buffer.size(), file_pos)) {
+    builder.Feed(buffer.data(), got);
+    file_pos += got;
+  }
+}
+
+template <typename T>
+void WriteVector(OutputFile& out, const std::vector<T>& values) {
+  out.Write(values.data(), values.size() * sizeof(T));
+}
+
+template <typename T>
+void ReadPod(std::ifstream& in, T& value, const std::string& path) {
+  if (!in.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+    throw std::runtime_error{path + " is a truncated timestamp index"};
+  }
+}
+
+// `count` comes from the file, so it is checked against the bytes left
+// before anything is allocated for it
+template <typename T>
+void ReadVector(std::ifstream& in, std::vector<T>& values, std::uint64_t count,
+                std::uint64_t file_size, const std::string& path, const char* what) {
+  const std::uint64_t remaining = file_size - static_cast<std::uint64_t>(in.tellg());
+  if (count > remaining / sizeof(T)) {
+    throw std::runtime_error{path + " is a truncated timestamp index: it lists " +
+                             std::to_string(count) + " " + what + " in " +
+                             std::to_string(remaining) + " bytes"};
+  }
+  values.resize(static_cast<std::size_t>(count));
+  if (!in.read(reinterpret_cast<char*>(values.data()),
+               static_cast<std::streamsize>(count * sizeof(T)))) {
+    throw std::runtime_error{path + " is a truncated timestamp index"};
+  }
+}
+}  // namespace
+
+std::size_t TsIndex::FindBlock(std::uint64_t ts) const {
+  return static_cast<std::size_t>(
+      std::lower_bound(max_ts_prefix.begin(), max_ts_prefix.end(), ts) -
+      max_ts_prefix.begin());
+}
+
+std::pair<const std::uint32_t*, const std::uint32_t*> TsIndex::BlocksFor(
+    std::uint32_t instrument_id) const {
+  const auto it =
+      std::lower_bound(instrument_ids.begin(), instrument_ids.end(), instrument_id);
+  if (it == instrument_ids.end() || *it != instrument_id) {
+    return {nullptr, nullptr};
+  }
+  const std::size_t i = static_cast<std::size_t>(it - instrument_ids.begin());
+  const std::uint32_t* base = postings.data();
+  return {base + posting_offsets[i], base + posting_offsets[i + 1]};
+}
+
+bool TsIndex::MatchesSource(const std::string& dbn_path) const {
+  struct stat st {};
+  if (::stat(dbn_path.c_str(), &st) != 0) {
+    return false;
+  }
+  const std::int64_t mtime_ns =
+      static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1'000'000'000 + st.st_mtim.tv_nsec;
+  return static_cast<std::uint64_t>(st.st_size) == source_size &&
+         mtime_ns == source_mtime_ns;
+}
+
+void TsIndex::BuildSearchTable() {
+  max_ts_prefix.resize(blocks.size());
+  std::uint64_t running = 0;
+  for (std::size_t i = 0; i < blocks.size(); ++i) {
+    running = std::max(running, blocks[i].max_ts_event);
+    max_ts_prefix[i] = running;
+  }
+}
+
+void TsIndex::Save(const std::string& index_path) const {
+  OutputFile out{index_path};
+  const std::uint32_t flags = (compressed ? kFlagCompressed : 0) |
+                              (HasInstrumentPostings() ? kFlagPostings : 0);
+  out.Write(kIndexMagic, sizeof(kIndexMagic));
+  out.WritePod(kIndexVersion);
+  out.WritePod(flags);
+  out.WritePod(static_cast<std::uint32_t>(dbn_version));
+  out.WritePod(std::uint32_t{0});
+  out.WritePod(source_size);
+  out.WritePod(source_mtime_ns);
+  out.WritePod(stride);
+  out.WritePod(metadata_end);
+  out.WritePod(record_count);
+  out.WritePod(static_cast<std::uint64_t>(blocks.size()));
+  WriteVector(out, blocks);
+  if (HasInstrumentPostings()) {
+    out.WritePod(static_cast<std::uint64_t>(instrument_ids.size()));
+    WriteVector(out, instrument_ids);
+    WriteVector(out, posting_offsets);
+    WriteVector(out, postings);
+  }
+  out.Commit();
+}
+
+TsIndex TsIndex::Load(const std::string& index_path) {
+  std::ifstream in{index_path, std::ios::binary | std::ios::ate};
+  if (!in) {
+    throw std::runtime_error{"Failed to open timestamp index " + index_path};
+  }
+  const auto file_size = static_cast<std::uint64_t>(in.tellg());
+  in.seekg(0);
+  char magic[sizeof(kIndexMagic)];
+  std::uint32_t version;
+  std::uint32_t flags;
+  std::uint32_t dbn_version;
+  std::uint32_t reserved;
+  if (!in.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, kIndexMagic, sizeof(magic)) != 0) {
+    throw std::runtime_error{index_path + " is not a DBN timestamp index"};
+  }
+  ReadPod(in, version, index_path);
+  if (version != kIndexVersion) {
+    throw std::runtime_error{index_path + " has unsupported index version " +
+                             std::to_string(version)};
+  }
+  TsIndex index;
+  std::uint64_t block_count;
+  ReadPod(in, flags, index_path);
+  ReadPod(in, dbn_version, index_path);
+  ReadPod(in, reserved, index_path);
+  ReadPod(in, index.source_size, index_path);
+  ReadPod(in, index.source_mtime_ns, index_path);
+  ReadPod(in, index.stride, index_path);
+  ReadPod(in, index.metadata_end, index_path);
+  ReadPod(in, index.record_count, index_path);
+  ReadPod(in, block_count, index_path);
+  index.compressed = (flags & kFlagCompressed) != 0;
+  index.dbn_version = static_cast<std::uint8_t>(dbn_version);
+  ReadVector(in, index.blocks, block_count, file_size, index_path, "blocks");
+  if ((flags & kFlagPostings) != 0) {
+    std::uint64_t instrument_count;
+    ReadPod(in, instrument_count, index_path);
+    ReadVector(in, index.instrument_ids, instrument_count, file_size, index_path,
+               "instruments");
+    ReadVector(in, index.posting_offsets, instrument_count + 1, file_size, index_path,
+               "posting offsets");
+    ReadVector(in, index.postings, index.posting_offsets.back(), file_size, index_path,
+               "postings");
+    // BlocksFor and the readers index with these unchecked
+    const auto corrupt = [&index_path](const char* why) {
+      return std::runtime_error{index_path + " is a corrupt timestamp index: " + why};
+    };
+    if (!std::is_sorted(index.instrument_ids.begin(), index.instrument_ids.end())) {
+      throw corrupt("instrument IDs are not sorted");
+    }
+    if (index.posting_offsets.front() != 0 ||
+        !std::is_sorted(index.posting_offsets.begin(), index.posting_offsets.end())) {
+      throw corrupt("posting offsets do not start at 0 and ascend");
+    }
+    for (const std::uint32_t block : index.postings) {
+      if (block >= index.blocks.size()) {
+        throw corrupt("a posting refers to a block past the last");
+      }
+    }
+  }
+  index.BuildSearchTable();
+  return index;
+}
+
+TsIndex BuildTsIndex(const std::string& dbn_path, std::size_t stride,
+                     bool by_instrument) {
+  if (stride == 0) {
+    throw std::invalid_argument{"Timestamp index stride must be positive"};
+  }
+  const PosixFile file{dbn_path};
+  TsIndex index;
+  index.source_size = file.Size();
+  index.source_mtime_ns = file.MtimeNs();
+  index.stride = stride;
+
+  std::uint32_t magic = 0;
+  file.ReadAt(&magic, sizeof(magic), 0);
+  index.compressed = magic == kZstdMagic;
+
+  IndexBuilder builder{index, by_instrument};
+  if (index.compressed) {
+    IndexCompressed(file, builder);
+  } else {
+    IndexUncompressed(file, builder);
+  }
+  builder.Finish();
+  index.BuildSearchTable();
+  return index;
+}
+
+}  // namespace databento_jl
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace databento_jl {
+
+// A contiguous run of records that can be read without decoding anything
+// before it. For zstd-compressed files a block starts on a frame boundary;
+// for uncompressed files it starts on a record.
+struct TsIndexBlock {
+  // Where reading resumes in the file
+  std::uint64_t file_offset;
+  // Offset in the decompressed DBN stream corresponding to file_offset
+  std::uint64_t data_offset;
+  // Decompressed offset of the first record starting in the block. It
+  // differs from data_offset when a record straddles the frame boundary.
+  std::uint64_t record_offset;
+  std::uint64_t record_count;
+  std::uint64_t min_ts_event;
+  std::uint64_t max_ts_event;
+};
+
+// Sidecar index mapping ts_event (and optionally instrument_id) to block
+// offsets in a DBN file, built in one pass by BuildTsIndex.
+//
+// Blocks hold at least `stride` records. Uncompressed files are split at
+// exactly every `stride` records; compressed files can only be entered at
+// a zstd frame boundary, so a new block starts at the first frame boundary
+// after `stride` records and a single-frame file is a single block.
+//
+// The size and modification time of the indexed file are recorded so a
+// stale index is detected rather than silently used.
+struct TsIndex {
+  static constexpr std::size_t kDefaultStride = 4096;
+
+  bool compressed{};
+  std::uint8_t dbn_version{};
+  std::uint64_t source_size{};
+  std::int64_t source_mtime_ns{};
+  std::uint64_t stride{};
+  // Decompressed offset of the first record, just past the metadata
+  std::uint64_t metadata_end{};
+  std::uint64_t record_count{};
+  std::vector<TsIndexBlock> blocks;
+  // Optional postings: the ascending numbers of the blocks holding each
+  // instrument are postings[posting_offsets[i], posting_offsets[i + 1]) for
+  // instrument_ids[i], with instrument_ids sorted
+  std::vector<std::uint32_t> instrument_ids;
+  std::vector<std::uint64_t> posting_offsets;
+  std::vector<std::uint32_t> postings;
+
+  bool HasInstrumentPostings() const { return !posting_offsets.empty(); }
+  // First block that can contain a record with ts_event >= ts, or
+  // blocks.size() if there is none. ts_event need not be monotonic: blocks
+  // are skipped only when every record in them is earlier than `ts`.
+  std::size_t FindBlock(std::uint64_t ts) const;
+  // Block numbers holding `instrument_id`; empty without postings
+  std::pair<const std::uint32_t*, const std::uint32_t*> BlocksFor(
+      std::uint32_t instrument_id) const;
+  // True when the file at `dbn_path` is the one this index was built from
+  bool MatchesSource(const std::string& dbn_path) const;
+
+  void Save(const std::string& index_path) const;
+  static TsIndex Load(const std::string& index_path);
+
+  // Running maximum of max_ts_event, which makes FindBlock a binary search
+  void BuildSearchTable();
+  std::vector<std::uint64_t> max_ts_prefix;
+};
+
+inline std::string DefaultIndexPath(const std::string& dbn_path) {
+  return dbn_path + ".tsidx";
+}
+
+// Scans `dbn_path` once, zstd-compressed or not, and builds its index
+TsIndex BuildTsIndex(const std::string& dbn_path,
+                     std::size_t stride = TsIndex::kDefaultStride,
+                     bool by_instrument = false);
+
+}  // namespace databento_jl
@@ -1,6 +1,7 @@
 module Databento
 
 using CxxWrap
+import Dates
 
 # Load the C++ extension library
 const depsfile = joinpath(@__DIR__, "..", "deps", "deps.jl")
@@ -14,6 +15,7 @@ include(depsfile)
 
 function __init__()
     @initcxx
+    _MATCH_ALL[] = RecordFilter()
 end
 
 # ============================================================================
@@ -61,4 +63,1925 @@ Base.show(io::IO, e::Encoding) = print(io, "Encoding::", string(e))
 Base.show(io::IO, s::SType) = print(io, "SType::", string(s))
 Base.show(io::IO, d::Dataset) = print(io, "Dataset::", string(d))
 
+# ============================================================================
+# Record Field Layout
+# ============================================================================
+
+export record_layout, field_offset, load_field
+
+const _RecordField = NamedTuple{(:name, :offset, :size),Tuple{Symbol,Int,Int}}
+const _RECORD_LAYOUTS = Dict{DataType,Vector{_RecordField}}()
+const _RECORD_LAYOUTS_LOCK = ReentrantLock()
+
+"""
+    record_layout(T) -> Vector{NamedTuple{(:name, :offset, :size)}}
+
+Byte offset and size of every field of the record bits type `T` (`MboMsg`,
+`OhlcvMsg`, `SymbolMappingMsg`, `BidAskPair`, `RecordHeader`, ...), in
+declaration order, as the C++ struct lays them out. Every listed field also has
+an accessor of the same name, e.g. `Databento.volume(bar)`. Reserved padding is
+not listed; character arrays such as `raw_symbol` are listed at their full
+capacity.
+"""
+function record_layout(::Type{T}) where {T}
+    lock(_RECORD_LAYOUTS_LOCK) do
+        get!(_RECORD_LAYOUTS, T) do
+            names = record_field_names(T)
+            offsets = record_field_offsets(T)
+            sizes = record_field_sizes(T)
+            [(name = Symbol(String(names[i])), offset = Int(offsets[i]), size = Int(sizes[i]))
+             for i in eachindex(names)]
+        end
+    end
+end
+
+"""
+    field_offset(T, name::Symbol) -> Int
+
+Byte offset of field `name` in the record bits type `T`, for `load_field`.
+"""
+function field_offset(::Type{T}, name::Symbol) where {T}
+    for field in record_layout(T)
+        field.name === name && return field.offset
+    end
+    throw(ArgumentError("$T has no field $name"))
+end
+
+"""
+    load_field(F, record, offset) -> F
+
+Loads a field of type `F` at byte `offset` of `record` directly, without a call
+into the C++ library. Look the offset up once with `field_offset` and reuse it
+in hot loops:
+
+```julia
+off = field_offset(Databento.OhlcvMsg, :close)
+closes = load_field.(Int64, bars, off)
+```
+
+`F` must match the C++ field type (`Int64` for prices, `UInt64` for
+timestamps); only the bounds of the record are checked.
+"""
+@inline function load_field(::Type{F}, record::T, offset::Integer) where {F,T}
+    isbitstype(F) || throw(ArgumentError("$F is not a bits type"))
+    0 <= offset && offset + sizeof(F) <= sizeof(T) ||
+        throw(BoundsError(record, offset + 1:offset + sizeof(F)))
+    ref = Ref(record)
+    GC.@preserve ref begin
+        return unsafe_load(Ptr{F}(Base.unsafe_convert(Ptr{T}, ref) + offset))
+    end
+end
+
+# ============================================================================
+# Bulk Columnar Decode
+# ============================================================================
+
+export MboColumns, TradeColumns, Mbp1Columns, BboColumns, OhlcvColumns, read_columns!
+
+# Struct-of-arrays buffers filled by `read_columns!`. Construct once with the
+# desired chunk size and reuse across calls: the C++ side writes records
+# straight into these vectors, so decoding allocates nothing per record.
+# `action` and `side` hold the raw ASCII codes (e.g. `UInt8('A')`).
+
+struct MboColumns
+    ts_event::Vector{UInt64}
+    instrument_id::Vector{UInt32}
+    publisher_id::Vector{UInt16}
+    ts_recv::Vector{UInt64}
+    order_id::Vector{UInt64}
+    price::Vector{Int64}
+    size::Vector{UInt32}
+    flags::Vector{UInt8}
+    channel_id::Vector{UInt8}
+    action::Vector{UInt8}
+    side::Vector{UInt8}
+    ts_in_delta::Vector{Int32}
+    sequence::Vector{UInt32}
+end
+
+struct TradeColumns
+    ts_event::Vector{UInt64}
+    instrument_id::Vector{UInt32}
+    publisher_id::Vector{UInt16}
+    ts_recv::Vector{UInt64}
+    price::Vector{Int64}
+    size::Vector{UInt32}
+    action::Vector{UInt8}
+    side::Vector{UInt8}
+    flags::Vector{UInt8}
+    depth::Vector{UInt8}
+    ts_in_delta::Vector{Int32}
+    sequence::Vector{UInt32}
+end
+
+struct Mbp1Columns
+    ts_event::Vector{UInt64}
+    instrument_id::Vector{UInt32}
+    publisher_id::Vector{UInt16}
+    ts_recv::Vector{UInt64}
+    price::Vector{Int64}
+    size::Vector{UInt32}
+    action::Vector{UInt8}
+    side::Vector{UInt8}
+    flags::Vector{UInt8}
+    depth::Vector{UInt8}
+    ts_in_delta::Vector{Int32}
+    sequence::Vector{UInt32}
+    bid_px::Vector{Int64}
+    ask_px::Vector{Int64}
+    bid_sz::Vector{UInt32}
+    ask_sz::Vector{UInt32}
+    bid_ct::Vector{UInt32}
+    ask_ct::Vector{UInt32}
+end
+
+# BBO-1s/BBO-1m records: the last trade of the interval plus the closing quote
+struct BboColumns
+    ts_event::Vector{UInt64}
+    instrument_id::Vector{UInt32}
+    publisher_id::Vector{UInt16}
+    ts_recv::Vector{UInt64}
+    price::Vector{Int64}
+    size::Vector{UInt32}
+    side::Vector{UInt8}
+    flags::Vector{UInt8}
+    sequence::Vector{UInt32}
+    bid_px::Vector{Int64}
+    ask_px::Vector{Int64}
+    bid_sz::Vector{UInt32}
+    ask_sz::Vector{UInt32}
+    bid_ct::Vector{UInt32}
+    ask_ct::Vector{UInt32}
+end
+
+struct OhlcvColumns
+    ts_event::Vector{UInt64}
+    instrument_id::Vector{UInt32}
+    publisher_id::Vector{UInt16}
+    open::Vector{Int64}
+    high::Vector{Int64}
+    low::Vector{Int64}
+    close::Vector{Int64}
+    volume::Vector{UInt64}
+end
+
+# Completed bars drained from a `BarAggregator`; prices are fixed-precision
+# like `OhlcvColumns` and `notional` is in currency units
+struct BarColumns
+    ts_open::Vector{UInt64}
+    ts_close::Vector{UInt64}
+    instrument_id::Vector{UInt32}
+    publisher_id::Vector{UInt16}
+    open::Vector{Int64}
+    high::Vector{Int64}
+    low::Vector{Int64}
+    close::Vector{Int64}
+    volume::Vector{UInt64}
+    trade_count::Vector{UInt32}
+    notional::Vector{Float64}
+end
+
+# Rows of a `DefinitionStore`. String fields hold IDs into
+# `definition_strings(store)`, 0 for an empty string; `instrument_class` is the
+# raw ASCII code
+struct DefinitionColumns
+    instrument_id::Vector{UInt32}
+    publisher_id::Vector{UInt16}
+    ts_event::Vector{UInt64}
+    ts_recv::Vector{UInt64}
+    raw_symbol::Vector{UInt32}
+    underlying::Vector{UInt32}
+    exchange::Vector{UInt32}
+    asset::Vector{UInt32}
+    cfi::Vector{UInt32}
+    security_type::Vector{UInt32}
+    currency::Vector{UInt32}
+    instrument_class::Vector{UInt8}
+    strike_price::Vector{Int64}
+    expiration::Vector{UInt64}
+    activation::Vector{UInt64}
+    min_price_increment::Vector{Int64}
+    display_factor::Vector{Int64}
+    high_limit_price::Vector{Int64}
+    low_limit_price::Vector{Int64}
+    unit_of_measure_qty::Vector{Int64}
+    contract_multiplier::Vector{Int32}
+    underlying_id::Vector{UInt32}
+end
+
+const ColumnBatch = Union{MboColumns, TradeColumns, Mbp1Columns, BboColumns, OhlcvColumns,
+                          BarColumns, DefinitionColumns}
+
+# Allocate every column with `n` rows, e.g. `MboColumns(65_536)`
+function (::Type{C})(n::Integer) where {C <: ColumnBatch}
+    return C((Vector{eltype(T)}(undef, n) for T in fieldtypes(C))...)
+end
+
+Base.length(cols::ColumnBatch) = length(getfield(cols, 1))
+
+_columns(cols::ColumnBatch) = ntuple(i -> getfield(cols, i), fieldcount(typeof(cols)))
+
+"""
+    read_columns!(source, cols; filter=nothing) -> Int
+
+Decode up to `length(cols)` records of the matching schema from `source`
+(e.g. a `DbnFileStore`) into `cols` with a single C++ call. Returns the number
+of rows filled; a value smaller than `length(cols)` means the source is
+exhausted. Records of other types are skipped, as are records rejected by an
+optional `RecordFilter`.
+"""
+read_columns!(source, cols::MboColumns; filter=nothing) =
+    Int(read_mbo_columns!(source, _filter(filter), _columns(cols)...))
+read_columns!(source, cols::TradeColumns; filter=nothing) =
+    Int(read_trade_columns!(source, _filter(filter), _columns(cols)...))
+read_columns!(source, cols::Mbp1Columns; filter=nothing) =
+    Int(read_mbp1_columns!(source, _filter(filter), _columns(cols)...))
+read_columns!(source, cols::BboColumns; filter=nothing) =
+    Int(read_bbo_columns!(source, _filter(filter), _columns(cols)...))
+read_columns!(source, cols::OhlcvColumns; filter=nothing) =
+    Int(read_ohlcv_columns!(source, _filter(filter), _columns(cols)...))
+
+# ============================================================================
+# MBP-10 Depth Tensor
+# ============================================================================
+
+export Mbp10Tensor, read_depth!
+
+"""
+    Mbp10Tensor(n; features=true)
+
+Reusable buffers for up to `n` MBP-10 books. `depth[f, l, i]` is field `f` of
+level `l` of record `i`, with the fields in `BidAskPair` order: bid price, ask
+price, bid size, ask size, bid count, ask count. Each record's book is one
+contiguous block, so `@view depth[:, :, 1:rows]` is the filled part of a batch.
+
+`features`, if requested, holds four values per level computed in the same
+pass: cumulative bid size and cumulative ask size through the level, the level
+imbalance `(bid_sz - ask_sz) / (bid_sz + ask_sz)`, and the size-weighted mid
+`(bid_px * ask_sz + ask_px * bid_sz) / (bid_sz + ask_sz)`. Empty levels have
+NaN prices, imbalances and mids.
+"""
+struct Mbp10Tensor
+    ts_event::Vector{UInt64}
+    ts_recv::Vector{UInt64}
+    instrument_id::Vector{UInt32}
+    depth::Array{Float64,3}
+    features::Union{Array{Float64,3}, Nothing}
+end
+
+function Mbp10Tensor(n::Integer; features::Bool=true)
+    return Mbp10Tensor(Vector{UInt64}(undef, n), Vector{UInt64}(undef, n),
+                       Vector{UInt32}(undef, n), Array{Float64}(undef, 6, 10, n),
+                       features ? Array{Float64}(undef, 4, 10, n) : nothing)
+end
+
+Base.length(t::Mbp10Tensor) = length(t.ts_event)
+
+"""
+    read_depth!(source, tensor::Mbp10Tensor; filter=nothing, scale_prices=true) -> Int
+
+Decode up to `length(tensor)` `Mbp10Msg` records from `source` into `tensor`
+with a single C++ call and return the number filled, like `read_columns!`.
+Prices are in currency units unless `scale_prices` is false, in which case they
+are the raw fixed-point values as Float64.
+"""
+function read_depth!(source, tensor::Mbp10Tensor; filter=nothing, scale_prices::Bool=true)
+    features = tensor.features === nothing ? Float64[] : vec(tensor.features)
+    return Int(read_mbp10_tensor!(source, _filter(filter), tensor.ts_event, tensor.ts_recv,
+                                  tensor.instrument_id, vec(tensor.depth), features,
+                                  scale_prices))
+end
+
+# ============================================================================
+# Record Type Demultiplexer
+# ============================================================================
+
+export RecordDemux, demux!, demuxed, demux_counts
+
+"""
+    RecordDemux()
+
+Per-type record buffers for mixed-schema files (`has_mixed_schema`). `demux!`
+splits a source into one contiguous buffer per message type in a single C++
+pass, dispatching each record on its `rtype` with one jump instead of a chain
+of `holds_*` probes; `demuxed` then views a buffer as a typed vector. Every
+record type with a bits type is covered: `MboMsg`, `TradeMsg`, `Mbp1Msg`,
+`Mbp10Msg`, `BboMsg`, `CbboMsg`, `Cmbp1Msg`, `OhlcvMsg`, `StatusMsg`,
+`InstrumentDefMsg`, `ImbalanceMsg`, `StatMsg`, `ErrorMsg`, `SystemMsg` and
+`SymbolMappingMsg`.
+"""
+RecordDemux
+
+"""
+    demux!(demux::RecordDemux, source; filter=nothing, max_records=typemax(Int)) -> Int
+
+Append up to `max_records` records of `source` (any reader) to the buffers of
+their types, optionally only those accepted by a `RecordFilter`. Returns the
+number of records read; records of other types are counted in
+`demux_counts(demux).skipped`. Buffers grow as needed and keep their capacity
+across `empty!`.
+"""
+function demux!(demux::RecordDemux, source; filter=nothing, max_records::Integer=typemax(Int))
+    if filter === nothing
+        return Int(demux!(demux, source, UInt64(max_records)))
+    end
+    return Int(demux!(demux, source, filter, UInt64(max_records)))
+end
+
+"""
+    demuxed(demux::RecordDemux, T) -> Vector{T}
+
+The records of type `T` (e.g. `Databento.MboMsg`) collected so far, without
+copying. The vector aliases the demultiplexer's buffer: it is invalidated by
+the next `demux!` or `empty!`, so `copy` it to keep it longer, and `demux`
+must be kept alive while it is in use.
+"""
+function demuxed(demux::RecordDemux, ::Type{T}) where {T}
+    slot = demux_slot(String(nameof(T)))
+    record_size = Int(slot_record_size(demux, slot))
+    record_size == sizeof(T) ||
+        throw(ArgumentError("record size $record_size does not match sizeof($T) = $(sizeof(T))"))
+    n = Int(slot_count(demux, slot))
+    n == 0 && return T[]
+    return unsafe_wrap(Array, Ptr{T}(slot_data(demux, slot)), n)
+end
+
+"""
+    demux_counts(demux::RecordDemux) -> NamedTuple
+
+Number of records per message type, e.g. `demux_counts(d).MboMsg`, plus
+`skipped`.
+"""
+function demux_counts(demux::RecordDemux)
+    names = Tuple(Symbol.(String.(demux_slot_names())))
+    counts = ntuple(i -> Int(slot_count(demux, i - 1)), length(names))
+    return merge(NamedTuple{names}(counts), (skipped = Int(records_skipped(demux)),))
+end
+
+Base.empty!(demux::RecordDemux) = (clear_demux!(demux); demux)
+
+# ============================================================================
+# Memory-Mapped DBN Reader
+# ============================================================================
+
+export MmapDbnReader, records_view
+
+Base.length(reader::MmapDbnReader) = Int(record_count(reader))
+
+# 1-based indexing over the record table; the Record points into the mapping
+function Base.getindex(reader::MmapDbnReader, i::Integer)
+    checkbounds(Bool, 1:length(reader), i) || throw(BoundsError(reader, i))
+    return record_at(reader, i - 1)
+end
+
+"""
+    records_view(reader::MmapDbnReader, T) -> Vector{T}
+
+Wrap every record of a uniform file (see `is_uniform`) as a `Vector{T}` without
+copying. `T` must be an isbits type whose size equals `record_stride(reader)`.
+The returned array aliases the mapped pages, so `reader` must be kept alive for
+as long as the array is in use.
+"""
+function records_view(reader::MmapDbnReader, ::Type{T}) where {T}
+    isbitstype(T) || throw(ArgumentError("$T is not an isbits type"))
+    n = length(reader)
+    n == 0 && return T[]
+    is_uniform(reader) || throw(ArgumentError("records differ in type or length"))
+    stride = Int(record_stride(reader))
+    stride == sizeof(T) || throw(ArgumentError("record stride $stride does not match sizeof($T) = $(sizeof(T))"))
+    return unsafe_wrap(Array, Ptr{T}(record_data(reader)), n)
+end
+
+# ============================================================================
+# Multi-File Merged Reader
+# ============================================================================
+
+export MultiDbnReader
+
+"""
+    MultiDbnReader(paths; threads=0, block_records=4096, max_blocks_per_file=4)
+
+Replay several DBN files as a single stream ordered by index timestamp
+(`ts_recv` for most schemas), with ties broken by the order of `paths`. Files
+are decoded and decompressed on `threads` worker threads (`0` picks one per
+core, capped at the number of files); each file buffers at most
+`max_blocks_per_file` blocks of `block_records` records ahead of the merge.
+
+Iterate with `next_record` or fill merged batches with `read_columns!`;
+`current_file_index` reports the 0-based file of the last record returned.
+"""
+function MultiDbnReader(paths::AbstractVector{<:AbstractString};
+                        threads::Integer=0, block_records::Integer=4096,
+                        max_blocks_per_file::Integer=4)
+    return MultiDbnReader(StdVector(String.(paths)), UInt(threads),
+                          UInt(block_records), UInt(max_blocks_per_file))
+end
+
+# ============================================================================
+# Prefetching DBN Reader
+# ============================================================================
+
+export PrefetchDbnFileStore, prefetch_stats
+
+"""
+    PrefetchDbnFileStore(path; buffers=4, block_size=1 << 20)
+
+Opt-in read-ahead variant of `DbnFileStore`. A background thread decompresses
+(for `.dbn.zst`) and frames records into a ring of `buffers` blocks of about
+`block_size` bytes while the caller consumes the previous block through
+`next_record` or `read_columns!`. At least two buffers are always used.
+"""
+function PrefetchDbnFileStore(path::AbstractString; buffers::Integer=4,
+                              block_size::Integer=1 << 20)
+    return PrefetchDbnFileStore(String(path), UInt(buffers), UInt(block_size))
+end
+
+"""
+    prefetch_stats(store::PrefetchDbnFileStore) -> NamedTuple
+
+Counters for tuning the pipeline. `consumer_stall_ns` is time spent waiting for
+decoded data (decoding is the bottleneck); `producer_stall_ns` is time the
+background thread waited for a free buffer (the consumer is the bottleneck).
+"""
+function prefetch_stats(store::PrefetchDbnFileStore)
+    return (producer_stall_ns = Int(producer_stall_ns(store)),
+            consumer_stall_ns = Int(consumer_stall_ns(store)),
+            blocks_filled = Int(blocks_filled(store)),
+            records_delivered = Int(records_delivered(store)))
+end
+
+# ============================================================================
+# Streaming Historical Requests
+# ============================================================================
+
+export HistoricalStream, stream_stats
+
+"""
+    HistoricalStream(; dataset, symbols, schema, start, stop, key=ENV["DATABENTO_API_KEY"],
+                     stype_in=RAW_SYMBOL, stype_out=INSTRUMENT_ID, limit=0, gateway="", port=80,
+                     buffers=4, block_size=1 << 20, latency=false)
+
+Historical timeseries request read like a DBN file but without one: records are
+decoded on a background thread as the HTTP response arrives and handed over in
+a ring of `buffers` blocks of about `block_size` bytes, so memory stays bounded
+however large the response. Consume it with `next_record`, `read_columns!`, a
+`RecordFilter` or the book and bar engines. `get_metadata` waits for the
+response header. Request errors are thrown by the call that reaches them.
+`gateway` and `port` point the client at a plain-HTTP server, e.g. a local
+stand-in. With `latency=true` the request thread also builds feed latency
+histograms of the records as they arrive; see `latency_stats`.
+"""
+function HistoricalStream(; dataset::AbstractString, symbols::AbstractVector{<:AbstractString},
+                          schema::Schema, start::AbstractString, stop::AbstractString,
+                          key::AbstractString=get(ENV, "DATABENTO_API_KEY", ""),
+                          stype_in::SType=RAW_SYMBOL, stype_out::SType=INSTRUMENT_ID,
+                          limit::Integer=0, gateway::AbstractString="", port::Integer=80,
+                          buffers::Integer=4, block_size::Integer=1 << 20, latency::Bool=false)
+    return HistoricalStream(String(key), String(gateway), UInt16(port), String(dataset),
+                            StdVector(String.(symbols)), schema, String(start), String(stop),
+                            stype_in, stype_out, UInt64(limit), UInt(buffers), UInt(block_size),
+                            latency)
+end
+
+"""
+    stream_stats(stream::HistoricalStream) -> NamedTuple
+
+Same counters as `prefetch_stats`, plus `records_received` and `bytes_received`
+(DBN bytes) from the response so far, and `records_filtered`, the delivered
+records a `RecordFilter` then rejected. A large `producer_stall_ns` means the
+consumer is holding back the download; a large `consumer_stall_ns` means the
+network is the bottleneck.
+"""
+function stream_stats(stream::HistoricalStream)
+    return (producer_stall_ns = Int(producer_stall_ns(stream)),
+            consumer_stall_ns = Int(consumer_stall_ns(stream)),
+            blocks_filled = Int(blocks_filled(stream)),
+            records_received = Int(records_received(stream)),
+            bytes_received = Int(bytes_received(stream)),
+            records_delivered = Int(records_delivered(stream)),
+            records_filtered = Int(records_filtered(stream)))
+end
+
+# ============================================================================
+# Cached Parallel Downloads
+# ============================================================================
+
+export DownloadManager, download!, download_stats
+
+"""
+    DownloadManager(; cache_dir, key=ENV["DATABENTO_API_KEY"], gateway="", port=80,
+                    max_in_flight=4, symbols_per_request=500, max_attempts=3,
+                    retry_delay=1.0, split_by_day=true)
+
+Historical downloads split into pieces, fetched concurrently and cached in
+`cache_dir`. `download!` splits a request at UTC midnights (with
+`split_by_day`) and into batches of at most `symbols_per_request` symbols
+grouped by hash, so adding or dropping a symbol changes only its own batch, and
+runs the pieces not already cached on up to `max_in_flight` connections. Each
+piece is stored under a digest of everything its response depends on
+(dataset, symbols, schema, time range, `stype_in`, `stype_out`), so repeated
+and overlapping requests are served from disk, and an interrupted download
+resumes from its unfinished pieces. Failed pieces are retried up to
+`max_attempts` times, waiting `retry_delay` seconds, then twice as long each
+time. `gateway` and `port` point the client at a plain-HTTP server, e.g. a
+local stand-in.
+"""
+function DownloadManager(; cache_dir::AbstractString,
+                         key::AbstractString=get(ENV, "DATABENTO_API_KEY", ""),
+                         gateway::AbstractString="", port::Integer=80,
+                         max_in_flight::Integer=4, symbols_per_request::Integer=500,
+                         max_attempts::Integer=3, retry_delay::Real=1.0,
+                         split_by_day::Bool=true)
+    return DownloadManager(String(key), String(gateway), UInt16(port), String(cache_dir),
+                           UInt(max_in_flight), UInt(symbols_per_request), UInt(max_attempts),
+                           UInt64(round(retry_delay * 1000)), split_by_day)
+end
+
+"""
+    download!(manager; dataset, symbols, schema, start, stop, stype_in=RAW_SYMBOL,
+              stype_out=INSTRUMENT_ID) -> Vector{String}
+
+Download `schema` records of `symbols` (empty for all symbols) in `[start,
+stop)`, nanoseconds since the UNIX epoch, and return the paths of the cached
+DBN responses, one per piece, ordered by start time then symbol batch. Read
+them with `MultiDbnReader` or any file reader. Throws if a piece still fails
+after its retries, once the others are done.
+"""
+function download!(manager::DownloadManager; dataset::AbstractString,
+                   symbols::AbstractVector{<:AbstractString}, schema::Schema, start::Integer,
+                   stop::Integer, stype_in::SType=RAW_SYMBOL, stype_out::SType=INSTRUMENT_ID)
+    return String.(download_range!(manager, String(dataset), StdVector(String.(symbols)), schema,
+                                   UInt64(start), UInt64(stop), stype_in, stype_out))
+end
+
+"""
+    download_stats(manager::DownloadManager) -> NamedTuple
+
+Pieces planned, served from the cache, downloaded and failed over the
+manager's lifetime, plus the retried attempts and the bytes downloaded.
+"""
+function download_stats(manager::DownloadManager)
+    return (pieces_planned = Int(pieces_planned(manager)), cache_hits = Int(cache_hits(manager)),
+            pieces_downloaded = Int(pieces_downloaded(manager)),
+            pieces_failed = Int(pieces_failed(manager)), retries = Int(retries(manager)),
+            bytes_downloaded = Int(bytes_downloaded(manager)))
+end
+
+# ============================================================================
+# Pipeline Instrumentation
+# ============================================================================
+
+export ProfiledDbnFileStore, pipeline_stats, latency_stats
+
+"""
+    ProfiledDbnFileStore(path; latency=false)
+
+Drop-in `DbnFileStore` that counts where reading time goes: bytes read from
+disk, bytes after zstd decompression, records decoded, rejected by a
+`RecordFilter` and delivered, and the time spent reading, decompressing and
+decoding. See `pipeline_stats`. With `latency=true` it also builds feed latency
+histograms of every decoded record; see `latency_stats`.
+"""
+ProfiledDbnFileStore(path::AbstractString; latency::Bool=false) =
+    ProfiledDbnFileStore(String(path), latency)
+
+"""
+    pipeline_stats(store::ProfiledDbnFileStore) -> NamedTuple
+
+Byte and record counts per stage, with `records_decoded == records_filtered +
+records_delivered`, and nanoseconds per stage: `read_ns` and `decompress_ns`
+are measured per chunk, `decode_ns` is extrapolated from one `next_record` call
+in 64, and `other_ns` is the rest of `elapsed_ns` (time since the store was
+opened, up to the end of the file): FFI crossings, column stores and the
+caller's own code. A `other_ns` that dominates points at the consumer rather
+than the reader.
+"""
+function pipeline_stats(store::ProfiledDbnFileStore)
+    read, decompress, decode = Int(read_ns(store)), Int(decompress_ns(store)), Int(decode_ns(store))
+    elapsed = Int(elapsed_ns(store))
+    return (bytes_read = Int(bytes_read(store)),
+            bytes_decompressed = Int(bytes_decompressed(store)),
+            records_decoded = Int(records_decoded(store)),
+            records_filtered = Int(records_filtered(store)),
+            records_delivered = Int(records_delivered(store)),
+            read_ns = read, decompress_ns = decompress, decode_ns = decode,
+            other_ns = max(elapsed - read - decompress - decode, 0),
+            elapsed_ns = elapsed)
+end
+
+function _histogram_stats(h, percentiles)
+    return (count = Int(histogram_count(h)),
+            negative = Int(histogram_negative_count(h)),
+            min = Int(histogram_min(h)),
+            max = Int(histogram_max(h)),
+            mean = histogram_mean(h),
+            percentiles = [Float64(p) => Int(value_at_percentile(h, p)) for p in percentiles])
+end
+
+"""
+    latency_stats(source; percentiles=(50, 90, 99, 99.9)) -> NamedTuple
+
+Feed latency summaries, in nanoseconds, of the records read so far from a
+`ProfiledDbnFileStore` or `HistoricalStream` opened with `latency=true`:
+
+- `recv_delay`: `ts_recv - ts_event`, capture time behind the venue timestamp
+- `ts_in_delta`: the venue send-to-receive delta carried by the record
+- `send_delay`: `ts_out - ts_recv`, gateway send time behind capture, for
+  streams with `ts_out`
+
+Each holds `count`, `min`, `max`, `mean` and `percentiles` as `p => value`
+pairs accurate to 1.6%. Negative samples (clock skew) are only counted, in
+`negative`.
+"""
+function latency_stats(source::Union{ProfiledDbnFileStore, HistoricalStream};
+                       percentiles=(50, 90, 99, 99.9))
+    has_feed_latency(source) ||
+        throw(ArgumentError("feed latency histograms are off; open the source with latency=true"))
+    return GC.@preserve source (recv_delay = _histogram_stats(recv_delay_histogram(source), percentiles),
+                                ts_in_delta = _histogram_stats(ts_in_delta_histogram(source), percentiles),
+                                send_delay = _histogram_stats(send_delay_histogram(source), percentiles))
+end
+
+# ============================================================================
+# L3 Order Book Engine
+# ============================================================================
+
+export OrderBookEngine, top_levels, book_snapshot
+
+"""
+    consume!(engine::OrderBookEngine, source; filter=nothing, max_records=typemax(Int)) -> Int
+
+Apply MBO records from `source` (a `DbnFileStore` or any other reader) to the
+engine's books entirely in C++. Returns the number of records read, counting
+only those accepted by `filter` when one is given; other record types are
+skipped.
+"""
+function consume!(engine::OrderBookEngine, source; filter=nothing, max_records::Integer=typemax(Int))
+    if filter === nothing
+        return Int(consume!(engine, source, UInt(max_records)))
+    end
+    return Int(consume!(engine, source, filter, UInt(max_records)))
+end
+
+"""
+    top_levels(engine, instrument_id, n) -> Vector{BidAskPair}
+
+Aggregated bid and ask price levels from the top of the book, best first, up to
+`n` deep. Missing levels on the shallower side carry an undefined price.
+"""
+function top_levels(engine::OrderBookEngine, instrument_id::Integer, n::Integer)
+    levels = Vector{BidAskPair}(undef, n)
+    filled = top_levels!(engine, UInt32(instrument_id), levels)
+    return resize!(levels, Int(filled))
+end
+
+"""
+    book_snapshot(engine, instrument_id) -> NamedTuple
+
+Every resting order of one instrument's book as columns `order_id`, `price`,
+`size` and `side` (ASCII code), bids then asks, best level first and in queue
+priority within a level.
+"""
+function book_snapshot(engine::OrderBookEngine, instrument_id::Integer)
+    n = Int(order_count(engine, UInt32(instrument_id)))
+    order_id = Vector{UInt64}(undef, n)
+    price = Vector{Int64}(undef, n)
+    size = Vector{UInt32}(undef, n)
+    side = Vector{UInt8}(undef, n)
+    snapshot_orders!(engine, UInt32(instrument_id), order_id, price, size, side)
+    return (order_id = order_id, price = price, size = size, side = side)
+end
+
+# ============================================================================
+# Bar Aggregation
+# ============================================================================
+
+export BarAggregator, BarColumns, flush!, drain_bars!, drain_ohlcv
+
+const _BAR_KINDS = Dict(:time => BAR_TIME, :tick => BAR_TICK,
+                        :volume => BAR_VOLUME, :dollar => BAR_DOLLAR)
+
+"""
+    BarAggregator(kind::Symbol, threshold)
+
+Streaming trade-to-bar resampler over many instruments at once. `kind` is
+`:time` (`threshold` in nanoseconds, e.g. `250_000_000` for 250ms bars aligned
+to the epoch), `:tick` (trades per bar), `:volume` (traded size per bar) or
+`:dollar` (notional in currency units per bar). Trades are `TradeMsg` records
+and `Mbp1Msg`/`MboMsg` records with a trade action. Feed it with `consume!`,
+`apply!` or `add_trade!`, call `flush!` at the end of the data and collect bars
+with `drain_bars!` or `drain_ohlcv`.
+"""
+function BarAggregator(kind::Symbol, threshold::Real)
+    haskey(_BAR_KINDS, kind) || throw(ArgumentError("unknown bar kind :$kind"))
+    return BarAggregator(_BAR_KINDS[kind], Float64(threshold))
+end
+
+"""
+    consume!(aggregator::BarAggregator, source; filter=nothing, max_records=typemax(Int)) -> Int
+
+Aggregate trades from `source` entirely in C++. Returns the number of records
+read.
+"""
+function consume!(aggregator::BarAggregator, source; filter=nothing, max_records::Integer=typemax(Int))
+    if filter === nothing
+        return Int(consume!(aggregator, source, UInt(max_records)))
+    end
+    return Int(consume!(aggregator, source, filter, UInt(max_records)))
+end
+
+"""
+    drain_bars!(aggregator, cols::BarColumns) -> Int
+
+Move up to `length(cols)` completed bars into `cols`, oldest first. Returns the
+number of rows filled.
+"""
+drain_bars!(aggregator::BarAggregator, cols::BarColumns) =
+    Int(drain_bars!(aggregator, _columns(cols)...))
+
+"""
+    drain_ohlcv(aggregator) -> Vector{OhlcvMsg}
+
+Move every completed bar out as `OhlcvMsg` records with `ts_event` set to the
+bar's open time.
+"""
+function drain_ohlcv(aggregator::BarAggregator)
+    bars = Vector{OhlcvMsg}(undef, pending_bars(aggregator))
+    drain_ohlcv!(aggregator, bars)
+    return bars
+end
+
+# ============================================================================
+# As-Of Join
+# ============================================================================
+
+export AsofJoin, AsofJoinColumns, asof_join!, join_horizons, join_stats
+
+"""
+    AsofJoin(; horizons=(), exact_matches=true, tolerance=0)
+
+Streaming as-of join of trades with the quote prevailing for their instrument,
+for transaction-cost analysis over many instruments at once. Trades
+(`TradeMsg`) and quotes (`Mbp1Msg`, `BboMsg`, `Cmbp1Msg` or `CbboMsg`) are read
+from two sources and merged by `ts_recv` in C++, keeping the top of book of
+every instrument; see `asof_join!`.
+
+A quote with the same `ts_recv` as a trade prevails only with
+`exact_matches`; with a nonzero `tolerance` (nanoseconds) older quotes count as
+missing. For each of the `horizons` (nanoseconds) a row also gets the bid and
+ask prevailing `h` after the trade, including quotes at exactly that time. Rows
+are held back until their longest horizon has passed in the quote stream, so
+memory stays bounded by the trades within that window.
+"""
+function AsofJoin(; horizons=(), exact_matches::Bool=true, tolerance::Integer=0)
+    return AsofJoin(StdVector(UInt64[h for h in horizons]), exact_matches, UInt64(tolerance))
+end
+
+"""
+    join_horizons(join::AsofJoin) -> Vector{UInt64}
+
+Markout horizons of `join` in nanoseconds, sorted and without duplicates; this
+is the row order of the markout matrices.
+"""
+join_horizons(join::AsofJoin) = [horizon(join, UInt(i)) for i in 0:Int(horizon_count(join)) - 1]
+
+# Rows of an `AsofJoin`: the trade, then the prevailing quote, whose
+# `quote_ts_recv` is `typemax(UInt64)` and prices `typemax(Int64)` when there
+# is none. Column `i` of `markout_bid`/`markout_ask` holds row `i`'s quote at
+# each horizon of `join_horizons`. Prices are fixed-precision and `side` is the
+# raw ASCII code.
+struct AsofJoinColumns
+    ts_recv::Vector{UInt64}
+    ts_event::Vector{UInt64}
+    instrument_id::Vector{UInt32}
+    publisher_id::Vector{UInt16}
+    price::Vector{Int64}
+    size::Vector{UInt32}
+    side::Vector{UInt8}
+    quote_ts_recv::Vector{UInt64}
+    bid_px::Vector{Int64}
+    ask_px::Vector{Int64}
+    bid_sz::Vector{UInt32}
+    ask_sz::Vector{UInt32}
+    markout_bid::Matrix{Int64}
+    markout_ask::Matrix{Int64}
+end
+
+# Columns for `n` rows of `join`
+function AsofJoinColumns(join::AsofJoin, n::Integer)
+    horizons = Int(horizon_count(join))
+    vectors = (Vector{eltype(T)}(undef, n) for T in fieldtypes(AsofJoinColumns)[1:end-2])
+    return AsofJoinColumns(vectors..., Matrix{Int64}(undef, horizons, n),
+                           Matrix{Int64}(undef, horizons, n))
+end
+
+Base.length(cols::AsofJoinColumns) = length(cols.ts_recv)
+
+"""
+    asof_join!(join::AsofJoin, trades, quotes, cols::AsofJoinColumns) -> Int
+
+Read `trades` and `quotes` (any record sources, e.g. a `DbnFileStore` of
+`TRADES` and one of `MBP1` or `BBO_1S`) until `length(cols)` joined rows are
+ready, then move them into `cols` in trade order. Returns the number of rows
+filled; a value smaller than `length(cols)` means the join is complete. The
+sources must not be read elsewhere until then.
+"""
+function asof_join!(join::AsofJoin, trades, quotes, cols::AsofJoinColumns)
+    size(cols.markout_bid, 1) == size(cols.markout_ask, 1) == horizon_count(join) ||
+        throw(DimensionMismatch("markout columns need one row per horizon of the join"))
+    GC.@preserve trades quotes advance_join!(join, source_ref(trades), source_ref(quotes),
+                                             UInt(length(cols)))
+    return Int(drain_join!(join, ntuple(i -> getfield(cols, i), 12)...,
+                           vec(cols.markout_bid), vec(cols.markout_ask)))
+end
+
+"""
+    join_stats(join::AsofJoin)
+
+Progress of an as-of join as a NamedTuple: trades joined so far, how many of
+them had no prevailing quote, quotes applied, records of other types skipped,
+instruments quoted and rows held back for markouts or not yet drained.
+"""
+function join_stats(join::AsofJoin)
+    return (trades_joined = Int(trades_joined(join)),
+            trades_without_quote = Int(trades_without_quote(join)),
+            quotes_applied = Int(quotes_applied(join)),
+            records_skipped = Int(records_skipped(join)),
+            instruments = Int(instrument_count(join)),
+            pending_rows = Int(pending_rows(join)),
+            complete = join_complete(join))
+end
+
+# ============================================================================
+# Live Client with Ring Buffer Handoff
+# ============================================================================
+
+export LiveClient, subscribe!, start!, stop!, live_stats
+
+"""
+    LiveClient(; dataset, key=ENV["DATABENTO_API_KEY"], gateway="", port=13000,
+               send_ts_out=false, capacity=1 << 16, slot_bytes=512, block_when_full=false)
+
+Live session whose receive thread copies every record into a pre-sized
+lock-free ring of `capacity` slots of `slot_bytes` bytes. Drain it from Julia
+with `next_record`, `read_columns!` or `next_arrow_batch`; they return
+immediately when the ring is empty, so poll in a loop until `is_finished`.
+Methods that consume a whole source (writers, `demux!`, `consume!`, joins)
+would stop at the first empty ring and are not defined for it. When the ring is full the record
+is dropped and counted as an overrun, or with `block_when_full=true` the
+receive thread waits (backpressure). `gateway` and `port` override the
+dataset's gateway, e.g. to point at a local stand-in.
+"""
+function LiveClient(; dataset::AbstractString, key::AbstractString=get(ENV, "DATABENTO_API_KEY", ""),
+                    gateway::AbstractString="", port::Integer=13000, send_ts_out::Bool=false,
+                    capacity::Integer=1 << 16, slot_bytes::Integer=512, block_when_full::Bool=false)
+    return LiveClient(String(key), String(dataset), String(gateway), UInt16(port), send_ts_out,
+                      UInt(capacity), UInt(slot_bytes), block_when_full)
+end
+
+"""
+    subscribe!(client::LiveClient, symbols, schema; stype_in=RAW_SYMBOL)
+
+Subscribe before `start!`.
+"""
+subscribe!(client::LiveClient, symbols::AbstractVector{<:AbstractString}, schema::Schema;
+           stype_in::SType=RAW_SYMBOL) =
+    subscribe!(client, StdVector(String.(symbols)), schema, stype_in)
+
+"""
+    live_stats(client::LiveClient) -> NamedTuple
+
+Ring counters. `overruns` and `oversize_drops` count records lost to a full
+ring or to records larger than a slot; `backpressure_ns` is time the receive
+thread spent waiting for room with `block_when_full=true`.
+"""
+function live_stats(client::LiveClient)
+    return (received = Int(records_received(client)),
+            delivered = Int(records_delivered(client)),
+            buffered = Int(buffered(client)),
+            high_water_mark = Int(high_water_mark(client)),
+            overruns = Int(overruns(client)),
+            oversize_drops = Int(oversize_drops(client)),
+            backpressure_events = Int(backpressure_events(client)),
+            backpressure_ns = Int(backpressure_ns(client)))
+end
+
+# ============================================================================
+# Record Filtering
+# ============================================================================
+
+export RecordFilter, record_filter, filter_stats
+
+# Shared match-all filter used when a batch call is given `filter=nothing`
+const _MATCH_ALL = Ref{RecordFilter}()
+
+_filter(::Nothing) = _MATCH_ALL[]
+_filter(filter::RecordFilter) = filter
+
+"""
+    record_filter(; instrument_ids, publisher_ids, rtypes, actions, sides,
+                    ts_event, ts_recv, stop_at_end=false) -> RecordFilter
+
+Build a `RecordFilter` that is evaluated inside the C++ decode loop of
+`read_columns!`, `consume!` and `next_record(source, filter)`, so rejected
+records never reach Julia. Every keyword is optional and all given conditions
+must hold. `ts_event` and `ts_recv` are half-open `(start, stop)` ranges in
+nanoseconds since the UNIX epoch; `ts_recv` applies to the index timestamp of
+each record. With `stop_at_end = true`, reading stops at the first record past
+the `ts_recv` stop instead of scanning the rest of the source; only use it on
+sources ordered by index timestamp, such as a `MultiDbnReader` or a file known
+to be sorted. `actions` and `sides` accept `Action`/`Side` values or their
+`Char` codes and only constrain MBO, trade and MBP records.
+
+`Databento.reset!(filter)` clears the conditions but keeps the counters of
+`filter_stats`; `Databento.reset_counters!(filter)` zeroes them.
+"""
+function record_filter(; instrument_ids=(), publisher_ids=(), rtypes=(), actions=(),
+                       sides=(), ts_event=nothing, ts_recv=nothing, stop_at_end::Bool=false)
+    filter = RecordFilter()
+    foreach(id -> add_instrument_id!(filter, UInt32(id)), instrument_ids)
+    foreach(id -> add_publisher_id!(filter, UInt16(id)), publisher_ids)
+    foreach(rtype -> add_rtype!(filter, rtype), rtypes)
+    foreach(action -> add_action!(filter, _enum(Action, action)), actions)
+    foreach(side -> add_side!(filter, _enum(Side, side)), sides)
+    if ts_event !== nothing
+        set_ts_event_range!(filter, UInt64(first(ts_event)), UInt64(last(ts_event)))
+    end
+    if ts_recv !== nothing
+        set_ts_recv_range!(filter, UInt64(first(ts_recv)), UInt64(last(ts_recv)))
+    end
+    set_stop_at_ts_recv_end!(filter, stop_at_end)
+    return filter
+end
+
+_enum(::Type{T}, value::T) where {T} = value
+_enum(::Type{T}, code::Char) where {T} = reinterpret(T, Int8(code))
+
+"""
+    filter_stats(filter) -> NamedTuple
+
+Records examined and accepted by every read that used `filter`.
+"""
+filter_stats(filter::RecordFilter) =
+    (scanned = Int(records_scanned(filter)), matched = Int(records_matched(filter)))
+
+# ============================================================================
+# Timestamp Index and Seekable Reader
+# ============================================================================
+
+export IndexedDbnReader, build_ts_index
+
+"""
+    build_ts_index(path; index_path=path * ".tsidx", stride=4096, by_instrument=false) -> Int
+
+Scan a DBN file (`.dbn` or `.dbn.zst`) once and write a sidecar index mapping
+`ts_event` to block offsets. Blocks hold at least `stride` records; in
+compressed files they start on zstd frame boundaries, so a file written as a
+single frame yields a single block. With `by_instrument=true` the index also
+lists the blocks holding each `instrument_id`. Returns the number of blocks.
+"""
+function build_ts_index(path::AbstractString; index_path::AbstractString=path * ".tsidx",
+                        stride::Integer=4096, by_instrument::Bool=false)
+    return Int(build_ts_index(String(path), String(index_path), UInt(stride), by_instrument))
+end
+
+"""
+    IndexedDbnReader(path; index_path=path * ".tsidx", build=true, stride=4096, by_instrument=false)
+
+DBN reader that can `seek` by timestamp using a sidecar index. When `build` is
+true a missing or stale index is (re)built first with `build_ts_index`.
+Iterate with `next_record` or `read_columns!` like a `DbnFileStore`.
+"""
+function IndexedDbnReader(path::AbstractString; index_path::AbstractString=path * ".tsidx",
+                          build::Bool=true, stride::Integer=4096, by_instrument::Bool=false)
+    if build && !ts_index_is_current(String(path), String(index_path))
+        build_ts_index(path; index_path, stride, by_instrument)
+    end
+    return IndexedDbnReader(String(path), String(index_path))
+end
+
+"""
+    seek(reader::IndexedDbnReader, ts; instrument_id=nothing) -> reader
+
+Position `reader` at the first record with `ts_event >= ts` (nanoseconds since
+the UNIX epoch), decoding only from the index block that can contain it. With
+`instrument_id`, position at that instrument's first such record and visit only
+the blocks holding it until the next `seek`; other instruments' records in
+those blocks are still returned, so combine with a `record_filter`. Requires
+an index built with `by_instrument=true`.
+"""
+function Base.seek(reader::IndexedDbnReader, ts::Integer; instrument_id=nothing)
+    if instrument_id === nothing
+        seek_ts!(reader, UInt64(ts))
+    else
+        seek_ts!(reader, UInt64(ts), UInt32(instrument_id))
+    end
+    return reader
+end
+
+# ============================================================================
+# Shared Block Cache
+# ============================================================================
+
+export CachedDbnReader, block_cache_stats, set_block_cache_budget!, clear_block_cache!
+
+"""
+    CachedDbnReader(path)
+
+DBN reader backed by a process-wide LRU cache of decoded record blocks, for
+replaying the same files many times, from any number of threads. Blocks come
+from the file's timestamp index (the `build_ts_index` sidecar when current,
+otherwise an index built in memory on first open); each is decoded once and
+then shared by every reader until the cache's memory budget evicts it.
+Iterate with `next_record` or `read_columns!`, reposition with `seek`; each
+reader belongs to one task at a time. A `.dbn.zst` written as a single zstd
+frame is a single block, so compressed files cache best when written by
+`DbnWriter`.
+"""
+CachedDbnReader
+
+"""
+    seek(reader::CachedDbnReader, ts) -> reader
+
+Position `reader` at the first record with `ts_event >= ts` (nanoseconds since
+the UNIX epoch), starting from the index block that can contain it.
+"""
+function Base.seek(reader::CachedDbnReader, ts::Integer)
+    seek_ts!(reader, UInt64(ts))
+    return reader
+end
+
+"""
+    set_block_cache_budget!(bytes)
+
+Set the memory budget of the shared block cache (1 GiB initially), evicting
+least recently used blocks right away if it is now over.
+"""
+set_block_cache_budget!(bytes::Integer) = set_block_cache_budget!(UInt64(bytes))
+
+"""
+    block_cache_stats()
+
+Occupancy and counters of the shared block cache as a NamedTuple. `hits` and
+`misses` count block lookups by all readers since the last
+`clear_block_cache!`.
+"""
+function block_cache_stats()
+    hits, misses = Int(block_cache_hits()), Int(block_cache_misses())
+    return (budget = Int(block_cache_budget()), bytes = Int(block_cache_bytes()),
+            blocks = Int(block_cache_blocks()), hits = hits, misses = misses,
+            hit_rate = hits + misses == 0 ? 0.0 : hits / (hits + misses),
+            evictions = Int(block_cache_evictions()))
+end
+
+# ============================================================================
+# Dataset Catalog
+# ============================================================================
+
+export DbnCatalog, refresh!, catalog_files, catalog_reader
+
+"""
+    DbnCatalog(root; manifest=joinpath(root, ".dbn_catalog"), refresh=true, threads=0)
+
+Catalog of the `.dbn` and `.dbn.zst` files under the directory `root`, built
+from their metadata headers (dataset, schema, `start`/`end` and symbols) and
+persisted in a compact manifest. An existing manifest is loaded, and with
+`refresh=true` brought up to date: only new or modified files are opened, on
+`threads` threads (`0` for one per core). Query it with `catalog_files` or
+`catalog_reader` without touching the archive.
+"""
+function DbnCatalog(root::AbstractString; manifest::AbstractString=joinpath(root, ".dbn_catalog"),
+                    refresh::Bool=true, threads::Integer=0)
+    catalog = DbnCatalog(String(root), String(manifest))
+    refresh && refresh_catalog!(catalog, UInt(threads))
+    return catalog
+end
+
+"""
+    refresh!(catalog::DbnCatalog; threads=0) -> NamedTuple
+
+Rescan the catalog's tree, decode the headers of new and modified files and
+drop deleted ones, then save the manifest if anything changed. Files whose
+header cannot be decoded are listed in `failed` and retried next time.
+"""
+function refresh!(catalog::DbnCatalog; threads::Integer=0)
+    refresh_catalog!(catalog, UInt(threads))
+    return (scanned = Int(refresh_scanned(catalog)), added = Int(refresh_added(catalog)),
+            updated = Int(refresh_updated(catalog)), removed = Int(refresh_removed(catalog)),
+            failed = String.(refresh_failed(catalog)))
+end
+
+Base.length(catalog::DbnCatalog) = Int(file_count(catalog))
+
+"""
+    catalog_files(catalog; dataset=nothing, schema=nothing, symbols=(), ts=nothing) -> Vector{String}
+
+Paths of the cataloged files that can hold records matching the query, ordered
+by start time. `ts` is a half-open `(start, stop)` range in nanoseconds since
+the UNIX epoch, compared with each file's metadata `start` and `end`. Symbols
+match the requested symbols in the metadata and, for files whose `stype_out`
+is `RAW_SYMBOL`, the raw symbols they resolved to. Planning is conservative:
+mixed-schema files match any `schema`, and files of all symbols, or of parent
+or continuous symbols not resolved to raw symbols, match any `symbols`, so
+filter the records themselves with `record_filter`.
+"""
+function catalog_files(catalog::DbnCatalog; dataset=nothing, schema=nothing, symbols=(),
+                       ts=nothing)
+    start, stop = ts === nothing ? (0, typemax(UInt64)) : (first(ts), last(ts))
+    paths = plan_files(catalog, dataset === nothing ? "" : String(dataset), schema === nothing,
+                       schema === nothing ? MBO : schema, StdVector(String[String(s) for s in symbols]),
+                       UInt64(start), UInt64(stop))
+    return String.(paths)
+end
+
+"""
+    catalog_reader(catalog; dataset=nothing, schema=nothing, symbols=(), ts=nothing,
+                   threads=0, block_records=4096, max_blocks_per_file=4) -> MultiDbnReader
+
+Open the files selected by `catalog_files` as one `MultiDbnReader`, decoded in
+parallel and merged by index timestamp.
+"""
+function catalog_reader(catalog::DbnCatalog; dataset=nothing, schema=nothing, symbols=(),
+                        ts=nothing, threads::Integer=0, block_records::Integer=4096,
+                        max_blocks_per_file::Integer=4)
+    paths = catalog_files(catalog; dataset, schema, symbols, ts)
+    return MultiDbnReader(paths; threads, block_records, max_blocks_per_file)
+end
+
+# ============================================================================
+# DBN Summary Scan
+# ============================================================================
+
+export summarize_dbn
+
+"""
+    summarize_dbn(path; threads=0) -> NamedTuple
+
+Profile a DBN file, zstd-compressed or not, from its record headers and
+sequence numbers alone, without decoding any record into a message. The
+frames of a compressed file are decompressed on `threads` threads (0 for one
+per core), each filling its own tables, which are merged at the end; a
+single-frame or uncompressed file is scanned on one thread.
+
+- `records`, `record_bytes`, `file_size`, `dbn_version`, `compressed`
+- `ts_event`: `(min, max)` over the records, or `nothing` if none has one
+- `rtypes`: records per record type, e.g. `s.rtypes[Databento.RTYPE_MBO]`
+- `publishers`: records per `publisher_id`
+- `instruments`: columns sorted by `instrument_id`, with `records`,
+  `min_ts_event`, `max_ts_event` and, over the records carrying a sequence
+  number (MBO, trades, MBP, BBO, statistics), `sequenced`, `first_sequence`,
+  `last_sequence`, `sequence_gaps` (steps forward by more than one),
+  `missing_sequences` (numbers those steps skip) and `sequence_resets` (steps
+  backward)
+- `frames`, `runs`, `runs_rescanned`: how the scan was split; a run is
+  rescanned when the one before it ends inside a record
+"""
+function summarize_dbn(path::AbstractString; threads::Integer=0)
+    s = summarize_dbn(String(path), UInt(threads))
+    n = Int(summary_instrument_count(s))
+    instruments = (instrument_id = Vector{UInt32}(undef, n),
+                   records = Vector{UInt64}(undef, n),
+                   min_ts_event = Vector{UInt64}(undef, n),
+                   max_ts_event = Vector{UInt64}(undef, n),
+                   sequenced = Vector{UInt64}(undef, n),
+                   first_sequence = Vector{UInt32}(undef, n),
+                   last_sequence = Vector{UInt32}(undef, n),
+                   sequence_gaps = Vector{UInt64}(undef, n),
+                   missing_sequences = Vector{UInt64}(undef, n),
+                   sequence_resets = Vector{UInt64}(undef, n))
+    read_instrument_summary!(s, values(instruments)...)
+    min_ts, max_ts = summary_min_ts_event(s), summary_max_ts_event(s)
+    return (records = Int(summary_record_count(s)),
+            record_bytes = Int(summary_record_bytes(s)),
+            file_size = Int(summary_file_size(s)),
+            dbn_version = Int(summary_dbn_version(s)),
+            compressed = summary_compressed(s),
+            ts_event = min_ts > max_ts ? nothing : (min_ts, max_ts),
+            rtypes = Dict(zip(collect(summary_rtypes(s)), Int.(summary_rtype_counts(s)))),
+            publishers = Dict(zip(UInt16.(summary_publisher_ids(s)),
+                                  Int.(summary_publisher_records(s)))),
+            instruments = instruments,
+            frames = Int(summary_frames(s)),
+            runs = Int(summary_runs(s)),
+            runs_rescanned = Int(summary_runs_rescanned(s)))
+end
+
+# ============================================================================
+# Point-in-Time Symbol Map
+# ============================================================================
+
+export TsSymbolMap, symbol_map, symbol_at, symbol_ids!, symbol_table, save_symbol_map, resolve!
+
+const _UNIX_EPOCH_DATE = Dates.Date(1970, 1, 1)
+_epoch_days(date::Dates.Date) = UInt32(Dates.value(date - _UNIX_EPOCH_DATE))
+
+"""
+    TsSymbolMap()
+    TsSymbolMap(cache_path)
+
+Native point-in-time map from `(instrument_id, date)` to symbol. Symbols are
+interned: lookups return small integer symbol IDs (0 when unmapped) that index
+`symbol_table(map)`. Each instrument keeps its mappings as sorted date spans,
+so a lookup is one hash probe and a binary search. Fill it with
+`insert_metadata!` from a DBN header, `resolve!` from a symbology request,
+`consume!` over the `SymbolMappingMsg` records of any reader, or `apply!` on
+single records. Later mappings replace earlier ones for the same instrument
+and date. `save_symbol_map` writes a compact binary cache that the second form
+loads, so a cold start need not repeat resolution.
+"""
+TsSymbolMap
+
+"""
+    symbol_map(store) -> TsSymbolMap
+
+Symbol map from the mappings in the metadata of a DBN reader.
+"""
+function symbol_map(store)
+    map = TsSymbolMap()
+    insert_metadata!(map, get_metadata(store))
+    return map
+end
+
+"""
+    resolve!(map::TsSymbolMap, client::Historical, dataset, symbols, start_date, end_date;
+             stype_in=RAW_SYMBOL) -> map
+
+Resolve `symbols` to instrument IDs over `[start_date, end_date)` and insert the
+result, without parsing JSON.
+"""
+function resolve!(map::TsSymbolMap, client::Historical, dataset::AbstractString,
+                  symbols::AbstractVector{<:AbstractString}, start_date::Dates.Date,
+                  end_date::Dates.Date; stype_in::SType=RAW_SYMBOL)
+    resolve!(map, client, String(dataset), StdVector(String.(symbols)), stype_in,
+             string(start_date), string(end_date))
+    return map
+end
+
+"""
+    consume!(map::TsSymbolMap, source; max_records=typemax(Int)) -> Int
+
+Apply the `SymbolMappingMsg` records of `source` in C++. Returns the number of
+records read.
+"""
+consume!(map::TsSymbolMap, source; max_records::Integer=typemax(Int)) =
+    Int(consume!(map, source, UInt(max_records)))
+
+"""
+    insert_mapping!(map::TsSymbolMap, instrument_id, start_date, end_date, symbol) -> map
+
+Map `instrument_id` to `symbol` on the dates `[start_date, end_date)`.
+"""
+function insert_mapping!(map::TsSymbolMap, instrument_id::Integer, start_date::Dates.Date,
+                         end_date::Dates.Date, symbol::AbstractString)
+    insert_mapping!(map, UInt32(instrument_id), _epoch_days(start_date), _epoch_days(end_date),
+                    String(symbol))
+    return map
+end
+
+"""
+    symbol_at(map::TsSymbolMap, instrument_id, date::Date) -> Union{String,Nothing}
+    symbol_at(map::TsSymbolMap, instrument_id, ts::Integer) -> Union{String,Nothing}
+
+Symbol of `instrument_id` on `date`, or on the UTC date of the nanosecond
+timestamp `ts`.
+"""
+symbol_at(map::TsSymbolMap, instrument_id::Integer, date::Dates.Date) =
+    _symbol_or_nothing(map, find_symbol_id(map, UInt32(instrument_id), _epoch_days(date)))
+symbol_at(map::TsSymbolMap, instrument_id::Integer, ts::Integer) =
+    _symbol_or_nothing(map, find_symbol_id(map, UInt32(instrument_id),
+                                           UInt32(div(UInt64(ts), 86_400_000_000_000))))
+
+_symbol_or_nothing(map::TsSymbolMap, id) = id == 0 ? nothing : symbol(map, id)
+
+"""
+    symbol_ids!(out::Vector{UInt32}, map::TsSymbolMap, instrument_ids::Vector{UInt32}, ts::Vector{UInt64}) -> out
+    symbol_ids!(out::Vector{UInt32}, map::TsSymbolMap, instrument_ids::Vector{UInt32}, date::Date) -> out
+
+Vectorized lookup over a whole `instrument_id` column, e.g. from
+`read_columns!`, on the UTC date of each row's timestamp or on one `date`.
+Writes symbol IDs (0 when unmapped) for the first `min` of the lengths; map
+them to strings with `symbol_table(map)[id]`.
+"""
+function symbol_ids!(out::Vector{UInt32}, map::TsSymbolMap, instrument_ids::Vector{UInt32},
+                     ts::Vector{UInt64})
+    find_symbol_ids!(map, instrument_ids, ts, out)
+    return out
+end
+function symbol_ids!(out::Vector{UInt32}, map::TsSymbolMap, instrument_ids::Vector{UInt32},
+                     date::Dates.Date)
+    find_symbol_ids!(map, instrument_ids, _epoch_days(date), out)
+    return out
+end
+
+# ============================================================================
+# Columnar Instrument Definition Store
+# ============================================================================
+
+export DefinitionStore, DefinitionColumns, load_definitions, read_definitions!,
+       definition_row, instruments_of, definition_strings
+
+"""
+    DefinitionStore()
+
+Latest instrument definition per `instrument_id`, ingested from
+`InstrumentDefMsg` records in C++ into columns. String fields (`raw_symbol`,
+`underlying`, `exchange`, `asset`, `cfi`, `security_type`, `currency`) are
+interned once and stored as IDs into `definition_strings(store)`, so loading a
+large definition file allocates no string per record. A definition for a known
+instrument replaces its row; one with a Delete `security_update_action` removes
+it. Fill it with `consume!` over any reader, or `load_definitions`.
+"""
+DefinitionStore
+
+"""
+    load_definitions(source) -> DefinitionStore
+
+Read every record of `source` into a new `DefinitionStore`.
+"""
+function load_definitions(source)
+    store = DefinitionStore()
+    consume!(store, source)
+    return store
+end
+
+"""
+    consume!(store::DefinitionStore, source; max_records=typemax(Int)) -> Int
+
+Ingest the definitions among the next `max_records` records of `source` in
+C++. Returns the number of records read.
+"""
+consume!(store::DefinitionStore, source; max_records::Integer=typemax(Int)) =
+    Int(consume!(store, source, UInt(max_records)))
+
+Base.length(store::DefinitionStore) = Int(row_count(store))
+
+"""
+    read_definitions!(cols::DefinitionColumns, store; first=1) -> Int
+
+Copy up to `length(cols)` rows starting at row `first` into `cols`. Returns the
+number of rows copied, 0 once `first` is past the last row.
+`DefinitionColumns(length(store))` takes the whole table in one call.
+"""
+function read_definitions!(cols::DefinitionColumns, store::DefinitionStore; first::Integer=1)
+    first >= 1 || throw(ArgumentError("first must be at least 1, got $first"))
+    return Int(export_definitions!(store, UInt(first - 1), _columns(cols)...))
+end
+
+"""
+    definition_row(store, instrument_id::Integer) -> Union{Int,Nothing}
+    definition_row(store, raw_symbol::AbstractString) -> Union{Int,Nothing}
+
+Row of an instrument by ID, or of the instrument most recently defined with
+`raw_symbol`.
+"""
+definition_row(store::DefinitionStore, instrument_id::Integer) =
+    _row_or_nothing(find_row(store, UInt32(instrument_id)))
+definition_row(store::DefinitionStore, raw_symbol::AbstractString) =
+    _row_or_nothing(find_row(store, String(raw_symbol)))
+
+_row_or_nothing(row) = row < 0 ? nothing : Int(row) + 1
+
+"""
+    instruments_of(store, underlying) -> AbstractVector{UInt32}
+
+IDs of the instruments currently defined with `underlying`, in no particular
+order.
+"""
+instruments_of
+
+"""
+    definition_strings(store) -> AbstractVector{<:AbstractString}
+
+The interned strings; a string ID `i > 0` in `DefinitionColumns` is element `i`.
+"""
+definition_strings
+
+# ============================================================================
+# DBN Writer
+# ============================================================================
+
+export DbnWriter, DbnFanOut, write_record!, write_records!, route!, default_output!,
+       writer_stats
+
+"""
+    DbnWriter(path, metadata; zstd=endswith(path, ".zst"), level=3, threads=0,
+              frame_size=1 << 20, max_pending_frames=4)
+
+Write a DBN file with the header from `metadata` (e.g. `get_metadata(store)`).
+Records are buffered into frames of about `frame_size` uncompressed bytes; with
+`zstd` each frame is compressed independently on `threads` background threads
+(`0` for one per core) while writing continues, so the output is seekable by
+frame. At most `max_pending_frames` frames are in flight before a write waits.
+
+Feed it single records with `write_record!`, vectors of messages or whole
+sources with `write_records!`, then `close` it. The file only appears at `path`
+once `close` succeeds.
+"""
+function DbnWriter(path::AbstractString, metadata; zstd::Bool=endswith(path, ".zst"),
+                   level::Integer=3, threads::Integer=0, frame_size::Integer=1 << 20,
+                   max_pending_frames::Integer=4)
+    return DbnWriter(String(path), metadata, zstd, Int32(level), UInt(threads),
+                     UInt(frame_size), UInt(max_pending_frames))
+end
+
+"""
+    DbnFanOut(paths, metadata; routes=Dict(), default=nothing, kwargs...)
+
+Split one record stream into the files `paths` in a single pass. `routes` maps
+`instrument_id` to a 1-based index into `paths` (more can be added with
+`route!`); records of other instruments go to output `default`, or are dropped
+when it is `nothing`. Every output is a `DbnWriter` taking the same keyword
+options, and all of them share one compression thread pool. When the metadata
+maps symbols to instrument IDs, each file's header keeps only the mappings of
+its own instruments, so set up routes before writing.
+"""
+function DbnFanOut(paths::AbstractVector{<:AbstractString}, metadata;
+                   routes=Dict{UInt32,Int}(), default::Union{Integer,Nothing}=nothing,
+                   zstd::Bool=all(p -> endswith(p, ".zst"), paths), level::Integer=3,
+                   threads::Integer=0, frame_size::Integer=1 << 20,
+                   max_pending_frames::Integer=4)
+    fan_out = DbnFanOut(StdVector(String.(paths)), metadata, zstd, Int32(level), UInt(threads),
+                        UInt(frame_size), UInt(max_pending_frames))
+    for (instrument_id, output) in routes
+        route!(fan_out, instrument_id, output)
+    end
+    default === nothing || default_output!(fan_out, default)
+    return fan_out
+end
+
+"""
+    route!(fan_out::DbnFanOut, instrument_id, output)
+
+Send the records of `instrument_id` to `paths[output]`.
+"""
+route!(fan_out::DbnFanOut, instrument_id::Integer, output::Integer) =
+    add_route!(fan_out, UInt32(instrument_id), UInt(output - 1))
+
+"""
+    default_output!(fan_out::DbnFanOut, output)
+
+Send instruments without a route to `paths[output]`, or drop them if `output`
+is `nothing`.
+"""
+default_output!(fan_out::DbnFanOut, output::Integer) =
+    set_default_output!(fan_out, UInt(output - 1))
+default_output!(fan_out::DbnFanOut, ::Nothing) = drop_unrouted!(fan_out)
+
+"""
+    write_record!(writer, record)
+
+Append one `Record` (as returned by `next_record`) to a `DbnWriter`, or route it
+through a `DbnFanOut`, where the result is `false` if it was dropped.
+"""
+write_record!
+
+const _RecordSink = Union{DbnWriter, DbnFanOut}
+
+"""
+    write_records!(writer, source; filter=nothing, max_records=typemax(Int)) -> Int
+    write_records!(writer::DbnWriter, records::Vector{T}) -> Int
+
+Copy records from any reader (`DbnFileStore`, `MmapDbnReader`, ...) into a
+`DbnWriter` or `DbnFanOut` without returning to Julia, optionally only those
+accepted by a `RecordFilter`; or write a vector of messages such as `MboMsg` in
+one call. Returns the number of records read from `source`, or written from
+`records`.
+"""
+function write_records!(writer::_RecordSink, source; filter=nothing,
+                        max_records::Integer=typemax(Int))
+    if filter === nothing
+        return Int(write_records!(writer, source, UInt(max_records)))
+    end
+    return Int(write_records!(writer, source, filter, UInt(max_records)))
+end
+
+function write_records!(writer::DbnWriter, records::Vector{T}) where {T}
+    isbitstype(T) || throw(ArgumentError("$T is not an isbits record type"))
+    GC.@preserve records write_bytes!(writer, Ptr{Cvoid}(pointer(records)), UInt(sizeof(records)))
+    return length(records)
+end
+
+Base.close(writer::_RecordSink) = close_writer!(writer)
+
+"""
+    writer_stats(writer::DbnWriter) -> NamedTuple
+    writer_stats(fan_out::DbnFanOut) -> NamedTuple
+
+Records and bytes written so far. For a `DbnWriter`, `bytes_encoded` is the
+uncompressed DBN size and `stall_ns` the time writes waited for compression to
+catch up (raise `threads` or `max_pending_frames` if it is large). For a
+`DbnFanOut`, `records` holds the count per output.
+"""
+function writer_stats(writer::DbnWriter)
+    return (records_written = Int(records_written(writer)),
+            bytes_encoded = Int(bytes_encoded(writer)),
+            bytes_written = Int(bytes_written(writer)),
+            frames_written = Int(frames_written(writer)),
+            stall_ns = Int(stall_ns(writer)))
+end
+
+function writer_stats(fan_out::DbnFanOut)
+    return (records_written = Int(records_written(fan_out)),
+            records_dropped = Int(records_dropped(fan_out)),
+            records = [Int(output_records_written(fan_out, UInt(i))) for i in 0:output_count(fan_out) - 1])
+end
+
+# ============================================================================
+# Arrow Export
+# ============================================================================
+
+export ArrowConverter, ArrowBatch, next_arrow_batch, arrow_batches, dbn_to_arrow,
+       arrow_array_ptr, arrow_schema_ptr
+
+"""
+    ArrowConverter(schema; batch_rows=65_536, scale_prices=false)
+
+Convert records of `schema` (`MBO`, `TRADES`, `MBP1`, `TBBO` or any OHLCV
+schema) into Arrow record batches of at most `batch_rows` rows, so memory stays
+bounded however large the input. `ts_event` and `ts_recv` become
+`timestamp[ns, UTC]` columns, `action` and `side` keep their ASCII codes, and
+with `scale_prices` the fixed-point prices become `Float64` (undefined prices
+become `NaN`).
+"""
+function ArrowConverter(schema::Schema; batch_rows::Integer=65_536, scale_prices::Bool=false)
+    return ArrowConverter(schema, UInt(batch_rows), scale_prices)
+end
+
+# Layouts of the Arrow C Data Interface structs
+struct CArrowSchema
+    format::Ptr{Cchar}
+    name::Ptr{Cchar}
+    metadata::Ptr{Cchar}
+    flags::Int64
+    n_children::Int64
+    children::Ptr{Ptr{CArrowSchema}}
+    dictionary::Ptr{CArrowSchema}
+    release::Ptr{Cvoid}
+    private_data::Ptr{Cvoid}
+end
+
+struct CArrowArray
+    length::Int64
+    null_count::Int64
+    offset::Int64
+    n_buffers::Int64
+    n_children::Int64
+    buffers::Ptr{Ptr{Cvoid}}
+    children::Ptr{Ptr{CArrowArray}}
+    dictionary::Ptr{CArrowArray}
+    release::Ptr{Cvoid}
+    private_data::Ptr{Cvoid}
+end
+
+# A struct whose release callback is null, i.e. already released
+_released(::Type{T}) where {T} =
+    T(ntuple(i -> fieldtype(T, i) <: Ptr ? fieldtype(T, i)(0) : 0, fieldcount(T))...)
+
+function _release!(ref::Base.RefValue{T}) where {T}
+    release = ref[].release
+    release == C_NULL || ccall(release, Cvoid, (Ptr{T},), ref)
+    return nothing
+end
+
+const _ARROW_FORMATS = Dict("C" => UInt8, "S" => UInt16, "I" => UInt32, "L" => UInt64,
+                            "i" => Int32, "l" => Int64, "g" => Float64, "tsn:UTC" => Int64)
+
+"""
+    ArrowBatch
+
+One record batch in C++ memory, exported through the Arrow C Data Interface.
+`batch.columns` is a `NamedTuple` of vectors wrapping the Arrow buffers without
+copying (timestamps as `Int64` nanoseconds); they are only valid while the
+batch is reachable, so `copy` columns that must outlive it. The buffers are
+freed by the finalizer, or early with `finalize(batch)`.
+
+To hand the batch to another Arrow implementation (e.g. pyarrow's
+`RecordBatch._import_from_c`), pass `arrow_array_ptr(batch)` and
+`arrow_schema_ptr(batch)`; the importer takes ownership and the columns must no
+longer be used.
+"""
+mutable struct ArrowBatch
+    array::Base.RefValue{CArrowArray}
+    schema::Base.RefValue{CArrowSchema}
+    columns::NamedTuple
+
+    function ArrowBatch()
+        batch = new(Ref(_released(CArrowArray)), Ref(_released(CArrowSchema)), NamedTuple())
+        return finalizer(batch) do b
+            _release!(b.array)
+            _release!(b.schema)
+        end
+    end
+end
+
+Base.length(batch::ArrowBatch) = Int(batch.array[].length)
+
+arrow_array_ptr(batch::ArrowBatch) = Base.unsafe_convert(Ptr{CArrowArray}, batch.array)
+arrow_schema_ptr(batch::ArrowBatch) = Base.unsafe_convert(Ptr{CArrowSchema}, batch.schema)
+
+function _arrow_columns(array::CArrowArray, schema::CArrowSchema)
+    names = Symbol[]
+    columns = Vector[]
+    for i in 1:schema.n_children
+        field = unsafe_load(unsafe_load(schema.children, i))
+        child = unsafe_load(unsafe_load(array.children, i))
+        T = _ARROW_FORMATS[unsafe_string(field.format)]
+        data = Ptr{T}(unsafe_load(child.buffers, 2))
+        push!(names, Symbol(unsafe_string(field.name)))
+        push!(columns, unsafe_wrap(Array, data, Int(child.length)))
+    end
+    return NamedTuple{Tuple(names)}(Tuple(columns))
+end
+
+"""
+    next_arrow_batch(converter::ArrowConverter, source; filter=nothing) -> Union{ArrowBatch, Nothing}
+
+Decode the next batch of records from `source`, optionally only those accepted
+by a `RecordFilter`. Returns `nothing` once the source is exhausted.
+"""
+function next_arrow_batch(converter::ArrowConverter, source; filter=nothing)
+    batch = ArrowBatch()
+    GC.@preserve batch begin
+        array = Ptr{Cvoid}(arrow_array_ptr(batch))
+        n = filter === nothing ? next_arrow_batch!(converter, source, array) :
+                                 next_arrow_batch!(converter, source, filter, array)
+        if n == 0
+            finalize(batch)
+            return nothing
+        end
+        export_arrow_schema!(converter, Ptr{Cvoid}(arrow_schema_ptr(batch)))
+    end
+    batch.columns = _arrow_columns(batch.array[], batch.schema[])
+    return batch
+end
+
+struct ArrowBatches{S}
+    converter::ArrowConverter
+    source::S
+    filter::Any
+end
+
+"""
+    arrow_batches(source; schema, batch_rows=65_536, scale_prices=false, filter=nothing)
+
+Iterate over `source` as `ArrowBatch`es, see `ArrowConverter`. Only the batches
+still referenced are held in memory.
+"""
+function arrow_batches(source; schema::Schema, batch_rows::Integer=65_536,
+                       scale_prices::Bool=false, filter=nothing)
+    return ArrowBatches(ArrowConverter(schema; batch_rows, scale_prices), source, filter)
+end
+
+function Base.iterate(it::ArrowBatches, state=nothing)
+    batch = next_arrow_batch(it.converter, it.source; filter=it.filter)
+    return batch === nothing ? nothing : (batch, nothing)
+end
+
+Base.IteratorSize(::Type{<:ArrowBatches}) = Base.SizeUnknown()
+Base.eltype(::Type{<:ArrowBatches}) = ArrowBatch
+
+"""
+    dbn_to_arrow(source, path; schema, format=:auto, batch_rows=65_536,
+                 scale_prices=false, filter=nothing, zstd=true, level=3, threads=0,
+                 row_group_rows=1_048_576) -> Int
+
+Convert the records of `schema` in `source` into an Arrow IPC (Feather v2) or
+Parquet file without going through Julia, one batch at a time, and return the
+number of rows written. `format` is `:arrow` or `:parquet`; by default files
+ending in `.parquet` are written as Parquet. Parquet row groups hold
+`row_group_rows` rows whatever `batch_rows` is, with one data page per batch;
+their columns are compressed with zstd at `level` on `threads` threads (`0`
+for one per core) unless `zstd` is false. A row group is buffered in memory
+until it is complete. Arrow IPC output is uncompressed. The file only appears
+at `path` once it is complete.
+"""
+function dbn_to_arrow(source, path::AbstractString; schema::Schema, format::Symbol=:auto,
+                      batch_rows::Integer=65_536, scale_prices::Bool=false, filter=nothing,
+                      zstd::Bool=true, level::Integer=3, threads::Integer=0,
+                      row_group_rows::Integer=1_048_576)
+    if format === :auto
+        format = endswith(path, ".parquet") ? :parquet : :arrow
+    end
+    converter = ArrowConverter(schema; batch_rows, scale_prices)
+    if format === :parquet
+        options = (zstd, Int32(level), UInt(threads), UInt(row_group_rows))
+        rows = filter === nothing ? write_parquet!(converter, source, String(path), options...) :
+                                    write_parquet!(converter, source, filter, String(path), options...)
+    elseif format === :arrow
+        rows = filter === nothing ? write_arrow_ipc!(converter, source, String(path)) :
+                                    write_arrow_ipc!(converter, source, filter, String(path))
+    else
+        throw(ArgumentError("Unknown Arrow output format :$format"))
+    end
+    return Int(rows)
+end
+
+# ============================================================================
+# Analytics Kernels
+# ============================================================================
+
+export price_to_float!, mid_prices!, spreads!, microprices!, signed_volumes!,
+       GroupedAnalytics, group_indexes!, add_trades!, trade_totals, returns!,
+       simd_level, set_simd_enabled!
+
+# The kernels run over the first `n` rows of `read_columns!` buffers and write
+# into `out`, using AVX2 when the CPU has it. Prices come out as Float64 in
+# currency units; any result involving an undefined price (`typemax(Int64)`) is
+# NaN.
+
+"""
+    price_to_float!(out::Vector{Float64}, price::Vector{Int64}, n=length(price)) -> out
+
+Scale fixed-point prices to Float64.
+"""
+function price_to_float!(out::Vector{Float64}, price::Vector{Int64}, n::Integer=length(price))
+    fill_price_to_float!(out, price, UInt(n))
+    return out
+end
+
+const _QuoteColumns = Union{Mbp1Columns, BboColumns}
+
+"""
+    mid_prices!(out, bid_px, ask_px, n=length(bid_px)) -> out
+    mid_prices!(out, cols::Union{Mbp1Columns, BboColumns}, n=length(cols)) -> out
+
+Midpoint of the top-of-book quote.
+"""
+function mid_prices!(out::Vector{Float64}, bid_px::Vector{Int64}, ask_px::Vector{Int64},
+                     n::Integer=length(bid_px))
+    fill_mid_prices!(out, bid_px, ask_px, UInt(n))
+    return out
+end
+mid_prices!(out::Vector{Float64}, cols::_QuoteColumns, n::Integer=length(cols)) =
+    mid_prices!(out, cols.bid_px, cols.ask_px, n)
+
+"""
+    spreads!(out, bid_px, ask_px, n=length(bid_px)) -> out
+    spreads!(out, cols::Union{Mbp1Columns, BboColumns}, n=length(cols)) -> out
+
+Quoted spread, `ask_px - bid_px`.
+"""
+function spreads!(out::Vector{Float64}, bid_px::Vector{Int64}, ask_px::Vector{Int64},
+                  n::Integer=length(bid_px))
+    fill_spreads!(out, bid_px, ask_px, UInt(n))
+    return out
+end
+spreads!(out::Vector{Float64}, cols::_QuoteColumns, n::Integer=length(cols)) =
+    spreads!(out, cols.bid_px, cols.ask_px, n)
+
+"""
+    microprices!(out, bid_px, ask_px, bid_sz, ask_sz, n=length(bid_px)) -> out
+    microprices!(out, cols::Union{Mbp1Columns, BboColumns}, n=length(cols)) -> out
+
+Size-weighted mid, `(bid_px * ask_sz + ask_px * bid_sz) / (bid_sz + ask_sz)`;
+NaN when both sides are empty.
+"""
+function microprices!(out::Vector{Float64}, bid_px::Vector{Int64}, ask_px::Vector{Int64},
+                      bid_sz::Vector{UInt32}, ask_sz::Vector{UInt32}, n::Integer=length(bid_px))
+    fill_microprices!(out, bid_px, ask_px, bid_sz, ask_sz, UInt(n))
+    return out
+end
+microprices!(out::Vector{Float64}, cols::_QuoteColumns, n::Integer=length(cols)) =
+    microprices!(out, cols.bid_px, cols.ask_px, cols.bid_sz, cols.ask_sz, n)
+
+const _TradeLikeColumns = Union{TradeColumns, Mbp1Columns, BboColumns}
+
+"""
+    signed_volumes!(out::Vector{Int64}, size, side, n=length(size)) -> out
+    signed_volumes!(out::Vector{Int64}, cols, n=length(cols)) -> out
+
+`size` signed by aggressor side: positive for buys (`'B'`), negative for sells
+(`'A'`), zero when the side is unknown.
+"""
+function signed_volumes!(out::Vector{Int64}, size::Vector{UInt32}, side::Vector{UInt8},
+                         n::Integer=length(size))
+    fill_signed_volumes!(out, size, side, UInt(n))
+    return out
+end
+signed_volumes!(out::Vector{Int64}, cols::_TradeLikeColumns, n::Integer=length(cols)) =
+    signed_volumes!(out, cols.size, cols.side, n)
+
+"""
+    simd_level() -> Symbol
+
+`:avx2` or `:scalar`, the code path the kernels currently take.
+"""
+simd_level() = simd_avx2_active() ? :avx2 : :scalar
+
+"""
+    set_simd_enabled!(enabled::Bool)
+
+Force the scalar kernels with `false`, e.g. to compare against the AVX2 path,
+which gives identical results.
+"""
+set_simd_enabled!
+
+"""
+    GroupedAnalytics()
+
+Per-instrument state for the grouped kernels, kept across chunks. Instruments
+are numbered 1, 2, ... in order of first appearance; these group indexes
+address the per-instrument results. `empty!` resets it.
+"""
+GroupedAnalytics
+
+Base.length(analytics::GroupedAnalytics) = Int(group_count(analytics))
+Base.empty!(analytics::GroupedAnalytics) = (clear_groups!(analytics); analytics)
+
+"""
+    group_indexes!(out::Vector{UInt32}, analytics, instrument_id, n=length(instrument_id)) -> out
+
+Write the 1-based group index of each row's instrument.
+"""
+function group_indexes!(out::Vector{UInt32}, analytics::GroupedAnalytics,
+                        instrument_id::Vector{UInt32}, n::Integer=length(instrument_id))
+    fill_group_indexes!(analytics, out, instrument_id, UInt(n))
+    @views out[1:n] .+= 0x1
+    return out
+end
+
+"""
+    add_trades!(analytics, cols::Union{TradeColumns, BboColumns}, n=length(cols))
+    add_trades!(analytics, instrument_id, price, size, side, n=length(instrument_id))
+
+Accumulate VWAP, volume, signed volume and trade counts per instrument; read
+them with `trade_totals`. Trades with an undefined price only count towards
+the volumes.
+"""
+function add_trades!(analytics::GroupedAnalytics, instrument_id::Vector{UInt32},
+                     price::Vector{Int64}, size::Vector{UInt32}, side::Vector{UInt8},
+                     n::Integer=length(instrument_id))
+    accumulate_trades!(analytics, instrument_id, price, size, side, UInt(n))
+    return analytics
+end
+add_trades!(analytics::GroupedAnalytics, cols::Union{TradeColumns, BboColumns},
+            n::Integer=length(cols)) =
+    add_trades!(analytics, cols.instrument_id, cols.price, cols.size, cols.side, n)
+
+"""
+    trade_totals(analytics) -> NamedTuple
+
+Per-instrument results of `add_trades!` in group order: `instrument_id`,
+`vwap` (NaN without priced trades), `volume`, `signed_volume` and `trades`.
+"""
+function trade_totals(analytics::GroupedAnalytics)
+    n = length(analytics)
+    totals = (instrument_id = Vector{UInt32}(undef, n), vwap = Vector{Float64}(undef, n),
+              volume = Vector{UInt64}(undef, n), signed_volume = Vector{Int64}(undef, n),
+              trades = Vector{UInt64}(undef, n))
+    copy_trade_totals!(analytics, totals...)
+    return totals
+end
+
+"""
+    returns!(out::Vector{Float64}, analytics, instrument_id, value, n=length(value)) -> out
+
+Simple returns `value / previous - 1` against the previous finite value of the
+same instrument, carried across calls, e.g. over `price_to_float!` trade
+prices or `mid_prices!`. The first value of each instrument gives NaN.
+"""
+function returns!(out::Vector{Float64}, analytics::GroupedAnalytics,
+                  instrument_id::Vector{UInt32}, value::Vector{Float64},
+                  n::Integer=length(value))
+    fill_returns!(analytics, out, instrument_id, value, UInt(n))
+    return out
+end
+
+# ============================================================================
+# Synthetic DBN Data
+# ============================================================================
+
+export write_synthetic_dbn
+
+"""
+    write_synthetic_dbn(path; schema=MBO, instruments=16, records=1_000_000,
+                        zstd=endswith(path, ".zst"), seed=1, dataset="GLBX.MDP3",
+                        start=1_704_153_600_000_000_000, frame_size=0, parent="",
+                        stype_out=INSTRUMENT_ID) -> Int
+
+Write a DBN file of generated records and return its size in bytes. The output
+depends only on the arguments, so benchmarks and tests can regenerate the same
+file anywhere. `schema` is one of `MBO`, `TRADES`, `MBP1`, `MBP10` or
+`OHLCV_1S`; instrument IDs run from 1 to `instruments`, each mapped to the
+symbol `"SYN<id>"` in the metadata. Records start at `start` (nanoseconds since
+the UNIX epoch, 2024-01-02 by default), 1µs apart. MBO files are book-consistent
+and can be fed to an `OrderBookEngine`. With `zstd` and a nonzero `frame_size`
+a new zstd frame starts every `frame_size` uncompressed bytes, cutting records
+across frames, as some writers do when they flush by size. A nonempty `parent`
+makes the metadata that of a `PARENT` request for that symbol, resolved to
+`stype_out` (`INSTRUMENT_ID`, or `RAW_SYMBOL` for the `"SYN<id>"` symbols).
+"""
+function write_synthetic_dbn(path::AbstractString; schema::Schema=MBO,
+                             instruments::Integer=16, records::Integer=1_000_000,
+                             zstd::Bool=endswith(path, ".zst"), seed::Integer=1,
+                             dataset::AbstractString="GLBX.MDP3",
+                             start::Integer=1_704_153_600_000_000_000,
+                             frame_size::Integer=0, parent::AbstractString="",
+                             stype_out::SType=INSTRUMENT_ID)
+    return Int(write_synthetic_dbn(String(path), schema, UInt32(instruments),
+                                   UInt64(records), zstd, UInt64(seed), String(dataset),
+                                   UInt64(start), UInt64(frame_size), String(parent),
+                                   stype_out))
+end
+
 end # module
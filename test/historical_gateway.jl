@@ -0,0 +1,106 @@
+using Sockets
+
+"""
+    replay_historical(path; chunk_size=4096) -> (server, port, task)
+
+Minimal stand-in for the Databento historical HTTP API on a local port. It
+accepts one connection, reads a single request without checking credentials
+or parameters, and answers it with the bytes of the DBN file at `path` as a
+chunked `200 OK` response of `chunk_size`-byte chunks, then closes the
+connection.
+"""
+function replay_historical(path::AbstractString; chunk_size::Integer=4096)
+    server = listen(ip"127.0.0.1", 0)
+    port = Int(getsockname(server)[2])
+    task = @async begin
+        sock = accept(server)
+        try
+            read_request_body(sock)
+            write_chunked_response(sock, read(path), chunk_size)
+        finally
+            close(sock)
+            close(server)
+        end
+    end
+    return server, port, task
+end
+
+"""
+    serve_historical(path; fail_first=0, cut_after=0) -> (process, port, log)
+
+Stand-in like `replay_historical` that answers any number of requests, each
+on its own connection, with the DBN file at `path`. It runs in a separate
+Julia process so that blocking calls into the client in this one can reach
+it. The first `fail_first` requests get a `503 Service Unavailable`. With a
+nonzero `cut_after`, responses stop after that many bytes of the file and
+the connection is closed without ending the chunked body. The form-encoded
+body of every request is appended to the file `log`, one per line. Stop it
+with `kill(process)`.
+"""
+function serve_historical(path::AbstractString; fail_first::Integer=0, cut_after::Integer=0)
+    log = tempname()
+    touch(log)
+    script = """
+        include($(repr(@__FILE__)))
+        serve_historical_loop($(repr(String(path))), $fail_first, $(repr(log)), $cut_after)
+        """
+    process = open(`$(Base.julia_cmd()) --startup-file=no -e $script`, "r")
+    port = parse(Int, readline(process))
+    return process, port, log
+end
+
+function serve_historical_loop(path::AbstractString, fail_first::Integer, log::AbstractString,
+                               cut_after::Integer)
+    server = listen(ip"127.0.0.1", 0)
+    println(Int(getsockname(server)[2]))
+    flush(stdout)
+    bytes = read(path)
+    served = 0
+    while true
+        sock = accept(server)
+        served += 1
+        fail = served <= fail_first
+        @async try
+            body = read_request_body(sock)
+            open(io -> println(io, body), log, "a")
+            if fail
+                write(sock, "HTTP/1.1 503 Service Unavailable\r\n",
+                      "Content-Length: 0\r\nConnection: close\r\n\r\n")
+            elseif cut_after > 0
+                write_chunked_response(sock, view(bytes, 1:cut_after), 4096; finish = false)
+            else
+                write_chunked_response(sock, bytes, 4096)
+            end
+        finally
+            close(sock)
+        end
+    end
+end
+
+# Reads the request line and headers, then returns the form-encoded body
+function read_request_body(sock)
+    content_length = 0
+    readline(sock)
+    while true
+        line = rstrip(readline(sock), '\r')
+        isempty(line) && break
+        name, value = split(line, ':'; limit = 2)
+        lowercase(name) == "content-length" && (content_length = parse(Int, strip(value)))
+    end
+    return String(read(sock, content_length))
+end
+
+# Without `finish` the body lacks its terminating chunk, like a dropped connection
+function write_chunked_response(sock, bytes::AbstractVector{UInt8}, chunk_size::Integer;
+                                finish::Bool=true)
+    write(sock, "HTTP/1.1 200 OK\r\n",
+          "Content-Type: application/octet-stream\r\n",
+          "Transfer-Encoding: chunked\r\n",
+          "Connection: close\r\n\r\n")
+    for first in 1:chunk_size:length(bytes)
+        chunk = view(bytes, first:min(first + chunk_size - 1, length(bytes)))
+        write(sock, string(length(chunk), base = 16), "\r\n", chunk, "\r\n")
+        flush(sock)
+    end
+    finish && write(sock, "0\r\n\r\n")
+end
@@ -0,0 +1,31 @@
+using Sockets
+
+"""
+    replay_gateway(path) -> (server, port, task)
+
+Minimal stand-in for a Databento live gateway on a local port. It accepts one
+connection, acknowledges the greeting, authentication and subscription
+exchange without checking credentials, and after `start_session` streams the
+bytes of the uncompressed DBN file at `path` before closing the connection.
+"""
+function replay_gateway(path::AbstractString)
+    server = listen(ip"127.0.0.1", 0)
+    port = Int(getsockname(server)[2])
+    task = @async begin
+        sock = accept(server)
+        try
+            write(sock, "lsg_version=0.0.0\n")
+            write(sock, "cram=stand-in-challenge\n")
+            readline(sock)                                  # auth=...|dataset=...
+            write(sock, "success=1|session_id=1\n")
+            while !eof(sock)
+                startswith(readline(sock), "start_session") && break
+            end
+            write(sock, read(path))
+        finally
+            close(sock)
+            close(server)
+        end
+    end
+    return server, port, task
+end
@@ -0,0 +1,102 @@
+# Just enough of a Parquet reader to check the files `dbn_to_arrow` writes:
+# the Thrift compact protocol of the footer and page headers, and PLAIN pages
+# of uncompressed fixed-width columns.
+
+mutable struct ThriftReader
+    bytes::Vector{UInt8}
+    pos::Int
+end
+
+function read_varint(r::ThriftReader)
+    value, shift = UInt64(0), 0
+    while true
+        byte = r.bytes[r.pos]
+        r.pos += 1
+        value |= UInt64(byte & 0x7f) << shift
+        byte < 0x80 && return value
+        shift += 7
+    end
+end
+
+zigzag(v::UInt64) = Int64(v >> 1) ⊻ -Int64(v & 1)
+
+function read_thrift_value(r::ThriftReader, type::Integer)
+    type == 1 && return true
+    type == 2 && return false
+    if type == 3
+        r.pos += 1
+        return reinterpret(Int8, r.bytes[r.pos - 1])
+    end
+    type in (4, 5, 6) && return zigzag(read_varint(r))
+    if type == 8
+        n = Int(read_varint(r))
+        r.pos += n
+        return String(r.bytes[r.pos - n:r.pos - 1])
+    end
+    if type in (9, 10)
+        header = r.bytes[r.pos]
+        r.pos += 1
+        n = header >> 4 == 15 ? Int(read_varint(r)) : Int(header >> 4)
+        return [read_thrift_value(r, header & 0x0f) for _ in 1:n]
+    end
+    type == 12 && return read_thrift_struct(r)
+    error("Unsupported Thrift compact type $type")
+end
+
+"""
+    read_thrift_struct(r) -> Dict{Int,Any}
+
+Decode a compact-protocol struct into its fields keyed by field ID; nested
+structs become `Dict`s and lists `Vector`s.
+"""
+function read_thrift_struct(r::ThriftReader)
+    fields = Dict{Int,Any}()
+    id = 0
+    while (header = r.bytes[r.pos]; r.pos += 1; header != 0)
+        delta, type = header >> 4, header & 0x0f
+        id = delta == 0 ? Int(zigzag(read_varint(r))) : id + delta
+        fields[id] = read_thrift_value(r, type)
+    end
+    return fields
+end
+
+"""
+    parquet_metadata(path) -> Dict{Int,Any}
+
+The `FileMetaData` footer of a Parquet file: field 2 is the schema, 3 the row
+count and 4 the row groups, each with its column chunks in field 1 and its row
+count in field 3.
+"""
+function parquet_metadata(path::AbstractString)
+    bytes = read(path)
+    String(bytes[1:4]) == "PAR1" && String(bytes[end - 3:end]) == "PAR1" ||
+        error("$path is not a Parquet file")
+    footer_length = Int(reinterpret(UInt32, bytes[end - 7:end - 4])[1])
+    return read_thrift_struct(ThriftReader(bytes, lastindex(bytes) - 8 - footer_length + 1))
+end
+
+"""
+    parquet_column(path, metadata, column, T) -> Vector{T}
+
+Every value of the `column`th column of an uncompressed Parquet file, read
+page by page across its row groups. INT32 values narrower than `T` are
+converted; others are reinterpreted as `T`.
+"""
+function parquet_column(path::AbstractString, metadata, column::Integer, ::Type{T}) where {T}
+    bytes = read(path)
+    values = T[]
+    for group in metadata[4]
+        chunk = group[1][column][3]
+        chunk[4] == 0 || error("Column chunk is compressed with codec $(chunk[4])")
+        offset, remaining = chunk[9], chunk[5]
+        while remaining > 0
+            r = ThriftReader(bytes, offset + 1)
+            header = read_thrift_struct(r)
+            page = bytes[r.pos:r.pos + header[3] - 1]
+            append!(values, sizeof(T) < 4 ? T.(reinterpret(Int32, page)) : reinterpret(T, page))
+            remaining -= header[5][1]
+            offset = r.pos - 1 + header[3]
+        end
+    end
+    return values
+end
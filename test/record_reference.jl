@@ -0,0 +1,88 @@
+"""
+    collect_mbo(source) -> Vector{MboMsg}
+
+Every MBO message of `source`, in order, read one at a time through
+`next_record` and `get_mbo_if`. The slow reference the batch paths are
+checked against.
+"""
+function collect_mbo(source)
+    return collect_mbo!(Databento.MboMsg[], source)
+end
+
+# Appends to `msgs` as it reads, so they survive an error from `source`
+function collect_mbo!(msgs::AbstractVector, source)
+    while (record_ptr = Databento.next_record(source)) != C_NULL
+        mbo_ptr = Databento.get_mbo_if(unsafe_load(record_ptr))
+        mbo_ptr != C_NULL && push!(msgs, unsafe_load(mbo_ptr))
+    end
+    return msgs
+end
+
+"""
+    mbo_columns(msgs) -> NamedTuple
+
+The columns `read_columns!` fills into `MboColumns`, built from MBO messages
+with the generated field accessors.
+"""
+function mbo_columns(msgs::AbstractVector)
+    hd = Databento.hd.(msgs)
+    nanos(ts) = UInt64(Databento.time_since_epoch(ts))
+    return (ts_event = nanos.(Databento.ts_event.(hd)),
+            instrument_id = UInt32.(Databento.instrument_id.(hd)),
+            publisher_id = UInt16.(Databento.publisher_id.(hd)),
+            ts_recv = nanos.(Databento.ts_recv.(msgs)),
+            order_id = UInt64.(Databento.order_id.(msgs)),
+            price = Int64.(Databento.price.(msgs)),
+            size = UInt32.(Databento.size.(msgs)),
+            flags = UInt8.(Databento.raw.(Databento.flags.(msgs))),
+            channel_id = UInt8.(Databento.channel_id.(msgs)),
+            action = reinterpret.(UInt8, Databento.action.(msgs)),
+            side = reinterpret.(UInt8, Databento.side.(msgs)),
+            ts_in_delta = Int32.(Databento.count.(Databento.ts_in_delta.(msgs))),
+            sequence = UInt32.(Databento.sequence.(msgs)))
+end
+
+"""
+    read_all_columns(source, cols; filter=nothing) -> NamedTuple
+
+Drain `source` through `read_columns!` in chunks of `length(cols)` rows and
+return every column concatenated, named like the fields of `cols`.
+"""
+function read_all_columns(source, cols; filter=nothing)
+    names = fieldnames(typeof(cols))
+    out = NamedTuple{names}(map(name -> similar(getfield(cols, name), 0), names))
+    while (n = read_columns!(source, cols; filter)) > 0
+        for name in names
+            append!(out[name], view(getfield(cols, name), 1:n))
+        end
+    end
+    return out
+end
+
+"""
+    make_record(T, rtype; instrument_id=0, ts_event=0, fields...) -> T
+
+A record of bits type `T` with its header filled in and every other byte zero
+except `fields`, each written at its `field_offset`. Strings fill character
+arrays such as `raw_symbol`; `Char`s fill single-byte enums such as `action`.
+"""
+function make_record(::Type{T}, rtype; instrument_id::Integer=0, ts_event::Integer=0,
+                     fields...) where {T}
+    bytes = zeros(UInt8, sizeof(T))
+    function put(offset, value)
+        data = value isa AbstractString ? codeunits(value) :
+               value isa Char ? [UInt8(value)] : reinterpret(UInt8, [value])
+        bytes[offset + 1:offset + length(data)] = data
+    end
+    H = Databento.RecordHeader
+    hd = field_offset(T, :hd)
+    put(hd + field_offset(H, :length), UInt8(sizeof(T) ÷ 4))
+    put(hd + field_offset(H, :rtype), reinterpret(UInt8, rtype))
+    put(hd + field_offset(H, :publisher_id), UInt16(1))
+    put(hd + field_offset(H, :instrument_id), UInt32(instrument_id))
+    put(hd + field_offset(H, :ts_event), UInt64(ts_event))
+    for (name, value) in fields
+        put(field_offset(T, name), value)
+    end
+    return reinterpret(T, bytes)[1]
+end
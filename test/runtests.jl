@@ -1,6 +1,11 @@
 using Test
 using Databento
 
+include("historical_gateway.jl")
+include("live_gateway.jl")
+include("parquet_reader.jl")
+include("record_reference.jl")
+
 @testset "Databento.jl - Phase 1: Core Enums" begin
 
     @testset "Schema Enum" begin
@@ -88,3 +93,1406 @@ using Databento
         @test typeof(TRADES) != typeof(JSON)
     end
 end
+
+@testset "Databento.jl - Bulk Columnar Decode" begin
+
+    @testset "Column Buffers" begin
+        cols = MboColumns(128)
+        @test length(cols) == 128
+        @test eltype(cols.ts_event) == UInt64
+        @test eltype(cols.price) == Int64
+        @test eltype(cols.action) == UInt8
+        @test length(cols.sequence) == 128
+
+        @test length(TradeColumns(16)) == 16
+        @test length(Mbp1Columns(16).ask_ct) == 16
+        @test length(OhlcvColumns(0)) == 0
+    end
+
+    @testset "Batch Methods" begin
+        @test isdefined(Databento, :read_mbo_columns!)
+        @test isdefined(Databento, :read_trade_columns!)
+        @test isdefined(Databento, :read_mbp1_columns!)
+        @test isdefined(Databento, :read_ohlcv_columns!)
+        @test hasmethod(read_columns!, Tuple{Any, MboColumns})
+    end
+
+    @testset "Against next_record" begin
+        # Chunks that do not divide the record count, over a compressed file
+        path = joinpath(mktempdir(), "mbo.dbn.zst")
+        write_synthetic_dbn(path; instruments = 3, records = 10_000, seed = 11)
+        msgs = collect_mbo(DbnFileStore(path))
+        @test length(msgs) == 10_000
+        cols = read_all_columns(DbnFileStore(path), MboColumns(3_000))
+        @test keys(cols) == fieldnames(MboColumns)
+        expected = mbo_columns(msgs)
+        for name in keys(cols)
+            @test cols[name] == expected[name]
+        end
+
+        # Records of another schema are skipped, which consumes the store
+        store = DbnFileStore(path)
+        @test read_columns!(store, TradeColumns(16)) == 0
+        @test read_columns!(store, MboColumns(16)) == 0
+    end
+end
+
+@testset "Databento.jl - Memory-Mapped DBN Reader" begin
+    @test isdefined(Databento, :MmapDbnReader)
+    @test isdefined(Databento, :record_at)
+    @test isdefined(Databento, :mbo_at)
+    @test isdefined(Databento, :records_view)
+
+    # Missing files surface as Julia exceptions rather than crashing
+    @test_throws Exception MmapDbnReader(joinpath(tempdir(), "does-not-exist.dbn"))
+
+    # Anything that is not a DBN file is rejected up front
+    path, io = mktemp()
+    write(io, "not a dbn file")
+    close(io)
+    @test_throws Exception MmapDbnReader(path)
+    rm(path)
+
+    # Every access path agrees with a sequential DbnFileStore pass
+    path = joinpath(mktempdir(), "mbo.dbn")
+    write_synthetic_dbn(path; instruments = 3, records = 5_000, seed = 12)
+    expected = mbo_columns(collect_mbo(DbnFileStore(path)))
+    reader = MmapDbnReader(path)
+    @test length(reader) == 5_000
+    @test Databento.file_size(reader) == filesize(path)
+    @test Databento.is_uniform(reader)
+    @test mbo_columns(records_view(reader, Databento.MboMsg)) == expected
+    @test mbo_columns(collect_mbo(reader)) == expected
+    Databento.rewind!(reader)
+    @test read_all_columns(reader, MboColumns(777)) == expected
+
+    for i in (1, 2, 2_500, 5_000)
+        msg = unsafe_load(Databento.get_mbo_if(unsafe_load(reader[i])))
+        @test mbo_columns([msg]) == map(col -> col[i:i], expected)
+        @test mbo_columns([unsafe_load(Databento.mbo_at(reader, UInt(i - 1)))]) ==
+              map(col -> col[i:i], expected)
+        @test Databento.trade_at(reader, UInt(i - 1)) == C_NULL
+    end
+    @test_throws BoundsError reader[5_001]
+    Databento.seek!(reader, UInt(4_990))
+    @test mbo_columns(collect_mbo(reader)) == map(col -> col[4_991:end], expected)
+end
+
+@testset "Databento.jl - Multi-File Merged Reader" begin
+    @test isdefined(Databento, :MultiDbnReader)
+    @test isdefined(Databento, :current_file_index)
+
+    # An empty file list yields an immediately exhausted stream
+    reader = MultiDbnReader(String[])
+    @test Databento.file_count(reader) == 0
+    @test Databento.next_record(reader) == C_NULL
+
+    @test_throws Exception MultiDbnReader([joinpath(tempdir(), "does-not-exist.dbn")])
+
+    # Files offset in time, one compressed; the first and third share every
+    # timestamp, so their ties must come out in file order
+    dir = mktempdir()
+    t0 = 1_704_153_600_000_000_000
+    paths = [joinpath(dir, "part1.dbn"), joinpath(dir, "part2.dbn.zst"),
+             joinpath(dir, "part3.dbn"), joinpath(dir, "part4.dbn")]
+    for (i, (offset, records)) in enumerate(((0, 4_000), (333, 3_000), (0, 4_000), (500, 100)))
+        write_synthetic_dbn(paths[i]; instruments = 2, records, seed = i, start = t0 + offset)
+    end
+
+    # Reference: every file read on its own, then sorted by (ts_recv, file)
+    parts = [mbo_columns(collect_mbo(DbnFileStore(path))) for path in paths]
+    all_cols = map((cols...) -> reduce(vcat, cols), parts...)
+    file = reduce(vcat, [fill(i, length(part.ts_recv)) for (i, part) in enumerate(parts)])
+    order = sortperm(collect(zip(all_cols.ts_recv, file)))
+    expected = map(col -> col[order], all_cols)
+
+    merged = read_all_columns(MultiDbnReader(paths; threads = 2, block_records = 256),
+                              MboColumns(1_000))
+    @test length(merged.ts_recv) == 11_100
+    @test merged == expected
+
+    # Per record, with one small block buffered per file
+    reader = MultiDbnReader(paths; block_records = 100, max_blocks_per_file = 1)
+    files = Int[]
+    while Databento.next_record(reader) != C_NULL
+        push!(files, Int(Databento.current_file_index(reader)) + 1)
+    end
+    @test files == file[order]
+    @test Databento.records_merged(reader) == 11_100
+end
+
+@testset "Databento.jl - Prefetching DBN Reader" begin
+    @test isdefined(Databento, :PrefetchDbnFileStore)
+    @test isdefined(Databento, :producer_stall_ns)
+    @test isdefined(Databento, :consumer_stall_ns)
+    @test hasmethod(prefetch_stats, Tuple{PrefetchDbnFileStore})
+
+    @test_throws Exception PrefetchDbnFileStore(joinpath(tempdir(), "does-not-exist.dbn.zst"))
+
+    # Small blocks and two buffers keep the producer cycling through the ring
+    path = joinpath(mktempdir(), "mbo.dbn.zst")
+    write_synthetic_dbn(path; instruments = 3, records = 10_000, seed = 13)
+    expected = mbo_columns(collect_mbo(DbnFileStore(path)))
+    store = PrefetchDbnFileStore(path; buffers = 2, block_size = 4096)
+    @test Databento.buffer_count(store) == 2
+    @test read_all_columns(store, MboColumns(1_000)) == expected
+    stats = prefetch_stats(store)
+    @test stats.records_delivered == 10_000
+    @test stats.blocks_filled >= 10_000 * sizeof(Databento.MboMsg) ÷ 4096
+
+    store = PrefetchDbnFileStore(path; buffers = 3, block_size = 10_000)
+    @test mbo_columns(collect_mbo(store)) == expected
+    @test Databento.next_record(store) == C_NULL
+end
+
+@testset "Databento.jl - L3 Order Book Engine" begin
+    engine = OrderBookEngine()
+    @test Databento.book_count(engine) == 0
+    @test !Databento.has_book(engine, UInt32(42))
+
+    # Instruments without a book behave like an empty book
+    @test Databento.order_count(engine, UInt32(42)) == 0
+    @test Databento.queue_position(engine, UInt32(42), UInt64(1)) == (-1, -1)
+    @test isempty(top_levels(engine, 42, 5))
+    snap = book_snapshot(engine, 42)
+    @test isempty(snap.order_id)
+    @test eltype(snap.price) == Int64
+
+    # Reference books rebuilt in Julia, order_id => (price, size, side, priority)
+    path = joinpath(mktempdir(), "mbo.dbn")
+    write_synthetic_dbn(path; instruments = 3, records = 20_000, seed = 14)
+    msgs = collect_mbo(DbnFileStore(path))
+    books = Dict{UInt32, Dict{UInt64, NTuple{4, Int}}}()
+    for (priority, m) in enumerate(msgs)
+        book = get!(Dict{UInt64, NTuple{4, Int}}, books, Databento.instrument_id(Databento.hd(m)))
+        action, id = Char(reinterpret(UInt8, Databento.action(m))), Databento.order_id(m)
+        price, size = Int(Databento.price(m)), Int(Databento.size(m))
+        side = Int(reinterpret(UInt8, Databento.side(m)))
+        if action == 'A'
+            book[id] = (price, size, side, priority)
+        elseif action == 'C'
+            old = book[id]
+            size >= old[2] ? delete!(book, id) : (book[id] = (old[1], old[2] - size, old[3], old[4]))
+        elseif action == 'M'
+            old = book[id]
+            keeps_priority = old[1] == price && old[3] == side && size <= old[2]
+            book[id] = (price, size, side, keeps_priority ? old[4] : priority)
+        end
+    end
+    # (price, size, count) per level, best first
+    function reference_levels(book, side)
+        orders = [o for o in values(book) if o[3] == side]
+        prices = sort(unique(first.(orders)); rev = side == Int('B'))
+        return [(px, sum(o[2] for o in orders if o[1] == px), count(o -> o[1] == px, orders))
+                for px in prices]
+    end
+
+    engine = OrderBookEngine()
+    @test consume!(engine, DbnFileStore(path)) == 20_000
+    @test Databento.book_count(engine) == length(books)
+    for (id, book) in books
+        bids, asks = reference_levels(book, Int('B')), reference_levels(book, Int('A'))
+        levels = top_levels(engine, id, 1_000)
+        @test length(levels) == max(length(bids), length(asks))
+        @test [(Databento.bid_px(l), Databento.bid_sz(l), Databento.bid_ct(l))
+               for l in levels[1:length(bids)]] == bids
+        @test [(Databento.ask_px(l), Databento.ask_sz(l), Databento.ask_ct(l))
+               for l in levels[1:length(asks)]] == asks
+        @test Databento.order_count(engine, UInt32(id)) == length(book)
+
+        # Snapshot order: bids then asks, best level first, then queue priority
+        ranked = sort([(o[3] == Int('B') ? 0 : 1, o[3] == Int('B') ? -o[1] : o[1], o[4], oid)
+                       for (oid, o) in book])
+        @test book_snapshot(engine, id).order_id == last.(ranked)
+        for (oid, (px, _, side, priority)) in book
+            ahead = [o[2] for o in values(book) if o[1] == px && o[3] == side && o[4] < priority]
+            @test Databento.queue_position(engine, UInt32(id), oid) == (length(ahead), sum(ahead; init = 0))
+        end
+    end
+
+    # Level sizes add up past 32 bits; BidAskPair saturates instead of wrapping
+    function with_fields(msg::T; fields...) where {T}
+        bytes = collect(reinterpret(UInt8, [msg]))
+        for (name, value) in fields
+            offset = field_offset(T, name)
+            bytes[offset + 1:offset + sizeof(value)] = reinterpret(UInt8, [value])
+        end
+        return reinterpret(T, bytes)[1]
+    end
+    add = msgs[findfirst(m -> Databento.action(m) == Databento.ACTION_ADD, msgs)]
+    id = Databento.instrument_id(Databento.hd(add))
+    big = OrderBookEngine()
+    for oid in 1:3
+        Databento.apply!(big, with_fields(add; order_id = UInt64(oid), size = UInt32(3_000_000_000)))
+    end
+    top = only(top_levels(big, id, 1))
+    is_bid = Databento.side(add) == Databento.SIDE_BID
+    @test (is_bid ? Databento.bid_sz(top) : Databento.ask_sz(top)) == typemax(UInt32)
+    @test (is_bid ? Databento.bid_ct(top) : Databento.ask_ct(top)) == 3
+    @test Databento.queue_position(big, UInt32(id), UInt64(3)) == (2, 6_000_000_000)
+end
+
+@testset "Databento.jl - Record Filtering" begin
+    @test Databento.is_empty(RecordFilter())
+    @test filter_stats(RecordFilter()) == (scanned = 0, matched = 0)
+
+    f = record_filter(instrument_ids = [1, 2], ts_recv = (0, 1_000))
+    @test !Databento.is_empty(f)
+    Databento.reset!(f)
+    @test Databento.is_empty(f)
+
+    f = record_filter(actions = ['A'], sides = [Databento.SIDE_BID])
+    @test !Databento.is_empty(f)
+    @test hasmethod(read_columns!, Tuple{Any, MboColumns})
+
+    # Filtered decode matches filtering every column in Julia
+    dir = mktempdir()
+    t0 = 1_704_153_600_000_000_000
+    path = joinpath(dir, "mbo.dbn.zst")
+    write_synthetic_dbn(path; instruments = 4, records = 10_000, seed = 15, start = t0)
+    all_cols = mbo_columns(collect_mbo(DbnFileStore(path)))
+    t1, t2 = t0 + 2_000_000, t0 + 6_000_000
+    f = record_filter(instrument_ids = [1, 3], actions = ['A', 'C'], sides = [Databento.SIDE_BID],
+                      ts_recv = (t1, t2))
+    keep = [id in (1, 3) && Char(action) in ('A', 'C') && side == UInt8('B') && t1 <= ts < t2
+            for (id, action, side, ts) in zip(all_cols.instrument_id, all_cols.action,
+                                              all_cols.side, all_cols.ts_recv)]
+    @test count(keep) > 0
+    @test read_all_columns(DbnFileStore(path), MboColumns(500); filter = f) ==
+          map(col -> col[keep], all_cols)
+    # Without stop_at_end every record is scanned
+    @test filter_stats(f) == (scanned = 10_000, matched = count(keep))
+
+    # The file is sorted, so stopping at the end of the range loses nothing
+    f = record_filter(ts_recv = (t1, t2), stop_at_end = true)
+    in_range = t1 .<= all_cols.ts_recv .< t2
+    @test read_all_columns(DbnFileStore(path), MboColumns(500); filter = f) ==
+          map(col -> col[in_range], all_cols)
+    @test filter_stats(f).scanned < 10_000
+
+    # Out of index-timestamp order: a later block written first. Only the
+    # default full scan finds the records in range.
+    late, early, unsorted = joinpath.(dir, ("late.dbn", "early.dbn", "unsorted.dbn"))
+    write_synthetic_dbn(late; instruments = 2, records = 1_000, seed = 1, start = t0 + 10_000_000)
+    write_synthetic_dbn(early; instruments = 2, records = 1_000, seed = 2, start = t0)
+    store = DbnFileStore(late)
+    writer = DbnWriter(unsorted, Databento.get_metadata(store))
+    write_records!(writer, DbnFileStore(late))
+    write_records!(writer, DbnFileStore(early))
+    close(writer)
+    range = (t0, t0 + 10_000_000)
+    @test length(read_all_columns(DbnFileStore(unsorted), MboColumns(256);
+                                  filter = record_filter(ts_recv = range)).ts_recv) == 1_000
+    @test read_columns!(DbnFileStore(unsorted), MboColumns(256);
+                        filter = record_filter(ts_recv = range, stop_at_end = true)) == 0
+
+    # reset! clears the conditions, not the counters
+    f = record_filter(instrument_ids = [1])
+    read_columns!(DbnFileStore(path), MboColumns(100); filter = f)
+    before = filter_stats(f)
+    @test before.scanned > 0 && before.matched == 100
+    Databento.reset!(f)
+    @test Databento.is_empty(f)
+    @test filter_stats(f) == before
+    Databento.reset_counters!(f)
+    @test filter_stats(f) == (scanned = 0, matched = 0)
+end
+
+@testset "Databento.jl - Timestamp Index" begin
+    @test isdefined(Databento, :IndexedDbnReader)
+    @test isdefined(Databento, :seek_ts!)
+    @test hasmethod(seek, Tuple{IndexedDbnReader, Integer})
+
+    missing_path = joinpath(tempdir(), "does-not-exist.dbn.zst")
+    @test !Databento.ts_index_is_current(missing_path, missing_path * ".tsidx")
+    @test_throws Exception build_ts_index(missing_path)
+    @test_throws Exception IndexedDbnReader(missing_path)
+
+    # A file without the DBN prelude cannot be indexed
+    path, io = mktemp()
+    write(io, "not a dbn file")
+    close(io)
+    @test_throws Exception build_ts_index(path)
+    rm(path)
+
+    # Frames of 1000 bytes cut most 56-byte MBO records in two; seeks must
+    # still land on each record's first byte
+    dir = mktempdir()
+    t0 = 1_704_153_600_000_000_000
+    path = joinpath(dir, "split.dbn.zst")
+    write_synthetic_dbn(path; instruments = 4, records = 5_000, seed = 7, start = t0,
+                        frame_size = 1_000)
+    expected = mbo_columns(collect_mbo(DbnFileStore(path)))
+    blocks = build_ts_index(path; stride = 64, by_instrument = true)
+    @test blocks > 50
+    reader = IndexedDbnReader(path; build = false)
+    @test Databento.indexed_record_count(reader) == 5_000
+    @test mbo_columns(collect_mbo(reader)) == expected
+    for ts in (t0, t0 + 1, t0 + 1_234_000, t0 + 2_500_500, t0 + 4_999_000, t0 + 6_000_000)
+        k = something(findfirst(>=(ts), expected.ts_event), 5_001)
+        seek(reader, ts)
+        @test mbo_columns(collect_mbo(reader)) == map(col -> col[k:end], expected)
+    end
+    for id in 1:4, ts in (t0, t0 + 3_333_000)
+        seek(reader, ts; instrument_id = id)
+        rest = mbo_columns(collect_mbo(reader))
+        keep = (expected.instrument_id .== id) .& (expected.ts_event .>= ts)
+        @test rest.instrument_id[1] == id && rest.ts_event[1] >= ts
+        @test rest.order_id[(rest.instrument_id .== id)] == expected.order_id[keep]
+    end
+    Databento.rewind!(reader)
+    @test mbo_columns(collect_mbo(reader)) == expected
+
+    # A corrupt index is rejected before allocating or reading past its
+    # tables: 72 header bytes, 48 per block, then the four instruments'
+    # IDs, posting offsets and postings
+    bytes = read(path * ".tsidx")
+    ids_at = 72 + 48 * blocks + 8
+    offsets_at = ids_at + 4 * 4
+    postings_at = offsets_at + 8 * 5
+    corrupt_index = joinpath(dir, "corrupt.tsidx")
+    for (offset, value) in ((64, typemax(UInt64)), (72 + 48 * blocks, typemax(UInt64)),
+                            (ids_at, typemax(UInt32)), (offsets_at, UInt64(1)),
+                            (offsets_at + 8, typemax(UInt64)), (postings_at, UInt32(blocks)))
+        corrupt = copy(bytes)
+        corrupt[offset + 1:offset + sizeof(value)] = reinterpret(UInt8, [value])
+        write(corrupt_index, corrupt)
+        @test_throws Exception IndexedDbnReader(path; index_path = corrupt_index, build = false)
+    end
+end
+
+@testset "Databento.jl - Bar Aggregation" begin
+    bars = BarAggregator(:tick, 2)
+    for (i, px) in enumerate([100, 105, 95, 101, 99])
+        Databento.add_trade!(bars, UInt32(7), UInt16(1), UInt64(i), Int64(px), UInt32(3))
+    end
+    @test Databento.pending_bars(bars) == 2
+    Databento.flush!(bars)
+
+    cols = BarColumns(8)
+    @test drain_bars!(bars, cols) == 3
+    @test cols.open[1:3] == [100, 95, 99]
+    @test cols.high[1:2] == [105, 101]
+    @test cols.volume[1:3] == [6, 6, 3]
+    @test cols.trade_count[3] == 1
+    @test Databento.pending_bars(bars) == 0
+
+    time_bars = BarAggregator(:time, 1_000_000_000)
+    Databento.add_trade!(time_bars, UInt32(1), UInt16(1), UInt64(1_500_000_000), Int64(10), UInt32(1))
+    Databento.flush!(time_bars)
+    msgs = drain_ohlcv(time_bars)
+    @test length(msgs) == 1
+
+    @test_throws ArgumentError BarAggregator(:range, 1)
+    @test_throws Exception BarAggregator(:tick, 0)
+end
+
+@testset "Databento.jl - Streaming Historical" begin
+    @test isdefined(Databento, :HistoricalStream)
+    @test hasmethod(stream_stats, Tuple{HistoricalStream})
+
+    # A refused connection surfaces as an error from the consuming side
+    server, port, task = replay_historical(tempname())
+    close(server)
+    stream = HistoricalStream(dataset = "GLBX.MDP3", symbols = ["ES.FUT"], schema = MBO,
+                              start = "2024-01-01", stop = "2024-01-02", key = "db-" * "x"^29,
+                              gateway = "127.0.0.1", port = port)
+    @test_throws Exception Databento.get_metadata(stream)
+    @test_throws Exception Databento.next_record(stream)
+
+    # End-to-end through a stand-in in another process, so the blocking reads
+    # here cannot stall it. Small blocks and two buffers keep the download
+    # waiting on the consumer; the records match a DbnFileStore pass.
+    fixture = joinpath(mktempdir(), "stream.dbn")
+    write_synthetic_dbn(fixture; instruments = 4, records = 20_000, seed = 10)
+    store = DbnFileStore(fixture)
+    expected = mbo_columns(collect_mbo(store))
+
+    process, port, _ = serve_historical(fixture)
+    try
+        stream = HistoricalStream(dataset = "GLBX.MDP3", symbols = ["ES.FUT"], schema = MBO,
+                                  start = "2024-01-01", stop = "2024-01-02", key = "db-" * "x"^29,
+                                  stype_in = PARENT, gateway = "127.0.0.1", port = port,
+                                  buffers = 2, block_size = 4096, latency = true)
+        @test Databento.dataset(Databento.get_metadata(stream)) ==
+              Databento.dataset(Databento.get_metadata(store))
+        @test mbo_columns(collect_mbo(stream)) == expected
+        stats = stream_stats(stream)
+        @test stats.records_received == 20_000
+        @test stats.records_delivered == 20_000
+        @test 0 < stats.bytes_received < filesize(fixture)
+        @test latency_stats(stream).recv_delay.count == 20_000
+        @test Databento.buffer_count(stream) == 2
+    finally
+        kill(process)
+    end
+
+    # A connection dropped mid-block: the records received before it are
+    # delivered, then the error
+    header = filesize(fixture) - 20_000 * sizeof(Databento.MboMsg)
+    process, port, _ = serve_historical(fixture; cut_after = header + 5_000 * sizeof(Databento.MboMsg))
+    try
+        stream = HistoricalStream(dataset = "GLBX.MDP3", symbols = ["ES.FUT"], schema = MBO,
+                                  start = "2024-01-01", stop = "2024-01-02", key = "db-" * "x"^29,
+                                  gateway = "127.0.0.1", port = port)
+        msgs = Databento.MboMsg[]
+        @test_throws Exception collect_mbo!(msgs, stream)
+        @test mbo_columns(msgs) == map(column -> column[1:5_000], expected)
+        @test stream_stats(stream).records_received == 5_000
+    finally
+        kill(process)
+    end
+end
+
+@testset "Databento.jl - Live Client" begin
+    @test isdefined(Databento, :LiveClient)
+    @test hasmethod(live_stats, Tuple{LiveClient})
+    # An empty ring is not the end of the session, so sinks that read a whole
+    # source are only defined for the others
+    @test hasmethod(Databento.demux!, Tuple{RecordDemux, DbnFileStore, UInt64})
+    @test !hasmethod(Databento.demux!, Tuple{RecordDemux, LiveClient, UInt64})
+    @test !hasmethod(Databento.write_records!, Tuple{DbnWriter, LiveClient, UInt})
+    @test !hasmethod(Databento.consume!, Tuple{OrderBookEngine, LiveClient, UInt})
+    @test hasmethod(Databento.next_record, Tuple{LiveClient, RecordFilter})
+
+    # Nothing listens on the stand-in's port once it has closed
+    server, port, task = replay_gateway(tempname())
+    close(server)
+    @test_throws Exception LiveClient(dataset = "GLBX.MDP3", key = "db-" * "x"^29,
+                                      gateway = "127.0.0.1", port = port)
+
+    # End-to-end replay of a generated file through a ring much smaller than
+    # the stream: every record arrives once, in file order
+    fixture = joinpath(mktempdir(), "live.dbn")
+    write_synthetic_dbn(fixture; instruments = 4, records = 20_000, seed = 9)
+    expected = mbo_columns(collect_mbo(DbnFileStore(fixture)))
+
+    server, port, task = replay_gateway(fixture)
+    client = LiveClient(dataset = "GLBX.MDP3", key = "db-" * "x"^29, gateway = "127.0.0.1",
+                        port = port, capacity = 64, block_when_full = true)
+    subscribe!(client, ["ES.FUT"], MBO; stype_in = PARENT)
+    start!(client)
+    msgs = Databento.MboMsg[]
+    deadline = time() + 60
+    while time() < deadline
+        if (record_ptr = Databento.next_record(client)) != C_NULL
+            mbo_ptr = Databento.get_mbo_if(unsafe_load(record_ptr))
+            mbo_ptr != C_NULL && push!(msgs, unsafe_load(mbo_ptr))
+        elseif Databento.is_finished(client) && Databento.buffered(client) == 0
+            break
+        else
+            yield()
+        end
+    end
+    stop!(client)
+    stats = live_stats(client)
+    @test length(msgs) == 20_000
+    @test mbo_columns(msgs) == expected
+    @test stats.overruns == 0
+    @test stats.delivered == 20_000
+    @test stats.high_water_mark <= 64
+end
+
+@testset "Databento.jl - Symbol Map" begin
+    map = TsSymbolMap()
+    d = Databento.Dates.Date
+    Databento.insert_mapping!(map, 5482, d(2024, 1, 2), d(2024, 1, 4), "ESH4")
+    Databento.insert_mapping!(map, 5483, d(2024, 1, 2), d(2024, 1, 3), "ESM4")
+    # A later mapping replaces an earlier one on the days it covers
+    Databento.insert_mapping!(map, 5482, d(2024, 1, 3), d(2024, 1, 4), "ESH4-roll")
+
+    @test symbol_at(map, 5482, d(2024, 1, 2)) == "ESH4"
+    @test symbol_at(map, 5482, d(2024, 1, 3)) == "ESH4-roll"
+    @test symbol_at(map, 5482, d(2024, 1, 4)) === nothing
+    @test symbol_at(map, 9999, d(2024, 1, 2)) === nothing
+    # 2024-01-02T12:00:00Z in nanoseconds
+    @test symbol_at(map, 5483, 1_704_196_800_000_000_000) == "ESM4"
+    @test Databento.symbol_count(map) == 3
+    @test Databento.entry_count(map) == 3
+
+    ids = symbol_ids!(zeros(UInt32, 3), map, UInt32[5482, 5483, 1], d(2024, 1, 2))
+    @test symbol_table(map)[ids[1:2]] == ["ESH4", "ESM4"]
+    @test ids[3] == 0
+
+    path = tempname()
+    save_symbol_map(map, path)
+    loaded = TsSymbolMap(path)
+    @test symbol_table(loaded) == symbol_table(map)
+    @test symbol_at(loaded, 5482, d(2024, 1, 3)) == "ESH4-roll"
+    @test Databento.interval_count(loaded) == 3
+    rm(path)
+
+    bad, io = mktemp()
+    write(io, "not a symbol map")
+    close(io)
+    @test_throws Exception TsSymbolMap(bad)
+    rm(bad)
+
+    # A file of generated MBO records and in-stream symbol mappings, one of
+    # which changes instrument 1's symbol partway through an earlier mapping
+    mapping_msg(instrument_id, symbol, start_ts, end_ts) =
+        make_record(Databento.SymbolMappingMsg, Databento.RTYPE_SYMBOL_MAPPING; instrument_id,
+                    ts_event = start_ts, stype_out_symbol = symbol, start_ts = UInt64(start_ts),
+                    end_ts = UInt64(end_ts))
+    dir = mktempdir()
+    t0, day, hour = 1_704_153_600_000_000_000, 86_400_000_000_000, 3_600_000_000_000
+    mbo, path = joinpath(dir, "mbo.dbn"), joinpath(dir, "mapped.dbn")
+    write_synthetic_dbn(mbo; instruments = 3, records = 3_000, seed = 11, start = t0)
+    writer = DbnWriter(path, Databento.get_metadata(DbnFileStore(mbo)))
+    write_records!(writer, [mapping_msg(1, "AAA", t0, t0 + 5day),
+                            mapping_msg(2, "CCC", t0 + day + hour, typemax(UInt64))])
+    write_records!(writer, DbnFileStore(mbo))
+    write_records!(writer, [mapping_msg(1, "BBB", t0 + 2day + 12hour, t0 + 3day + 6hour)])
+    close(writer)
+
+    ids = UInt32[1, 1, 1, 1, 1, 2, 2, 2, 3, 3]
+    ts = UInt64[t0, t0 + day, t0 + 2day + 1, t0 + 4day, t0 + 5day, t0, t0 + day, t0 + 2day,
+                t0, t0 + day]
+    # Dates are UTC days: BBB covers the whole of 2024-01-04 and 2024-01-05
+    expected = ["AAA", "AAA", "BBB", "AAA", nothing, "SYN2", "CCC", nothing, "SYN3", nothing]
+    lookup(map) = [id == 0 ? nothing : symbol_table(map)[id]
+                   for id in symbol_ids!(zeros(UInt32, length(ids)), map, ids, ts)]
+
+    map = symbol_map(DbnFileStore(path))
+    @test [symbol_at(map, id, t0) for id in 1:3] == ["SYN1", "SYN2", "SYN3"]
+    @test consume!(map, DbnFileStore(path)) == 3_003
+    @test lookup(map) == expected
+    @test [symbol_at(map, id, t) for (id, t) in zip(ids, ts)] == expected
+    @test Databento.interval_count(map) == 6
+    # AAA cut in two around BBB, SYN1 replaced, SYN2 then CCC, SYN3
+    @test Databento.entry_count(map) == 6
+
+    # apply! on single records gives the same mappings, minus the metadata's
+    applied = TsSymbolMap()
+    store = DbnFileStore(path)
+    n = 0
+    while (record_ptr = Databento.next_record(store)) != C_NULL
+        n += Databento.apply!(applied, unsafe_load(record_ptr))
+    end
+    @test n == 3
+    @test lookup(applied) == [startswith(string(s), "SYN") ? nothing : s for s in expected]
+
+    path = joinpath(dir, "mapped.symmap")
+    save_symbol_map(map, path)
+    @test lookup(TsSymbolMap(path)) == expected
+
+    # Counts and lengths past the end of the file are rejected before allocating
+    bytes = read(path)
+    for (offset, value) in ((16, typemax(UInt64)), (24, typemax(UInt64)), (32, typemax(UInt32)))
+        corrupt = copy(bytes)
+        corrupt[offset + 1:offset + sizeof(value)] = reinterpret(UInt8, [value])
+        write(path, corrupt)
+        @test_throws Exception TsSymbolMap(path)
+    end
+
+    # resolve! against a stand-in serving a symbology response
+    response = joinpath(dir, "resolve.json")
+    write(response, """
+        {"result": {"ESH4": [{"d0": "2024-01-02", "d1": "2024-01-04", "s": "5482"}],
+                    "ESM4": [{"d0": "2024-01-03", "d1": "2024-01-05", "s": "5483"}]},
+         "symbols": ["ESH4", "ESM4"], "stype_in": "raw_symbol", "stype_out": "instrument_id",
+         "start_date": "2024-01-02", "end_date": "2024-01-05",
+         "partial": [], "not_found": [], "message": "OK", "status": 0}
+        """)
+    process, port, _ = serve_historical(response)
+    try
+        client = Databento.Historical("db-" * "x"^29, "127.0.0.1", UInt16(port))
+        resolved = resolve!(TsSymbolMap(), client, "GLBX.MDP3", ["ESH4", "ESM4"],
+                            d(2024, 1, 2), d(2024, 1, 5))
+        @test symbol_at(resolved, 5482, d(2024, 1, 3)) == "ESH4"
+        @test symbol_at(resolved, 5482, d(2024, 1, 4)) === nothing
+        @test symbol_at(resolved, 5483, d(2024, 1, 2)) === nothing
+        @test symbol_at(resolved, 5483, d(2024, 1, 4)) == "ESM4"
+    finally
+        kill(process)
+    end
+end
+
+@testset "Databento.jl - Definition Store" begin
+    store = DefinitionStore()
+    @test length(store) == 0
+    @test definition_row(store, 42) === nothing
+    @test definition_row(store, "ESH4") === nothing
+    @test isempty(instruments_of(store, "ES"))
+    @test read_definitions!(DefinitionColumns(4), store) == 0
+    @test isempty(definition_strings(store))
+    @test_throws ArgumentError read_definitions!(DefinitionColumns(4), store; first = 0)
+
+    # Adds, a modify, a delete and a reused symbol, written with DbnWriter
+    t0 = 1_704_153_600_000_000_000
+    def(id, action, symbol, underlying; tick = 250_000_000, multiplier = 50) =
+        make_record(Databento.InstrumentDefMsg, Databento.RTYPE_INSTRUMENT_DEF;
+                    instrument_id = id, ts_event = t0 + id, ts_recv = UInt64(t0 + id + 1),
+                    raw_symbol = symbol, underlying, exchange = "XCME", asset = underlying,
+                    cfi = "FFIXSX", security_type = "FUT", currency = "USD",
+                    instrument_class = 'F', security_update_action = action,
+                    min_price_increment = Int64(tick), display_factor = Int64(1_000_000_000),
+                    expiration = UInt64(t0 + 90 * 86_400_000_000_000),
+                    contract_multiplier = Int32(multiplier), underlying_id = UInt32(id ÷ 100))
+    dir = mktempdir()
+    mbo, path = joinpath(dir, "mbo.dbn"), joinpath(dir, "definitions.dbn")
+    write_synthetic_dbn(mbo; instruments = 1, records = 10, start = t0)
+    writer = DbnWriter(path, Databento.get_metadata(DbnFileStore(mbo)))
+    write_records!(writer, [def(101, 'A', "ESH4", "ES"), def(102, 'A', "ESM4", "ES"),
+                            def(201, 'A', "NQH4", "NQ"; multiplier = 20),
+                            def(101, 'M', "ESH4", "ES"; tick = 125_000_000),
+                            def(102, 'D', "ESM4", "ES"), def(301, 'A', "ESH4", "ES")])
+    write_records!(writer, DbnFileStore(mbo))
+    close(writer)
+
+    store = load_definitions(DbnFileStore(path))
+    @test length(store) == 3
+    @test Databento.definitions_applied(store) == 6
+    @test Databento.replacements(store) == 1
+    @test Databento.deletions(store) == 1
+    cols = DefinitionColumns(3)
+    @test read_definitions!(cols, store) == 3
+    strings = definition_strings(store)
+    text(id) = id == 0 ? "" : strings[id]
+    @test sort(cols.instrument_id) == UInt32[101, 201, 301]
+    for (id, symbol, underlying, tick, multiplier) in ((101, "ESH4", "ES", 125_000_000, 50),
+                                                       (201, "NQH4", "NQ", 250_000_000, 20),
+                                                       (301, "ESH4", "ES", 250_000_000, 50))
+        row = definition_row(store, id)
+        @test cols.instrument_id[row] == id
+        @test cols.publisher_id[row] == 1
+        @test cols.ts_event[row] == t0 + id
+        @test cols.ts_recv[row] == t0 + id + 1
+        @test text.((cols.raw_symbol[row], cols.underlying[row], cols.exchange[row],
+                     cols.asset[row], cols.cfi[row], cols.security_type[row],
+                     cols.currency[row])) ==
+              (symbol, underlying, "XCME", underlying, "FFIXSX", "FUT", "USD")
+        @test cols.instrument_class[row] == UInt8('F')
+        @test cols.min_price_increment[row] == tick
+        @test cols.display_factor[row] == 1_000_000_000
+        @test cols.expiration[row] == t0 + 90 * 86_400_000_000_000
+        @test cols.contract_multiplier[row] == multiplier
+        @test cols.underlying_id[row] == id ÷ 100
+    end
+    # Each string is interned once, however many definitions use it
+    @test allunique(strings)
+    @test count(==("USD"), strings) == 1
+    @test definition_row(store, 102) === nothing
+    @test definition_row(store, "ESM4") === nothing
+    # The symbol now belongs to the instrument defined with it last
+    @test definition_row(store, "ESH4") == definition_row(store, 301)
+    @test sort(instruments_of(store, "ES")) == UInt32[101, 301]
+    @test collect(instruments_of(store, "NQ")) == UInt32[201]
+
+    # Paging through the table in chunks that do not divide it
+    page = DefinitionColumns(2)
+    @test read_definitions!(page, store) == 2
+    @test page.instrument_id == cols.instrument_id[1:2]
+    @test read_definitions!(page, store; first = 3) == 1
+    @test page.instrument_id[1] == cols.instrument_id[3]
+    @test read_definitions!(page, store; first = 4) == 0
+end
+
+@testset "Databento.jl - Synthetic DBN Generator" begin
+    dir = mktempdir()
+    a = joinpath(dir, "a.dbn")
+    b = joinpath(dir, "b.dbn")
+    @test write_synthetic_dbn(a; instruments = 4, records = 10_000) == filesize(a)
+    write_synthetic_dbn(b; instruments = 4, records = 10_000)
+    @test read(a) == read(b)
+    write_synthetic_dbn(b; instruments = 4, records = 10_000, seed = 2)
+    @test read(a) != read(b)
+
+    reader = MmapDbnReader(a)
+    @test length(reader) == 10_000
+    @test Databento.is_uniform(reader)
+    engine = OrderBookEngine()
+    @test Databento.consume!(engine, reader) == 10_000
+    @test Databento.book_count(engine) == 4
+    @test all(id -> Databento.is_consistent(engine, UInt32(id)), 1:4)
+
+    zst = joinpath(dir, "trades.dbn.zst")
+    write_synthetic_dbn(zst; schema = TRADES, records = 1_000)
+    @test read_columns!(DbnFileStore(zst), TradeColumns(2_000)) == 1_000
+    @test_throws Exception write_synthetic_dbn(joinpath(dir, "def.dbn"); schema = DEFINITION)
+end
+
+@testset "Databento.jl - DBN Writer" begin
+    dir = mktempdir()
+    src = joinpath(dir, "src.dbn")
+    write_synthetic_dbn(src; instruments = 4, records = 20_000)
+    expected = MboColumns(30_000)
+    n = read_columns!(DbnFileStore(src), expected)
+    @test n == 20_000
+    # The metadata reference points into the store, which must stay alive
+    src_store = DbnFileStore(src)
+    metadata = Databento.get_metadata(src_store)
+
+    # Small frames so the output spans many independent zstd frames
+    out = joinpath(dir, "copy.dbn.zst")
+    writer = DbnWriter(out, metadata; frame_size = 4096, threads = 2)
+    @test write_records!(writer, DbnFileStore(src)) == n
+    @test !isfile(out)
+    close(writer)
+    stats = writer_stats(writer)
+    @test stats.records_written == n
+    @test stats.frames_written > 10
+    @test stats.bytes_written == filesize(out)
+    cols = MboColumns(30_000)
+    @test read_columns!(DbnFileStore(out), cols) == n
+    @test cols.order_id[1:n] == expected.order_id[1:n]
+    @test cols.ts_recv[1:n] == expected.ts_recv[1:n]
+
+    # Filtered pipe and a batch of messages from a memory-mapped view
+    out = joinpath(dir, "one.dbn")
+    writer = DbnWriter(out, metadata)
+    write_records!(writer, DbnFileStore(src); filter = record_filter(instrument_ids = (1,)))
+    reader = MmapDbnReader(src)
+    @test write_records!(writer, records_view(reader, Databento.MboMsg)[1:10]) == 10
+    close(writer)
+    cols = MboColumns(30_000)
+    m = read_columns!(DbnFileStore(out), cols)
+    @test m == count(==(1), expected.instrument_id[1:n]) + 10
+    @test all(==(1), cols.instrument_id[1:m - 10])
+
+    # Fan-out: instruments 1 and 2 to the first file, the rest to the second
+    paths = [joinpath(dir, "a.dbn.zst"), joinpath(dir, "b.dbn.zst"), joinpath(dir, "c.dbn.zst")]
+    fan_out = DbnFanOut(paths, metadata;
+                        routes = Dict(1 => 1, 2 => 1), default = 2)
+    @test write_records!(fan_out, DbnFileStore(src)) == n
+    close(fan_out)
+    stats = writer_stats(fan_out)
+    @test stats.records_written == n
+    @test stats.records == [count(<=(2), expected.instrument_id[1:n]),
+                            count(>(2), expected.instrument_id[1:n]), 0]
+    store = DbnFileStore(paths[1])
+    @test sort(collect(Databento.symbols(Databento.get_metadata(store)))) == ["SYN1", "SYN2"]
+    @test read_columns!(DbnFileStore(paths[3]), MboColumns(16)) == 0
+    @test_throws Exception route!(fan_out, 5, 4)
+end
+
+@testset "Databento.jl - Arrow Export" begin
+    dir = mktempdir()
+    src = joinpath(dir, "src.dbn")
+    write_synthetic_dbn(src; instruments = 4, records = 10_000)
+    expected = MboColumns(20_000)
+    n = read_columns!(DbnFileStore(src), expected)
+
+    batches = collect(arrow_batches(DbnFileStore(src); schema = MBO, batch_rows = 4_096))
+    @test length.(batches) == [4_096, 4_096, n - 8_192]
+    @test keys(batches[1].columns) == fieldnames(MboColumns)
+    @test reduce(vcat, [b.columns.order_id for b in batches]) == expected.order_id[1:n]
+    @test reduce(vcat, [b.columns.ts_recv for b in batches]) == Int64.(expected.ts_recv[1:n])
+    foreach(finalize, batches)
+
+    converter = ArrowConverter(MBO; scale_prices = true)
+    batch = next_arrow_batch(converter, DbnFileStore(src); filter = record_filter(instrument_ids = (2,)))
+    @test all(==(2), batch.columns.instrument_id)
+    @test batch.columns.price isa Vector{Float64}
+    mask = expected.instrument_id[1:n] .== 2
+    @test batch.columns.price ≈ expected.price[1:n][mask] .* 1e-9
+    @test arrow_array_ptr(batch) != C_NULL
+    @test next_arrow_batch(ArrowConverter(MBO), DbnFileStore(src);
+                           filter = record_filter(instrument_ids = (99,))) === nothing
+
+    ipc = joinpath(dir, "mbo.arrow")
+    @test dbn_to_arrow(DbnFileStore(src), ipc; schema = MBO, batch_rows = 1_000) == n
+    @test String(read(ipc, 6)) == "ARROW1"
+    parquet = joinpath(dir, "mbo.parquet")
+    @test dbn_to_arrow(DbnFileStore(src), parquet; schema = MBO, threads = 2) == n
+    @test String(read(parquet, 4)) == "PAR1"
+    @test !isfile(parquet * ".tmp")
+    meta = parquet_metadata(parquet)
+    @test meta[3] == n
+    @test [group[3] for group in meta[4]] == [n]
+    @test all(chunk[3][4] == 6 for chunk in meta[4][1][1])    # ZSTD
+
+    # Row groups follow row_group_rows, not the batch size; read back the
+    # uncompressed pages column by column
+    plain = joinpath(dir, "plain.parquet")
+    @test dbn_to_arrow(DbnFileStore(src), plain; schema = MBO, batch_rows = 3_000,
+                       row_group_rows = 4_096, zstd = false) == n
+    meta = parquet_metadata(plain)
+    @test meta[3] == n
+    @test [group[3] for group in meta[4]] == [4_096, 4_096, n - 8_192]
+    @test [element[4] for element in meta[2][2:end]] == collect(String.(fieldnames(MboColumns)))
+    for (i, name) in enumerate(fieldnames(MboColumns))
+        column = getfield(expected, name)
+        @test parquet_column(plain, meta, i, eltype(column)) == column[1:n]
+    end
+    @test_throws Exception dbn_to_arrow(DbnFileStore(src), plain; schema = MBO, row_group_rows = 0)
+    @test_throws Exception ArrowConverter(DEFINITION)
+end
+
+@testset "Databento.jl - Analytics Kernels" begin
+    dir = mktempdir()
+    mbp1 = joinpath(dir, "mbp1.dbn")
+    write_synthetic_dbn(mbp1; schema = MBP1, instruments = 3, records = 5_000)
+    quotes = Mbp1Columns(8_000)
+    n = read_columns!(DbnFileStore(mbp1), quotes)
+    bid = quotes.bid_px[1:n] .* 1e-9
+    ask = quotes.ask_px[1:n] .* 1e-9
+    out = Vector{Float64}(undef, length(quotes))
+
+    @test simd_level() in (:avx2, :scalar)
+    @test mid_prices!(out, quotes, n)[1:n] ≈ (bid .+ ask) ./ 2
+    @test spreads!(out, quotes, n)[1:n] ≈ ask .- bid
+    bsz, asz = Float64.(quotes.bid_sz[1:n]), Float64.(quotes.ask_sz[1:n])
+    @test microprices!(out, quotes, n)[1:n] ≈ (bid .* asz .+ ask .* bsz) ./ (bsz .+ asz)
+    fast = copy(microprices!(out, quotes, n))
+    set_simd_enabled!(false)
+    @test simd_level() == :scalar
+    @test isequal(microprices!(out, quotes, n), fast)
+    set_simd_enabled!(true)
+
+    prices = [100_250_000_000, typemax(Int64), 99_000_000_000]
+    @test isequal(price_to_float!(zeros(3), prices), [100.25, NaN, 99.0])
+    @test signed_volumes!(zeros(Int64, 3), UInt32[5, 7, 9], UInt8['B', 'A', 'N']) == [5, -7, 0]
+    @test_throws Exception price_to_float!(zeros(2), prices)
+
+    trades = joinpath(dir, "trades.dbn")
+    write_synthetic_dbn(trades; schema = TRADES, instruments = 3, records = 5_000)
+    cols = TradeColumns(8_000)
+    m = read_columns!(DbnFileStore(trades), cols)
+    analytics = GroupedAnalytics()
+    # Two chunks accumulate like one
+    half = m ÷ 2
+    add_trades!(analytics, cols, half)
+    add_trades!(analytics, cols.instrument_id[half + 1:m], cols.price[half + 1:m],
+                cols.size[half + 1:m], cols.side[half + 1:m])
+    totals = trade_totals(analytics)
+    @test length(analytics) == 3
+    for (g, id) in enumerate(totals.instrument_id)
+        rows = findall(==(id), cols.instrument_id[1:m])
+        px, sz = cols.price[rows] .* 1e-9, Float64.(cols.size[rows])
+        @test totals.vwap[g] ≈ sum(px .* sz) / sum(sz)
+        @test totals.volume[g] == sum(cols.size[rows])
+        @test totals.trades[g] == length(rows)
+        @test totals.signed_volume[g] == sum(signed_volumes!(zeros(Int64, m), cols, m)[rows])
+    end
+    groups = group_indexes!(zeros(UInt32, m), analytics, cols.instrument_id, m)
+    @test totals.instrument_id[groups] == cols.instrument_id[1:m]
+
+    px = price_to_float!(zeros(m), cols.price, m)
+    rets = returns!(zeros(m), GroupedAnalytics(), cols.instrument_id, px, m)
+    rows = findall(==(totals.instrument_id[1]), cols.instrument_id[1:m])
+    @test isnan(rets[rows[1]])
+    @test rets[rows[2:end]] ≈ px[rows[2:end]] ./ px[rows[1:end - 1]] .- 1
+    @test length(empty!(analytics)) == 0
+end
+
+@testset "Databento.jl - MBP-10 Depth Tensor" begin
+    path = joinpath(mktempdir(), "mbp10.dbn")
+    write_synthetic_dbn(path; schema = MBP10, instruments = 2, records = 3_000)
+    tensor = Mbp10Tensor(4_096)
+    n = read_depth!(DbnFileStore(path), tensor)
+    @test n == 3_000
+    @test size(tensor.depth) == (6, 10, 4_096)
+    book = tensor.depth[:, :, 1:n]
+    bid_px, ask_px = book[1, :, :], book[2, :, :]
+    bid_sz, ask_sz = book[3, :, :], book[4, :, :]
+    @test all(isnan.(bid_px) .| (ask_px .- bid_px .> 0))
+    @test all(diff(bid_px[1:8, :]; dims = 1) .≈ -0.25)
+
+    features = tensor.features[:, :, 1:n]
+    @test features[1, :, :] ≈ cumsum(bid_sz; dims = 1)
+    @test features[2, :, :] ≈ cumsum(ask_sz; dims = 1)
+    @test features[3, 1, :] ≈ (bid_sz[1, :] .- ask_sz[1, :]) ./ (bid_sz[1, :] .+ ask_sz[1, :])
+    @test features[4, 1, :] ≈ (bid_px[1, :] .* ask_sz[1, :] .+ ask_px[1, :] .* bid_sz[1, :]) ./
+                              (bid_sz[1, :] .+ ask_sz[1, :])
+    @test any(isnan, features[4, 10, :])
+
+    raw = Mbp10Tensor(16; features = false)
+    @test read_depth!(DbnFileStore(path), raw; scale_prices = false) == 16
+    @test raw.features === nothing
+    @test raw.depth[1, 1, :] ≈ tensor.depth[1, 1, 1:16] .* 1e9
+    @test raw.instrument_id == tensor.instrument_id[1:16]
+end
+
+@testset "Databento.jl - Pipeline Instrumentation" begin
+    dir = mktempdir()
+    plain = joinpath(dir, "mbo.dbn")
+    compressed = joinpath(dir, "mbo.dbn.zst")
+    write_synthetic_dbn(plain; instruments = 4, records = 20_000)
+    write_synthetic_dbn(compressed; instruments = 4, records = 20_000)
+
+    store = ProfiledDbnFileStore(compressed; latency = true)
+    cols = MboColumns(4_096)
+    total = 0
+    while (n = read_columns!(store, cols)) > 0
+        total += n
+    end
+    stats = pipeline_stats(store)
+    @test total == 20_000
+    @test stats.records_decoded == stats.records_delivered == 20_000
+    @test stats.records_filtered == 0
+    @test stats.bytes_read == filesize(compressed)
+    @test stats.bytes_decompressed == filesize(plain)
+    @test stats.decompress_ns > 0
+    @test stats.elapsed_ns >= stats.read_ns + stats.decompress_ns
+
+    # Synthetic records are received 1 us after the event with no venue delta
+    latency = latency_stats(store; percentiles = (50, 99))
+    @test latency.recv_delay.count == 20_000
+    @test latency.recv_delay.min == latency.recv_delay.max == 1_000
+    @test latency.recv_delay.percentiles == [50.0 => 1_000, 99.0 => 1_000]
+    @test latency.ts_in_delta.max == 0
+    @test latency.send_delay.count == 0
+
+    filter = record_filter(instrument_ids = [1])
+    store = ProfiledDbnFileStore(plain)
+    matched = 0
+    while (n = read_columns!(store, cols; filter = filter)) > 0
+        matched += n
+    end
+    stats = pipeline_stats(store)
+    @test stats.bytes_read == stats.bytes_decompressed == filesize(plain)
+    @test stats.records_delivered == matched
+    @test stats.records_filtered == 20_000 - matched
+    @test stats.decompress_ns == 0
+    @test_throws ArgumentError latency_stats(store)
+end
+
+@testset "Databento.jl - Record Demultiplexer" begin
+    dir = mktempdir()
+    schemas = (MBO, TRADES, MBP1, MBP10, OHLCV_1S)
+    parts = [joinpath(dir, "part$i.dbn") for i in eachindex(schemas)]
+    for (path, schema) in zip(parts, schemas)
+        write_synthetic_dbn(path; schema = schema, instruments = 3, records = 1_000, seed = 7)
+    end
+    store = DbnFileStore(parts[1])
+    mixed = joinpath(dir, "mixed.dbn")
+    writer = DbnWriter(mixed, Databento.get_metadata(store))
+    for path in parts
+        write_records!(writer, DbnFileStore(path))
+    end
+    close(writer)
+
+    demux = RecordDemux()
+    @test demux!(demux, DbnFileStore(mixed)) == 5_000
+    counts = demux_counts(demux)
+    @test counts.MboMsg == counts.TradeMsg == counts.Mbp1Msg == counts.Mbp10Msg ==
+          counts.OhlcvMsg == 1_000
+    @test counts.StatMsg == 0 && counts.skipped == 0
+
+    trades = TradeColumns(1_000)
+    read_columns!(DbnFileStore(parts[2]), trades)
+    @test Databento.price.(demuxed(demux, Databento.TradeMsg)) == trades.price
+    @test length(demuxed(demux, Databento.Mbp10Msg)) == 1_000
+    @test isempty(demuxed(demux, Databento.StatusMsg))
+
+    # Appends across calls; a filter runs before the split
+    @test demux!(demux, DbnFileStore(mixed); max_records = 10) == 10
+    @test demux_counts(demux).MboMsg == 1_010
+    empty!(demux)
+    demux!(demux, DbnFileStore(mixed); filter = record_filter(rtypes = (Databento.RTYPE_MBP1,)))
+    @test sum(values(demux_counts(demux))) == demux_counts(demux).Mbp1Msg == 1_000
+    @test_throws Exception demuxed(demux, Float64)
+end
+
+@testset "Databento.jl - As-of Join" begin
+    dir = mktempdir()
+    trades_path = joinpath(dir, "trades.dbn")
+    quotes_path = joinpath(dir, "mbp1.dbn")
+    write_synthetic_dbn(trades_path; schema = TRADES, instruments = 4, records = 2_000, seed = 3)
+    write_synthetic_dbn(quotes_path; schema = MBP1, instruments = 4, records = 6_000, seed = 4)
+    trades = TradeColumns(2_000)
+    read_columns!(DbnFileStore(trades_path), trades)
+    quotes = Mbp1Columns(6_000)
+    read_columns!(DbnFileStore(quotes_path), quotes)
+
+    # Bid of the last quote of `id` at or before `ts`, by brute force
+    function prevailing_bid(id, ts; exact = true, tolerance = 0)
+        i = findlast(eachindex(quotes.ts_recv)) do j
+            quotes.instrument_id[j] == id &&
+                (exact ? quotes.ts_recv[j] <= ts : quotes.ts_recv[j] < ts)
+        end
+        stale = i !== nothing && tolerance > 0 && ts - quotes.ts_recv[i] > tolerance
+        return i === nothing || stale ? typemax(Int64) : quotes.bid_px[i]
+    end
+
+    # Joins in batches of 300 rows, collecting the bids and bid markouts
+    function run_join(join)
+        trade_store, quote_store = DbnFileStore(trades_path), DbnFileStore(quotes_path)
+        cols = AsofJoinColumns(join, 300)
+        ts_recv, bids, markouts = UInt64[], Int64[], Matrix{Int64}(undef, size(cols.markout_bid, 1), 0)
+        while true
+            n = asof_join!(join, trade_store, quote_store, cols)
+            append!(ts_recv, cols.ts_recv[1:n])
+            append!(bids, cols.bid_px[1:n])
+            markouts = hcat(markouts, cols.markout_bid[:, 1:n])
+            n < length(cols) && return ts_recv, bids, markouts
+        end
+    end
+
+    join = AsofJoin(; horizons = (5_000, 0, 20_000))
+    @test join_horizons(join) == [0, 5_000, 20_000]
+    ts_recv, bids, markouts = run_join(join)
+    @test ts_recv == trades.ts_recv
+    @test bids == prevailing_bid.(trades.instrument_id, trades.ts_recv)
+    for (k, h) in enumerate(join_horizons(join))
+        @test markouts[k, :] == prevailing_bid.(trades.instrument_id, trades.ts_recv .+ h)
+    end
+    stats = join_stats(join)
+    @test stats.trades_joined == 2_000 && stats.complete && stats.pending_rows == 0
+    @test stats.instruments == 4 && stats.records_skipped == 0
+    # Quotes past the last markout are never read
+    @test stats.quotes_applied < 6_000
+    @test stats.trades_without_quote == count(==(typemax(Int64)), bids)
+
+    join = AsofJoin(; exact_matches = false, tolerance = 3_000)
+    _, bids, markouts = run_join(join)
+    @test size(markouts, 1) == 0
+    @test bids == prevailing_bid.(trades.instrument_id, trades.ts_recv;
+                                  exact = false, tolerance = 3_000)
+
+    # Sources of different types share the one type-erased join loop
+    join = AsofJoin()
+    cols = AsofJoinColumns(join, 4_000)
+    @test asof_join!(join, MmapDbnReader(trades_path), DbnFileStore(quotes_path), cols) == 2_000
+    @test cols.bid_px[1:2_000] == prevailing_bid.(trades.instrument_id, trades.ts_recv)
+
+    # Trades against trades: nothing to quote
+    join = AsofJoin()
+    cols = AsofJoinColumns(join, 4_000)
+    @test asof_join!(join, DbnFileStore(trades_path), DbnFileStore(trades_path), cols) == 2_000
+    @test all(==(typemax(UInt64)), cols.quote_ts_recv[1:2_000])
+    @test join_stats(join).records_skipped == 2_000
+    @test_throws DimensionMismatch asof_join!(AsofJoin(; horizons = (1,)), DbnFileStore(trades_path),
+                                              DbnFileStore(quotes_path), cols)
+end
+
+@testset "Databento.jl - Shared Block Cache" begin
+    dir = mktempdir()
+    path = joinpath(dir, "trades.dbn")
+    write_synthetic_dbn(path; schema = TRADES, instruments = 4, records = 20_000, seed = 5)
+    expected = TradeColumns(20_000)
+    @test read_columns!(DbnFileStore(path), expected) == 20_000
+    # The sidecar index defines the blocks
+    @test build_ts_index(path; stride = 1_000) >= 20
+
+    saved_budget = block_cache_stats().budget
+    clear_block_cache!()
+    try
+        cold = CachedDbnReader(path)
+        cols = TradeColumns(20_000)
+        @test read_columns!(cold, cols) == 20_000
+        @test cols.ts_event == expected.ts_event && cols.price == expected.price
+        blocks = Databento.block_count(cold)
+        @test Databento.cache_misses(cold) == blocks && Databento.cache_hits(cold) == 0
+
+        # A second reader of the file is served entirely from the cache
+        warm = CachedDbnReader(path)
+        @test read_columns!(warm, cols) == 20_000
+        @test cols.price == expected.price
+        @test Databento.cache_hits(warm) == blocks && Databento.cache_misses(warm) == 0
+        stats = block_cache_stats()
+        @test stats.blocks == blocks && stats.hits == blocks && stats.misses == blocks
+        @test stats.hit_rate == 0.5 && 0 < stats.bytes <= stats.budget
+
+        ts = expected.ts_event[12_345]
+        seek(warm, ts)
+        @test read_columns!(warm, cols) == 20_000 - findfirst(>=(ts), expected.ts_event) + 1
+        Databento.rewind!(warm)
+        @test read_columns!(warm, cols) == 20_000
+
+        # Readers on several threads decode and hit the same blocks at once
+        clear_block_cache!()
+        matches = fill(false, 8)
+        Threads.@threads for t in 1:8
+            thread_cols = TradeColumns(20_000)
+            for _ in 1:3
+                n = read_columns!(CachedDbnReader(path), thread_cols)
+                matches[t] = n == 20_000 && thread_cols.price == expected.price
+            end
+        end
+        @test all(matches)
+        stats = block_cache_stats()
+        @test stats.blocks == blocks && stats.hits + stats.misses == 24 * blocks
+        @test stats.misses >= blocks
+
+        # A small budget evicts down to it, and evicted blocks are decoded again
+        set_block_cache_budget!(stats.bytes ÷ 4)
+        stats = block_cache_stats()
+        @test stats.bytes <= stats.budget && stats.evictions > 0 && stats.blocks < blocks
+        @test read_columns!(CachedDbnReader(path), cols) == 20_000
+        @test cols.price == expected.price
+        @test block_cache_stats().bytes <= stats.budget
+
+        # Eviction drops the least recently used blocks of the whole cache:
+        # after a full read, touching the first block again keeps it
+        clear_block_cache!()
+        set_block_cache_budget!(saved_budget)
+        recent = CachedDbnReader(path)
+        @test read_columns!(recent, cols) == 20_000
+        seek(recent, expected.ts_event[1])
+        set_block_cache_budget!(block_cache_stats().bytes ÷ 2)
+        probe = CachedDbnReader(path)
+        seek(probe, expected.ts_event[1])
+        seek(probe, expected.ts_event[end])
+        @test Databento.cache_hits(probe) == 2
+        seek(probe, expected.ts_event[1_001])
+        @test Databento.cache_misses(probe) == 1
+    finally
+        set_block_cache_budget!(saved_budget)
+        clear_block_cache!()
+    end
+    @test block_cache_stats().blocks == 0
+    @test_throws Exception CachedDbnReader(joinpath(dir, "missing.dbn"))
+end
+
+@testset "Databento.jl - Dataset Catalog" begin
+    root = mktempdir()
+    day = 86_400 * 10^9
+    t0 = 1_704_153_600_000_000_000
+    path(parts...) = (p = joinpath(root, parts...); mkpath(dirname(p)); p)
+    write_synthetic_dbn(path("glbx", "2024-01-02", "trades.dbn"); schema = TRADES,
+                        instruments = 4, records = 1_000, start = t0)
+    write_synthetic_dbn(path("glbx", "2024-01-03", "trades.dbn.zst"); schema = TRADES,
+                        instruments = 4, records = 1_000, start = t0 + day)
+    write_synthetic_dbn(path("glbx", "2024-01-03", "mbo.dbn"); schema = MBO,
+                        instruments = 2, records = 1_000, start = t0 + day)
+    write_synthetic_dbn(path("xnas", "2024-01-02", "trades.dbn"); schema = TRADES,
+                        instruments = 8, records = 1_000, start = t0, dataset = "XNAS.ITCH")
+    write(path("glbx", "corrupt.dbn"), "not a dbn file")
+    write(path("glbx", "README.txt"), "ignored")
+
+    catalog = DbnCatalog(root; threads = 2)
+    @test length(catalog) == 4
+    @test isfile(joinpath(root, ".dbn_catalog"))
+    stats = refresh!(catalog)
+    @test stats.scanned == 5 && stats.added + stats.updated + stats.removed == 0
+    @test stats.failed == [joinpath("glbx", "corrupt.dbn")]
+
+    names(files) = [relpath(f, root) for f in files]
+    @test length(catalog_files(catalog)) == 4
+    @test names(catalog_files(catalog; dataset = "GLBX.MDP3", schema = TRADES)) ==
+          [joinpath("glbx", "2024-01-02", "trades.dbn"), joinpath("glbx", "2024-01-03", "trades.dbn.zst")]
+    @test names(catalog_files(catalog; ts = (t0 + day, t0 + 2day))) ==
+          [joinpath("glbx", "2024-01-03", "mbo.dbn"), joinpath("glbx", "2024-01-03", "trades.dbn.zst")]
+    @test names(catalog_files(catalog; symbols = ["SYN7"])) == [joinpath("xnas", "2024-01-02", "trades.dbn")]
+    @test length(catalog_files(catalog; symbols = ["SYN2"], ts = (t0, t0 + 1))) == 2
+    @test isempty(catalog_files(catalog; dataset = "OPRA.PILLAR"))
+    @test isempty(catalog_files(catalog; ts = (t0 + 3day, t0 + 4day)))
+
+    # A parent request is indexed by its resolved raw symbols, or matches any
+    # symbol when it was resolved to instrument IDs
+    parents = mktempdir()
+    write_synthetic_dbn(joinpath(parents, "raw.dbn"); schema = TRADES, instruments = 4,
+                        records = 100, start = t0, parent = "ES.FUT", stype_out = RAW_SYMBOL)
+    write_synthetic_dbn(joinpath(parents, "ids.dbn"); schema = TRADES, instruments = 4,
+                        records = 100, start = t0, parent = "ES.FUT")
+    parent_catalog = DbnCatalog(parents)
+    parent_names(symbols) = [relpath(f, parents) for f in catalog_files(parent_catalog; symbols)]
+    @test parent_names(["SYN2"]) == ["ids.dbn", "raw.dbn"]
+    @test parent_names(["ES.FUT"]) == ["ids.dbn", "raw.dbn"]
+    @test parent_names(["SYN9"]) == ["ids.dbn"]
+
+    # The planned files are scanned as one merged stream
+    reader = catalog_reader(catalog; schema = TRADES, threads = 2)
+    @test Databento.file_count(reader) == 3
+    cols = TradeColumns(4_000)
+    @test read_columns!(reader, cols) == 3_000
+    @test issorted(cols.ts_recv[1:3_000])
+
+    # A new catalog loads the manifest and only decodes what changed
+    rm(joinpath(root, "xnas"); recursive = true)
+    write_synthetic_dbn(joinpath(root, "glbx", "corrupt.dbn"); schema = TRADES,
+                        instruments = 4, records = 10, start = t0 + 2day)
+    reopened = DbnCatalog(root; refresh = false)
+    @test length(reopened) == 4
+    stats = refresh!(reopened)
+    @test stats.added == 1 && stats.removed == 1 && stats.updated == 0 && isempty(stats.failed)
+    @test names(catalog_files(reopened; ts = (t0 + 2day, t0 + 3day))) == [joinpath("glbx", "corrupt.dbn")]
+    @test length(DbnCatalog(root; refresh = false)) == 4
+
+    write(joinpath(root, "bad_manifest"), "garbage")
+    @test_throws Exception DbnCatalog(root; manifest = joinpath(root, "bad_manifest"))
+
+    # Counts and lengths past the end of the manifest are rejected before allocating
+    manifest = read(joinpath(root, ".dbn_catalog"))
+    read_at(T, offset) = reinterpret(T, manifest[offset + 1:offset + sizeof(T)])[1]
+    entries_at = 24
+    for _ in 1:read_at(UInt64, 16)
+        entries_at += 4 + read_at(UInt32, entries_at)
+    end
+    symbols_at = entries_at + 12 + read_at(UInt32, entries_at + 8) + 40
+    for (offset, value) in ((16, typemax(UInt64)), (24, typemax(UInt32)), (entries_at, typemax(UInt64)),
+                            (entries_at + 8, typemax(UInt32)), (symbols_at, typemax(UInt32)))
+        corrupt = copy(manifest)
+        corrupt[offset + 1:offset + sizeof(value)] = reinterpret(UInt8, [value])
+        write(joinpath(root, "bad_manifest"), corrupt)
+        @test_throws Exception DbnCatalog(root; manifest = joinpath(root, "bad_manifest"))
+    end
+end
+
+@testset "Databento.jl - Cached Parallel Downloads" begin
+    fixture = tempname() * ".dbn"
+    write_synthetic_dbn(fixture; schema = TRADES, instruments = 3, records = 100)
+    process, port, log = serve_historical(fixture; fail_first = 1)
+    requests() = readlines(log)
+    cache = mktempdir()
+    day = 86_400 * 10^9
+    t0 = 1_704_153_600_000_000_000
+    key = "db-" * "x"^29
+    query = (dataset = "GLBX.MDP3", symbols = ["SYN3", "SYN1", "SYN2"], schema = TRADES,
+             start = t0 + 3_600 * 10^9, stop = t0 + 2day)
+    try
+        manager = DownloadManager(; cache_dir = cache, key, gateway = "127.0.0.1", port,
+                                  max_in_flight = 3, symbols_per_request = 2, retry_delay = 0.01)
+        # Two days by two symbol batches
+        @test length(Databento.planned_paths(manager, query.dataset, StdVector(query.symbols),
+                                             TRADES, UInt64(query.start), UInt64(query.stop),
+                                             RAW_SYMBOL, INSTRUMENT_ID)) == 4
+        paths = download!(manager; query...)
+        @test length(paths) == 4 && allunique(paths) && all(p -> dirname(p) == cache, paths)
+        @test all(p -> read(p) == read(fixture), paths)
+        stats = download_stats(manager)
+        @test stats.pieces_downloaded == 4 && stats.retries == 1 && stats.cache_hits == 0
+        @test stats.bytes_downloaded == 4 * filesize(fixture)
+        @test length(requests()) == 5
+        # Batches follow the symbols' hashes, not their sorted positions
+        @test count(body -> occursin(r"SYN2(,|%2C)SYN3", body), requests()) >= 2
+
+        # The same symbols in any order are served from the cache
+        @test download!(manager; query..., symbols = ["SYN2", "SYN1", "SYN3", "SYN1"]) == paths
+        @test length(requests()) == 5 && download_stats(manager).cache_hits == 4
+
+        # Adding a symbol only replaces the batch it hashes into
+        planned(symbols) = Databento.planned_paths(manager, query.dataset, StdVector(symbols), TRADES,
+                                                   UInt64(query.start), UInt64(query.stop),
+                                                   RAW_SYMBOL, INSTRUMENT_ID)
+        grown = planned(["SYN1", "SYN2", "SYN3", "SYN4"])
+        @test length(grown) == 6 && count(in(paths), grown) == 4
+        @test count(in(paths), planned(["SYN1", "SYN3"])) == 0
+        @test count(in(paths), planned(["SYN2", "SYN3"])) == 2
+
+        # So is the overlap of a longer request, from a new manager
+        manager = DownloadManager(; cache_dir = cache, key, gateway = "127.0.0.1", port,
+                                  symbols_per_request = 2)
+        longer = download!(manager; query..., stop = t0 + 3day)
+        @test longer[1:4] == paths && length(longer) == 6 && length(requests()) == 7
+        reader = MultiDbnReader(longer)
+        n = 0
+        while Databento.next_record(reader) != C_NULL
+            n += 1
+        end
+        @test n == 600
+    finally
+        kill(process)
+    end
+
+    # Nothing listens any more: every attempt of both pieces fails
+    failing = DownloadManager(; cache_dir = cache, key, gateway = "127.0.0.1", port,
+                              symbols_per_request = 2, max_attempts = 2, retry_delay = 0.001)
+    @test_throws Exception download!(failing; query..., start = t0 + 5day, stop = t0 + 6day)
+    stats = download_stats(failing)
+    @test stats.pieces_failed == 2 && stats.retries == 2 && stats.pieces_downloaded == 0
+    @test !any(endswith(".part"), readdir(cache))
+    @test_throws Exception download!(failing; query..., stop = query.start)
+end
+
+@testset "Databento.jl - Record Field Tables" begin
+    dir = mktempdir()
+    path = joinpath(dir, "ohlcv.dbn")
+    write_synthetic_dbn(path; schema = OHLCV_1S, instruments = 3, records = 500, seed = 5)
+    demux = RecordDemux()
+    demux!(demux, DbnFileStore(path))
+    bars = demuxed(demux, Databento.OhlcvMsg)
+    cols = OhlcvColumns(500)
+    @test read_columns!(DbnFileStore(path), cols) == 500
+
+    # Generated accessors
+    @test Databento.open.(bars) == cols.open
+    @test Databento.close.(bars) == cols.close
+    @test Databento.volume.(bars) == cols.volume
+    @test Databento.instrument_id.(Databento.hd.(bars)) == cols.instrument_id
+
+    # Direct loads agree with them
+    layout = record_layout(Databento.OhlcvMsg)
+    @test [f.name for f in layout] == [:hd, :open, :high, :low, :close, :volume]
+    @test all(f -> f.offset + f.size <= sizeof(Databento.OhlcvMsg), layout)
+    @test load_field.(Int64, bars, field_offset(Databento.OhlcvMsg, :high)) == cols.high
+    @test load_field.(UInt64, bars, field_offset(Databento.OhlcvMsg, :volume)) == cols.volume
+    @test_throws ArgumentError field_offset(Databento.OhlcvMsg, :price)
+    @test_throws BoundsError load_field(Int64, bars[1], sizeof(Databento.OhlcvMsg))
+
+    # Every record type is covered, with fields laid out within the struct
+    for T in (Databento.MboMsg, Databento.TradeMsg, Databento.Mbp1Msg, Databento.Mbp10Msg,
+              Databento.BboMsg, Databento.Cmbp1Msg, Databento.CbboMsg, Databento.OhlcvMsg,
+              Databento.StatusMsg, Databento.InstrumentDefMsg, Databento.ImbalanceMsg,
+              Databento.StatMsg, Databento.ErrorMsg, Databento.SystemMsg,
+              Databento.SymbolMappingMsg)
+        layout = record_layout(T)
+        @test first(layout).name === :hd && first(layout).offset == 0
+        @test all(f -> f.offset + f.size <= sizeof(T), layout)
+        @test all(f -> hasmethod(getfield(Databento, f.name), Tuple{T}), layout)
+    end
+    @test (name = :stype_in_symbol, offset = 17, size = 71) in record_layout(Databento.SymbolMappingMsg)
+    @test hasmethod(Databento.err, Tuple{Databento.ErrorMsg})
+    @test hasmethod(Databento.bid_pb, Tuple{Databento.ConsolidatedBidAskPair})
+end
+
+@testset "Databento.jl - DBN Summary Scan" begin
+    dir = mktempdir()
+    plain = joinpath(dir, "mbo.dbn")
+    compressed = joinpath(dir, "mbo.dbn.zst")
+    write_synthetic_dbn(plain; instruments = 4, records = 20_000, seed = 6)
+    write_synthetic_dbn(compressed; instruments = 4, records = 20_000, seed = 6)
+    cols = MboColumns(20_000)
+    @test read_columns!(DbnFileStore(plain), cols) == 20_000
+
+    # Reference per-instrument counts from the decoded columns
+    expected = Dict{UInt32,Any}()
+    for id in sort(unique(cols.instrument_id))
+        seqs = cols.sequence[cols.instrument_id .== id]
+        steps = Int64.(seqs[2:end]) .- Int64.(seqs[1:end-1])
+        expected[id] = (records = length(seqs), first = first(seqs), last = last(seqs),
+                        gaps = count(>(1), steps), missing = sum(s - 1 for s in steps if s > 1; init = 0),
+                        resets = count(<(0), steps))
+    end
+
+    s = summarize_dbn(plain)
+    @test s.records == 20_000
+    @test !s.compressed && s.frames == 0
+    @test s.file_size == filesize(plain)
+    @test s.rtypes == Dict(Databento.RTYPE_MBO => 20_000)
+    @test s.publishers == Dict(UInt16(1) => 20_000)
+    @test s.ts_event == extrema(cols.ts_event)
+    @test s.instruments.instrument_id == sort(collect(keys(expected)))
+    for (i, id) in enumerate(s.instruments.instrument_id)
+        e = expected[id]
+        @test s.instruments.records[i] == s.instruments.sequenced[i] == e.records
+        @test s.instruments.first_sequence[i] == e.first
+        @test s.instruments.last_sequence[i] == e.last
+        @test s.instruments.sequence_gaps[i] == e.gaps
+        @test s.instruments.missing_sequences[i] == e.missing
+        @test s.instruments.sequence_resets[i] == e.resets
+    end
+
+    # Same summary from a single-frame and a many-frame compressed copy
+    store = DbnFileStore(plain)
+    framed = joinpath(dir, "framed.dbn.zst")
+    writer = DbnWriter(framed, Databento.get_metadata(store); frame_size = 4096, threads = 2)
+    write_records!(writer, DbnFileStore(plain))
+    close(writer)
+    strip_scan(x) = Base.structdiff(x, NamedTuple{(:compressed, :file_size, :frames, :runs, :runs_rescanned)})
+    for (path, threads) in ((compressed, 0), (framed, 1), (framed, 4), (framed, 0))
+        z = summarize_dbn(path; threads)
+        @test z.compressed && z.file_size == filesize(path)
+        @test strip_scan(z) == strip_scan(s)
+        @test z.runs_rescanned == 0
+    end
+    @test summarize_dbn(compressed).frames == 1
+    framed_summary = summarize_dbn(framed; threads = 4)
+    @test framed_summary.frames > 10 && framed_summary.runs > 1
+
+    # Frames that cut records: runs starting inside a record are scanned again
+    split = joinpath(dir, "split.dbn.zst")
+    write_synthetic_dbn(split; instruments = 4, records = 20_000, seed = 6, frame_size = 1_000)
+    @test strip_scan(summarize_dbn(split; threads = 1)) == strip_scan(s)
+    split_summary = summarize_dbn(split; threads = 4)
+    @test strip_scan(split_summary) == strip_scan(s)
+    @test split_summary.runs > 1 && split_summary.runs_rescanned > 0
+
+    # A truncated trailing record is not counted
+    truncated = joinpath(dir, "truncated.dbn")
+    write(truncated, read(plain)[1:end-10])
+    @test summarize_dbn(truncated).records == 19_999
+    @test_throws Exception summarize_dbn(joinpath(dir, "missing.dbn"))
+end